@@ -221,12 +221,16 @@ namespace rwe
 
         MapFeatureService featureService(&vfs);
 
+        // The most recent game is always recorded, so it can be replayed headlessly.
+        auto replayPath = (localDataPath / "last_game.rwreplay").string();
+
         if (mapName)
         {
             logger.info("Launching into map: {0}", *mapName);
             GameParameters params{*mapName, 0};
             params.players[0] = PlayerInfo{PlayerInfo::Controller::Human, "ARM", 0};
             params.players[1] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 1};
+            params.replayPath = replayPath;
             auto scene = std::make_unique<LoadingScene>(
                 &vfs,
                 &textureService,
@@ -264,7 +268,8 @@ namespace rwe
                 &sideDataMap,
                 &viewportService,
                 viewportService.width(),
-                viewportService.height());
+                viewportService.height(),
+                replayPath);
             sceneManager.setNextScene(std::move(scene));
         }
 
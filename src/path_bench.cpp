@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <rwe/MovementClass.h>
+#include <rwe/MovementClassCollisionService.h>
+#include <rwe/OccupiedGrid.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/pathfinding/UnitPathFinder.h>
+#include <rwe/pathfinding/UnitPerimeterPathFinder.h>
+#include <rwe/pathfinding/pathfinding_utils.h>
+#include <rwe/tnt/TntArchive.h>
+#include <string>
+#include <vector>
+
+/**
+ * Runs UnitPathFinder and UnitPerimeterPathFinder over a fixed set of maps
+ * and reports, for each map and pathfinder,
+ * how many vertices the searches expanded, how long they took,
+ * how many heap allocations they made and how long the paths were.
+ *
+ * The generated maps are an open field, a maze of corridors walled off by features
+ * and a group of islands, some joined by bridges and some cut off.
+ * Each TNT file given on the command line adds a map with its heightmap and sea level;
+ * its features are not placed.
+ *
+ * Every map gets the same number of searches between cells picked by a fixed seed,
+ * so runs on the same maps always make the same searches
+ * and any change to the pathfinders can be measured against them.
+ * Each search is repeated and the time is averaged over the repeats.
+ */
+
+static std::atomic<std::size_t> allocationCount{0};
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size == 0 ? 1 : size); p != nullptr)
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace rwe
+{
+    /** Width and height of the generated maps in heightmap cells. */
+    static const unsigned int GeneratedMapSize = 256;
+
+    static const unsigned int SearchesPerMap = 32;
+
+    /** Searches are at least this fraction of the map's width or height long, so that they cross a good part of it. */
+    static const unsigned int MinSearchStepsDivisor = 4;
+
+    /** Side of the square goal given to UnitPerimeterPathFinder, as if attacking a building. */
+    static const unsigned int GoalRectSize = 4;
+
+    static const unsigned int RandomSeed = 20240601;
+
+    /** Roughly a medium tank. */
+    static const MovementClass BenchMovementClass{"BENCHTANK", 2, 2, 0, 22, 16, 22};
+
+    /** A map to search across, with the walkable grid of BenchMovementClass. */
+    struct BenchMap
+    {
+        std::string name;
+        OccupiedGrid occupiedGrid;
+        MovementClassCollisionService collisionService;
+        MovementClassId movementClass;
+    };
+
+    struct Search
+    {
+        Point start;
+        Point goal;
+    };
+
+    struct SearchTotals
+    {
+        unsigned int searches{0};
+        unsigned int complete{0};
+        std::size_t expansions{0};
+        std::size_t allocations{0};
+        std::chrono::nanoseconds time{0};
+        double pathLength{0.0};
+    };
+
+    BenchMap createMap(const std::string& name, const Grid<unsigned char>& heights, unsigned int seaLevel, ThreadPool& threadPool)
+    {
+        auto grids = computeWalkableGrids(heights, seaLevel, {BenchMovementClass}, threadPool);
+
+        MovementClassCollisionService collisionService;
+        auto movementClass = collisionService.registerMovementClass(BenchMovementClass.name, std::move(grids.front()));
+
+        return BenchMap{name, OccupiedGrid(heights.getWidth(), heights.getHeight()), std::move(collisionService), movementClass};
+    }
+
+    BenchMap createOpenField(ThreadPool& threadPool)
+    {
+        Grid<unsigned char> heights(GeneratedMapSize, GeneratedMapSize, 100);
+        return createMap("open field", heights, 0, threadPool);
+    }
+
+    /**
+     * A maze carved by a randomised depth-first search,
+     * with corridors wide enough for the unit to pass
+     * and walls made of features.
+     * It is half the size of the other maps,
+     * since winding through the whole of a bigger one
+     * takes more than a single search may explore.
+     */
+    BenchMap createMaze(ThreadPool& threadPool)
+    {
+        static const unsigned int Size = GeneratedMapSize / 2;
+        static const unsigned int Pitch = 8;
+        static const unsigned int WallWidth = 2;
+        static const unsigned int CorridorWidth = Pitch - WallWidth;
+
+        Grid<unsigned char> heights(Size, Size, 100);
+        auto map = createMap("maze", heights, 0, threadPool);
+
+        auto& occupiedGrid = map.occupiedGrid;
+        occupiedGrid.setArea(GridRegion(0, 0, Size, Size), OccupiedFeature(FeatureId(1)));
+
+        const unsigned int cellsAcross = Size / Pitch;
+        Grid<char> visited(cellsAcross, cellsAcross, false);
+        auto carveCell = [&](unsigned int x, unsigned int y) {
+            visited.set(x, y, true);
+            occupiedGrid.setArea(GridRegion(x * Pitch + WallWidth, y * Pitch + WallWidth, CorridorWidth, CorridorWidth), OccupiedNone());
+        };
+
+        std::mt19937 random(RandomSeed);
+        std::vector<std::pair<unsigned int, unsigned int>> stack{{0, 0}};
+        carveCell(0, 0);
+        while (!stack.empty())
+        {
+            auto [x, y] = stack.back();
+
+            std::vector<std::pair<int, int>> unvisited;
+            for (auto [dx, dy] : {std::pair(-1, 0), std::pair(1, 0), std::pair(0, -1), std::pair(0, 1)})
+            {
+                auto nx = static_cast<int>(x) + dx;
+                auto ny = static_cast<int>(y) + dy;
+                if (nx >= 0 && ny >= 0 && nx < static_cast<int>(cellsAcross) && ny < static_cast<int>(cellsAcross) && !visited.get(nx, ny))
+                {
+                    unvisited.emplace_back(dx, dy);
+                }
+            }
+
+            if (unvisited.empty())
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            auto [dx, dy] = unvisited[random() % unvisited.size()];
+            auto nx = x + dx;
+            auto ny = y + dy;
+
+            // knock through the wall between the two cells
+            auto wallX = std::min(x, nx) * Pitch + WallWidth;
+            auto wallY = std::min(y, ny) * Pitch + WallWidth;
+            auto width = dx != 0 ? Pitch + CorridorWidth : CorridorWidth;
+            auto height = dy != 0 ? Pitch + CorridorWidth : CorridorWidth;
+            occupiedGrid.setArea(GridRegion(wallX, wallY, width, height), OccupiedNone());
+
+            carveCell(nx, ny);
+            stack.emplace_back(nx, ny);
+        }
+
+        return map;
+    }
+
+    /**
+     * Nine round islands in deep water.
+     * The islands in the top two rows are joined by bridges,
+     * but the bottom row is cut off from the rest,
+     * so searches from there to the top end as partial paths.
+     */
+    BenchMap createIslands(ThreadPool& threadPool)
+    {
+        static const unsigned int SeaLevel = 40;
+        static const unsigned char Land = 60;
+        static const int BridgeWidth = 6;
+
+        Grid<unsigned char> heights(GeneratedMapSize, GeneratedMapSize, 0);
+
+        const int spacing = GeneratedMapSize / 3;
+        const int radius = spacing / 3;
+        auto center = [&](int i) { return (i * spacing) + (spacing / 2); };
+
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                for (int y = center(row) - radius; y <= center(row) + radius; ++y)
+                {
+                    for (int x = center(column) - radius; x <= center(column) + radius; ++x)
+                    {
+                        auto dx = x - center(column);
+                        auto dy = y - center(row);
+                        if ((dx * dx) + (dy * dy) <= radius * radius)
+                        {
+                            heights.set(x, y, Land);
+                        }
+                    }
+                }
+            }
+
+            if (row < 2)
+            {
+                heights.setArea(center(0), center(row) - (BridgeWidth / 2), center(2) - center(0), BridgeWidth, Land);
+            }
+        }
+
+        heights.setArea(center(0) - (BridgeWidth / 2), center(0), BridgeWidth, center(1) - center(0), Land);
+
+        return createMap("islands", heights, SeaLevel, threadPool);
+    }
+
+    BenchMap loadTntMap(const std::string& path, ThreadPool& threadPool)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            throw std::runtime_error("Failed to open " + path);
+        }
+
+        TntArchive tnt(&stream);
+        Grid<TntTileAttributes> mapAttributes(tnt.getHeader().width, tnt.getHeader().height);
+        tnt.readMapAttributes(mapAttributes.getData());
+
+        std::vector<unsigned char> heights;
+        heights.reserve(mapAttributes.getVector().size());
+        for (const auto& e : mapAttributes.getVector())
+        {
+            heights.push_back(e.height);
+        }
+        Grid<unsigned char> heightGrid(mapAttributes.getWidth(), mapAttributes.getHeight(), std::move(heights));
+
+        return createMap(path, heightGrid, tnt.getHeader().seaLevel, threadPool);
+    }
+
+    bool isWalkable(const BenchMap& map, const Point& p)
+    {
+        DiscreteRect rect(p.x, p.y, BenchMovementClass.footprintX, BenchMovementClass.footprintZ);
+        return map.collisionService.isWalkable(map.movementClass, p) && !map.occupiedGrid.isCollisionAt(rect, UnitId(0));
+    }
+
+    /** Picks searches between walkable cells, the same ones for the same map every time. */
+    std::vector<Search> pickSearches(const BenchMap& map)
+    {
+        std::mt19937 random(RandomSeed);
+        auto width = map.occupiedGrid.grid.getWidth();
+        auto height = map.occupiedGrid.grid.getHeight();
+        auto randomCell = [&]() {
+            return Point(static_cast<int>(random() % width), static_cast<int>(random() % height));
+        };
+
+        static const unsigned int MaxAttempts = 100000;
+        auto minSteps = static_cast<int>(std::min(width, height) / MinSearchStepsDivisor);
+
+        std::vector<Search> searches;
+        for (unsigned int attempt = 0; attempt < MaxAttempts && searches.size() < SearchesPerMap; ++attempt)
+        {
+            auto start = randomCell();
+            auto goal = randomCell();
+            auto delta = goal - start;
+            if (std::max(std::abs(delta.x), std::abs(delta.y)) < minSteps)
+            {
+                continue;
+            }
+
+            if (isWalkable(map, start) && isWalkable(map, goal))
+            {
+                searches.push_back(Search{start, goal});
+            }
+        }
+
+        return searches;
+    }
+
+    /** Returns the goal rect as UnitPerimeterPathFinder expects it, expanded for the unit's footprint. */
+    DiscreteRect getGoalRect(const Point& goal)
+    {
+        auto offset = static_cast<int>(GoalRectSize / 2);
+        return DiscreteRect(
+            goal.x - offset - static_cast<int>(BenchMovementClass.footprintX),
+            goal.y - offset - static_cast<int>(BenchMovementClass.footprintZ),
+            GoalRectSize + BenchMovementClass.footprintX,
+            GoalRectSize + BenchMovementClass.footprintZ);
+    }
+
+    double getPathLength(const std::vector<Point>& path)
+    {
+        double length = 0.0;
+        for (std::size_t i = 1; i < path.size(); ++i)
+        {
+            length += octileDistance(path[i - 1], path[i]).asFloat();
+        }
+        return length;
+    }
+
+    template <typename F>
+    SearchTotals runSearches(const std::vector<Search>& searches, unsigned int repeats, F findPath)
+    {
+        SearchTotals totals;
+        for (const auto& search : searches)
+        {
+            std::optional<AStarPathInfo<Point, PathCost>> result;
+
+            auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < repeats; ++i)
+            {
+                result = findPath(search);
+            }
+            auto end = std::chrono::steady_clock::now();
+            auto allocationsAfter = allocationCount.load(std::memory_order_relaxed);
+
+            totals.searches += 1;
+            totals.time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start) / repeats;
+            totals.allocations += (allocationsAfter - allocationsBefore) / repeats;
+
+            // The start is expanded without an edge leading to it.
+            totals.expansions += result->closedEdges.size() + 1;
+
+            if (result->type == AStarPathType::Complete)
+            {
+                totals.complete += 1;
+                totals.pathLength += getPathLength(result->path);
+            }
+        }
+
+        return totals;
+    }
+
+    void printHeader()
+    {
+        std::cout << std::left
+                  << std::setw(24) << "map"
+                  << std::setw(11) << "finder"
+                  << std::right
+                  << std::setw(10) << "complete"
+                  << std::setw(14) << "expansions"
+                  << std::setw(12) << "time us"
+                  << std::setw(10) << "allocs"
+                  << std::setw(12) << "length"
+                  << std::endl;
+    }
+
+    /** Prints one line of means per search, with the path length averaged over complete paths. */
+    void printTotals(const std::string& mapName, const std::string& finderName, const SearchTotals& totals)
+    {
+        auto perSearch = [&](double value) { return totals.searches == 0 ? 0.0 : value / totals.searches; };
+        auto micros = std::chrono::duration<double, std::micro>(totals.time).count();
+
+        std::cout << std::left
+                  << std::setw(24) << mapName.substr(0, 23)
+                  << std::setw(11) << finderName
+                  << std::right << std::fixed
+                  << std::setw(10) << (std::to_string(totals.complete) + "/" + std::to_string(totals.searches))
+                  << std::setprecision(1)
+                  << std::setw(14) << perSearch(static_cast<double>(totals.expansions))
+                  << std::setw(12) << perSearch(micros)
+                  << std::setw(10) << perSearch(static_cast<double>(totals.allocations))
+                  << std::setw(12) << (totals.complete == 0 ? 0.0 : totals.pathLength / totals.complete)
+                  << std::endl;
+    }
+
+    void benchmarkMap(const BenchMap& map, unsigned int repeats)
+    {
+        auto searches = pickSearches(map);
+
+        // Searches share node storage, as they do on a worker thread.
+        AStarNodeGrid<PathCost> nodes;
+
+        auto pointTotals = runSearches(searches, repeats, [&](const Search& search) {
+            UnitPathFinder pathFinder(
+                &nodes,
+                &map.occupiedGrid,
+                &map.collisionService,
+                UnitId(0),
+                map.movementClass,
+                BenchMovementClass.footprintX,
+                BenchMovementClass.footprintZ,
+                search.goal);
+            return pathFinder.findPath(search.start);
+        });
+        printTotals(map.name, "point", pointTotals);
+
+        auto perimeterTotals = runSearches(searches, repeats, [&](const Search& search) {
+            UnitPerimeterPathFinder pathFinder(
+                &nodes,
+                &map.occupiedGrid,
+                &map.collisionService,
+                UnitId(0),
+                map.movementClass,
+                BenchMovementClass.footprintX,
+                BenchMovementClass.footprintZ,
+                getGoalRect(search.goal));
+            return pathFinder.findPath(search.start);
+        });
+        printTotals(map.name, "perimeter", perimeterTotals);
+    }
+
+    int run(unsigned int repeats, const std::vector<std::string>& tntPaths)
+    {
+        ThreadPool threadPool(ThreadPool::defaultWorkerCount());
+
+        std::vector<BenchMap> maps;
+        maps.push_back(createOpenField(threadPool));
+        maps.push_back(createMaze(threadPool));
+        maps.push_back(createIslands(threadPool));
+        for (const auto& path : tntPaths)
+        {
+            std::cerr << "Loading " << path << std::endl;
+            maps.push_back(loadTntMap(path, threadPool));
+        }
+
+        std::cerr << "Running " << SearchesPerMap << " searches per map, " << repeats << " times each" << std::endl;
+        printHeader();
+        for (const auto& map : maps)
+        {
+            benchmarkMap(map, repeats);
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int repeats = 5;
+    std::vector<std::string> tntPaths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if (arg.rfind("--repeats=", 0) == 0)
+        {
+            repeats = std::max(1ul, std::stoul(arg.substr(10)));
+        }
+        else if (arg == "--help")
+        {
+            std::cerr << "Usage: " << argv[0] << " [--repeats=<count>] [tnt-file...]" << std::endl;
+            return 0;
+        }
+        else
+        {
+            tntPaths.push_back(arg);
+        }
+    }
+
+    try
+    {
+        return rwe::run(repeats, tntPaths);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
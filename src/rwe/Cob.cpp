@@ -50,6 +50,8 @@ namespace rwe
             stream.seekg(loc);
         }
 
+        script.program = decodeCobProgram(script);
+
         return script;
     }
 }
@@ -2,6 +2,7 @@
 #define RWE_COB_H
 
 #include <cstdint>
+#include <rwe/cob/CobProgram.h>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -37,6 +38,9 @@ namespace rwe
         std::vector<std::string> pieces;
         std::vector<CobFunctionInfo> functions;
         unsigned int staticVariableCount;
+
+        /** The instructions decoded for the interpreter to run. */
+        CobProgram program;
     };
 
     CobScript parseCob(std::istream& stream);
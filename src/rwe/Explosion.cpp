@@ -2,6 +2,10 @@
 
 namespace rwe
 {
+    /** Explosion animations run at 15 frames per second. */
+    static const unsigned int TicksPerExplosionFrame = SimTicksPerSecond / 15;
+    static_assert(SimTicksPerSecond % 15 == 0, "explosion frames must last a whole number of ticks");
+
     bool Explosion::isStarted(GameTime currentTime) const
     {
         return currentTime >= startTime;
@@ -11,7 +15,7 @@ namespace rwe
     {
         assert(currentTime >= startTime);
         auto deltaTime = currentTime - startTime;
-        auto frameIndex = deltaTime.value / 4; // explosions run at 15fps
+        auto frameIndex = deltaTime.value / TicksPerExplosionFrame;
         return frameIndex;
     }
 
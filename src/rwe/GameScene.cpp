@@ -1,59 +1,10 @@
 #include "GameScene.h"
 #include <boost/range/adaptor/map.hpp>
+#include <cassert>
 #include <rwe/Mesh.h>
-#include <unordered_set>
 
 namespace rwe
 {
-    class LaserCollisionVisitor : public boost::static_visitor<bool>
-    {
-    private:
-        const GameScene* scene;
-        const std::optional<LaserProjectile>* laserPtr;
-
-    public:
-        LaserCollisionVisitor(const GameScene* scene, const std::optional<LaserProjectile>* laserPtr)
-            : scene(scene), laserPtr(laserPtr)
-        {
-        }
-
-        bool operator()(const OccupiedUnit& v) const
-        {
-            auto& laser = *laserPtr;
-            const auto& unit = scene->getSimulation().getUnit(v.id);
-
-            if (unit.isOwnedBy(laser->owner))
-            {
-                return false;
-            }
-
-            // ignore if the laser is above or below the unit
-            if (laser->position.y < unit.position.y || laser->position.y > unit.position.y + unit.height)
-            {
-                return false;
-            }
-
-            return true;
-        }
-        bool operator()(const OccupiedFeature& v) const
-        {
-            auto& laser = *laserPtr;
-            const auto& feature = scene->getSimulation().getFeature(v.id);
-
-            // ignore if the laser is above or below the feature
-            if (laser->position.y < feature.position.y || laser->position.y > feature.position.y + feature.height)
-            {
-                return false;
-            }
-
-            return true;
-        }
-        bool operator()(const OccupiedNone&) const
-        {
-            return false;
-        }
-    };
-
     GameScene::GameScene(
         TextureService* textureService,
         CursorService* cursor,
@@ -68,7 +19,8 @@ namespace rwe
         MovementClassCollisionService&& collisionService,
         UnitDatabase&& unitDatabase,
         MeshService&& meshService,
-        PlayerId localPlayerId)
+        PlayerId localPlayerId,
+        std::optional<ReplayRecorder>&& recorder)
         : textureService(textureService),
           cursor(cursor),
           sdl(sdl),
@@ -76,23 +28,57 @@ namespace rwe
           viewportService(viewportService),
           renderService(std::move(renderService)),
           uiRenderService(std::move(uiRenderService)),
-          simulation(std::move(simulation)),
-          collisionService(std::move(collisionService)),
-          unitFactory(textureService, std::move(unitDatabase), std::move(meshService), &this->collisionService, palette, guiPalette),
-          pathFindingService(&this->simulation, &this->collisionService),
-          unitBehaviorService(this, &pathFindingService, &this->collisionService),
-          cobExecutionService(),
-          localPlayerId(localPlayerId)
+          runner(
+              textureService,
+              audioService,
+              palette,
+              guiPalette,
+              std::move(simulation),
+              std::move(collisionService),
+              std::move(unitDatabase),
+              std::move(meshService),
+              ThreadPool::defaultWorkerCount()),
+          localPlayerId(localPlayerId),
+          recorder(std::move(recorder)),
+          simulationThread(&runner, this->recorder ? &*this->recorder : nullptr)
+    {
+    }
+
+    GameScene::~GameScene()
     {
+        if (simulationThread.isRunning())
+        {
+            simulationThread.stop();
+        }
+
+        if (recorder)
+        {
+            recorder->record(runner.getGameTime(), EndGameCommand());
+        }
     }
 
     void GameScene::init()
     {
         audioService->reserveChannels(reservedChannelsCount);
+        simulationThread.start();
+        snapshot = &simulationThread.acquireSnapshot();
     }
 
-    void GameScene::render(GraphicsContext& context)
+    void GameScene::render(GraphicsContext& context, float interpolationAlpha)
     {
+        snapshot = &simulationThread.acquireSnapshot();
+        clearDeadUnitReferences();
+
+        // If the simulation has not caught up with the ticks asked of it,
+        // draw the newest state it has rather than interpolating towards a tick it has not run.
+        if (simulationThread.getTicksBehind() > 0)
+        {
+            interpolationAlpha = 1.0f;
+        }
+
+        // The terrain and features do not change once the game has started.
+        const auto& simulation = runner.getSimulation();
+
         context.disableDepthBuffer();
 
         renderService.drawMapTerrain(simulation.terrain);
@@ -100,42 +86,52 @@ namespace rwe
         renderService.drawFlatFeatureShadows(simulation.features | boost::adaptors::map_values);
         renderService.drawFlatFeatures(simulation.features | boost::adaptors::map_values);
 
-        if (occupiedGridVisible)
+        if (occupiedGridVisible || pathfindingVisualisationVisible || movementClassGridVisible)
         {
-            renderService.drawOccupiedGrid(simulation.terrain, simulation.occupiedGrid);
-        }
+            // Debug views read the live simulation, so hold it still while drawing them.
+            auto lock = simulationThread.lockSimulation();
 
-        if (pathfindingVisualisationVisible)
-        {
-            renderService.drawPathfindingVisualisation(simulation.terrain, pathFindingService.lastPathDebugInfo);
-        }
+            if (occupiedGridVisible)
+            {
+                renderService.drawOccupiedGrid(simulation.terrain, simulation.occupiedGrid);
+            }
 
-        if (selectedUnit && movementClassGridVisible)
-        {
-            const auto& unit = simulation.getUnit(*selectedUnit);
-            if (unit.movementClass)
+            if (pathfindingVisualisationVisible)
+            {
+                renderService.drawPathfindingVisualisation(simulation.terrain, runner.getPathFindingService().lastPathDebugInfo);
+            }
+
+            if (selectedUnit && movementClassGridVisible && simulation.unitExists(*selectedUnit))
             {
-                const auto& grid = collisionService.getGrid(*unit.movementClass);
-                renderService.drawMovementClassCollisionGrid(simulation.terrain, grid);
+                const auto& unit = simulation.getUnit(*selectedUnit);
+                if (unit.movementClass)
+                {
+                    const auto& grid = runner.getCollisionService().getGrid(*unit.movementClass);
+                    renderService.drawMovementClassCollisionGrid(simulation.terrain, grid);
+                }
             }
         }
 
         if (selectedUnit)
         {
-            renderService.drawSelectionRect(getUnit(*selectedUnit));
+            const auto unit = snapshot->findUnit(*selectedUnit);
+            if (unit != nullptr)
+            {
+                renderService.drawSelectionRect(*unit, interpolationAlpha);
+            }
         }
 
-        renderService.drawUnitShadows(simulation.terrain, simulation.units | boost::adaptors::map_values);
+        renderService.drawUnitShadows(simulation.terrain, *snapshot, interpolationAlpha);
 
         context.enableDepthBuffer();
 
         auto seaLevel = simulation.terrain.getSeaLevel();
-        for (const auto& unit : (simulation.units | boost::adaptors::map_values))
+        for (const auto& unit : snapshot->units)
         {
-            renderService.drawUnit(unit, seaLevel);
+            renderService.drawUnit(*snapshot, unit, seaLevel, interpolationAlpha);
         }
 
-        renderService.drawLasers(simulation.lasers);
+        renderService.drawLasers(snapshot->lasers, interpolationAlpha);
 
         context.disableDepthWrites();
 
@@ -146,7 +142,7 @@ namespace rwe
         renderService.drawStandingFeatures(simulation.features | boost::adaptors::map_values);
 
         context.disableDepthTest();
-        renderService.drawExplosions(simulation.gameTime, simulation.explosions);
+        renderService.drawExplosions(snapshot->explosions);
         context.enableDepthTest();
 
         context.enableDepthWrites();
@@ -156,7 +152,7 @@ namespace rwe
 
         if (healthBarsVisible)
         {
-            for (const Unit& unit : (simulation.units | boost::adaptors::map_values))
+            for (const auto& unit : snapshot->units)
             {
                 if (!unit.isOwnedBy(localPlayerId))
                 {
@@ -166,8 +162,8 @@ namespace rwe
 
                 auto uiPos = uiRenderService.getCamera().getInverseViewProjectionMatrix()
                     * renderService.getCamera().getViewProjectionMatrix()
-                    * unit.position;
-                uiRenderService.drawHealthBar(uiPos.x, uiPos.y, static_cast<float>(unit.hitPoints) / static_cast<float>(unit.maxHitPoints));
+                    * unit.getInterpolatedPosition(interpolationAlpha);
+                uiRenderService.drawHealthBar(uiPos.x, uiPos.y, unit.healthFraction);
             }
         }
 
@@ -362,13 +358,13 @@ namespace rwe
             {
                 if (normalCursor->selecting)
                 {
-                    if (hoveredUnit && getUnit(*hoveredUnit).isOwnedBy(localPlayerId))
+                    const auto unit = hoveredUnit ? findUnit(*hoveredUnit) : nullptr;
+                    if (unit != nullptr && unit->isOwnedBy(localPlayerId))
                     {
                         selectedUnit = hoveredUnit;
-                        const auto& selectionSound = getUnit(*hoveredUnit).selectionSound;
-                        if (selectionSound)
+                        if (unit->selectionSound)
                         {
-                            playSoundOnSelectChannel(*selectionSound);
+                            playSoundOnSelectChannel(*unit->selectionSound);
                         }
                     }
                     else
@@ -382,9 +378,17 @@ namespace rwe
 
     void GameScene::update()
     {
-        simulation.gameTime = nextGameTime(simulation.gameTime);
+        const auto& simulation = runner.getSimulation();
+
+        // The scene manager decides when ticks are due; the simulation thread runs them.
+        // If it is already a frame's worth of ticks behind, drop this one
+        // and let the game run slower than real time rather than pile up work.
+        if (simulationThread.getTicksBehind() < SceneManager::MaxTicksPerFrame)
+        {
+            simulationThread.requestTick();
+        }
 
-        float secondsElapsed = static_cast<float>(SceneManager::TickInterval) / 1000.0f;
+        float secondsElapsed = SimTickDurationSeconds;
         const float speed = CameraPanSpeed * secondsElapsed;
         int directionX = (right ? 1 : 0) - (left ? 1 : 0);
         int directionZ = (down ? 1 : 0) - (up ? 1 : 0);
@@ -405,7 +409,7 @@ namespace rwe
 
         camera.translate(Vector3f(dx, 0.0f, dz));
 
-        hoveredUnit = getUnitUnderCursor();
+        hoveredUnit = getUnitUnderCursor(*snapshot);
 
         if (boost::get<AttackCursorMode>(&cursorMode) != nullptr)
         {
@@ -413,11 +417,13 @@ namespace rwe
         }
         else if (boost::get<NormalCursorMode>(&cursorMode) != nullptr)
         {
-            if (hoveredUnit && getUnit(*hoveredUnit).isOwnedBy(localPlayerId))
+            const auto hovered = hoveredUnit ? findUnit(*hoveredUnit) : nullptr;
+            const auto selected = selectedUnit ? findUnit(*selectedUnit) : nullptr;
+            if (hovered != nullptr && hovered->isOwnedBy(localPlayerId))
             {
                 cursor->useSelectCursor();
             }
-            else if (selectedUnit && getUnit(*selectedUnit).canAttack && hoveredUnit && isEnemy(*hoveredUnit))
+            else if (selected != nullptr && selected->canAttack && hovered != nullptr && !hovered->isOwnedBy(localPlayerId))
             {
                 cursor->useRedCursor();
             }
@@ -426,35 +432,18 @@ namespace rwe
                 cursor->useNormalCursor();
             }
         }
-
-        pathFindingService.update();
-
-        // run unit scripts
-        for (auto& entry : simulation.units)
-        {
-            auto unitId = entry.first;
-            auto& unit = entry.second;
-
-            unitBehaviorService.update(unitId);
-
-            unit.mesh.update(secondsElapsed);
-
-            cobExecutionService.run(simulation, unitId);
-        }
-
-        updateLasers();
-
-        updateExplosions();
-
-        deleteDeadUnits();
     }
 
     void GameScene::spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position)
     {
-        auto unit = unitFactory.createUnit(unitType, owner, simulation.getPlayer(owner).color, position);
+        // Spawning creates the unit's meshes, which must happen on this thread.
+        assert(!simulationThread.isRunning());
 
-        // TODO: if we failed to add the unit throw some warning
-        simulation.tryAddUnit(std::move(unit));
+        if (recorder)
+        {
+            recorder->record(runner.getGameTime(), SpawnUnitCommand{unitType, owner, position});
+        }
+        runner.spawnUnit(unitType, owner, position);
     }
 
     void GameScene::setCameraPosition(const Vector3f& newPosition)
@@ -464,76 +453,18 @@ namespace rwe
 
     const MapTerrain& GameScene::getTerrain() const
     {
-        return simulation.terrain;
-    }
-
-    void GameScene::showObject(UnitId unitId, const std::string& name)
-    {
-        simulation.showObject(unitId, name);
-    }
-
-    void GameScene::hideObject(UnitId unitId, const std::string& name)
-    {
-        simulation.hideObject(unitId, name);
-    }
-
-    void
-    GameScene::moveObject(UnitId unitId, const std::string& name, Axis axis, float position, float speed)
-    {
-        simulation.moveObject(unitId, name, axis, position, speed);
-    }
-
-    void GameScene::moveObjectNow(UnitId unitId, const std::string& name, Axis axis, float position)
-    {
-        simulation.moveObjectNow(unitId, name, axis, position);
-    }
-
-    void GameScene::turnObject(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle, float speed)
-    {
-        simulation.turnObject(unitId, name, axis, angle, speed);
-    }
-
-    void GameScene::turnObjectNow(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle)
-    {
-        simulation.turnObjectNow(unitId, name, axis, angle);
-    }
-
-    bool GameScene::isPieceMoving(UnitId unitId, const std::string& name, Axis axis) const
-    {
-        return simulation.isPieceMoving(unitId, name, axis);
-    }
-
-    bool GameScene::isPieceTurning(UnitId unitId, const std::string& name, Axis axis) const
-    {
-        return simulation.isPieceTurning(unitId, name, axis);
-    }
-
-    GameTime GameScene::getGameTime() const
-    {
-        return simulation.gameTime;
+        return runner.getTerrain();
     }
 
     void GameScene::playSoundOnSelectChannel(const AudioService::SoundHandle& handle)
     {
-        audioService->playSoundIfFree(handle, UnitSelectChannel);
-    }
-
-    void GameScene::playUnitSound(UnitId /*unitId*/, const AudioService::SoundHandle& sound)
-    {
-        // FIXME: should play on a unit-specific channel group
-        audioService->playSound(sound);
+        runner.playSoundOnSelectChannel(handle);
     }
 
-    void GameScene::playSoundAt(const Vector3f& /*position*/, const AudioService::SoundHandle& sound)
-    {
-        // FIXME: should play on a position-aware channel
-        audioService->playSound(sound);
-    }
-
-    std::optional<UnitId> GameScene::getUnitUnderCursor() const
+    std::optional<UnitId> GameScene::getUnitUnderCursor(const RenderSnapshot& snapshot) const
     {
         auto ray = renderService.getCamera().screenToWorldRay(screenToClipSpace(getMousePosition()));
-        return getFirstCollidingUnit(ray);
+        return snapshot.getFirstCollidingUnit(getTerrain(), ray);
     }
 
     Vector2f GameScene::screenToClipSpace(Point p) const
@@ -549,385 +480,89 @@ namespace rwe
         return Point(x, y);
     }
 
-    std::optional<UnitId> GameScene::getFirstCollidingUnit(const Ray3f& ray) const
-    {
-        return simulation.getFirstCollidingUnit(ray);
-    }
-
     std::optional<Vector3f> GameScene::getMouseTerrainCoordinate() const
     {
         auto ray = renderService.getCamera().screenToWorldRay(screenToClipSpace(getMousePosition()));
-        return simulation.intersectLineWithTerrain(ray.toLine());
+        return runner.getTerrain().intersectLine(ray.toLine());
     }
 
     void GameScene::issueMoveOrder(UnitId unitId, Vector3f position)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createMoveOrder(position));
-        if (unit.okSound)
-        {
-            playSoundOnSelectChannel(*(unit.okSound));
-        }
+        simulationThread.submitCommand(MoveOrderCommand{unitId, position, false});
+        playOkSound(unitId);
     }
 
     void GameScene::enqueueMoveOrder(UnitId unitId, Vector3f position)
     {
-        getUnit(unitId).addOrder(createMoveOrder(position));
+        simulationThread.submitCommand(MoveOrderCommand{unitId, position, true});
     }
 
     void GameScene::issueAttackOrder(UnitId unitId, UnitId target)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createAttackOrder(target));
-        if (unit.okSound)
-        {
-            playSoundOnSelectChannel(*(unit.okSound));
-        }
+        simulationThread.submitCommand(AttackOrderCommand{unitId, target, false});
+        playOkSound(unitId);
     }
 
     void GameScene::enqueueAttackOrder(UnitId unitId, UnitId target)
     {
-        getUnit(unitId).addOrder(createAttackOrder(target));
+        simulationThread.submitCommand(AttackOrderCommand{unitId, target, true});
     }
 
     void GameScene::issueAttackGroundOrder(UnitId unitId, Vector3f position)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createAttackGroundOrder(position));
-        if (unit.okSound)
-        {
-            playSoundOnSelectChannel(*(unit.okSound));
-        }
+        simulationThread.submitCommand(AttackGroundOrderCommand{unitId, position, false});
+        playOkSound(unitId);
     }
 
     void GameScene::enqueueAttackGroundOrder(UnitId unitId, Vector3f position)
     {
-        getUnit(unitId).addOrder(createAttackGroundOrder(position));
+        simulationThread.submitCommand(AttackGroundOrderCommand{unitId, position, true});
     }
 
     void GameScene::stopSelectedUnit()
     {
         if (selectedUnit)
         {
-            auto& unit = getUnit(*selectedUnit);
-            unit.clearOrders();
-            if (unit.okSound)
-            {
-                playSoundOnSelectChannel(*(unit.okSound));
-            }
+            simulationThread.submitCommand(StopCommand{*selectedUnit});
+            playOkSound(*selectedUnit);
         }
     }
 
-    bool GameScene::isShiftDown() const
-    {
-        return leftShiftDown || rightShiftDown;
-    }
-
-    Unit& GameScene::getUnit(UnitId id)
-    {
-        return simulation.getUnit(id);
-    }
-
-    const Unit& GameScene::getUnit(UnitId id) const
-    {
-        return simulation.getUnit(id);
-    }
-
-    const GamePlayerInfo& GameScene::getPlayer(PlayerId player) const
-    {
-        return simulation.getPlayer(player);
-    }
-
-    DiscreteRect
-    GameScene::computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const
-    {
-        return simulation.computeFootprintRegion(position, footprintX, footprintZ);
-    }
-
-    bool GameScene::isCollisionAt(const DiscreteRect& rect, UnitId self) const
+    void GameScene::playOkSound(UnitId unitId)
     {
-        return simulation.isCollisionAt(rect, self);
-    }
-
-    void GameScene::moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId)
-    {
-        simulation.moveUnitOccupiedArea(oldRect, newRect, unitId);
-    }
-
-    GameSimulation& GameScene::getSimulation()
-    {
-        return simulation;
-    }
-
-    const GameSimulation& GameScene::getSimulation() const
-    {
-        return simulation;
-    }
-
-    bool GameScene::isEnemy(UnitId id) const
-    {
-        // TODO: consider allies/teams here
-        return !getUnit(id).isOwnedBy(localPlayerId);
-    }
-
-    void GameScene::updateLasers()
-    {
-        auto gameTime = getGameTime();
-        for (auto& laser : simulation.lasers)
+        const auto unit = findUnit(unitId);
+        if (unit != nullptr && unit->okSound)
         {
-            if (!laser)
-            {
-                continue;
-            }
-
-            laser->position += laser->velocity;
-
-            // emit smoke trail
-            if (laser->smokeTrail)
-            {
-                if (gameTime > laser->lastSmoke + *laser->smokeTrail)
-                {
-                    createLightSmoke(laser->position);
-                    laser->lastSmoke = gameTime;
-                }
-            }
-
-            // test collision with terrain
-            auto terrainHeight = simulation.terrain.getHeightAt(laser->position.x, laser->position.z);
-            auto seaLevel = simulation.terrain.getSeaLevel();
-
-            // test collision with sea
-            // FIXME: waterweapons should be allowed in water
-            if (seaLevel > terrainHeight && laser->position.y <= seaLevel)
-            {
-                doLaserImpact(laser, ImpactType::Water);
-            }
-            else if (laser->position.y <= terrainHeight)
-            {
-                doLaserImpact(laser, ImpactType::Normal);
-            }
-            else
-            {
-                // detect collision with something's footprint
-                auto heightMapPos = simulation.terrain.worldToHeightmapCoordinate(laser->position);
-                auto cellValue = simulation.occupiedGrid.grid.tryGet(heightMapPos);
-                if (cellValue)
-                {
-                    auto collides = boost::apply_visitor(LaserCollisionVisitor(this, &laser), cellValue->get());
-                    if (collides)
-                    {
-                        doLaserImpact(laser, ImpactType::Normal);
-                    }
-                }
-            }
-
-            // TODO: detect collision between a laser and the world boundary
+            playSoundOnSelectChannel(*unit->okSound);
         }
     }
 
-    void GameScene::updateExplosions()
+    bool GameScene::isShiftDown() const
     {
-        for (auto& exp : simulation.explosions)
-        {
-            if (!exp)
-            {
-                continue;
-            }
-
-            if (exp->isFinished(simulation.gameTime))
-            {
-                exp = std::nullopt;
-                continue;
-            }
-
-            if (exp->floats)
-            {
-                // TODO: drift with the wind
-                exp->position.y += 0.5f;
-            }
-        }
+        return leftShiftDown || rightShiftDown;
     }
 
-    void GameScene::doLaserImpact(std::optional<LaserProjectile>& laser, ImpactType impactType)
+    const UnitRenderState* GameScene::findUnit(UnitId id) const
     {
-        switch (impactType)
-        {
-            case ImpactType::Normal:
-            {
-                if (laser->soundHit)
-                {
-                    playSoundAt(laser->position, *laser->soundHit);
-                }
-                if (laser->explosion)
-                {
-                    simulation.spawnExplosion(laser->position, *laser->explosion);
-                }
-                if (laser->endSmoke)
-                {
-                    createLightSmoke(laser->position);
-                }
-                break;
-            }
-            case ImpactType::Water:
-            {
-                if (laser->soundWater)
-                {
-                    playSoundAt(laser->position, *laser->soundWater);
-                }
-                if (laser->waterExplosion)
-                {
-                    simulation.spawnExplosion(laser->position, *laser->waterExplosion);
-                }
-                break;
-            }
-        }
-
-        applyDamageInRadius(laser->position, laser->damageRadius, *laser);
-
-        laser = std::nullopt;
+        return snapshot->findUnit(id);
     }
 
-    void GameScene::applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser)
+    bool GameScene::isEnemy(UnitId id)
     {
-        auto minX = position.x - radius;
-        auto maxX = position.x + radius;
-        auto minZ = position.z - radius;
-        auto maxZ = position.z + radius;
-
-        auto minPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(minX, position.y, minZ));
-        auto maxPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(maxX, position.y, maxZ));
-        auto minCell = simulation.terrain.getHeightMap().clampToCoords(minPoint);
-        auto maxCell = simulation.terrain.getHeightMap().clampToCoords(maxPoint);
-
-        assert(minCell.x <= maxCell.x);
-        assert(minCell.y <= maxCell.y);
-
-        auto radiusSquared = radius * radius;
-
-        std::unordered_set<UnitId> seenUnits;
-
-        // for each cell
-        for (std::size_t y = minCell.y; y <= maxCell.y; ++y)
-        {
-            for (std::size_t x = minCell.x; x <= maxCell.x; ++x)
-            {
-                // check if it's in range
-                auto cellCenter = simulation.terrain.heightmapIndexToWorldCenter(x, y);
-                Rectangle2f cellRectangle(
-                    Vector2f(cellCenter.x, cellCenter.z),
-                    Vector2f(MapTerrain::HeightTileWidthInWorldUnits / 2.0f, MapTerrain::HeightTileHeightInWorldUnits / 2.0f));
-                auto cellDistanceSquared = cellRectangle.distanceSquared(Vector2f(position.x, position.z));
-                if (cellDistanceSquared > radiusSquared)
-                {
-                    continue;
-                }
-
-                // check if a unit (or feature) is there
-                auto occupiedType = simulation.occupiedGrid.grid.get(x, y);
-                auto u = boost::get<OccupiedUnit>(&occupiedType);
-                if (u == nullptr)
-                {
-                    continue;
-                }
-
-                // check if the unit was seen/mark as seen
-                auto pair = seenUnits.insert(u->id);
-                if (!pair.second) // the unit was already present
-                {
-                    continue;
-                }
-
-                const auto& unit = simulation.getUnit(u->id);
-
-                // skip dead units
-                if (unit.isDead())
-                {
-                    continue;
-                }
-
-                // add in the third dimension component to distance,
-                // check if we are still in range
-                auto unitDistanceSquared = createBoundingBox(unit).distanceSquared(position);
-                if (unitDistanceSquared > radiusSquared)
-                {
-                    continue;
-                }
-
-                // apply appropriate damage
-                auto damageScale = std::clamp(1.0f - (std::sqrt(unitDistanceSquared) / radius), 0.0f, 1.0f);
-                auto rawDamage = laser.getDamage(unit.unitType);
-                auto scaledDamage = static_cast<unsigned int>(static_cast<float>(rawDamage) * damageScale);
-                applyDamage(u->id, scaledDamage);
-            }
-        }
+        // TODO: consider allies/teams here
+        const auto unit = findUnit(id);
+        return unit != nullptr && !unit->isOwnedBy(localPlayerId);
     }
 
-    void GameScene::applyDamage(UnitId unitId, unsigned int damagePoints)
+    void GameScene::clearDeadUnitReferences()
     {
-        auto& unit = simulation.getUnit(unitId);
-        if (unit.hitPoints <= damagePoints)
+        if (selectedUnit && findUnit(*selectedUnit) == nullptr)
         {
-            unit.markAsDead();
-
-            // TODO: spawn debris particles, corpse
-            if (unit.explosionWeapon)
-            {
-                auto impactType = unit.position.y < simulation.terrain.getSeaLevel() ? ImpactType::Water : ImpactType::Normal;
-                std::optional<LaserProjectile> projectile = simulation.createProjectileFromWeapon(unit.owner, *unit.explosionWeapon, unit.position, Vector3f(0.0f, -1.0f, 0.0f));
-                doLaserImpact(projectile, impactType);
-            }
+            selectedUnit = std::nullopt;
         }
-        else
+        if (hoveredUnit && findUnit(*hoveredUnit) == nullptr)
         {
-            unit.hitPoints -= damagePoints;
+            hoveredUnit = std::nullopt;
         }
     }
-
-    void GameScene::createLightSmoke(const Vector3f& position)
-    {
-        simulation.spawnSmoke(position, textureService->getGafEntry("anims/FX.GAF", "smoke 1"));
-    }
-
-    void GameScene::deleteDeadUnits()
-    {
-        for (auto it = simulation.units.begin(); it != simulation.units.end();)
-        {
-            const auto& unit = it->second;
-            if (unit.isDead())
-            {
-                if (selectedUnit && *selectedUnit == it->first)
-                {
-                    selectedUnit = std::nullopt;
-                }
-                if (hoveredUnit && *hoveredUnit == it->first)
-                {
-                    hoveredUnit = std::nullopt;
-                }
-
-                auto footprintRect = computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-                auto footprintRegion = simulation.occupiedGrid.grid.tryToRegion(footprintRect);
-                assert(!!footprintRegion);
-                simulation.occupiedGrid.grid.setArea(*footprintRegion, OccupiedNone());
-
-                it = simulation.units.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
-        }
-    }
-
-    BoundingBox3f GameScene::createBoundingBox(const Unit& unit) const
-    {
-        auto footprint = simulation.computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        auto min = Vector3f(footprint.x, unit.position.y, footprint.y);
-        auto max = Vector3f(footprint.x + footprint.width, unit.position.y + unit.height, footprint.y + footprint.height);
-        auto worldMin = simulation.terrain.heightmapToWorldSpace(min);
-        auto worldMax = simulation.terrain.heightmapToWorldSpace(max);
-        return BoundingBox3f::fromMinMax(worldMin, worldMax);
-    }
 }
@@ -9,18 +9,18 @@
 #include <rwe/OccupiedGrid.h>
 #include <rwe/PlayerId.h>
 #include <rwe/RenderService.h>
+#include <rwe/RenderSnapshot.h>
 #include <rwe/SceneManager.h>
+#include <rwe/SimulationRunner.h>
+#include <rwe/SimulationThread.h>
 #include <rwe/TextureService.h>
 #include <rwe/UiRenderService.h>
 #include <rwe/Unit.h>
-#include <rwe/UnitBehaviorService.h>
 #include <rwe/UnitDatabase.h>
-#include <rwe/UnitFactory.h>
 #include <rwe/UnitId.h>
 #include <rwe/ViewportService.h>
 #include <rwe/camera/UiCamera.h>
-#include <rwe/cob/CobExecutionService.h>
-#include <rwe/pathfinding/PathFindingService.h>
+#include <rwe/replay/ReplayRecorder.h>
 
 namespace rwe
 {
@@ -34,18 +34,10 @@ namespace rwe
 
     using CursorMode = boost::variant<AttackCursorMode, NormalCursorMode>;
 
-    enum class ImpactType
-    {
-        Normal,
-        Water
-    };
-
     class GameScene : public SceneManager::Scene
     {
     private:
-        static const unsigned int UnitSelectChannel = 0;
-
-        static const unsigned int reservedChannelsCount = 1;
+        static const unsigned int reservedChannelsCount = SimulationRunner::UnitSelectChannel + 1;
 
         /**
          * Speed the camera pans via the arrow keys
@@ -62,15 +54,7 @@ namespace rwe
         RenderService renderService;
         UiRenderService uiRenderService;
 
-        GameSimulation simulation;
-
-        MovementClassCollisionService collisionService;
-
-        UnitFactory unitFactory;
-
-        PathFindingService pathFindingService;
-        UnitBehaviorService unitBehaviorService;
-        CobExecutionService cobExecutionService;
+        SimulationRunner runner;
 
         PlayerId localPlayerId;
 
@@ -93,6 +77,23 @@ namespace rwe
 
         CursorMode cursorMode{NormalCursorMode()};
 
+        /** If set, every command issued in the game is recorded here. */
+        std::optional<ReplayRecorder> recorder;
+
+        /**
+         * Ticks the runner while the scene is active.
+         * Once started, the scene reads the game through its snapshots
+         * and changes it only by submitting commands.
+         */
+        SimulationThread simulationThread;
+
+        /**
+         * The snapshot acquired for the last frame drawn.
+         * Input and update work against it, so they see what is on screen,
+         * and it does not change until the next frame is drawn.
+         */
+        const RenderSnapshot* snapshot{nullptr};
+
     public:
         GameScene(
             TextureService* textureService,
@@ -108,11 +109,14 @@ namespace rwe
             MovementClassCollisionService&& collisionService,
             UnitDatabase&& unitDatabase,
             MeshService&& meshService,
-            PlayerId localPlayerId);
+            PlayerId localPlayerId,
+            std::optional<ReplayRecorder>&& recorder);
+
+        ~GameScene() override;
 
         void init() override;
 
-        void render(GraphicsContext& context) override;
+        void render(GraphicsContext& context, float interpolationAlpha) override;
 
         void onKeyDown(const SDL_Keysym& keysym) override;
 
@@ -130,53 +134,15 @@ namespace rwe
 
         const MapTerrain& getTerrain() const;
 
-        void showObject(UnitId unitId, const std::string& name);
-
-        void hideObject(UnitId unitId, const std::string& name);
-
-        void moveObject(UnitId unitId, const std::string& name, Axis axis, float position, float speed);
-
-        void moveObjectNow(UnitId unitId, const std::string& name, Axis axis, float position);
-
-        void turnObject(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle, float speed);
-
-        void turnObjectNow(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle);
-
-        bool isPieceMoving(UnitId unitId, const std::string& name, Axis axis) const;
-
-        bool isPieceTurning(UnitId unitId, const std::string& name, Axis axis) const;
-
-        GameTime getGameTime() const;
-
-        bool isCollisionAt(const DiscreteRect& rect, UnitId self) const;
-
+    private:
         void playSoundOnSelectChannel(const AudioService::SoundHandle& sound);
 
-        void playUnitSound(UnitId unitId, const AudioService::SoundHandle& sound);
-
-        void playSoundAt(const Vector3f& position, const AudioService::SoundHandle& sound);
-
-        DiscreteRect computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const;
-
-        void moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId);
-
-        GameSimulation& getSimulation();
-
-        const GameSimulation& getSimulation() const;
-
-        void doLaserImpact(std::optional<LaserProjectile>& laser, ImpactType impactType);
-
-        void createLightSmoke(const Vector3f& position);
-
-    private:
-        std::optional<UnitId> getUnitUnderCursor() const;
+        std::optional<UnitId> getUnitUnderCursor(const RenderSnapshot& snapshot) const;
 
         Vector2f screenToClipSpace(Point p) const;
 
         Point getMousePosition() const;
 
-        std::optional<UnitId> getFirstCollidingUnit(const Ray3f& ray) const;
-
         std::optional<Vector3f> getMouseTerrainCoordinate() const;
 
         void issueMoveOrder(UnitId unitId, Vector3f position);
@@ -193,27 +159,16 @@ namespace rwe
 
         void stopSelectedUnit();
 
-        bool isShiftDown() const;
-
-        Unit& getUnit(UnitId id);
-
-        const Unit& getUnit(UnitId id) const;
+        /** Plays the acknowledgement sound of the unit, if it is still alive. */
+        void playOkSound(UnitId unitId);
 
-        const GamePlayerInfo& getPlayer(PlayerId player) const;
-
-        bool isEnemy(UnitId id) const;
-
-        void updateLasers();
-
-        void updateExplosions();
-
-        void applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser);
+        bool isShiftDown() const;
 
-        void applyDamage(UnitId unitId, unsigned int damagePoints);
+        const UnitRenderState* findUnit(UnitId id) const;
 
-        void deleteDeadUnits();
+        bool isEnemy(UnitId id);
 
-        BoundingBox3f createBoundingBox(const Unit& unit) const;
+        void clearDeadUnitReferences();
     };
 }
 
@@ -1,44 +1,12 @@
 #include "GameSimulation.h"
+#include <rwe/StateHasher.h>
 
 namespace rwe
 {
-    bool PathRequest::operator==(const PathRequest& rhs) const
-    {
-        return unitId == rhs.unitId;
-    }
-
-    bool PathRequest::operator!=(const PathRequest& rhs) const
-    {
-        return !(rhs == *this);
-    }
-
-    class IsCollisionVisitor : public boost::static_visitor<bool>
-    {
-    private:
-        UnitId unitId;
-
-    public:
-        explicit IsCollisionVisitor(const UnitId& unitId) : unitId(unitId)
-        {
-        }
-
-        bool operator()(const OccupiedNone&) const
-        {
-            return false;
-        }
-        bool operator()(const OccupiedUnit& u) const
-        {
-            return u.id != unitId;
-        }
-        bool operator()(const OccupiedFeature&) const
-        {
-            return true;
-        }
-    };
-
     GameSimulation::GameSimulation(MapTerrain&& terrain)
         : terrain(std::move(terrain)),
-          occupiedGrid(this->terrain.getHeightMap().getWidth(), this->terrain.getHeightMap().getHeight())
+          occupiedGrid(this->terrain.getHeightMap().getWidth(), this->terrain.getHeightMap().getHeight()),
+          unitSpatialIndex(this->terrain.getHeightMap().getWidth(), this->terrain.getHeightMap().getHeight())
     {
     }
 
@@ -53,7 +21,8 @@ namespace rwe
         if (f.isBlocking)
         {
             auto footprintRegion = computeFootprintRegion(f.position, f.footprintX, f.footprintZ);
-            occupiedGrid.grid.setArea(occupiedGrid.grid.clipRegion(footprintRegion), OccupiedFeature(featureId));
+            occupiedGrid.setArea(occupiedGrid.grid.clipRegion(footprintRegion), OccupiedFeature(featureId));
+            changedFeatureAreas.push_back(footprintRegion);
         }
 
         return featureId;
@@ -66,27 +35,60 @@ namespace rwe
         return id;
     }
 
-    bool GameSimulation::tryAddUnit(Unit&& unit)
+    std::optional<UnitId> GameSimulation::tryAddUnit(Unit&& unit, const UnitMovementAttributes& movementAttributes)
     {
-        auto unitId = nextUnitId;
+        auto unitId = units.nextId();
 
         // set footprint area as occupied by the unit
         auto footprintRect = computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
         if (isCollisionAt(footprintRect, unitId))
         {
-            return false;
+            return std::nullopt;
         }
 
         auto footprintRegion = occupiedGrid.grid.tryToRegion(footprintRect);
         assert(!!footprintRegion);
 
-        occupiedGrid.grid.setArea(*footprintRegion, OccupiedUnit(unitId));
+        occupiedGrid.setArea(*footprintRegion, OccupiedUnit(unitId));
+        unitSpatialIndex.insert(unitId, footprintRect);
 
-        units.insert_or_assign(unitId, std::move(unit));
+        StateHasher seedHasher(randomSeed);
+        seedHasher.add(unitId.value);
+        unit.cobEnvironment->randomSeed = seedHasher.get();
 
-        nextUnitId = UnitId(nextUnitId.value + 1);
+        unitKinematics.pushBack(unit.rotation, movementAttributes);
+        auto insertedId = units.insert(std::move(unit));
+        assert(insertedId == unitId);
+        assert(units.size() == unitKinematics.size());
 
-        return true;
+        return insertedId;
+    }
+
+    void GameSimulation::deleteDeadUnits(std::vector<Unit>& deadUnits)
+    {
+        std::size_t i = 0;
+        while (i < units.size())
+        {
+            const auto& unit = units.valueAt(i);
+            if (!unit.isDead())
+            {
+                ++i;
+                continue;
+            }
+
+            auto footprintRect = computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+            auto footprintRegion = occupiedGrid.grid.tryToRegion(footprintRect);
+            assert(!!footprintRegion);
+            occupiedGrid.setArea(*footprintRegion, OccupiedNone());
+            unitSpatialIndex.remove(units.idAt(i), footprintRect);
+
+            deadUnits.push_back(std::move(units.valueAt(i)));
+
+            // Both containers move their last element into the hole,
+            // so they stay in step. Test the same index again.
+            units.removeAt(i);
+            unitKinematics.swapRemove(i);
+        }
     }
 
     DiscreteRect GameSimulation::computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const
@@ -105,62 +107,44 @@ namespace rwe
 
     bool GameSimulation::isCollisionAt(const DiscreteRect& rect, UnitId self) const
     {
-        auto region = occupiedGrid.grid.tryToRegion(rect);
-        if (!region)
-        {
-            return true;
-        }
-
-        for (unsigned int dy = 0; dy < region->height; ++dy)
-        {
-            for (unsigned int dx = 0; dx < region->width; ++dx)
-            {
-                const auto& cell = occupiedGrid.grid.get(region->x + dx, region->y + dy);
-                if (boost::apply_visitor(IsCollisionVisitor(self), cell))
-                {
-                    return true;
-                }
-            }
-        }
-        return false;
+        return occupiedGrid.isCollisionAt(rect, self);
     }
 
     bool GameSimulation::isAdjacentToObstacle(const DiscreteRect& rect, UnitId self) const
     {
-        DiscreteRect expandedRect(rect.x - 1, rect.y - 1, rect.width + 2, rect.height + 2);
-        return isCollisionAt(expandedRect, self);
+        return occupiedGrid.isAdjacentToObstacle(rect, self);
     }
 
-    void GameSimulation::showObject(UnitId unitId, const std::string& name)
+    void GameSimulation::showObject(UnitId unitId, unsigned int piece)
     {
-        auto mesh = getUnit(unitId).mesh.find(name);
+        auto mesh = getUnit(unitId).findScriptPiece(piece);
         if (mesh)
         {
             mesh->get().visible = true;
         }
     }
 
-    void GameSimulation::hideObject(UnitId unitId, const std::string& name)
+    void GameSimulation::hideObject(UnitId unitId, unsigned int piece)
     {
-        auto mesh = getUnit(unitId).mesh.find(name);
+        auto mesh = getUnit(unitId).findScriptPiece(piece);
         if (mesh)
         {
             mesh->get().visible = false;
         }
     }
 
-    void GameSimulation::enableShading(UnitId unitId, const std::string& name)
+    void GameSimulation::enableShading(UnitId unitId, unsigned int piece)
     {
-        auto mesh = getUnit(unitId).mesh.find(name);
+        auto mesh = getUnit(unitId).findScriptPiece(piece);
         if (mesh)
         {
             mesh->get().shaded = true;
         }
     }
 
-    void GameSimulation::disableShading(UnitId unitId, const std::string& name)
+    void GameSimulation::disableShading(UnitId unitId, unsigned int piece)
     {
-        auto mesh = getUnit(unitId).mesh.find(name);
+        auto mesh = getUnit(unitId).findScriptPiece(piece);
         if (mesh)
         {
             mesh->get().shaded = false;
@@ -169,22 +153,24 @@ namespace rwe
 
     Unit& GameSimulation::getUnit(UnitId id)
     {
-        auto it = units.find(id);
-        assert(it != units.end());
-        return it->second;
+        return units.get(id);
     }
 
     const Unit& GameSimulation::getUnit(UnitId id) const
     {
-        auto it = units.find(id);
-        assert(it != units.end());
-        return it->second;
+        return units.get(id);
     }
 
     bool GameSimulation::unitExists(UnitId id) const
     {
-        auto it = units.find(id);
-        return it != units.end();
+        return units.contains(id);
+    }
+
+    std::size_t GameSimulation::getUnitIndex(UnitId id) const
+    {
+        auto index = units.indexOf(id);
+        assert(!!index);
+        return *index;
     }
 
     MapFeature& GameSimulation::getFeature(FeatureId id)
@@ -206,62 +192,62 @@ namespace rwe
         return players.at(player.value);
     }
 
-    void GameSimulation::moveObject(UnitId unitId, const std::string& name, Axis axis, float position, float speed)
+    void GameSimulation::moveObject(UnitId unitId, unsigned int piece, Axis axis, float position, float speed)
     {
-        getUnit(unitId).moveObject(name, axis, position, speed);
+        getUnit(unitId).moveObject(piece, axis, position, speed);
     }
 
-    void GameSimulation::moveObjectNow(UnitId unitId, const std::string& name, Axis axis, float position)
+    void GameSimulation::moveObjectNow(UnitId unitId, unsigned int piece, Axis axis, float position)
     {
-        getUnit(unitId).moveObjectNow(name, axis, position);
+        getUnit(unitId).moveObjectNow(piece, axis, position);
     }
 
-    void GameSimulation::turnObject(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle, float speed)
+    void GameSimulation::turnObject(UnitId unitId, unsigned int piece, Axis axis, RadiansAngle angle, float speed)
     {
-        getUnit(unitId).turnObject(name, axis, angle, speed);
+        getUnit(unitId).turnObject(piece, axis, angle, speed);
     }
 
-    void GameSimulation::turnObjectNow(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle)
+    void GameSimulation::turnObjectNow(UnitId unitId, unsigned int piece, Axis axis, RadiansAngle angle)
     {
-        getUnit(unitId).turnObjectNow(name, axis, angle);
+        getUnit(unitId).turnObjectNow(piece, axis, angle);
     }
 
-    void GameSimulation::spinObject(UnitId unitId, const std::string& name, Axis axis, float speed, float acceleration)
+    void GameSimulation::spinObject(UnitId unitId, unsigned int piece, Axis axis, float speed, float acceleration)
     {
-        getUnit(unitId).spinObject(name, axis, speed, acceleration);
+        getUnit(unitId).spinObject(piece, axis, speed, acceleration);
     }
 
-    void GameSimulation::stopSpinObject(UnitId unitId, const std::string& name, Axis axis, float deceleration)
+    void GameSimulation::stopSpinObject(UnitId unitId, unsigned int piece, Axis axis, float deceleration)
     {
-        getUnit(unitId).stopSpinObject(name, axis, deceleration);
+        getUnit(unitId).stopSpinObject(piece, axis, deceleration);
     }
 
-    bool GameSimulation::isPieceMoving(UnitId unitId, const std::string& name, Axis axis) const
+    bool GameSimulation::isPieceMoving(UnitId unitId, unsigned int piece, Axis axis) const
     {
-        return getUnit(unitId).isMoveInProgress(name, axis);
+        return getUnit(unitId).isMoveInProgress(piece, axis);
     }
 
-    bool GameSimulation::isPieceTurning(UnitId unitId, const std::string& name, Axis axis) const
+    bool GameSimulation::isPieceTurning(UnitId unitId, unsigned int piece, Axis axis) const
     {
-        return getUnit(unitId).isTurnInProgress(name, axis);
+        return getUnit(unitId).isTurnInProgress(piece, axis);
     }
 
-    std::optional<UnitId> GameSimulation::getFirstCollidingUnit(const Ray3f& ray) const
+    std::vector<UnitId> GameSimulation::getUnitsInRadius(const Vector3f& position, float radius) const
     {
-        auto bestDistance = std::numeric_limits<float>::infinity();
-        std::optional<UnitId> it;
+        auto center = terrain.worldToHeightmapSpace(position);
+        auto cellRadius = radius / std::min(MapTerrain::HeightTileWidthInWorldUnits, MapTerrain::HeightTileHeightInWorldUnits);
+        auto candidates = unitSpatialIndex.queryCircle(Vector2f(center.x, center.z), cellRadius);
 
-        for (const auto& entry : units)
-        {
-            auto distance = entry.second.selectionIntersect(ray);
-            if (distance && distance < bestDistance)
-            {
-                bestDistance = *distance;
-                it = entry.first;
-            }
-        }
+        auto radiusSquared = radius * radius;
+        Vector2f xzPosition(position.x, position.z);
+        candidates.erase(
+            std::remove_if(candidates.begin(), candidates.end(), [this, &xzPosition, radiusSquared](UnitId id) {
+                const auto& unitPosition = getUnit(id).position;
+                return xzPosition.distanceSquared(Vector2f(unitPosition.x, unitPosition.z)) > radiusSquared;
+            }),
+            candidates.end());
 
-        return it;
+        return candidates;
     }
 
     std::optional<Vector3f> GameSimulation::intersectLineWithTerrain(const Line3f& line) const
@@ -276,33 +262,29 @@ namespace rwe
         auto newRegion = occupiedGrid.grid.tryToRegion(newRect);
         assert(!!newRegion);
 
-        occupiedGrid.grid.setArea(*oldRegion, OccupiedNone());
-        occupiedGrid.grid.setArea(*newRegion, OccupiedUnit(unitId));
+        occupiedGrid.setArea(*oldRegion, OccupiedNone());
+        occupiedGrid.setArea(*newRegion, OccupiedUnit(unitId));
+
+        unitSpatialIndex.move(unitId, oldRect, newRect);
     }
 
-    void GameSimulation::requestPath(UnitId unitId)
+    void GameSimulation::requestPath(UnitId unitId, PathRequestPriority priority)
     {
-        PathRequest request{unitId};
-
         // If the unit is already in the queue for a path,
         // we'll assume that they no longer care about their old request
         // and that their new request is for some new path,
         // so we'll move them to the back of the queue for fairness.
-        auto it = std::find(pathRequests.begin(), pathRequests.end(), request);
-        if (it != pathRequests.end())
-        {
-            pathRequests.erase(it);
-        }
-
-        pathRequests.push_back(PathRequest{unitId});
+        pathRequests.push(PathRequest{unitId, priority, gameTime});
     }
 
     LaserProjectile GameSimulation::createProjectileFromWeapon(
-        PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction)
+        PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction) const
     {
         LaserProjectile laser;
+        laser.weaponType = weapon.weaponType;
         laser.owner = owner;
         laser.position = position;
+        laser.previousPosition = position;
         laser.origin = position;
         laser.velocity = direction * weapon.velocity;
         laser.duration = weapon.duration;
@@ -326,19 +308,9 @@ namespace rwe
         return laser;
     }
 
-    void GameSimulation::spawnLaser(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction)
+    void GameSimulation::spawnLaser(LaserProjectile&& laser)
     {
-        auto laser = createProjectileFromWeapon(owner, weapon, position, direction);
-
-        auto it = std::find_if(lasers.begin(), lasers.end(), [](const auto& x) { return !x; });
-        if (it == lasers.end())
-        {
-            lasers.push_back(laser);
-        }
-        else
-        {
-            *it = laser;
-        }
+        lasers.insert(std::move(laser));
     }
 
     void GameSimulation::spawnExplosion(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation)
@@ -348,15 +320,7 @@ namespace rwe
         exp.animation = animation;
         exp.startTime = gameTime;
 
-        auto it = std::find_if(explosions.begin(), explosions.end(), [](const auto& x) { return !x; });
-        if (it == explosions.end())
-        {
-            explosions.push_back(exp);
-        }
-        else
-        {
-            *it = exp;
-        }
+        explosions.insert(std::move(exp));
     }
 
     void GameSimulation::spawnSmoke(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation)
@@ -367,14 +331,54 @@ namespace rwe
         exp.startTime = gameTime;
         exp.floats = true;
 
-        auto it = std::find_if(explosions.begin(), explosions.end(), [](const auto& x) { return !x; });
-        if (it == explosions.end())
+        explosions.insert(std::move(exp));
+    }
+
+    std::uint64_t GameSimulation::computeStateHash() const
+    {
+        StateHasher hasher(randomSeed);
+        hasher.add(gameTime.value);
+
+        for (std::size_t i = 0; i < units.size(); ++i)
         {
-            explosions.push_back(exp);
+            const auto& unit = units.valueAt(i);
+            hasher.add(units.idAt(i).value);
+            hasher.addVector(unit.position);
+            hasher.add(unit.hitPoints);
+            hasher.add(unit.inCollision ? 1 : 0);
+            hasher.add(unit.orders.size());
+            hasher.add(static_cast<std::uint64_t>(unit.behaviourState.which()));
+
+            hasher.addFloat(unitKinematics.rotation[i]);
+            hasher.addFloat(unitKinematics.currentSpeed[i]);
+            hasher.addFloat(unitKinematics.targetAngle[i]);
+            hasher.addFloat(unitKinematics.targetSpeed[i]);
+
+            const auto& cob = *unit.cobEnvironment;
+            hasher.add(cob.threads.size());
+            for (auto value : cob._statics)
+            {
+                hasher.add(static_cast<std::uint32_t>(value));
+            }
+        }
+
+        hasher.add(lasers.size());
+        for (const auto& laser : lasers)
+        {
+            hasher.add(laser.owner.value);
+            hasher.addVector(laser.position);
+            hasher.addVector(laser.velocity);
         }
-        else
+
+        hasher.add(pathRequests.size());
+        for (const auto& request : pathRequestsInProgress)
         {
-            *it = exp;
+            hasher.add(request.unitId.value);
         }
+
+        hasher.add(pathCache.getEpoch());
+        hasher.add(pathCache.size());
+
+        return hasher.get();
     }
 }
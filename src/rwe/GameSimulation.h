@@ -1,16 +1,25 @@
 #ifndef RWE_GAMESIMULATION_H
 #define RWE_GAMESIMULATION_H
 
+#include <cstdint>
+#include <rwe/DiscreteRect.h>
 #include <rwe/Explosion.h>
 #include <rwe/FeatureId.h>
 #include <rwe/GameTime.h>
 #include <rwe/LaserProjectile.h>
 #include <rwe/MapFeature.h>
 #include <rwe/MapTerrain.h>
+#include <rwe/ObjectPool.h>
 #include <rwe/OccupiedGrid.h>
 #include <rwe/PlayerId.h>
+#include <rwe/SlotMap.h>
 #include <rwe/Unit.h>
+#include <rwe/UnitKinematics.h>
+#include <rwe/UnitSpatialIndex.h>
+#include <rwe/pathfinding/PathCache.h>
+#include <rwe/pathfinding/PathRequestQueue.h>
 #include <unordered_map>
+#include <vector>
 
 namespace rwe
 {
@@ -19,15 +28,6 @@ namespace rwe
         unsigned int color;
     };
 
-    struct PathRequest
-    {
-        UnitId unitId;
-
-        bool operator==(const PathRequest& rhs) const;
-
-        bool operator!=(const PathRequest& rhs) const;
-    };
-
     struct GameSimulation
     {
         MapTerrain terrain;
@@ -38,20 +38,51 @@ namespace rwe
 
         std::unordered_map<FeatureId, MapFeature> features;
 
-        UnitId nextUnitId{0};
-
         FeatureId nextFeatureId{0};
 
-        std::unordered_map<UnitId, Unit> units;
+        /**
+         * Footprints of blocking features placed or removed
+         * since the path finder last caught up with them.
+         */
+        std::vector<DiscreteRect> changedFeatureAreas;
+
+        SlotMap<Unit, UnitId> units;
 
-        std::vector<std::optional<LaserProjectile>> lasers;
+        /** Steering state of each unit, in the same order as units. */
+        UnitKinematicsStore unitKinematics;
 
-        std::vector<std::optional<Explosion>> explosions;
+        /** Which units are near each part of the map, kept in step with occupiedGrid. */
+        UnitSpatialIndex unitSpatialIndex;
 
-        std::deque<PathRequest> pathRequests;
+        ObjectPool<LaserProjectile> lasers;
+
+        /** Explosions and smoke. */
+        ObjectPool<Explosion> explosions;
+
+        PathRequestQueue pathRequests;
+
+        /**
+         * Requests taken from pathRequests at the end of the last tick
+         * whose searches are still running.
+         * Their results are applied at the start of the next tick.
+         */
+        std::vector<PathRequest> pathRequestsInProgress;
+
+        /**
+         * Routes found by recent searches, for later searches to join.
+         * Kept with the simulation because which routes are cached decides
+         * the paths units are given.
+         */
+        PathCache pathCache;
 
         GameTime gameTime{0};
 
+        /**
+         * Seeds all randomness in the simulation.
+         * Every participant in a game must use the same seed.
+         */
+        std::uint64_t randomSeed{0};
+
         explicit GameSimulation(MapTerrain&& terrain);
 
         FeatureId addFeature(MapFeature&& newFeature);
@@ -59,10 +90,17 @@ namespace rwe
         PlayerId addPlayer(const GamePlayerInfo& info);
 
         /**
-         * Returns true if the unit was really added, false otherwise.
+         * Returns the ID of the new unit if it was really added,
+         * or an empty optional otherwise.
          * A unit might not be added because it violates collision constraints.
          */
-        bool tryAddUnit(Unit&& unit);
+        std::optional<UnitId> tryAddUnit(Unit&& unit, const UnitMovementAttributes& movementAttributes);
+
+        /**
+         * Removes dead units and frees the area they occupied.
+         * The removed units are moved into deadUnits.
+         */
+        void deleteDeadUnits(std::vector<Unit>& deadUnits);
 
         DiscreteRect computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const;
 
@@ -70,13 +108,13 @@ namespace rwe
 
         bool isAdjacentToObstacle(const DiscreteRect& rect, UnitId self) const;
 
-        void showObject(UnitId unitId, const std::string& name);
+        void showObject(UnitId unitId, unsigned int piece);
 
-        void hideObject(UnitId unitId, const std::string& name);
+        void hideObject(UnitId unitId, unsigned int piece);
 
-        void enableShading(UnitId unitId, const std::string& name);
+        void enableShading(UnitId unitId, unsigned int piece);
 
-        void disableShading(UnitId unitId, const std::string& name);
+        void disableShading(UnitId unitId, unsigned int piece);
 
         Unit& getUnit(UnitId id);
 
@@ -84,43 +122,71 @@ namespace rwe
 
         bool unitExists(UnitId id) const;
 
+        /**
+         * Returns the position of the unit in units,
+         * which is also its index into unitKinematics.
+         */
+        std::size_t getUnitIndex(UnitId id) const;
+
         MapFeature& getFeature(FeatureId id);
 
         const MapFeature& getFeature(FeatureId id) const;
 
         const GamePlayerInfo& getPlayer(PlayerId player) const;
 
-        void moveObject(UnitId unitId, const std::string& name, Axis axis, float position, float speed);
+        void moveObject(UnitId unitId, unsigned int piece, Axis axis, float position, float speed);
 
-        void moveObjectNow(UnitId unitId, const std::string& name, Axis axis, float position);
+        void moveObjectNow(UnitId unitId, unsigned int piece, Axis axis, float position);
 
-        void turnObject(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle, float speed);
+        void turnObject(UnitId unitId, unsigned int piece, Axis axis, RadiansAngle angle, float speed);
 
-        void turnObjectNow(UnitId unitId, const std::string& name, Axis axis, RadiansAngle angle);
+        void turnObjectNow(UnitId unitId, unsigned int piece, Axis axis, RadiansAngle angle);
 
-        void spinObject(UnitId unitId, const std::string& name, Axis axis, float speed, float acceleration);
+        void spinObject(UnitId unitId, unsigned int piece, Axis axis, float speed, float acceleration);
 
-        void stopSpinObject(UnitId unitId, const std::string& name, Axis axis, float deceleration);
+        void stopSpinObject(UnitId unitId, unsigned int piece, Axis axis, float deceleration);
 
-        bool isPieceMoving(UnitId unitId, const std::string& name, Axis axis) const;
+        bool isPieceMoving(UnitId unitId, unsigned int piece, Axis axis) const;
 
-        bool isPieceTurning(UnitId unitId, const std::string& name, Axis axis) const;
+        bool isPieceTurning(UnitId unitId, unsigned int piece, Axis axis) const;
 
-        std::optional<UnitId> getFirstCollidingUnit(const Ray3f& ray) const;
+        /**
+         * Returns the units whose position is within the given distance
+         * of the given point on the XZ plane, ordered by ID.
+         */
+        std::vector<UnitId> getUnitsInRadius(const Vector3f& position, float radius) const;
 
         std::optional<Vector3f> intersectLineWithTerrain(const Line3f& line) const;
 
         void moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId);
 
-        void requestPath(UnitId unitId);
+        /**
+         * Queues the unit for a path search.
+         * A request the unit already has queued is replaced,
+         * since it is no longer interested in the old path.
+         */
+        void requestPath(UnitId unitId, PathRequestPriority priority);
 
-        LaserProjectile createProjectileFromWeapon(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction);
+        LaserProjectile createProjectileFromWeapon(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction) const;
 
-        void spawnLaser(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction);
+        void spawnLaser(LaserProjectile&& laser);
 
         void spawnExplosion(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation);
 
         void spawnSmoke(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation);
+
+        /**
+         * Returns a hash of the state that determines how the game plays out.
+         * Two simulations that have diverged will (almost certainly)
+         * have different hashes.
+         * Purely cosmetic state, such as explosions and smoke,
+         * is left out, since it differs between headless and graphical runs.
+         *
+         * This is a full rehash, linear in the number of units and projectiles.
+         * No running hash is kept, since nearly everything hashed
+         * (positions, speeds, rotations) is rewritten for every moving unit each tick anyway.
+         */
+        std::uint64_t computeStateHash() const;
     };
 }
 
@@ -64,6 +64,11 @@ namespace rwe
 
     GameTimeDelta deltaSecondsToTicks(float seconds)
     {
-        return GameTimeDelta(seconds * 60.0f);
+        return GameTimeDelta(seconds * static_cast<float>(SimTicksPerSecond));
+    }
+
+    GameTimeDelta deltaMillisecondsToTicks(unsigned int milliseconds)
+    {
+        return GameTimeDelta(milliseconds * SimTicksPerSecond / 1000);
     }
 }
@@ -2,9 +2,16 @@
 #define RWE_GAMETIME_H
 
 #include <rwe/OpaqueId.h>
+#include <rwe/config.h>
 
 namespace rwe
 {
+    /** The tick rate of the original game, which unit and weapon data are expressed in. */
+    static const unsigned int TaTicksPerSecond = 30;
+
+    /** The length of one simulation tick in seconds. */
+    static const float SimTickDurationSeconds = 1.0f / static_cast<float>(SimTicksPerSecond);
+
     struct GameTimeTag;
     using GameTime = OpaqueId<unsigned int, GameTimeTag>;
 
@@ -29,6 +36,8 @@ namespace rwe
     GameTimeDelta operator-(GameTime a, GameTime b);
 
     GameTimeDelta deltaSecondsToTicks(float seconds);
+
+    GameTimeDelta deltaMillisecondsToTicks(unsigned int milliseconds);
 }
 
 #endif
@@ -12,10 +12,16 @@ namespace rwe
 {
     struct LaserProjectile
     {
+        /** The name of the definition of the weapon that fired this projectile. */
+        std::string weaponType;
+
         PlayerId owner;
 
         Vector3f position;
 
+        /** The position at the end of the previous tick, used to draw the projectile in between ticks. */
+        Vector3f previousPosition;
+
         Vector3f origin;
 
         /** Velocity in game pixels/tick */
@@ -1,10 +1,17 @@
 #include "LoadingScene.h"
+#include <algorithm>
+#include <boost/filesystem.hpp>
 #include <boost/interprocess/streams/bufferstream.hpp>
+#include <cstdio>
+#include <fstream>
+#include <rwe/WalkableGridCache.h>
 #include <rwe/WeaponTdf.h>
 #include <rwe/ota.h>
 #include <rwe/tdf.h>
 #include <rwe/tnt/TntArchive.h>
 #include <rwe/ui/UiLabel.h>
+#include <rwe/util.h>
+#include <spdlog/spdlog.h>
 
 namespace rwe
 {
@@ -93,7 +100,7 @@ namespace rwe
         sceneManager->setNextScene(createGameScene(gameParameters.mapName, gameParameters.schemaIndex));
     }
 
-    void LoadingScene::render(GraphicsContext& context)
+    void LoadingScene::render(GraphicsContext& context, float /*interpolationAlpha*/)
     {
         panel->render(scaledUiRenderService);
         cursor->render(nativeUiRenderService);
@@ -121,19 +128,7 @@ namespace rwe
 
         auto unitDatabase = createUnitDatabase();
 
-        MovementClassCollisionService collisionService;
-
-        // compute cached walkable grids for each movement class
-        {
-            UnitDatabase::MovementClassIterator it = unitDatabase.movementClassBegin();
-            UnitDatabase::MovementClassIterator end = unitDatabase.movementClassEnd();
-            for (; it != end; ++it)
-            {
-                const auto& name = it->first;
-                const auto& mc = it->second;
-                collisionService.registerMovementClass(name, computeWalkableGrid(simulation, mc));
-            }
-        }
+        auto collisionService = createCollisionService(simulation, unitDatabase);
 
         std::optional<PlayerId> localPlayerId;
 
@@ -165,6 +160,27 @@ namespace rwe
         RenderService renderService(graphics, shaders, camera);
         UiRenderService uiRenderService(graphics, shaders, uiCamera);
 
+        std::optional<ReplayRecorder> recorder;
+        if (gameParameters.replayPath)
+        {
+            ReplayHeader header;
+            header.mapName = mapName;
+            header.schemaIndex = schemaIndex;
+            header.unitDataVersion = unitDatabase.getDataVersion();
+            header.randomSeed = simulation.randomSeed;
+            for (const auto& player : simulation.players)
+            {
+                header.playerColors.push_back(player.color);
+            }
+
+            auto stream = std::make_unique<std::ofstream>(*gameParameters.replayPath, std::ios::binary);
+            if (!*stream)
+            {
+                throw std::runtime_error("Failed to open replay file " + *gameParameters.replayPath);
+            }
+            recorder.emplace(std::move(stream), header);
+        }
+
         auto gameScene = std::make_unique<GameScene>(
             textureService,
             cursor,
@@ -179,7 +195,8 @@ namespace rwe
             std::move(collisionService),
             std::move(unitDatabase),
             std::move(meshService),
-            *localPlayerId);
+            *localPlayerId,
+            std::move(recorder));
 
         const auto& schema = ota.schemas.at(schemaIndex);
 
@@ -225,6 +242,74 @@ namespace rwe
         return gameScene;
     }
 
+    MovementClassCollisionService LoadingScene::createCollisionService(const GameSimulation& simulation, const UnitDatabase& unitDatabase)
+    {
+        // sorted by name so that the cache key does not depend on hash map order
+        std::vector<std::pair<std::string, MovementClass>> namedClasses(unitDatabase.movementClassBegin(), unitDatabase.movementClassEnd());
+        std::sort(namedClasses.begin(), namedClasses.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::vector<MovementClass> movementClasses;
+        for (const auto& pair : namedClasses)
+        {
+            movementClasses.push_back(pair.second);
+        }
+
+        const auto& heights = simulation.terrain.getHeightMap();
+        auto waterLevel = static_cast<unsigned int>(simulation.terrain.getSeaLevel());
+        auto key = computeWalkableGridCacheKey(heights, waterLevel, movementClasses);
+
+        std::optional<boost::filesystem::path> cachePath;
+        if (auto localDataPath = getLocalDataPath())
+        {
+            char fileName[32];
+            std::snprintf(fileName, sizeof(fileName), "walkable_%016llx.bin", static_cast<unsigned long long>(key));
+            cachePath = *localDataPath / "cache" / fileName;
+        }
+
+        std::optional<std::vector<Grid<char>>> grids;
+        if (cachePath && boost::filesystem::exists(*cachePath))
+        {
+            try
+            {
+                std::ifstream stream(cachePath->string(), std::ios::binary);
+                grids = readWalkableGridCache(stream, key);
+            }
+            catch (const std::runtime_error& e)
+            {
+                spdlog::get("rwe")->warn("Ignoring walkable grid cache {0}: {1}", cachePath->string(), e.what());
+            }
+        }
+
+        if (!grids || grids->size() != movementClasses.size())
+        {
+            ThreadPool threadPool(ThreadPool::defaultWorkerCount());
+            grids = computeWalkableGrids(heights, waterLevel, movementClasses, threadPool);
+
+            if (cachePath)
+            {
+                boost::system::error_code ec;
+                boost::filesystem::create_directories(cachePath->parent_path(), ec);
+                std::ofstream stream(cachePath->string(), std::ios::binary);
+                if (!ec && stream)
+                {
+                    writeWalkableGridCache(stream, key, *grids);
+                }
+                else
+                {
+                    spdlog::get("rwe")->warn("Failed to write walkable grid cache {0}", cachePath->string());
+                }
+            }
+        }
+
+        MovementClassCollisionService collisionService;
+        for (std::size_t i = 0; i < namedClasses.size(); ++i)
+        {
+            collisionService.registerMovementClass(namedClasses[i].first, std::move((*grids)[i]));
+        }
+
+        return collisionService;
+    }
+
     GameSimulation LoadingScene::createInitialSimulation(const std::string& mapName, const OtaRecord& ota, unsigned int schemaIndex)
     {
         auto tntBytes = vfs->readFile("maps/" + mapName + ".tnt");
@@ -475,6 +560,7 @@ namespace rwe
             {
                 throw std::runtime_error("Failed to read gamedata/SOUND.TDF");
             }
+            db.addSourceFile("gamedata/SOUND.TDF", bytes->data(), bytes->size());
 
             std::string soundString(bytes->data(), bytes->size());
             auto sounds = parseSoundTdf(parseTdfFromString(soundString));
@@ -504,6 +590,7 @@ namespace rwe
             {
                 throw std::runtime_error("Failed to read gamedata/MOVEINFO.TDF");
             }
+            db.addSourceFile("gamedata/MOVEINFO.TDF", bytes->data(), bytes->size());
 
             std::string movementString(bytes->data(), bytes->size());
             auto classes = parseMovementTdf(parseTdfFromString(movementString));
@@ -525,6 +612,7 @@ namespace rwe
                 {
                     throw std::runtime_error("File in listing could not be read: " + fileName);
                 }
+                db.addSourceFile("weapons/" + fileName, bytes->data(), bytes->size());
 
                 std::string tdfString(bytes->data(), bytes->size());
                 auto entries = parseWeaponTdf(parseTdfFromString(tdfString));
@@ -550,6 +638,7 @@ namespace rwe
                 {
                     throw std::runtime_error("File in listing could not be read: " + fbiName);
                 }
+                db.addSourceFile("units/" + fbiName, bytes->data(), bytes->size());
 
                 std::string fbiString(bytes->data(), bytes->size());
                 auto fbi = parseUnitFbi(parseTdfFromString(fbiString));
@@ -569,6 +658,7 @@ namespace rwe
                 {
                     throw std::runtime_error("File in listing could not be read: " + scriptName);
                 }
+                db.addSourceFile("scripts/" + scriptName, bytes->data(), bytes->size());
 
                 boost::interprocess::bufferstream s(bytes->data(), bytes->size());
                 auto cob = parseCob(s);
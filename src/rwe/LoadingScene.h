@@ -37,6 +37,9 @@ namespace rwe
         unsigned int schemaIndex;
         std::array<std::optional<PlayerInfo>, 10> players;
 
+        /** If set, the game's commands are recorded to a replay file at this path. */
+        std::optional<std::string> replayPath;
+
         GameParameters(const std::string& mapName, unsigned int schemaIndex);
     };
 
@@ -88,13 +91,20 @@ namespace rwe
 
         void init() override;
 
-        void render(GraphicsContext& context) override;
+        void render(GraphicsContext& context, float interpolationAlpha) override;
 
     private:
         static unsigned int computeMidpointHeight(const Grid<unsigned char>& heightmap, std::size_t x, std::size_t y);
 
         std::unique_ptr<GameScene> createGameScene(const std::string& mapName, unsigned int schemaIndex);
 
+        /**
+         * Registers every movement class with its walkable grid.
+         * The grids are cached on disk, keyed by the terrain and movement classes,
+         * so loading the same map again skips computing them.
+         */
+        MovementClassCollisionService createCollisionService(const GameSimulation& simulation, const UnitDatabase& unitDatabase);
+
         GameSimulation createInitialSimulation(const std::string& mapName, const rwe::OtaRecord& ota, unsigned int schemaIndex);
 
         std::vector<TextureRegion> getTileTextures(TntArchive& tnt);
@@ -24,7 +24,8 @@ namespace rwe
         const std::unordered_map<std::string, SideData>* sideData,
         ViewportService* viewportService,
         float width,
-        float height)
+        float height,
+        const std::optional<std::string>& replayPath)
         : sceneManager(sceneManager),
           vfs(vfs),
           textureService(textureService),
@@ -39,6 +40,7 @@ namespace rwe
           sdl(sdl),
           sideData(sideData),
           viewportService(viewportService),
+          replayPath(replayPath),
           scaledUiRenderService(graphics, shaders, UiCamera(640.0f, 480.0f)),
           nativeUiRenderService(graphics, shaders, UiCamera(width, height)),
           model(),
@@ -55,7 +57,7 @@ namespace rwe
         goToMainMenu();
     }
 
-    void MainMenuScene::render(GraphicsContext& context)
+    void MainMenuScene::render(GraphicsContext& context, float /*interpolationAlpha*/)
     {
         panelStack.back()->render(scaledUiRenderService);
 
@@ -154,7 +156,7 @@ namespace rwe
 
     void MainMenuScene::update()
     {
-        topPanel().update(static_cast<float>(SceneManager::TickInterval) / 1000.0f);
+        topPanel().update(SimTickDurationSeconds);
     }
 
     void MainMenuScene::onMouseWheel(MouseWheelEvent event)
@@ -545,6 +547,7 @@ namespace rwe
         }
 
         GameParameters params{model.selectedMap.getValue()->name, 0};
+        params.replayPath = replayPath;
 
         for (unsigned int i = 0; i < model.players.size(); ++i)
         {
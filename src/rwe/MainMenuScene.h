@@ -35,6 +35,9 @@ namespace rwe
         const std::unordered_map<std::string, SideData>* sideData;
         ViewportService* viewportService;
 
+        /** Where games started from the menu are recorded, if anywhere. */
+        std::optional<std::string> replayPath;
+
         UiRenderService scaledUiRenderService;
         UiRenderService nativeUiRenderService;
 
@@ -63,7 +66,8 @@ namespace rwe
             const std::unordered_map<std::string, SideData>* sideData,
             ViewportService* viewportService,
             float width,
-            float height);
+            float height,
+            const std::optional<std::string>& replayPath);
 
         // "this" is passed to the owned UiFactory instance,
         // and this would not be correctly updated
@@ -75,7 +79,7 @@ namespace rwe
 
         void init() override;
 
-        void render(GraphicsContext& context) override;
+        void render(GraphicsContext& context, float interpolationAlpha) override;
 
         void onMouseDown(MouseButtonEvent event) override;
 
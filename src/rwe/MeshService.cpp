@@ -153,16 +153,23 @@ namespace rwe
 
         SharedTextureHandle atlasTexture(graphics->createTexture(atlas));
 
-        return MeshService(vfs, palette, std::move(atlasTexture), std::move(atlasMap), std::move(attribs));
+        return MeshService(vfs, graphics, palette, std::move(atlasTexture), std::move(atlasMap), std::move(attribs));
+    }
+
+    MeshService MeshService::createHeadlessMeshService(AbstractVirtualFileSystem* vfs, const ColorPalette* palette)
+    {
+        return MeshService(vfs, nullptr, palette, SharedTextureHandle(), std::unordered_map<FrameId, Rectangle2f>(), std::unordered_map<std::string, TextureAttributes>());
     }
 
     MeshService::MeshService(
         AbstractVirtualFileSystem* vfs,
+        GraphicsContext* graphics,
         const ColorPalette* palette,
         SharedTextureHandle&& atlas,
         std::unordered_map<FrameId, Rectangle2f>&& atlasMap,
         std::unordered_map<std::string, TextureAttributes> textureAttributesMap)
         : vfs(vfs),
+          graphics(graphics),
           palette(palette),
           atlas(std::move(atlas)),
           atlasMap(std::move(atlasMap)),
@@ -180,7 +187,10 @@ namespace rwe
             // handle textured quads
             if (p.vertices.size() == 4 && p.textureName)
             {
-                auto textureBounds = getTextureRegion(*(p.textureName), teamColor);
+                // headless meshes are never drawn, so there is no atlas to look in
+                auto textureBounds = graphics == nullptr
+                    ? Rectangle2f::fromTLBR(0.0f, 0.0f, 0.0f, 0.0f)
+                    : getTextureRegion(*(p.textureName), teamColor);
 
                 Mesh::Triangle t0(
                     Mesh::Vertex(vertexToVector(o.vertices[p.vertices[2]]), textureBounds.bottomRight()),
@@ -253,7 +263,10 @@ namespace rwe
         m.name = o.name;
         auto mesh = meshFrom3do(o, teamColor);
         auto height = m.origin.y + getMeshHeight(mesh);
-        m.mesh = std::make_shared<ShaderMesh>(convertMesh(mesh));
+        if (graphics != nullptr)
+        {
+            m.mesh = std::make_shared<ShaderMesh>(convertMesh(mesh));
+        }
 
         for (const auto& c : o.children)
         {
@@ -339,6 +352,11 @@ namespace rwe
 
     GlMesh MeshService::createSelectionMesh(const Vector3f& a, const Vector3f& b, const Vector3f& c, const Vector3f& d)
     {
+        if (graphics == nullptr)
+        {
+            return GlMesh(VaoHandle(), VboHandle(), 0);
+        }
+
         const Vector3f color(0.325f, 0.875f, 0.310f);
 
         std::vector<GlColoredVertex> buffer{
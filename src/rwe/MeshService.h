@@ -49,8 +49,19 @@ namespace rwe
             GraphicsContext* graphics,
             const ColorPalette* palette);
 
+        /**
+         * Creates a mesh service that does not upload anything to the GPU.
+         * Meshes loaded by this service carry geometry information
+         * (height, selection collision mesh) but have no renderable parts,
+         * so they are only suitable for running the simulation.
+         */
+        static MeshService createHeadlessMeshService(
+            AbstractVirtualFileSystem* vfs,
+            const ColorPalette* palette);
+
         MeshService(
             AbstractVirtualFileSystem* vfs,
+            GraphicsContext* graphics,
             const ColorPalette* palette,
             SharedTextureHandle&& atlas,
             std::unordered_map<FrameId, Rectangle2f>&& atlasMap,
@@ -1,4 +1,6 @@
 #include "MovementClassCollisionService.h"
+#include <algorithm>
+#include <vector>
 
 namespace rwe
 {
@@ -6,6 +8,7 @@ namespace rwe
     MovementClassCollisionService::registerMovementClass(const std::string& className, Grid<char>&& walkableGrid)
     {
         MovementClassId id(nextId++);
+        componentGrids.insert({id, computeConnectedComponents(walkableGrid)});
         walkableGrids.insert({id, std::move(walkableGrid)});
         movementClassNameMap.insert({className, id});
         return id;
@@ -58,27 +61,308 @@ namespace rwe
         return it->second;
     }
 
-    Grid<char> computeWalkableGrid(const GameSimulation& sim, const MovementClass& movementClass)
+    std::optional<unsigned int> MovementClassCollisionService::getComponent(MovementClassId movementClass, const Point& position) const
+    {
+        auto component = getComponentGrid(movementClass).tryGet(position);
+        if (!component || component->get() == 0)
+        {
+            return std::nullopt;
+        }
+
+        return component->get();
+    }
+
+    bool MovementClassCollisionService::isReachable(MovementClassId movementClass, const Point& from, const Point& to) const
     {
-        const auto& terrain = sim.terrain;
+        auto component = getComponent(movementClass, from);
+        return component && component == getComponent(movementClass, to);
+    }
 
-        const auto width = terrain.getHeightMap().getWidth();
-        const auto height = terrain.getHeightMap().getHeight();
+    std::optional<Point> MovementClassCollisionService::findNearestInComponent(MovementClassId movementClass, unsigned int component, const Point& position) const
+    {
+        const auto& grid = getComponentGrid(movementClass);
+        auto width = static_cast<int>(grid.getWidth());
+        auto height = static_cast<int>(grid.getHeight());
+        auto maxRadius = std::max(width, height);
+
+        // Search outwards in square rings.
+        // A closer cell can be in the next ring out,
+        // so keep going until no cell left could beat the best so far.
+        std::optional<Point> best;
+        int bestDistanceSquared = 0;
+        for (int radius = 0; radius <= maxRadius; ++radius)
+        {
+            if (best && radius * radius > bestDistanceSquared)
+            {
+                break;
+            }
 
-        Grid<char> walkableGrid(width, height, false);
+            for (int dy = -radius; dy <= radius; ++dy)
+            {
+                // only the edge of the ring
+                auto step = (dy == -radius || dy == radius) ? 1 : 2 * radius;
+                for (int dx = -radius; dx <= radius; dx += step)
+                {
+                    Point p(position.x + dx, position.y + dy);
+                    if (p.x < 0 || p.y < 0 || p.x >= width || p.y >= height || grid.get(p.x, p.y) != component)
+                    {
+                        continue;
+                    }
+
+                    auto distanceSquared = (dx * dx) + (dy * dy);
+                    if (!best || distanceSquared < bestDistanceSquared)
+                    {
+                        best = p;
+                        bestDistanceSquared = distanceSquared;
+                    }
+                }
+            }
+        }
 
-        const auto footprintX = movementClass.footprintX;
-        const auto footprintY = movementClass.footprintZ;
+        return best;
+    }
 
-        for (unsigned int y = 0; y < height - footprintY - 1; ++y)
+    const Grid<unsigned int>& MovementClassCollisionService::getComponentGrid(MovementClassId movementClass) const
+    {
+        auto it = componentGrids.find(movementClass);
+        if (it == componentGrids.end())
         {
-            for (unsigned int x = 0; x < width - footprintX - 1; ++x)
+            throw std::runtime_error("Failed to find movement class grid");
+        }
+
+        return it->second;
+    }
+
+    /**
+     * Combines each run of window values spaced stride apart, starting at in,
+     * writing one result to out for each of count consecutive starting positions.
+     * Every loop runs over contiguous memory so that it can be vectorized.
+     */
+    template <typename Op>
+    static void combineWindow(const unsigned char* in, std::size_t stride, unsigned int window, unsigned char* out, std::size_t count, Op op)
+    {
+        std::copy(in, in + count, out);
+        for (unsigned int k = 1; k < window; ++k)
+        {
+            const auto* next = in + (k * stride);
+            for (std::size_t i = 0; i < count; ++i)
             {
-                walkableGrid.set(x, y, isGridPointWalkable(terrain, movementClass, x, y));
+                out[i] = op(out[i], next[i]);
             }
         }
+    }
+
+    static unsigned char minOf(unsigned char a, unsigned char b)
+    {
+        return std::min(a, b);
+    }
 
-        return walkableGrid;
+    static unsigned char maxOf(unsigned char a, unsigned char b)
+    {
+        return std::max(a, b);
+    }
+
+    static unsigned int getWaterDepth(unsigned char height, unsigned int waterLevel)
+    {
+        return height < waterLevel ? waterLevel - height : 0;
+    }
+
+    /**
+     * Window extremes over the terrain for one movement class, in row-major order.
+     * Each window has its top-left corner at the output cell.
+     */
+    struct FootprintWindows
+    {
+        /** The number of output columns. */
+        std::size_t width;
+
+        /** Steepest slope under the footprint. */
+        std::vector<unsigned char> maxSlope;
+
+        /** Lowest and highest heightmap points at the footprint's cells. */
+        std::vector<unsigned char> minHeight;
+        std::vector<unsigned char> maxHeight;
+
+        /** Lowest heightmap point at any corner of the footprint's cells. */
+        std::vector<unsigned char> minCornerHeight;
+    };
+
+    std::vector<Grid<char>> computeWalkableGrids(
+        const Grid<unsigned char>& heights,
+        unsigned int waterLevel,
+        const std::vector<MovementClass>& movementClasses,
+        ThreadPool& threadPool)
+    {
+        const auto width = heights.getWidth();
+        const auto height = heights.getHeight();
+
+        std::vector<Grid<char>> walkableGrids;
+        walkableGrids.reserve(movementClasses.size());
+        for (std::size_t i = 0; i < movementClasses.size(); ++i)
+        {
+            walkableGrids.emplace_back(width, height, false);
+        }
+
+        if (width < 2 || height < 2)
+        {
+            return walkableGrids;
+        }
+
+        // The slope of each cell, shared by every movement class.
+        std::vector<unsigned char> slopes((width - 1) * (height - 1));
+        threadPool.parallelFor(height - 1, [&](std::size_t y) {
+            const auto* top = heights.getData() + (y * width);
+            const auto* bottom = top + width;
+            auto* out = slopes.data() + (y * (width - 1));
+            for (std::size_t x = 0; x < width - 1; ++x)
+            {
+                auto lowest = std::min(std::min(top[x], top[x + 1]), std::min(bottom[x], bottom[x + 1]));
+                auto highest = std::max(std::max(top[x], top[x + 1]), std::max(bottom[x], bottom[x + 1]));
+                out[x] = static_cast<unsigned char>(highest - lowest);
+            }
+        });
+
+        // Only footprints that stay clear of the far edges are considered,
+        // leaving room for the corners of the footprint's cells.
+        auto outputWidth = [&](const MovementClass& mc) -> std::size_t {
+            return width > mc.footprintX + 1 ? width - mc.footprintX - 1 : 0;
+        };
+        auto outputHeight = [&](const MovementClass& mc) -> std::size_t {
+            return height > mc.footprintZ + 1 ? height - mc.footprintZ - 1 : 0;
+        };
+
+        // Horizontal pass, for every row of every movement class.
+        // The vertical pass below reads rows from these buffers.
+        std::vector<FootprintWindows> rowWindows(movementClasses.size());
+        for (std::size_t i = 0; i < movementClasses.size(); ++i)
+        {
+            auto outWidth = outputWidth(movementClasses[i]);
+            auto& w = rowWindows[i];
+            w.width = outWidth;
+            w.maxSlope.resize(outWidth * (height - 1));
+            w.minHeight.resize(outWidth * height);
+            w.maxHeight.resize(outWidth * height);
+            w.minCornerHeight.resize(outWidth * height);
+        }
+
+        threadPool.parallelFor(movementClasses.size() * height, [&](std::size_t index) {
+            const auto& mc = movementClasses[index / height];
+            auto& w = rowWindows[index / height];
+            auto y = index % height;
+            if (w.width == 0 || mc.footprintX == 0)
+            {
+                return;
+            }
+
+            const auto* heightRow = heights.getData() + (y * width);
+            auto offset = y * w.width;
+            combineWindow(heightRow, 1, mc.footprintX, w.minHeight.data() + offset, w.width, minOf);
+            combineWindow(heightRow, 1, mc.footprintX, w.maxHeight.data() + offset, w.width, maxOf);
+            combineWindow(heightRow, 1, mc.footprintX + 1, w.minCornerHeight.data() + offset, w.width, minOf);
+            if (y < height - 1)
+            {
+                combineWindow(slopes.data() + (y * (width - 1)), 1, mc.footprintX, w.maxSlope.data() + offset, w.width, maxOf);
+            }
+        });
+
+        // Vertical pass, producing the final grids one row at a time.
+        threadPool.parallelFor(movementClasses.size() * height, [&](std::size_t index) {
+            const auto& mc = movementClasses[index / height];
+            const auto& w = rowWindows[index / height];
+            auto y = index % height;
+            if (y >= outputHeight(mc) || w.width == 0)
+            {
+                return;
+            }
+
+            auto* out = walkableGrids[index / height].getData() + (y * width);
+
+            // A footprint with no cells has nothing to check.
+            if (mc.footprintX == 0 || mc.footprintZ == 0)
+            {
+                std::fill(out, out + w.width, true);
+                return;
+            }
+
+            std::vector<unsigned char> maxSlope(w.width);
+            std::vector<unsigned char> minHeight(w.width);
+            std::vector<unsigned char> maxHeight(w.width);
+            std::vector<unsigned char> minCornerHeight(w.width);
+            auto offset = y * w.width;
+            combineWindow(w.maxSlope.data() + offset, w.width, mc.footprintZ, maxSlope.data(), w.width, maxOf);
+            combineWindow(w.minHeight.data() + offset, w.width, mc.footprintZ, minHeight.data(), w.width, minOf);
+            combineWindow(w.maxHeight.data() + offset, w.width, mc.footprintZ, maxHeight.data(), w.width, maxOf);
+            combineWindow(w.minCornerHeight.data() + offset, w.width, mc.footprintZ + 1, minCornerHeight.data(), w.width, minOf);
+
+            for (std::size_t x = 0; x < w.width; ++x)
+            {
+                auto isUnderWater = minCornerHeight[x] < waterLevel;
+                auto effectiveMaxSlope = isUnderWater ? mc.maxWaterSlope : mc.maxSlope;
+
+                // Water depth falls as height rises,
+                // so the extreme heights give the extreme depths.
+                out[x] = maxSlope[x] <= effectiveMaxSlope
+                    && getWaterDepth(maxHeight[x], waterLevel) >= mc.minWaterDepth
+                    && getWaterDepth(minHeight[x], waterLevel) <= mc.maxWaterDepth;
+            }
+        });
+
+        return walkableGrids;
+    }
+
+    Grid<char> computeWalkableGrid(const GameSimulation& sim, const MovementClass& movementClass)
+    {
+        ThreadPool threadPool(0);
+        auto waterLevel = static_cast<unsigned int>(sim.terrain.getSeaLevel());
+        auto grids = computeWalkableGrids(sim.terrain.getHeightMap(), waterLevel, {movementClass}, threadPool);
+        return std::move(grids.front());
+    }
+
+    Grid<unsigned int> computeConnectedComponents(const Grid<char>& walkableGrid)
+    {
+        auto width = walkableGrid.getWidth();
+        auto height = walkableGrid.getHeight();
+        Grid<unsigned int> components(width, height, 0);
+
+        unsigned int nextLabel = 1;
+        std::vector<GridCoordinates> stack;
+        for (std::size_t y = 0; y < height; ++y)
+        {
+            for (std::size_t x = 0; x < width; ++x)
+            {
+                if (!walkableGrid.get(x, y) || components.get(x, y) != 0)
+                {
+                    continue;
+                }
+
+                auto label = nextLabel++;
+                components.set(x, y, label);
+                stack.emplace_back(x, y);
+                while (!stack.empty())
+                {
+                    auto cell = stack.back();
+                    stack.pop_back();
+
+                    auto minX = cell.x > 0 ? cell.x - 1 : 0;
+                    auto minY = cell.y > 0 ? cell.y - 1 : 0;
+                    auto maxX = std::min(cell.x + 1, width - 1);
+                    auto maxY = std::min(cell.y + 1, height - 1);
+                    for (auto ny = minY; ny <= maxY; ++ny)
+                    {
+                        for (auto nx = minX; nx <= maxX; ++nx)
+                        {
+                            if (walkableGrid.get(nx, ny) && components.get(nx, ny) == 0)
+                            {
+                                components.set(nx, ny, label);
+                                stack.emplace_back(nx, ny);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return components;
     }
 
     bool
@@ -142,8 +426,7 @@ namespace rwe
     unsigned int
     getWaterDepth(const Grid<unsigned char>& heights, unsigned int waterLevel, unsigned int x, unsigned int y)
     {
-        auto height = heights.get(x, y);
-        return height < waterLevel ? waterLevel - height : 0;
+        return getWaterDepth(heights.get(x, y), waterLevel);
     }
 
     unsigned int getSlope(const Grid<unsigned char>& heights, unsigned int x, unsigned int y)
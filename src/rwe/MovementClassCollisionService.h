@@ -6,7 +6,9 @@
 #include <rwe/MovementClass.h>
 #include <rwe/MovementClassId.h>
 #include <rwe/Point.h>
+#include <rwe/ThreadPool.h>
 #include <unordered_map>
+#include <vector>
 
 namespace rwe
 {
@@ -18,6 +20,9 @@ namespace rwe
         std::unordered_map<std::string, MovementClassId> movementClassNameMap;
         std::unordered_map<MovementClassId, Grid<char>> walkableGrids;
 
+        /** Connected areas of each walkable grid, see computeConnectedComponents. */
+        std::unordered_map<MovementClassId, Grid<unsigned int>> componentGrids;
+
     public:
         MovementClassId registerMovementClass(const std::string& className, Grid<char>&& walkableGrid);
 
@@ -26,10 +31,49 @@ namespace rwe
         bool isWalkable(MovementClassId movementClass, const Point& position) const;
 
         const Grid<char>& getGrid(MovementClassId movementClass) const;
+
+        /**
+         * Returns the label of the connected area of walkable cells the position is in,
+         * or nothing if the position is not walkable.
+         */
+        std::optional<unsigned int> getComponent(MovementClassId movementClass, const Point& position) const;
+
+        /**
+         * Returns false if the movement class certainly cannot get between the two positions.
+         * Only terrain is considered, so features may still be in the way.
+         */
+        bool isReachable(MovementClassId movementClass, const Point& from, const Point& to) const;
+
+        /**
+         * Returns the cell in the given component closest to the position,
+         * or nothing if the component has no cells.
+         */
+        std::optional<Point> findNearestInComponent(MovementClassId movementClass, unsigned int component, const Point& position) const;
+
+    private:
+        const Grid<unsigned int>& getComponentGrid(MovementClassId movementClass) const;
     };
 
+    /**
+     * Computes the walkable grid of each movement class over the given heightmap,
+     * spreading the work across the thread pool.
+     * Gives the same result as calling isGridPointWalkable for every cell.
+     */
+    std::vector<Grid<char>> computeWalkableGrids(
+        const Grid<unsigned char>& heights,
+        unsigned int waterLevel,
+        const std::vector<MovementClass>& movementClasses,
+        ThreadPool& threadPool);
+
     Grid<char> computeWalkableGrid(const GameSimulation& sim, const MovementClass& movementClass);
 
+    /**
+     * Labels each walkable cell with the connected area it belongs to,
+     * moving in eight directions as units do.
+     * Labels start at 1. Unwalkable cells are labelled 0.
+     */
+    Grid<unsigned int> computeConnectedComponents(const Grid<char>& walkableGrid);
+
     bool isGridPointWalkable(const MapTerrain& terrain, const MovementClass& movementClass, unsigned int x, unsigned int y);
 
     bool isMaxSlopeGreaterThan(const Grid<unsigned char>& heights, unsigned int waterLevel, unsigned int x, unsigned int y, unsigned int width, unsigned int height, unsigned int maxSlope, unsigned int maxWaterSlope);
@@ -0,0 +1,200 @@
+#ifndef RWE_OBJECTPOOL_H
+#define RWE_OBJECTPOOL_H
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Pool of short-lived objects such as projectiles and explosions.
+     * Slots of removed objects are threaded onto an intrusive free list
+     * and reused by later insertions, so inserting and removing are O(1).
+     * A compact list of live slots is maintained alongside,
+     * so iteration only visits live objects.
+     *
+     * Slot indices stay valid until the object in them is removed.
+     * Iteration order is not insertion order:
+     * removal moves the last live slot into the removed one's place.
+     */
+    template <typename T>
+    class ObjectPool
+    {
+    public:
+        using Handle = std::size_t;
+
+    private:
+        static constexpr std::size_t NoSlot = std::numeric_limits<std::size_t>::max();
+
+        struct Entry
+        {
+            std::optional<T> value;
+
+            /** If this slot is free, the next free slot after it. */
+            std::size_t nextFree;
+
+            /** If this slot is live, its position in liveSlots. */
+            std::size_t liveIndex;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<std::size_t> liveSlots;
+        std::size_t freeHead{NoSlot};
+
+        template <typename Value, typename Entries>
+        class Iterator
+        {
+        private:
+            Entries* entries;
+            std::vector<std::size_t>::const_iterator it;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+
+            Iterator(Entries* entries, std::vector<std::size_t>::const_iterator it) : entries(entries), it(it) {}
+
+            reference operator*() const { return *(*entries)[*it].value; }
+            pointer operator->() const { return &*(*entries)[*it].value; }
+
+            Iterator& operator++()
+            {
+                ++it;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                auto copy = *this;
+                ++it;
+                return copy;
+            }
+
+            bool operator==(const Iterator& rhs) const { return it == rhs.it; }
+            bool operator!=(const Iterator& rhs) const { return it != rhs.it; }
+        };
+
+    public:
+        using iterator = Iterator<T, std::vector<Entry>>;
+        using const_iterator = Iterator<const T, const std::vector<Entry>>;
+
+        Handle insert(T&& value)
+        {
+            std::size_t slot;
+            if (freeHead != NoSlot)
+            {
+                slot = freeHead;
+                freeHead = entries[slot].nextFree;
+            }
+            else
+            {
+                slot = entries.size();
+                entries.push_back(Entry{std::nullopt, NoSlot, 0});
+            }
+
+            auto& entry = entries[slot];
+            entry.value = std::move(value);
+            entry.nextFree = NoSlot;
+            entry.liveIndex = liveSlots.size();
+            liveSlots.push_back(slot);
+
+            return slot;
+        }
+
+        bool contains(Handle handle) const
+        {
+            return handle < entries.size() && entries[handle].value.has_value();
+        }
+
+        T& get(Handle handle)
+        {
+            assert(contains(handle));
+            return *entries[handle].value;
+        }
+
+        const T& get(Handle handle) const
+        {
+            assert(contains(handle));
+            return *entries[handle].value;
+        }
+
+        void remove(Handle handle)
+        {
+            assert(contains(handle));
+            auto& entry = entries[handle];
+
+            auto liveIndex = entry.liveIndex;
+            auto lastSlot = liveSlots.back();
+            liveSlots[liveIndex] = lastSlot;
+            entries[lastSlot].liveIndex = liveIndex;
+            liveSlots.pop_back();
+
+            entry.value = std::nullopt;
+            entry.nextFree = freeHead;
+            freeHead = handle;
+        }
+
+        /**
+         * Calls the given function on every live object
+         * and removes those for which it returns true.
+         * The function must not insert into or remove from this pool.
+         */
+        template <typename Function>
+        void removeIf(Function f)
+        {
+            std::size_t i = 0;
+            while (i < liveSlots.size())
+            {
+                auto slot = liveSlots[i];
+                if (f(*entries[slot].value))
+                {
+                    // the last live slot is moved into this position,
+                    // so test the same index again.
+                    remove(slot);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        /** Returns the number of live objects. */
+        std::size_t size() const
+        {
+            return liveSlots.size();
+        }
+
+        bool empty() const
+        {
+            return liveSlots.empty();
+        }
+
+        /** Returns the number of slots, live or free. */
+        std::size_t capacity() const
+        {
+            return entries.size();
+        }
+
+        void clear()
+        {
+            entries.clear();
+            liveSlots.clear();
+            freeHead = NoSlot;
+        }
+
+        iterator begin() { return iterator(&entries, liveSlots.cbegin()); }
+        iterator end() { return iterator(&entries, liveSlots.cend()); }
+        const_iterator begin() const { return const_iterator(&entries, liveSlots.cbegin()); }
+        const_iterator end() const { return const_iterator(&entries, liveSlots.cend()); }
+    };
+}
+
+#endif
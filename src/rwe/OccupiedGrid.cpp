@@ -1,4 +1,5 @@
 #include "OccupiedGrid.h"
+#include <algorithm>
 #include <rwe/FeatureId.h>
 
 namespace rwe
@@ -17,7 +18,192 @@ namespace rwe
         return !(rhs == *this);
     }
 
-    OccupiedGrid::OccupiedGrid(std::size_t width, std::size_t height) : grid(width, height, OccupiedType(OccupiedNone())) {}
+    /** IsIgnored says whether a unit does not count as an obstacle. */
+    template <typename IsIgnored>
+    bool isCollisionInRect(const OccupiedGrid& occupiedGrid, const DiscreteRect& rect, IsIgnored isIgnored)
+    {
+        const auto& grid = occupiedGrid.grid;
+        auto region = grid.tryToRegion(rect);
+        if (!region)
+        {
+            return true;
+        }
+
+        if (region->width == 0 || region->height == 0)
+        {
+            return false;
+        }
+
+        // If an empty square covers the rect there is nothing to find.
+        if (std::max(region->width, region->height) <= occupiedGrid.clearance.get(region->x, region->y))
+        {
+            return false;
+        }
+
+        auto firstWord = region->x / 64;
+        auto lastWord = (region->x + region->width - 1) / 64;
+        auto firstMask = ~std::uint64_t(0) << (region->x % 64);
+        auto endBit = (region->x + region->width) % 64;
+        auto lastMask = endBit == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << endBit) - 1;
+
+        for (auto y = region->y; y < region->y + region->height; ++y)
+        {
+            const auto* row = &occupiedGrid.occupiedBits[y * occupiedGrid.occupiedBitsStride];
+            for (auto w = firstWord; w <= lastWord; ++w)
+            {
+                auto bits = row[w];
+                if (w == firstWord)
+                {
+                    bits &= firstMask;
+                }
+                if (w == lastWord)
+                {
+                    bits &= lastMask;
+                }
+
+                // Only occupied cells need a closer look.
+                for (auto x = w * 64; bits != 0; ++x, bits >>= 1)
+                {
+                    if ((bits & 1) == 0)
+                    {
+                        continue;
+                    }
+
+                    const auto& cell = grid.get(x, y);
+                    if (cell.isFeature() || !isIgnored(cell.unitId()))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Recomputes the clearance of every cell whose square could reach into the region.
+     * Cells are visited from the bottom right so that the cells each one depends on are done first.
+     */
+    void updateClearance(const Grid<OccupiedCell>& grid, Grid<unsigned char>& clearance, const GridRegion& region)
+    {
+        if (region.width == 0 || region.height == 0)
+        {
+            return;
+        }
+
+        auto reach = OccupiedGrid::MaxClearance - 1;
+        auto minX = region.x > reach ? region.x - reach : 0;
+        auto minY = region.y > reach ? region.y - reach : 0;
+        auto maxX = region.x + region.width - 1;
+        auto maxY = region.y + region.height - 1;
+        auto width = grid.getWidth();
+        auto height = grid.getHeight();
+
+        auto getClearance = [&](std::size_t x, std::size_t y) -> unsigned int {
+            return x < width && y < height ? clearance.get(x, y) : 0;
+        };
+
+        for (auto y = maxY + 1; y-- > minY;)
+        {
+            for (auto x = maxX + 1; x-- > minX;)
+            {
+                if (!grid.get(x, y).isNone())
+                {
+                    clearance.set(x, y, 0);
+                    continue;
+                }
+
+                auto smallest = std::min({getClearance(x + 1, y), getClearance(x, y + 1), getClearance(x + 1, y + 1)});
+                clearance.set(x, y, static_cast<unsigned char>(std::min(smallest + 1, OccupiedGrid::MaxClearance)));
+            }
+        }
+    }
+
+    OccupiedGrid::OccupiedGrid(std::size_t width, std::size_t height)
+        : grid(width, height, OccupiedNone()),
+          occupiedBits(((width + 63) / 64) * height, 0),
+          occupiedBitsStride((width + 63) / 64),
+          clearance(width, height, 0),
+          rowVersions(height, 0)
+    {
+        updateClearance(grid, clearance, GridRegion(0, 0, width, height));
+    }
+
+    void OccupiedGrid::setArea(const GridRegion& region, const OccupiedCell& value)
+    {
+        grid.setArea(region, value);
+
+        auto occupied = !value.isNone();
+        for (auto y = region.y; y < region.y + region.height; ++y)
+        {
+            auto row = y * occupiedBitsStride;
+            for (auto x = region.x; x < region.x + region.width; ++x)
+            {
+                auto bit = std::uint64_t(1) << (x % 64);
+                auto& word = occupiedBits[row + (x / 64)];
+                word = occupied ? (word | bit) : (word & ~bit);
+            }
+        }
+
+        updateClearance(grid, clearance, region);
+
+        // Clearance changes reach up to MaxClearance - 1 rows above the region.
+        version += 1;
+        auto reach = MaxClearance - 1;
+        auto minY = region.y > reach ? region.y - reach : 0;
+        std::fill(rowVersions.begin() + minY, rowVersions.begin() + region.y + region.height, version);
+    }
+
+    void OccupiedGrid::updateFrom(const OccupiedGrid& source)
+    {
+        assert(grid.getWidth() == source.grid.getWidth() && grid.getHeight() == source.grid.getHeight());
+
+        if (version == source.version)
+        {
+            return;
+        }
+
+        auto width = grid.getWidth();
+        for (std::size_t y = 0; y < grid.getHeight(); ++y)
+        {
+            if (source.rowVersions[y] <= version)
+            {
+                continue;
+            }
+
+            std::copy_n(source.grid.getData() + (y * width), width, grid.getData() + (y * width));
+            std::copy_n(source.clearance.getData() + (y * width), width, clearance.getData() + (y * width));
+            std::copy_n(
+                source.occupiedBits.begin() + (y * occupiedBitsStride),
+                occupiedBitsStride,
+                occupiedBits.begin() + (y * occupiedBitsStride));
+            rowVersions[y] = source.rowVersions[y];
+        }
+
+        version = source.version;
+    }
+
+    bool OccupiedGrid::isCollisionAt(const DiscreteRect& rect, UnitId self) const
+    {
+        return isCollisionInRect(*this, rect, [self](const UnitId& id) { return id == self; });
+    }
+
+    bool OccupiedGrid::isCollisionAt(const DiscreteRect& rect, const std::unordered_set<UnitId>& group) const
+    {
+        return isCollisionInRect(*this, rect, [&group](const UnitId& id) { return group.find(id) != group.end(); });
+    }
+
+    bool OccupiedGrid::isAdjacentToObstacle(const DiscreteRect& rect, UnitId self) const
+    {
+        DiscreteRect expandedRect(rect.x - 1, rect.y - 1, rect.width + 2, rect.height + 2);
+        return isCollisionAt(expandedRect, self);
+    }
+
+    bool OccupiedGrid::isAdjacentToObstacle(const DiscreteRect& rect, const std::unordered_set<UnitId>& group) const
+    {
+        DiscreteRect expandedRect(rect.x - 1, rect.y - 1, rect.width + 2, rect.height + 2);
+        return isCollisionAt(expandedRect, group);
+    }
 
     OccupiedFeature::OccupiedFeature(const FeatureId& id) : id(id)
     {
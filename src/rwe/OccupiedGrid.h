@@ -1,10 +1,14 @@
 #ifndef RWE_OCCUPIEDGRID_H
 #define RWE_OCCUPIEDGRID_H
 
-#include <boost/variant.hpp>
+#include <cassert>
+#include <cstdint>
+#include <rwe/DiscreteRect.h>
 #include <rwe/FeatureId.h>
 #include <rwe/Grid.h>
 #include <rwe/UnitId.h>
+#include <unordered_set>
+#include <vector>
 
 namespace rwe
 {
@@ -37,13 +41,122 @@ namespace rwe
         bool operator!=(const OccupiedNone&) const { return true; }
     };
 
-    using OccupiedType = boost::variant<OccupiedUnit, OccupiedFeature, OccupiedNone>;
+    /**
+     * What occupies a cell, packed into one word:
+     * the top two bits say what kind of thing it is
+     * and the rest hold its ID.
+     */
+    class OccupiedCell
+    {
+    private:
+        static constexpr unsigned int KindShift = 30;
+        static constexpr std::uint32_t IdMask = (std::uint32_t(1) << KindShift) - 1;
+        static constexpr std::uint32_t NoneKind = 0;
+        static constexpr std::uint32_t UnitKind = 1;
+        static constexpr std::uint32_t FeatureKind = 2;
+
+        std::uint32_t value{0};
+
+        OccupiedCell(std::uint32_t kind, unsigned int id) : value((kind << KindShift) | id)
+        {
+            assert(id <= IdMask);
+        }
+
+    public:
+        OccupiedCell() = default;
+
+        OccupiedCell(const OccupiedNone&) {}
+
+        OccupiedCell(const OccupiedUnit& u) : OccupiedCell(UnitKind, u.id.value) {}
+
+        OccupiedCell(const OccupiedFeature& f) : OccupiedCell(FeatureKind, f.id.value) {}
+
+        bool isNone() const { return value == 0; }
+
+        bool isUnit() const { return (value >> KindShift) == UnitKind; }
+
+        bool isFeature() const { return (value >> KindShift) == FeatureKind; }
+
+        /** Only valid if isUnit() is true. */
+        UnitId unitId() const
+        {
+            assert(isUnit());
+            return UnitId(value & IdMask);
+        }
+
+        /** Only valid if isFeature() is true. */
+        FeatureId featureId() const
+        {
+            assert(isFeature());
+            return FeatureId(value & IdMask);
+        }
+
+        bool operator==(const OccupiedCell& rhs) const { return value == rhs.value; }
+
+        bool operator!=(const OccupiedCell& rhs) const { return !(rhs == *this); }
+    };
 
     struct OccupiedGrid
     {
-        Grid<OccupiedType> grid;
+        /** The largest clearance recorded, enough for the biggest footprint plus its border. */
+        static constexpr unsigned int MaxClearance = 12;
+
+        /** Write through setArea so that occupiedBits and clearance stay up to date. */
+        Grid<OccupiedCell> grid;
+
+        /**
+         * One bit per cell, set if the cell is occupied.
+         * Each row starts on a new word, so rect checks can skip 64 empty cells at a time.
+         */
+        std::vector<std::uint64_t> occupiedBits;
+
+        /** The number of words in each row of occupiedBits. */
+        std::size_t occupiedBitsStride;
+
+        /**
+         * For each cell, the size of the largest empty square with its top-left corner there,
+         * up to MaxClearance. Lets collision checks skip scanning areas with nothing in them.
+         */
+        Grid<unsigned char> clearance;
+
+        /** Incremented by every call to setArea. */
+        std::uint64_t version{0};
+
+        /**
+         * For each row, the version in which its cells, occupied bits or clearance last changed.
+         * Lets copies of the grid be brought up to date a row at a time.
+         */
+        std::vector<std::uint64_t> rowVersions;
 
         OccupiedGrid(std::size_t width, std::size_t height);
+
+        void setArea(const GridRegion& region, const OccupiedCell& value);
+
+        /**
+         * Brings this grid, an earlier copy of source, up to date with it
+         * by copying only the rows that have changed since.
+         */
+        void updateFrom(const OccupiedGrid& source);
+
+        bool isOccupied(std::size_t x, std::size_t y) const
+        {
+            return (occupiedBits[(y * occupiedBitsStride) + (x / 64)] >> (x % 64)) & 1;
+        }
+
+        /**
+         * Returns true if any cell in the rect is occupied by something other than the given unit.
+         * Space outside the grid counts as occupied.
+         */
+        bool isCollisionAt(const DiscreteRect& rect, UnitId self) const;
+
+        /** As above, but units in the group are not obstacles. */
+        bool isCollisionAt(const DiscreteRect& rect, const std::unordered_set<UnitId>& group) const;
+
+        /** Returns true if any cell in or bordering the rect is occupied by something other than the given unit. */
+        bool isAdjacentToObstacle(const DiscreteRect& rect, UnitId self) const;
+
+        /** As above, but units in the group are not obstacles. */
+        bool isAdjacentToObstacle(const DiscreteRect& rect, const std::unordered_set<UnitId>& group) const;
     };
 }
 
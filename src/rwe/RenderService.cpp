@@ -3,25 +3,6 @@
 
 namespace rwe
 {
-    class IsOccupiedVisitor : public boost::static_visitor<bool>
-    {
-    public:
-        bool operator()(const OccupiedNone&) const
-        {
-            return false;
-        }
-
-        bool operator()(const OccupiedUnit&) const
-        {
-            return true;
-        }
-
-        bool operator()(const OccupiedFeature&) const
-        {
-            return true;
-        }
-    };
-
     RenderService::RenderService(
         GraphicsContext* graphics,
         ShaderService* shaders,
@@ -33,36 +14,38 @@ namespace rwe
     }
 
     void
-    RenderService::drawSelectionRect(const Unit& unit)
+    RenderService::drawSelectionRect(const UnitRenderState& unit, float interpolationAlpha)
     {
+        auto position = unit.getInterpolatedPosition(interpolationAlpha);
+
         // try to ensure that the selection rectangle vertices
         // are aligned with the middle of pixels,
         // to prevent discontinuities in the drawn lines.
         Vector3f snappedPosition(
-            snapToInterval(unit.position.x, 1.0f) + 0.5f,
-            snapToInterval(unit.position.y, 2.0f),
-            snapToInterval(unit.position.z, 1.0f) + 0.5f);
+            snapToInterval(position.x, 1.0f) + 0.5f,
+            snapToInterval(position.y, 2.0f),
+            snapToInterval(position.z, 1.0f) + 0.5f);
 
-        auto matrix = Matrix4f::translation(snappedPosition) * Matrix4f::rotationY(unit.rotation);
+        auto matrix = Matrix4f::translation(snappedPosition) * Matrix4f::rotationY(unit.getInterpolatedRotation(interpolationAlpha));
 
         const auto& shader = shaders->basicColor;
         graphics->bindShader(shader.handle.get());
         graphics->setUniformMatrix(shader.mvpMatrix, camera.getViewProjectionMatrix() * matrix);
         graphics->setUniformFloat(shader.alpha, 1.0f);
-        graphics->drawLineLoop(unit.selectionMesh.visualMesh);
+        graphics->drawLineLoop(unit.selectionMesh->visualMesh);
     }
 
-    void RenderService::drawUnit(const Unit& unit, float seaLevel)
+    void RenderService::drawUnit(const RenderSnapshot& snapshot, const UnitRenderState& unit, float seaLevel, float interpolationAlpha)
     {
-        drawUnitMesh(unit.mesh, unit.getTransform(), seaLevel);
+        drawUnitPieces(snapshot, unit, unit.getInterpolatedTransform(interpolationAlpha), seaLevel);
     }
 
-    void RenderService::drawUnitMesh(const UnitMesh& mesh, const Matrix4f& modelMatrix, float seaLevel)
+    void RenderService::drawUnitPieces(const RenderSnapshot& snapshot, const UnitRenderState& unit, const Matrix4f& modelMatrix, float seaLevel)
     {
-        auto matrix = modelMatrix * mesh.getTransform();
-
-        if (mesh.visible)
+        for (std::size_t i = unit.firstPiece; i < unit.firstPiece + unit.pieceCount; ++i)
         {
+            const auto& piece = snapshot.pieces[i];
+            auto matrix = modelMatrix * piece.transform;
             auto mvpMatrix = camera.getViewProjectionMatrix() * matrix;
 
             {
@@ -71,26 +54,21 @@ namespace rwe
                 graphics->setUniformMatrix(colorShader.mvpMatrix, mvpMatrix);
                 graphics->setUniformMatrix(colorShader.modelMatrix, matrix);
                 graphics->setUniformFloat(colorShader.seaLevel, seaLevel);
-                graphics->setUniformBool(colorShader.shade, mesh.shaded);
-                graphics->drawTriangles(mesh.mesh->coloredVertices);
+                graphics->setUniformBool(colorShader.shade, piece.shaded);
+                graphics->drawTriangles(piece.mesh->coloredVertices);
             }
 
             {
                 const auto& textureShader = shaders->unitTexture;
                 graphics->bindShader(textureShader.handle.get());
-                graphics->bindTexture(mesh.mesh->texture.get());
+                graphics->bindTexture(piece.mesh->texture.get());
                 graphics->setUniformMatrix(textureShader.mvpMatrix, mvpMatrix);
                 graphics->setUniformMatrix(textureShader.modelMatrix, matrix);
                 graphics->setUniformFloat(textureShader.seaLevel, seaLevel);
-                graphics->setUniformBool(textureShader.shade, mesh.shaded);
-                graphics->drawTriangles(mesh.mesh->texturedVertices);
+                graphics->setUniformBool(textureShader.shade, piece.shaded);
+                graphics->drawTriangles(piece.mesh->texturedVertices);
             }
         }
-
-        for (const auto& c : mesh.children)
-        {
-            drawUnitMesh(c, matrix, seaLevel);
-        }
     }
 
     void RenderService::drawOccupiedGrid(const MapTerrain& terrain, const OccupiedGrid& occupiedGrid)
@@ -140,7 +118,7 @@ namespace rwe
                 lines.emplace_back(pos, rightPos);
                 lines.emplace_back(pos, downPos);
 
-                if (boost::apply_visitor(IsOccupiedVisitor(), occupiedGrid.grid.get(x, y)))
+                if (occupiedGrid.isOccupied(x, y))
                 {
                     auto downRightPos = terrain.heightmapIndexToWorldCorner(x + 1, y + 1);
                     downRightPos.y = terrain.getHeightMap().get(x + 1, y + 1);
@@ -243,16 +221,9 @@ namespace rwe
         graphics->setUniformMatrix(shader.mvpMatrix, camera.getViewProjectionMatrix());
         graphics->setUniformFloat(shader.alpha, 1.0f);
 
-        for (const auto& item : pathInfo.closedVertices)
+        for (const auto& edge : pathInfo.closedEdges)
         {
-            if (!item.second.predecessor)
-            {
-                continue;
-            }
-
-            auto start = (*item.second.predecessor)->vertex;
-            auto end = item.second.vertex;
-            drawTerrainArrow(terrain, start, end, Color(255, 0, 0));
+            drawTerrainArrow(terrain, edge.first, edge.second, Color(255, 0, 0));
         }
 
         if (pathInfo.path.size() > 1)
@@ -367,16 +338,39 @@ namespace rwe
         drawMapTerrain(terrain, x1, y1, (x2 + 1) - x1, (y2 + 1) - y1);
     }
 
-    void RenderService::drawUnitShadow(const Unit& unit, float groundHeight)
+    void RenderService::drawUnitShadow(const RenderSnapshot& snapshot, const UnitRenderState& unit, float groundHeight, float interpolationAlpha)
     {
         auto shadowProjection = Matrix4f::translation(Vector3f(0.0f, groundHeight, 0.0f))
             * Matrix4f::scale(Vector3f(1.0f, 0.0f, 1.0f))
             * Matrix4f::shearXZ(0.25f, -0.25f)
             * Matrix4f::translation(Vector3f(0.0f, -groundHeight, 0.0f));
 
-        auto matrix = Matrix4f::translation(unit.position) * Matrix4f::rotationY(unit.rotation);
+        auto matrix = unit.getInterpolatedTransform(interpolationAlpha);
 
-        drawUnitMesh(unit.mesh, shadowProjection * matrix, 0.0f);
+        drawUnitPieces(snapshot, unit, shadowProjection * matrix, 0.0f);
+    }
+
+    void RenderService::drawUnitShadows(const MapTerrain& terrain, const RenderSnapshot& snapshot, float interpolationAlpha)
+    {
+        graphics->enableStencilBuffer();
+        graphics->clearStencilBuffer();
+        graphics->useStencilBufferForWrites();
+        graphics->disableColorBuffer();
+
+        for (const auto& unit : snapshot.units)
+        {
+            auto position = unit.getInterpolatedPosition(interpolationAlpha);
+            auto groundHeight = terrain.getHeightAt(position.x, position.z);
+            drawUnitShadow(snapshot, unit, groundHeight, interpolationAlpha);
+        }
+
+        graphics->useStencilBufferAsMask();
+        graphics->enableColorBuffer();
+
+        fillScreen(0.0f, 0.0f, 0.0f, 0.5f);
+
+        graphics->enableColorBuffer();
+        graphics->disableStencilBuffer();
     }
 
     CabinetCamera& RenderService::getCamera()
@@ -414,25 +408,21 @@ namespace rwe
         graphics->drawTriangles(mesh);
     }
 
-    void RenderService::drawLasers(const std::vector<std::optional<LaserProjectile>>& lasers)
+    void RenderService::drawLasers(const std::vector<LaserRenderState>& lasers, float interpolationAlpha)
     {
         Vector3f pixelOffset(0.0f, 0.0f, -1.0f);
 
         std::vector<GlColoredVertex> vertices;
         for (const auto& laser : lasers)
         {
-            if (!laser)
-            {
-                continue;
-            }
-
-            auto backPosition = laser->getBackPosition();
+            auto position = laser.getInterpolatedPosition(interpolationAlpha);
+            auto backPosition = laser.backPosition - (laser.position - position);
 
-            vertices.emplace_back(laser->position, laser->color);
-            vertices.emplace_back(backPosition, laser->color);
+            vertices.emplace_back(position, laser.color);
+            vertices.emplace_back(backPosition, laser.color);
 
-            vertices.emplace_back(laser->position + pixelOffset, laser->color2);
-            vertices.emplace_back(backPosition + pixelOffset, laser->color2);
+            vertices.emplace_back(position + pixelOffset, laser.color2);
+            vertices.emplace_back(backPosition + pixelOffset, laser.color2);
         }
 
         auto mesh = graphics->createColoredMesh(vertices, GL_STREAM_DRAW);
@@ -445,25 +435,14 @@ namespace rwe
         graphics->drawLines(mesh);
     }
 
-    void RenderService::drawExplosions(GameTime currentTime, const std::vector<std::optional<Explosion>>& explosions)
+    void RenderService::drawExplosions(const std::vector<ExplosionRenderState>& explosions)
     {
         graphics->bindShader(shaders->basicTexture.handle.get());
 
         for (const auto& exp : explosions)
         {
-            if (!exp)
-            {
-                continue;
-            }
-
-            if (!exp->isStarted(currentTime) || exp->isFinished(currentTime))
-            {
-                continue;
-            }
-
-            const auto& position = exp->position;
-            auto frameIndex = exp->getFrameIndex(currentTime);
-            const auto& sprite = *exp->animation->sprites[frameIndex];
+            const auto& position = exp.position;
+            const auto& sprite = *exp.sprite;
 
             float alpha = 1.0f;
 
@@ -6,7 +6,9 @@
 #include <rwe/GameTime.h>
 #include <rwe/GraphicsContext.h>
 #include <rwe/LaserProjectile.h>
+#include <rwe/ObjectPool.h>
 #include <rwe/OccupiedGrid.h>
+#include <rwe/RenderSnapshot.h>
 #include <rwe/ShaderService.h>
 #include <rwe/Unit.h>
 #include <rwe/pathfinding/AStarPathFinder.h>
@@ -49,10 +51,15 @@ namespace rwe
         CabinetCamera& getCamera();
         const CabinetCamera& getCamera() const;
 
-        void drawUnit(const Unit& unit, float seaLevel);
-        void drawUnitShadow(const Unit& unit, float groundHeight);
-        void drawUnitMesh(const UnitMesh& mesh, const Matrix4f& modelMatrix, float seaLevel);
-        void drawSelectionRect(const Unit& unit);
+        /**
+         * Functions that take an interpolation alpha draw objects
+         * part way between their state at the end of the previous tick (0)
+         * and at the end of the current tick (1).
+         */
+        void drawUnit(const RenderSnapshot& snapshot, const UnitRenderState& unit, float seaLevel, float interpolationAlpha);
+        void drawUnitShadow(const RenderSnapshot& snapshot, const UnitRenderState& unit, float groundHeight, float interpolationAlpha);
+        void drawUnitPieces(const RenderSnapshot& snapshot, const UnitRenderState& unit, const Matrix4f& modelMatrix, float seaLevel);
+        void drawSelectionRect(const UnitRenderState& unit, float interpolationAlpha);
         void drawOccupiedGrid(const MapTerrain& terrain, const OccupiedGrid& occupiedGrid);
         void drawMovementClassCollisionGrid(const MapTerrain& terrain, const Grid<char>& movementClassGrid);
         void drawPathfindingVisualisation(const MapTerrain& terrain, const AStarPathInfo<Point, PathCost>& pathInfo);
@@ -85,34 +92,13 @@ namespace rwe
 
         void drawMapTerrain(const MapTerrain& terrain, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
 
-        template <typename Range>
-        void drawUnitShadows(const MapTerrain& terrain, const Range& units)
-        {
-            graphics->enableStencilBuffer();
-            graphics->clearStencilBuffer();
-            graphics->useStencilBufferForWrites();
-            graphics->disableColorBuffer();
-
-            for (const Unit& unit : units)
-            {
-                auto groundHeight = terrain.getHeightAt(unit.position.x, unit.position.z);
-                drawUnitShadow(unit, groundHeight);
-            }
-
-            graphics->useStencilBufferAsMask();
-            graphics->enableColorBuffer();
-
-            fillScreen(0.0f, 0.0f, 0.0f, 0.5f);
-
-            graphics->enableColorBuffer();
-            graphics->disableStencilBuffer();
-        }
+        void drawUnitShadows(const MapTerrain& terrain, const RenderSnapshot& snapshot, float interpolationAlpha);
 
         void fillScreen(float r, float g, float b, float a);
 
-        void drawLasers(const std::vector<std::optional<LaserProjectile>>& lasers);
+        void drawLasers(const std::vector<LaserRenderState>& lasers, float interpolationAlpha);
 
-        void drawExplosions(GameTime currentTime, const std::vector<std::optional<Explosion>>& explosions);
+        void drawExplosions(const std::vector<ExplosionRenderState>& explosions);
 
     private:
         GlMesh createTemporaryLinesMesh(const std::vector<Line3f>& lines);
@@ -0,0 +1,172 @@
+#include "RenderSnapshot.h"
+#include <limits>
+#include <rwe/math/rwe_math.h>
+#include <rwe/util.h>
+
+namespace rwe
+{
+    bool UnitRenderState::isOwnedBy(PlayerId player) const
+    {
+        return owner == player;
+    }
+
+    Vector3f UnitRenderState::getInterpolatedPosition(float alpha) const
+    {
+        return previousPosition + ((position - previousPosition) * alpha);
+    }
+
+    float UnitRenderState::getInterpolatedRotation(float alpha) const
+    {
+        // turn the short way round
+        auto delta = wrap(-Pif, Pif, rotation - previousRotation);
+        return previousRotation + (delta * alpha);
+    }
+
+    Matrix4f UnitRenderState::getInterpolatedTransform(float alpha) const
+    {
+        return Matrix4f::translation(getInterpolatedPosition(alpha)) * Matrix4f::rotationY(getInterpolatedRotation(alpha));
+    }
+
+    std::optional<float> UnitRenderState::selectionIntersect(const Ray3f& ray) const
+    {
+        auto line = ray.toLine();
+        Line3f modelSpaceLine(line.start - position, line.end - position);
+        auto v = selectionMesh->collisionMesh.intersectLine(modelSpaceLine);
+        if (!v)
+        {
+            return std::nullopt;
+        }
+
+        return ray.origin.distance(*v);
+    }
+
+    Vector3f LaserRenderState::getInterpolatedPosition(float alpha) const
+    {
+        return previousPosition + ((position - previousPosition) * alpha);
+    }
+
+    const UnitRenderState* RenderSnapshot::findUnit(UnitId id) const
+    {
+        auto it = unitIndices.find(id);
+        if (it == unitIndices.end())
+        {
+            return nullptr;
+        }
+
+        return &units[it->second];
+    }
+
+    std::optional<UnitId> RenderSnapshot::getFirstCollidingUnit(const MapTerrain& terrain, const Ray3f& ray) const
+    {
+        auto bestDistance = std::numeric_limits<float>::infinity();
+        std::optional<UnitId> it;
+
+        if (!unitSpatialIndex)
+        {
+            return it;
+        }
+
+        auto origin = terrain.worldToHeightmapSpace(ray.origin);
+        auto direction = terrain.worldToHeightmapSpace(ray.origin + ray.direction) - origin;
+        auto candidates = unitSpatialIndex->queryRay(Vector2f(origin.x, origin.z), Vector2f(direction.x, direction.z));
+
+        for (auto unitId : candidates)
+        {
+            const auto* unit = findUnit(unitId);
+            if (unit == nullptr)
+            {
+                continue;
+            }
+
+            auto distance = unit->selectionIntersect(ray);
+            if (distance && distance < bestDistance)
+            {
+                bestDistance = *distance;
+                it = unitId;
+            }
+        }
+
+        return it;
+    }
+
+    void capturePieces(const UnitMesh& mesh, const Matrix4f& parentTransform, std::vector<UnitPieceRenderState>& pieces)
+    {
+        auto transform = parentTransform * mesh.getTransform();
+
+        if (mesh.visible)
+        {
+            pieces.push_back(UnitPieceRenderState{mesh.mesh.get(), transform, mesh.shaded});
+        }
+
+        for (const auto& c : mesh.children)
+        {
+            capturePieces(c, transform, pieces);
+        }
+    }
+
+    void captureRenderSnapshot(const GameSimulation& simulation, RenderSnapshot& snapshot)
+    {
+        snapshot.gameTime = simulation.gameTime;
+
+        snapshot.units.clear();
+        snapshot.unitIndices.clear();
+        snapshot.pieces.clear();
+        for (std::size_t i = 0; i < simulation.units.size(); ++i)
+        {
+            const auto& unit = simulation.units.valueAt(i);
+
+            auto firstPiece = snapshot.pieces.size();
+            capturePieces(unit.mesh, Matrix4f::identity(), snapshot.pieces);
+
+            UnitRenderState state;
+            state.id = simulation.units.idAt(i);
+            state.owner = unit.owner;
+            state.position = unit.position;
+            state.rotation = unit.rotation;
+            state.previousPosition = unit.previousPosition;
+            state.previousRotation = unit.previousRotation;
+            state.healthFraction = static_cast<float>(unit.hitPoints) / static_cast<float>(unit.maxHitPoints);
+            state.canAttack = unit.canAttack;
+            state.selectionMesh = unit.selectionMesh.get();
+            state.selectionSound = unit.selectionSound;
+            state.okSound = unit.okSound;
+            state.firstPiece = firstPiece;
+            state.pieceCount = snapshot.pieces.size() - firstPiece;
+            snapshot.unitIndices.emplace(state.id, snapshot.units.size());
+            snapshot.units.push_back(std::move(state));
+        }
+
+        // Assigning over the previous copy reuses its buckets' storage.
+        if (snapshot.unitSpatialIndex)
+        {
+            *snapshot.unitSpatialIndex = simulation.unitSpatialIndex;
+        }
+        else
+        {
+            snapshot.unitSpatialIndex.emplace(simulation.unitSpatialIndex);
+        }
+
+        snapshot.lasers.clear();
+        for (const auto& laser : simulation.lasers)
+        {
+            snapshot.lasers.push_back(LaserRenderState{
+                laser.position,
+                laser.previousPosition,
+                laser.getBackPosition(),
+                laser.color,
+                laser.color2});
+        }
+
+        snapshot.explosions.clear();
+        for (const auto& exp : simulation.explosions)
+        {
+            if (!exp.isStarted(simulation.gameTime) || exp.isFinished(simulation.gameTime))
+            {
+                continue;
+            }
+
+            auto frameIndex = exp.getFrameIndex(simulation.gameTime);
+            snapshot.explosions.push_back(ExplosionRenderState{exp.position, exp.animation->sprites[frameIndex].get()});
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef RWE_RENDERSNAPSHOT_H
+#define RWE_RENDERSNAPSHOT_H
+
+#include <optional>
+#include <rwe/AudioService.h>
+#include <rwe/GameSimulation.h>
+#include <rwe/GameTime.h>
+#include <rwe/MapTerrain.h>
+#include <rwe/PlayerId.h>
+#include <rwe/SelectionMesh.h>
+#include <rwe/ShaderMesh.h>
+#include <rwe/Sprite.h>
+#include <rwe/Unit.h>
+#include <rwe/UnitId.h>
+#include <rwe/UnitSpatialIndex.h>
+#include <rwe/geometry/Ray3f.h>
+#include <rwe/math/Matrix4f.h>
+#include <rwe/math/Vector3f.h>
+#include <unordered_map>
+#include <vector>
+
+namespace rwe
+{
+    /** A visible piece of a unit's mesh. */
+    struct UnitPieceRenderState
+    {
+        /** Owned by the unit, which outlives every snapshot it appears in. */
+        const ShaderMesh* mesh;
+
+        /** Transforms the piece into the unit's space. */
+        Matrix4f transform;
+
+        bool shaded;
+    };
+
+    struct UnitRenderState
+    {
+        UnitId id;
+        PlayerId owner;
+
+        Vector3f position;
+        float rotation;
+
+        /** The position and rotation at the end of the previous tick. */
+        Vector3f previousPosition;
+        float previousRotation;
+
+        float healthFraction;
+
+        bool canAttack;
+
+        /** Owned by the unit, which outlives every snapshot it appears in. */
+        const SelectionMesh* selectionMesh;
+
+        std::optional<AudioService::SoundHandle> selectionSound;
+        std::optional<AudioService::SoundHandle> okSound;
+
+        /** The unit's pieces are RenderSnapshot::pieces[firstPiece] onwards. */
+        std::size_t firstPiece;
+        std::size_t pieceCount;
+
+        bool isOwnedBy(PlayerId player) const;
+
+        /**
+         * Returns the unit's position part way through the current tick.
+         * An alpha of 0 is the end of the previous tick and 1 is the end of this one.
+         */
+        Vector3f getInterpolatedPosition(float alpha) const;
+
+        /** Returns the unit's rotation part way through the current tick. */
+        float getInterpolatedRotation(float alpha) const;
+
+        /** Returns the unit's transform part way through the current tick. */
+        Matrix4f getInterpolatedTransform(float alpha) const;
+
+        /** Like Unit::selectionIntersect. */
+        std::optional<float> selectionIntersect(const Ray3f& ray) const;
+    };
+
+    struct LaserRenderState
+    {
+        Vector3f position;
+        Vector3f previousPosition;
+        Vector3f backPosition;
+        Vector3f color;
+        Vector3f color2;
+
+        /** Returns the projectile's front position part way through the current tick. */
+        Vector3f getInterpolatedPosition(float alpha) const;
+    };
+
+    struct ExplosionRenderState
+    {
+        Vector3f position;
+
+        /** Owned by a sprite series, which the texture service keeps for the rest of the game. */
+        const Sprite* sprite;
+    };
+
+    /**
+     * Everything needed to draw the simulation as it was at the end of a tick.
+     * The simulation thread publishes one of these after every tick,
+     * so that drawing never reads state that is being updated.
+     */
+    struct RenderSnapshot
+    {
+        GameTime gameTime{0};
+
+        std::vector<UnitRenderState> units;
+        std::vector<UnitPieceRenderState> pieces;
+        std::vector<LaserRenderState> lasers;
+        std::vector<ExplosionRenderState> explosions;
+
+        /** The index in units of each unit. */
+        std::unordered_map<UnitId, std::size_t> unitIndices;
+
+        /** A copy of the simulation's index, for picking units without scanning them all. */
+        std::optional<UnitSpatialIndex> unitSpatialIndex;
+
+        /**
+         * Units removed from the simulation since the previous snapshot.
+         * Their meshes hold graphics resources,
+         * so they are destroyed on the render thread once no snapshot refers to them.
+         */
+        std::vector<Unit> deadUnits;
+
+        const UnitRenderState* findUnit(UnitId id) const;
+
+        /**
+         * Returns the unit whose selection mesh the ray hits first.
+         * Only units near the ray's path across the map are tested.
+         */
+        std::optional<UnitId> getFirstCollidingUnit(const MapTerrain& terrain, const Ray3f& ray) const;
+    };
+
+    /**
+     * Replaces the contents of the snapshot, other than its dead units,
+     * with the current state of the simulation.
+     * Reuses the snapshot's storage.
+     */
+    void captureRenderSnapshot(const GameSimulation& simulation, RenderSnapshot& snapshot);
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "SceneManager.h"
+#include <algorithm>
+#include <cstdint>
 
 namespace rwe
 {
@@ -27,7 +29,11 @@ namespace rwe
 
     void SceneManager::execute()
     {
-        auto currentSimulationTime = sdl->getTicks();
+        // Update times are computed from the number of updates run
+        // rather than accumulated, so that intervals that are not
+        // a whole number of milliseconds do not drift.
+        auto startTime = sdl->getTicks();
+        std::uint64_t ticksRun = 0;
 
         while (!requestedExit)
         {
@@ -95,21 +101,37 @@ namespace rwe
                 }
             }
 
-            while (currentSimulationTime < currentRealTime)
+            // elapsed real time in thousandths of a tick
+            auto elapsed = static_cast<std::uint64_t>(currentRealTime - startTime) * TickRate;
+            auto ticksDue = elapsed / 1000;
+
+            unsigned int ticksThisFrame = 0;
+            while (ticksRun < ticksDue && ticksThisFrame < MaxTicksPerFrame)
             {
                 currentScene->update();
-                currentSimulationTime += TickInterval;
+                ++ticksRun;
+                ++ticksThisFrame;
             }
 
+            if (ticksRun < ticksDue)
+            {
+                ticksRun = ticksDue;
+            }
+
+            auto interpolationAlpha = static_cast<float>(elapsed % 1000) / 1000.0f;
+
             graphics->clear();
-            currentScene->render(*graphics);
+            currentScene->render(*graphics, interpolationAlpha);
             sdl->glSwapWindow(window);
 
+            // Sleep until the next update is due,
+            // waking early to draw the frames in between.
+            auto nextTickTime = startTime + static_cast<Uint32>(((ticksRun + 1) * 1000 + TickRate - 1) / TickRate);
+            auto nextFrameTime = std::min(nextTickTime, currentRealTime + FrameInterval);
             auto finishTime = sdl->getTicks();
-            auto nextSimTime = currentSimulationTime + TickInterval;
-            if (finishTime < nextSimTime)
+            if (finishTime < nextFrameTime)
             {
-                sdl->delay(nextSimTime - finishTime);
+                sdl->delay(nextFrameTime - finishTime);
             }
         }
     }
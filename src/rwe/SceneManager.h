@@ -2,6 +2,7 @@
 #define RWE_SCENEMANAGER_H
 
 #include <memory>
+#include <rwe/GameTime.h>
 #include <rwe/GraphicsContext.h>
 #include <rwe/SdlContextManager.h>
 #include <rwe/events.h>
@@ -20,7 +21,13 @@ namespace rwe
 
             virtual void init() {}
 
-            virtual void render(GraphicsContext& /*graphics*/) {}
+            /**
+             * Draws the scene.
+             * The interpolation alpha says how far real time has progressed
+             * between the previous update and the next one,
+             * from 0 to 1, so that moving objects can be drawn in between.
+             */
+            virtual void render(GraphicsContext& /*graphics*/, float /*interpolationAlpha*/) {}
 
             virtual void onKeyDown(const SDL_Keysym& /*key*/) {}
 
@@ -46,8 +53,19 @@ namespace rwe
         bool requestedExit;
 
     public:
-        // Number of milliseconds between each game tick.
-        static const unsigned int TickInterval = 1000 / 60;
+        /** Number of scene updates per second. */
+        static const unsigned int TickRate = SimTicksPerSecond;
+
+        /**
+         * The most updates run in a single frame to catch up with real time.
+         * If the scene falls further behind than this,
+         * the rest is dropped and the game runs slower than real time
+         * rather than spending ever longer catching up.
+         */
+        static const unsigned int MaxTicksPerFrame = 4;
+
+        /** Minimum number of milliseconds between rendered frames. */
+        static const unsigned int FrameInterval = 1000 / 60;
 
         explicit SceneManager(SdlContext* sdl, SDL_Window* window, GraphicsContext* graphics);
         void setNextScene(std::shared_ptr<Scene> scene);
@@ -0,0 +1,585 @@
+#include "SimulationRunner.h"
+#include <rwe/snapshot/SimulationSnapshot.h>
+#include <spdlog/spdlog.h>
+#include <unordered_set>
+
+namespace rwe
+{
+    static bool isLaserCollision(const GameSimulation& simulation, const LaserProjectile& laser, const OccupiedCell& cell)
+    {
+        if (cell.isUnit())
+        {
+            const auto& unit = simulation.getUnit(cell.unitId());
+
+            if (unit.isOwnedBy(laser.owner))
+            {
+                return false;
+            }
+
+            // ignore if the laser is above or below the unit
+            return laser.position.y >= unit.position.y && laser.position.y <= unit.position.y + unit.height;
+        }
+
+        if (cell.isFeature())
+        {
+            const auto& feature = simulation.getFeature(cell.featureId());
+
+            // ignore if the laser is above or below the feature
+            return laser.position.y >= feature.position.y && laser.position.y <= feature.position.y + feature.height;
+        }
+
+        return false;
+    }
+
+    SimulationRunner::SimulationRunner(
+        TextureService* textureService,
+        AudioService* audioService,
+        const ColorPalette* palette,
+        const ColorPalette* guiPalette,
+        GameSimulation&& simulation,
+        MovementClassCollisionService&& collisionService,
+        UnitDatabase&& unitDatabase,
+        MeshService&& meshService,
+        unsigned int workerThreadCount)
+        : audioService(audioService),
+          simulation(std::move(simulation)),
+          collisionService(std::move(collisionService)),
+          unitFactory(textureService, std::move(unitDatabase), std::move(meshService), &this->collisionService, palette, guiPalette),
+          pathFindingService(&this->simulation, &this->collisionService, workerThreadCount),
+          unitBehaviorService(this, &pathFindingService, &this->collisionService),
+          cobExecutionService(),
+          threadPool(workerThreadCount)
+    {
+        if (textureService != nullptr)
+        {
+            lightSmokeAnimation = textureService->getGafEntry("anims/FX.GAF", "smoke 1");
+        }
+    }
+
+    void SimulationRunner::update()
+    {
+        simulation.gameTime = nextGameTime(simulation.gameTime);
+
+        deadUnits.clear();
+
+        // remember where units were, so they can be drawn in between ticks
+        for (auto& unit : simulation.units)
+        {
+            unit.previousPosition = unit.position;
+            unit.previousRotation = unit.rotation;
+        }
+
+        float secondsElapsed = SimTickDurationSeconds;
+
+        // hand out the paths searched for since the last tick
+        pathFindingService.finishSearches();
+
+        auto unitCount = simulation.units.size();
+
+        // find where targeted units are aimed at before their scripts can run concurrently
+        unitBehaviorService.updateSweetSpots();
+
+        // decide what each unit wants to do, in parallel
+        unitEffects.resize(unitCount);
+        threadPool.parallelFor(unitCount, [this](std::size_t i) {
+            unitBehaviorService.update(simulation.units.idAt(i), unitEffects[i]);
+        });
+
+        // commit shared changes in unit order
+        applyUnitEffects();
+
+        // steer all units at once
+        simulation.unitKinematics.update();
+
+        // move units, in order, since movement claims occupied cells
+        for (std::size_t i = 0; i < unitCount; ++i)
+        {
+            unitBehaviorService.updateMovement(simulation.units.idAt(i));
+        }
+
+        // animate pieces and run unit scripts, in parallel
+        auto scriptStart = std::chrono::steady_clock::now();
+        threadPool.parallelFor(unitCount, [this, secondsElapsed](std::size_t i) {
+            simulation.units.valueAt(i).mesh.update(secondsElapsed);
+            cobExecutionService.run(simulation, simulation.units.idAt(i));
+        });
+        tickMetrics.scriptTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - scriptStart);
+
+        updateLasers();
+
+        updateExplosions();
+
+        simulation.deleteDeadUnits(deadUnits);
+
+        // search for paths in the background until the next tick
+        pathFindingService.startSearches();
+
+        auto hashStart = std::chrono::steady_clock::now();
+        auto stateHash = simulation.computeStateHash();
+        tickMetrics.stateHashTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hashStart);
+        stateHashes.record(simulation.gameTime, stateHash);
+    }
+
+    std::vector<Unit> SimulationRunner::takeDeadUnits()
+    {
+        return std::move(deadUnits);
+    }
+
+    void SimulationRunner::saveSnapshot(std::ostream& stream) const
+    {
+        writeSimulationSnapshot(stream, simulation);
+    }
+
+    void SimulationRunner::loadSnapshot(std::istream& stream)
+    {
+        readSimulationSnapshot(stream, simulation, unitFactory);
+        pathFindingService.restartSearches();
+        stateHashes.clear();
+        firstDivergence = std::nullopt;
+    }
+
+    class ApplyUnitEffectVisitor : public boost::static_visitor<>
+    {
+    private:
+        SimulationRunner* runner;
+
+    public:
+        explicit ApplyUnitEffectVisitor(SimulationRunner* runner) : runner(runner) {}
+
+        void operator()(const RequestPathEffect& e) const
+        {
+            runner->getSimulation().requestPath(e.unitId, e.priority);
+        }
+
+        void operator()(const SpawnLaserEffect& e) const
+        {
+            runner->getSimulation().spawnLaser(LaserProjectile(e.laser));
+        }
+
+        void operator()(const SpawnLightSmokeEffect& e) const
+        {
+            runner->createLightSmoke(e.position);
+        }
+
+        void operator()(const PlayUnitSoundEffect& e) const
+        {
+            runner->playUnitSound(e.unitId, e.sound);
+        }
+
+        void operator()(const PlaySelectChannelSoundEffect& e) const
+        {
+            runner->playSoundOnSelectChannel(e.sound);
+        }
+    };
+
+    void SimulationRunner::applyUnitEffects()
+    {
+        ApplyUnitEffectVisitor visitor(this);
+        for (auto& buffer : unitEffects)
+        {
+            for (const auto& effect : buffer.effects)
+            {
+                boost::apply_visitor(visitor, effect);
+            }
+            buffer.clear();
+        }
+    }
+
+    std::optional<UnitId> SimulationRunner::spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position)
+    {
+        auto unit = unitFactory.createUnit(unitType, owner, simulation.getPlayer(owner).color, position);
+
+        // TODO: if we failed to add the unit throw some warning
+        return simulation.tryAddUnit(std::move(unit), unitFactory.getMovementAttributes(unitType));
+    }
+
+    const MapTerrain& SimulationRunner::getTerrain() const
+    {
+        return simulation.terrain;
+    }
+
+    GameTime SimulationRunner::getGameTime() const
+    {
+        return simulation.gameTime;
+    }
+
+    const StateHashLog& SimulationRunner::getStateHashLog() const
+    {
+        return stateHashes;
+    }
+
+    bool SimulationRunner::verifyStateHash(GameTime time, std::uint64_t hash)
+    {
+        auto ourHash = stateHashes.find(time);
+        if (!ourHash)
+        {
+            throw std::runtime_error("No state hash recorded for tick " + std::to_string(time.value));
+        }
+
+        if (*ourHash == hash)
+        {
+            return true;
+        }
+
+        if (!firstDivergence || time < *firstDivergence)
+        {
+            firstDivergence = time;
+            spdlog::get("rwe")->error("Simulation diverged at tick {0}: local state hash {1:016x}, reference {2:016x}", time.value, *ourHash, hash);
+        }
+
+        return false;
+    }
+
+    std::optional<GameTime> SimulationRunner::getFirstDivergence() const
+    {
+        return firstDivergence;
+    }
+
+    bool SimulationRunner::isCollisionAt(const DiscreteRect& rect, UnitId self) const
+    {
+        return simulation.isCollisionAt(rect, self);
+    }
+
+    void SimulationRunner::playSoundOnSelectChannel(const AudioService::SoundHandle& sound)
+    {
+        if (audioService == nullptr)
+        {
+            return;
+        }
+
+        audioService->playSoundIfFree(sound, UnitSelectChannel);
+    }
+
+    void SimulationRunner::playUnitSound(UnitId /*unitId*/, const AudioService::SoundHandle& sound)
+    {
+        if (audioService == nullptr)
+        {
+            return;
+        }
+
+        // FIXME: should play on a unit-specific channel group
+        audioService->playSound(sound);
+    }
+
+    void SimulationRunner::playSoundAt(const Vector3f& /*position*/, const AudioService::SoundHandle& sound)
+    {
+        if (audioService == nullptr)
+        {
+            return;
+        }
+
+        // FIXME: should play on a position-aware channel
+        audioService->playSound(sound);
+    }
+
+    DiscreteRect SimulationRunner::computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const
+    {
+        return simulation.computeFootprintRegion(position, footprintX, footprintZ);
+    }
+
+    void SimulationRunner::moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId)
+    {
+        simulation.moveUnitOccupiedArea(oldRect, newRect, unitId);
+    }
+
+    GameSimulation& SimulationRunner::getSimulation()
+    {
+        return simulation;
+    }
+
+    const GameSimulation& SimulationRunner::getSimulation() const
+    {
+        return simulation;
+    }
+
+    const MovementClassCollisionService& SimulationRunner::getCollisionService() const
+    {
+        return collisionService;
+    }
+
+    const PathFindingService& SimulationRunner::getPathFindingService() const
+    {
+        return pathFindingService;
+    }
+
+    const TickMetrics& SimulationRunner::getTickMetrics() const
+    {
+        return tickMetrics;
+    }
+
+    Unit& SimulationRunner::getUnit(UnitId id)
+    {
+        return simulation.getUnit(id);
+    }
+
+    const Unit& SimulationRunner::getUnit(UnitId id) const
+    {
+        return simulation.getUnit(id);
+    }
+
+    void SimulationRunner::issueMoveOrder(UnitId unitId, Vector3f position)
+    {
+        auto& unit = getUnit(unitId);
+        unit.clearOrders();
+        unit.addOrder(createMoveOrder(position));
+    }
+
+    void SimulationRunner::enqueueMoveOrder(UnitId unitId, Vector3f position)
+    {
+        getUnit(unitId).addOrder(createMoveOrder(position));
+    }
+
+    void SimulationRunner::issueAttackOrder(UnitId unitId, UnitId target)
+    {
+        auto& unit = getUnit(unitId);
+        unit.clearOrders();
+        unit.addOrder(createAttackOrder(target));
+    }
+
+    void SimulationRunner::enqueueAttackOrder(UnitId unitId, UnitId target)
+    {
+        getUnit(unitId).addOrder(createAttackOrder(target));
+    }
+
+    void SimulationRunner::issueAttackGroundOrder(UnitId unitId, Vector3f position)
+    {
+        auto& unit = getUnit(unitId);
+        unit.clearOrders();
+        unit.addOrder(createAttackGroundOrder(position));
+    }
+
+    void SimulationRunner::enqueueAttackGroundOrder(UnitId unitId, Vector3f position)
+    {
+        getUnit(unitId).addOrder(createAttackGroundOrder(position));
+    }
+
+    void SimulationRunner::stopUnit(UnitId unitId)
+    {
+        getUnit(unitId).clearOrders();
+    }
+
+    void SimulationRunner::updateLasers()
+    {
+        auto gameTime = getGameTime();
+        simulation.lasers.removeIf([this, gameTime](LaserProjectile& laser) {
+            laser.previousPosition = laser.position;
+            laser.position += laser.velocity;
+
+            // emit smoke trail
+            if (laser.smokeTrail)
+            {
+                if (gameTime > laser.lastSmoke + *laser.smokeTrail)
+                {
+                    createLightSmoke(laser.position);
+                    laser.lastSmoke = gameTime;
+                }
+            }
+
+            // test collision with terrain
+            auto terrainHeight = simulation.terrain.getHeightAt(laser.position.x, laser.position.z);
+            auto seaLevel = simulation.terrain.getSeaLevel();
+
+            // test collision with sea
+            // FIXME: waterweapons should be allowed in water
+            if (seaLevel > terrainHeight && laser.position.y <= seaLevel)
+            {
+                doLaserImpact(laser, ImpactType::Water);
+                return true;
+            }
+
+            if (laser.position.y <= terrainHeight)
+            {
+                doLaserImpact(laser, ImpactType::Normal);
+                return true;
+            }
+
+            // detect collision with something's footprint
+            auto heightMapPos = simulation.terrain.worldToHeightmapCoordinate(laser.position);
+            auto cellValue = simulation.occupiedGrid.grid.tryGet(heightMapPos);
+            if (cellValue)
+            {
+                if (isLaserCollision(simulation, laser, cellValue->get()))
+                {
+                    doLaserImpact(laser, ImpactType::Normal);
+                    return true;
+                }
+            }
+
+            // TODO: detect collision between a laser and the world boundary
+
+            return false;
+        });
+    }
+
+    void SimulationRunner::updateExplosions()
+    {
+        auto gameTime = simulation.gameTime;
+        simulation.explosions.removeIf([gameTime](Explosion& exp) {
+            if (exp.isFinished(gameTime))
+            {
+                return true;
+            }
+
+            if (exp.floats)
+            {
+                // TODO: drift with the wind
+                exp.position.y += 0.5f;
+            }
+
+            return false;
+        });
+    }
+
+    void SimulationRunner::doLaserImpact(const LaserProjectile& laser, ImpactType impactType)
+    {
+        switch (impactType)
+        {
+            case ImpactType::Normal:
+            {
+                if (laser.soundHit)
+                {
+                    playSoundAt(laser.position, *laser.soundHit);
+                }
+                if (laser.explosion)
+                {
+                    simulation.spawnExplosion(laser.position, *laser.explosion);
+                }
+                if (laser.endSmoke)
+                {
+                    createLightSmoke(laser.position);
+                }
+                break;
+            }
+            case ImpactType::Water:
+            {
+                if (laser.soundWater)
+                {
+                    playSoundAt(laser.position, *laser.soundWater);
+                }
+                if (laser.waterExplosion)
+                {
+                    simulation.spawnExplosion(laser.position, *laser.waterExplosion);
+                }
+                break;
+            }
+        }
+
+        applyDamageInRadius(laser.position, laser.damageRadius, laser);
+    }
+
+    void SimulationRunner::applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser)
+    {
+        auto minX = position.x - radius;
+        auto maxX = position.x + radius;
+        auto minZ = position.z - radius;
+        auto maxZ = position.z + radius;
+
+        auto minPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(minX, position.y, minZ));
+        auto maxPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(maxX, position.y, maxZ));
+        auto minCell = simulation.terrain.getHeightMap().clampToCoords(minPoint);
+        auto maxCell = simulation.terrain.getHeightMap().clampToCoords(maxPoint);
+
+        assert(minCell.x <= maxCell.x);
+        assert(minCell.y <= maxCell.y);
+
+        auto radiusSquared = radius * radius;
+
+        std::unordered_set<UnitId> seenUnits;
+
+        // for each cell
+        for (std::size_t y = minCell.y; y <= maxCell.y; ++y)
+        {
+            for (std::size_t x = minCell.x; x <= maxCell.x; ++x)
+            {
+                // check if it's in range
+                auto cellCenter = simulation.terrain.heightmapIndexToWorldCenter(x, y);
+                Rectangle2f cellRectangle(
+                    Vector2f(cellCenter.x, cellCenter.z),
+                    Vector2f(MapTerrain::HeightTileWidthInWorldUnits / 2.0f, MapTerrain::HeightTileHeightInWorldUnits / 2.0f));
+                auto cellDistanceSquared = cellRectangle.distanceSquared(Vector2f(position.x, position.z));
+                if (cellDistanceSquared > radiusSquared)
+                {
+                    continue;
+                }
+
+                // check if a unit (or feature) is there
+                const auto& cell = simulation.occupiedGrid.grid.get(x, y);
+                if (!cell.isUnit())
+                {
+                    continue;
+                }
+
+                // check if the unit was seen/mark as seen
+                auto unitId = cell.unitId();
+                auto pair = seenUnits.insert(unitId);
+                if (!pair.second) // the unit was already present
+                {
+                    continue;
+                }
+
+                const auto& unit = simulation.getUnit(unitId);
+
+                // skip dead units
+                if (unit.isDead())
+                {
+                    continue;
+                }
+
+                // add in the third dimension component to distance,
+                // check if we are still in range
+                auto unitDistanceSquared = createBoundingBox(unit).distanceSquared(position);
+                if (unitDistanceSquared > radiusSquared)
+                {
+                    continue;
+                }
+
+                // apply appropriate damage
+                auto damageScale = std::clamp(1.0f - (std::sqrt(unitDistanceSquared) / radius), 0.0f, 1.0f);
+                auto rawDamage = laser.getDamage(unit.unitType);
+                auto scaledDamage = static_cast<unsigned int>(static_cast<float>(rawDamage) * damageScale);
+                applyDamage(unitId, scaledDamage);
+            }
+        }
+    }
+
+    void SimulationRunner::applyDamage(UnitId unitId, unsigned int damagePoints)
+    {
+        auto& unit = simulation.getUnit(unitId);
+        if (unit.hitPoints <= damagePoints)
+        {
+            unit.markAsDead();
+
+            // TODO: spawn debris particles, corpse
+            if (unit.explosionWeapon)
+            {
+                auto impactType = unit.position.y < simulation.terrain.getSeaLevel() ? ImpactType::Water : ImpactType::Normal;
+                auto projectile = simulation.createProjectileFromWeapon(unit.owner, *unit.explosionWeapon, unit.position, Vector3f(0.0f, -1.0f, 0.0f));
+                doLaserImpact(projectile, impactType);
+            }
+        }
+        else
+        {
+            unit.hitPoints -= damagePoints;
+        }
+    }
+
+    void SimulationRunner::createLightSmoke(const Vector3f& position)
+    {
+        if (!lightSmokeAnimation)
+        {
+            return;
+        }
+
+        simulation.spawnSmoke(position, *lightSmokeAnimation);
+    }
+
+    BoundingBox3f SimulationRunner::createBoundingBox(const Unit& unit) const
+    {
+        auto footprint = simulation.computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+        auto min = Vector3f(footprint.x, unit.position.y, footprint.y);
+        auto max = Vector3f(footprint.x + footprint.width, unit.position.y + unit.height, footprint.y + footprint.height);
+        auto worldMin = simulation.terrain.heightmapToWorldSpace(min);
+        auto worldMax = simulation.terrain.heightmapToWorldSpace(max);
+        return BoundingBox3f::fromMinMax(worldMin, worldMax);
+    }
+}
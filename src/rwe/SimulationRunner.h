@@ -0,0 +1,213 @@
+#ifndef RWE_SIMULATIONRUNNER_H
+#define RWE_SIMULATIONRUNNER_H
+
+#include <chrono>
+#include <rwe/AudioService.h>
+#include <rwe/DiscreteRect.h>
+#include <rwe/GameSimulation.h>
+#include <rwe/MeshService.h>
+#include <rwe/MovementClassCollisionService.h>
+#include <rwe/PlayerId.h>
+#include <rwe/StateHashLog.h>
+#include <rwe/TextureService.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/Unit.h>
+#include <rwe/UnitBehaviorService.h>
+#include <rwe/UnitDatabase.h>
+#include <rwe/UnitEffectBuffer.h>
+#include <rwe/UnitFactory.h>
+#include <rwe/UnitId.h>
+#include <rwe/cob/CobExecutionService.h>
+#include <rwe/pathfinding/PathFindingService.h>
+
+namespace rwe
+{
+    enum class ImpactType
+    {
+        Normal,
+        Water
+    };
+
+    /**
+     * How long parts of the last tick took, for profiling.
+     * Unlike the simulation itself, these depend on the machine.
+     */
+    struct TickMetrics
+    {
+        /** The parallel phase that animates pieces and runs unit scripts, as seen by the calling thread. */
+        std::chrono::microseconds scriptTime{0};
+
+        /** Computing the state hash recorded at the end of the tick. */
+        std::chrono::microseconds stateHashTime{0};
+    };
+
+    /**
+     * Owns the game simulation and the services that advance it.
+     * Contains no rendering or input handling, so it can be driven
+     * either by GameScene or by a headless tool.
+     *
+     * The texture and audio services are optional.
+     * When they are null, smoke is not spawned and sounds are not played,
+     * but the simulation otherwise behaves identically.
+     *
+     * Per-unit work that touches only the unit's own state
+     * (behaviour, piece animation and scripts) is spread across a thread pool.
+     * Everything that touches shared state (occupancy, projectiles, sounds,
+     * path requests) is applied on the calling thread in unit order,
+     * so the outcome does not depend on the number of threads.
+     */
+    class SimulationRunner
+    {
+    public:
+        static const unsigned int UnitSelectChannel = 0;
+
+    private:
+        AudioService* audioService;
+
+        GameSimulation simulation;
+
+        MovementClassCollisionService collisionService;
+
+        UnitFactory unitFactory;
+
+        PathFindingService pathFindingService;
+        UnitBehaviorService unitBehaviorService;
+        CobExecutionService cobExecutionService;
+
+        ThreadPool threadPool;
+
+        /** Effects recorded by each unit during the parallel behaviour phase, by dense unit index. */
+        std::vector<UnitEffectBuffer> unitEffects;
+
+        /** The simulation state hash at the end of every tick so far. */
+        StateHashLog stateHashes;
+
+        TickMetrics tickMetrics;
+
+        /** The first tick at which a hash from elsewhere did not match ours. */
+        std::optional<GameTime> firstDivergence;
+
+        /**
+         * Units removed in the last tick.
+         * They are kept until the next tick begins
+         * so that they can be handed to another thread to destroy.
+         */
+        std::vector<Unit> deadUnits;
+
+        /**
+         * Loaded up front because loading textures must happen
+         * on the thread that owns the graphics context.
+         */
+        std::optional<std::shared_ptr<SpriteSeries>> lightSmokeAnimation;
+
+    public:
+        SimulationRunner(
+            TextureService* textureService,
+            AudioService* audioService,
+            const ColorPalette* palette,
+            const ColorPalette* guiPalette,
+            GameSimulation&& simulation,
+            MovementClassCollisionService&& collisionService,
+            UnitDatabase&& unitDatabase,
+            MeshService&& meshService,
+            unsigned int workerThreadCount);
+
+        SimulationRunner(const SimulationRunner&) = delete;
+        SimulationRunner& operator=(const SimulationRunner&) = delete;
+
+        /** Advances the simulation by one tick. */
+        void update();
+
+        /** Takes ownership of the units removed in the last tick. */
+        std::vector<Unit> takeDeadUnits();
+
+        /** Writes the state of the simulation to the stream. See writeSimulationSnapshot. */
+        void saveSnapshot(std::ostream& stream) const;
+
+        /**
+         * Replaces the state of the simulation with a snapshot
+         * taken from a game on the same map with the same players.
+         * Recorded state hashes are discarded.
+         */
+        void loadSnapshot(std::istream& stream);
+
+        std::optional<UnitId> spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position);
+
+        const MapTerrain& getTerrain() const;
+
+        GameTime getGameTime() const;
+
+        const StateHashLog& getStateHashLog() const;
+
+        /**
+         * Checks a state hash computed elsewhere, such as by another player
+         * or in a previous run of the same game, against our own for that tick.
+         * The tick must already have been simulated here.
+         * The first mismatch is logged and remembered.
+         * Returns true if the hashes match.
+         */
+        bool verifyStateHash(GameTime time, std::uint64_t hash);
+
+        /** Returns the first tick at which verifyStateHash found a mismatch. */
+        std::optional<GameTime> getFirstDivergence() const;
+
+        bool isCollisionAt(const DiscreteRect& rect, UnitId self) const;
+
+        void playSoundOnSelectChannel(const AudioService::SoundHandle& sound);
+
+        void playUnitSound(UnitId unitId, const AudioService::SoundHandle& sound);
+
+        void playSoundAt(const Vector3f& position, const AudioService::SoundHandle& sound);
+
+        DiscreteRect computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const;
+
+        void moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId);
+
+        GameSimulation& getSimulation();
+
+        const GameSimulation& getSimulation() const;
+
+        const MovementClassCollisionService& getCollisionService() const;
+
+        const PathFindingService& getPathFindingService() const;
+
+        const TickMetrics& getTickMetrics() const;
+
+        Unit& getUnit(UnitId id);
+
+        const Unit& getUnit(UnitId id) const;
+
+        void doLaserImpact(const LaserProjectile& laser, ImpactType impactType);
+
+        void createLightSmoke(const Vector3f& position);
+
+        void issueMoveOrder(UnitId unitId, Vector3f position);
+
+        void enqueueMoveOrder(UnitId unitId, Vector3f position);
+
+        void issueAttackOrder(UnitId unitId, UnitId target);
+
+        void enqueueAttackOrder(UnitId unitId, UnitId target);
+
+        void issueAttackGroundOrder(UnitId unitId, Vector3f position);
+
+        void enqueueAttackGroundOrder(UnitId unitId, Vector3f position);
+
+        void stopUnit(UnitId unitId);
+
+    private:
+        void applyUnitEffects();
+
+        void updateLasers();
+
+        void updateExplosions();
+
+        void applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser);
+
+        void applyDamage(UnitId unitId, unsigned int damagePoints);
+
+        BoundingBox3f createBoundingBox(const Unit& unit) const;
+    };
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "SimulationThread.h"
+#include <cassert>
+#include <iterator>
+#include <rwe/GameTime.h>
+#include <rwe/replay/ReplayPlayer.h>
+#include <utility>
+
+namespace rwe
+{
+    SimulationThread::SimulationThread(SimulationRunner* runner, ReplayRecorder* recorder)
+        : runner(runner), recorder(recorder)
+    {
+    }
+
+    SimulationThread::~SimulationThread()
+    {
+        if (isRunning())
+        {
+            stop();
+        }
+    }
+
+    void SimulationThread::start()
+    {
+        assert(!isRunning());
+
+        frontFrame = std::make_unique<RenderSnapshot>();
+        captureRenderSnapshot(runner->getSimulation(), *frontFrame);
+        startTime = frontFrame->gameTime;
+        ticksRequested = 0;
+
+        backFrame = std::make_unique<RenderSnapshot>();
+
+        pendingTicks = 0;
+        stopRequested = false;
+        thread = std::thread(&SimulationThread::run, this);
+    }
+
+    void SimulationThread::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            stopRequested = true;
+        }
+        wakeCondition.notify_one();
+
+        thread.join();
+    }
+
+    bool SimulationThread::isRunning() const
+    {
+        return thread.joinable();
+    }
+
+    void SimulationThread::submitCommand(const ReplayCommand& command)
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pendingCommands.push_back(command);
+    }
+
+    void SimulationThread::requestTick()
+    {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            ++pendingTicks;
+        }
+        wakeCondition.notify_one();
+
+        ++ticksRequested;
+    }
+
+    unsigned int SimulationThread::getTicksBehind() const
+    {
+        auto ticksDone = frontFrame->gameTime.value - startTime.value;
+        return ticksRequested - ticksDone;
+    }
+
+    const RenderSnapshot& SimulationThread::acquireSnapshot()
+    {
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            if (readyFrame)
+            {
+                freeFrame = std::move(frontFrame);
+                frontFrame = std::move(readyFrame);
+            }
+        }
+
+        // The previous front snapshot was the last one that could refer to these.
+        frontFrame->deadUnits.clear();
+
+        return *frontFrame;
+    }
+
+    std::unique_lock<std::mutex> SimulationThread::lockSimulation()
+    {
+        return std::unique_lock<std::mutex>(simulationMutex);
+    }
+
+    void SimulationThread::run()
+    {
+        try
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(commandMutex);
+                    wakeCondition.wait(lock, [this]() { return stopRequested || pendingTicks > 0; });
+                    if (stopRequested)
+                    {
+                        return;
+                    }
+                    --pendingTicks;
+                }
+
+                tick();
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            error = std::current_exception();
+        }
+    }
+
+    void SimulationThread::tick()
+    {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            std::swap(pendingCommands, commandsToApply);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(simulationMutex);
+
+            for (const auto& command : commandsToApply)
+            {
+                if (!canApplyReplayCommand(*runner, command))
+                {
+                    continue;
+                }
+
+                if (recorder != nullptr)
+                {
+                    recorder->record(runner->getGameTime(), command);
+                }
+
+                applyReplayCommand(*runner, command);
+            }
+            commandsToApply.clear();
+
+            runner->update();
+
+            captureRenderSnapshot(runner->getSimulation(), *backFrame);
+        }
+
+        auto deadUnits = runner->takeDeadUnits();
+        auto& snapshotDeadUnits = backFrame->deadUnits;
+        snapshotDeadUnits.insert(
+            snapshotDeadUnits.end(),
+            std::make_move_iterator(deadUnits.begin()),
+            std::make_move_iterator(deadUnits.end()));
+
+        publish();
+    }
+
+    void SimulationThread::publish()
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+
+        if (readyFrame)
+        {
+            // The render thread never picked up the previous snapshot,
+            // so pass its dead units on to be destroyed there.
+            auto& staleDeadUnits = readyFrame->deadUnits;
+            auto& snapshotDeadUnits = backFrame->deadUnits;
+            snapshotDeadUnits.insert(
+                snapshotDeadUnits.end(),
+                std::make_move_iterator(staleDeadUnits.begin()),
+                std::make_move_iterator(staleDeadUnits.end()));
+            staleDeadUnits.clear();
+
+            std::swap(readyFrame, backFrame);
+            return;
+        }
+
+        readyFrame = std::move(backFrame);
+        if (freeFrame)
+        {
+            backFrame = std::move(freeFrame);
+        }
+        else
+        {
+            backFrame = std::make_unique<RenderSnapshot>();
+        }
+    }
+}
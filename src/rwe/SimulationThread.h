@@ -0,0 +1,125 @@
+#ifndef RWE_SIMULATIONTHREAD_H
+#define RWE_SIMULATIONTHREAD_H
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <rwe/RenderSnapshot.h>
+#include <rwe/SimulationRunner.h>
+#include <rwe/replay/Replay.h>
+#include <rwe/replay/ReplayRecorder.h>
+#include <thread>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Runs a simulation on a dedicated thread,
+     * so ticks do not hold up drawing frames.
+     * The thread keeps no clock of its own:
+     * it runs a tick each time one is requested,
+     * so the scene manager alone decides when ticks are due.
+     *
+     * Player commands are queued and applied at the start of the next tick.
+     * After each tick a RenderSnapshot is published for the render thread.
+     * Snapshots are triple buffered, so neither thread waits for the other:
+     * the simulation always has a snapshot to write into,
+     * and the render thread always has the newest complete one to read.
+     *
+     * While the thread is running, the runner must only be touched
+     * from other threads while holding the lock from lockSimulation.
+     */
+    class SimulationThread
+    {
+    private:
+        SimulationRunner* runner;
+
+        /** If not null, every command applied is recorded here. */
+        ReplayRecorder* recorder;
+
+        /** Held by the simulation thread for the duration of each tick. */
+        std::mutex simulationMutex;
+
+        /** Guards pendingCommands, pendingTicks and stopRequested. */
+        std::mutex commandMutex;
+        std::condition_variable wakeCondition;
+        std::vector<ReplayCommand> pendingCommands;
+        unsigned int pendingTicks{0};
+        bool stopRequested{false};
+
+        /** Guards the snapshots exchanged between the two threads and the error. */
+        std::mutex frameMutex;
+        std::unique_ptr<RenderSnapshot> readyFrame;
+        std::unique_ptr<RenderSnapshot> freeFrame;
+        std::exception_ptr error;
+
+        /** Owned by the simulation thread. */
+        std::unique_ptr<RenderSnapshot> backFrame;
+        std::vector<ReplayCommand> commandsToApply;
+
+        /** Owned by the render thread. */
+        std::unique_ptr<RenderSnapshot> frontFrame;
+
+        /** The game time when the thread was started. Owned by the render thread. */
+        GameTime startTime{0};
+
+        /** The number of ticks requested since the thread was started. Owned by the render thread. */
+        unsigned int ticksRequested{0};
+
+        std::thread thread;
+
+    public:
+        SimulationThread(SimulationRunner* runner, ReplayRecorder* recorder);
+
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        /** Stops the thread if it is running. */
+        ~SimulationThread();
+
+        /** Starts the thread. The current state becomes the first snapshot. */
+        void start();
+
+        /** Finishes the current tick and stops the thread. Ticks not yet started are dropped. */
+        void stop();
+
+        bool isRunning() const;
+
+        /** Queues a command to be applied at the start of the next tick. */
+        void submitCommand(const ReplayCommand& command);
+
+        /**
+         * Asks for one more tick to be run.
+         * Ticks are run in order as soon as the thread is free.
+         * Must only be called from the thread that acquires snapshots.
+         */
+        void requestTick();
+
+        /**
+         * Returns how many requested ticks the last acquired snapshot does not include yet.
+         * Must only be called from the thread that acquires snapshots.
+         */
+        unsigned int getTicksBehind() const;
+
+        /**
+         * Returns the newest snapshot published by the simulation.
+         * The snapshot stays valid until the next call.
+         * Must only be called from one thread.
+         * If the simulation thread failed, rethrows its exception.
+         */
+        const RenderSnapshot& acquireSnapshot();
+
+        /** Pauses the simulation until the returned lock is released. */
+        std::unique_lock<std::mutex> lockSimulation();
+
+    private:
+        void run();
+
+        void tick();
+
+        void publish();
+    };
+}
+
+#endif
@@ -0,0 +1,377 @@
+#ifndef RWE_SLOTMAP_H
+#define RWE_SLOTMAP_H
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Associative container that hands out its own IDs.
+     * Values are stored densely in insertion order (modulo removals)
+     * so that iterating them walks contiguous memory.
+     * IDs are made of a slot index and a generation counter.
+     * When a slot is reused its generation is bumped,
+     * so IDs of removed values are never mistaken for new ones.
+     * A slot whose generation has reached its maximum is retired
+     * instead of being reused, so generations never wrap around.
+     *
+     * Removal moves the last value into the hole left by the removed one,
+     * so pointers and references to values are invalidated
+     * by any insertion or removal.
+     *
+     * Id must be an OpaqueId over an unsigned integer type
+     * at least 32 bits wide.
+     */
+    template <typename T, typename Id>
+    class SlotMap
+    {
+    public:
+        static constexpr unsigned int IndexBits = 16;
+        static constexpr unsigned int GenerationBits = 14;
+        static constexpr std::uint32_t MaxSize = std::uint32_t(1) << IndexBits;
+
+    private:
+        static constexpr std::uint32_t IndexMask = MaxSize - 1;
+        static constexpr std::uint32_t GenerationMask = (std::uint32_t(1) << GenerationBits) - 1;
+
+        struct Slot
+        {
+            std::uint32_t generation;
+            std::uint32_t denseIndex;
+            bool occupied;
+        };
+
+        std::vector<T> values;
+        std::vector<std::uint32_t> denseToSlot;
+        std::vector<Slot> slots;
+        std::vector<std::uint32_t> freeSlots;
+
+    public:
+        using iterator = typename std::vector<T>::iterator;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        /** Returns the ID that the next call to insert will return. */
+        Id nextId() const
+        {
+            if (!freeSlots.empty())
+            {
+                auto slotIndex = freeSlots.back();
+                return makeId(slotIndex, slots[slotIndex].generation);
+            }
+
+            return makeId(static_cast<std::uint32_t>(slots.size()), 0);
+        }
+
+        Id insert(T&& value)
+        {
+            std::uint32_t slotIndex;
+            if (!freeSlots.empty())
+            {
+                slotIndex = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+            {
+                if (slots.size() >= MaxSize)
+                {
+                    throw std::length_error("SlotMap is full");
+                }
+
+                slotIndex = static_cast<std::uint32_t>(slots.size());
+                slots.push_back(Slot{0, 0, false});
+            }
+
+            auto& slot = slots[slotIndex];
+            slot.denseIndex = static_cast<std::uint32_t>(values.size());
+            slot.occupied = true;
+
+            values.push_back(std::move(value));
+            denseToSlot.push_back(slotIndex);
+
+            return makeId(slotIndex, slot.generation);
+        }
+
+        bool contains(Id id) const
+        {
+            auto slotIndex = getSlotIndex(id);
+            if (slotIndex >= slots.size())
+            {
+                return false;
+            }
+
+            const auto& slot = slots[slotIndex];
+            return slot.occupied && slot.generation == getGeneration(id);
+        }
+
+        T& get(Id id)
+        {
+            assert(contains(id));
+            return values[slots[getSlotIndex(id)].denseIndex];
+        }
+
+        const T& get(Id id) const
+        {
+            assert(contains(id));
+            return values[slots[getSlotIndex(id)].denseIndex];
+        }
+
+        T* tryGet(Id id)
+        {
+            return contains(id) ? &values[slots[getSlotIndex(id)].denseIndex] : nullptr;
+        }
+
+        const T* tryGet(Id id) const
+        {
+            return contains(id) ? &values[slots[getSlotIndex(id)].denseIndex] : nullptr;
+        }
+
+        /** Returns true if the value was present and has been removed. */
+        bool remove(Id id)
+        {
+            if (!contains(id))
+            {
+                return false;
+            }
+
+            removeDense(slots[getSlotIndex(id)].denseIndex);
+            return true;
+        }
+
+        /**
+         * Removes every value for which the predicate,
+         * called as predicate(id, value), returns true.
+         */
+        template <typename Predicate>
+        void removeIf(Predicate predicate)
+        {
+            std::size_t i = 0;
+            while (i < values.size())
+            {
+                if (predicate(idAt(i), values[i]))
+                {
+                    // the last value is moved into this position,
+                    // so test the same index again.
+                    removeDense(static_cast<std::uint32_t>(i));
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        /**
+         * Removes the value at the given position in iteration order.
+         * The last value is moved into its place.
+         */
+        void removeAt(std::size_t denseIndex)
+        {
+            assert(denseIndex < values.size());
+            removeDense(static_cast<std::uint32_t>(denseIndex));
+        }
+
+        /** Returns the position in iteration order of the value with the given ID. */
+        std::optional<std::size_t> indexOf(Id id) const
+        {
+            if (!contains(id))
+            {
+                return std::nullopt;
+            }
+
+            return slots[getSlotIndex(id)].denseIndex;
+        }
+
+        /** Returns the ID of the value at the given position in iteration order. */
+        Id idAt(std::size_t denseIndex) const
+        {
+            assert(denseIndex < denseToSlot.size());
+            auto slotIndex = denseToSlot[denseIndex];
+            return makeId(slotIndex, slots[slotIndex].generation);
+        }
+
+        /** Returns the value at the given position in iteration order. */
+        T& valueAt(std::size_t denseIndex)
+        {
+            return values[denseIndex];
+        }
+
+        const T& valueAt(std::size_t denseIndex) const
+        {
+            return values[denseIndex];
+        }
+
+        std::size_t size() const
+        {
+            return values.size();
+        }
+
+        bool empty() const
+        {
+            return values.empty();
+        }
+
+        void clear()
+        {
+            for (auto slotIndex : denseToSlot)
+            {
+                releaseSlot(slotIndex);
+            }
+
+            values.clear();
+            denseToSlot.clear();
+        }
+
+        /** Returns the current generation of every slot, for saving the map's state. */
+        std::vector<std::uint32_t> getSlotGenerations() const
+        {
+            std::vector<std::uint32_t> generations;
+            generations.reserve(slots.size());
+            for (const auto& slot : slots)
+            {
+                generations.push_back(slot.generation);
+            }
+            return generations;
+        }
+
+        /** Returns the free slots, in the order they will be reused (last first). */
+        const std::vector<std::uint32_t>& getFreeSlots() const
+        {
+            return freeSlots;
+        }
+
+        /**
+         * Replaces the contents of the map with previously saved state,
+         * so that existing IDs, iteration order and future IDs
+         * all match the map the state was taken from.
+         * ids[i] is the ID of values[i].
+         * Throws if the state is inconsistent.
+         */
+        void restore(
+            const std::vector<std::uint32_t>& slotGenerations,
+            const std::vector<std::uint32_t>& newFreeSlots,
+            const std::vector<Id>& ids,
+            std::vector<T>&& newValues)
+        {
+            if (ids.size() != newValues.size()
+                || slotGenerations.size() > MaxSize
+                || ids.size() + newFreeSlots.size() > slotGenerations.size())
+            {
+                throw std::runtime_error("Inconsistent SlotMap state");
+            }
+
+            std::vector<Slot> newSlots;
+            newSlots.reserve(slotGenerations.size());
+            for (auto generation : slotGenerations)
+            {
+                if (generation > GenerationMask)
+                {
+                    throw std::runtime_error("Inconsistent SlotMap state");
+                }
+                newSlots.push_back(Slot{generation, 0, false});
+            }
+
+            std::vector<std::uint32_t> newDenseToSlot;
+            newDenseToSlot.reserve(ids.size());
+            for (std::size_t i = 0; i < ids.size(); ++i)
+            {
+                auto slotIndex = getSlotIndex(ids[i]);
+                if (slotIndex >= newSlots.size()
+                    || newSlots[slotIndex].occupied
+                    || newSlots[slotIndex].generation != getGeneration(ids[i]))
+                {
+                    throw std::runtime_error("Inconsistent SlotMap state");
+                }
+
+                newSlots[slotIndex].occupied = true;
+                newSlots[slotIndex].denseIndex = static_cast<std::uint32_t>(i);
+                newDenseToSlot.push_back(slotIndex);
+            }
+
+            // Every slot is now either occupied or must appear once in the free list,
+            // unless it has been retired.
+            std::vector<bool> seenFree(newSlots.size(), false);
+            for (auto slotIndex : newFreeSlots)
+            {
+                if (slotIndex >= newSlots.size() || newSlots[slotIndex].occupied || seenFree[slotIndex])
+                {
+                    throw std::runtime_error("Inconsistent SlotMap state");
+                }
+                seenFree[slotIndex] = true;
+            }
+            for (std::size_t i = 0; i < newSlots.size(); ++i)
+            {
+                if (!newSlots[i].occupied && !seenFree[i] && newSlots[i].generation != GenerationMask)
+                {
+                    throw std::runtime_error("Inconsistent SlotMap state");
+                }
+            }
+
+            values = std::move(newValues);
+            denseToSlot = std::move(newDenseToSlot);
+            slots = std::move(newSlots);
+            freeSlots = newFreeSlots;
+        }
+
+        iterator begin() { return values.begin(); }
+        iterator end() { return values.end(); }
+        const_iterator begin() const { return values.begin(); }
+        const_iterator end() const { return values.end(); }
+
+    private:
+        static Id makeId(std::uint32_t slotIndex, std::uint32_t generation)
+        {
+            return Id((generation << IndexBits) | slotIndex);
+        }
+
+        static std::uint32_t getSlotIndex(Id id)
+        {
+            return static_cast<std::uint32_t>(id.value) & IndexMask;
+        }
+
+        static std::uint32_t getGeneration(Id id)
+        {
+            return (static_cast<std::uint32_t>(id.value) >> IndexBits) & GenerationMask;
+        }
+
+        void releaseSlot(std::uint32_t slotIndex)
+        {
+            auto& slot = slots[slotIndex];
+            slot.occupied = false;
+
+            // Bumping the generation any further would wrap it around
+            // and bring back the IDs of the slot's first values,
+            // so retire the slot instead.
+            if (slot.generation == GenerationMask)
+            {
+                return;
+            }
+
+            slot.generation += 1;
+            freeSlots.push_back(slotIndex);
+        }
+
+        void removeDense(std::uint32_t denseIndex)
+        {
+            auto lastIndex = static_cast<std::uint32_t>(values.size() - 1);
+            auto removedSlot = denseToSlot[denseIndex];
+
+            if (denseIndex != lastIndex)
+            {
+                values[denseIndex] = std::move(values[lastIndex]);
+                auto movedSlot = denseToSlot[lastIndex];
+                denseToSlot[denseIndex] = movedSlot;
+                slots[movedSlot].denseIndex = denseIndex;
+            }
+
+            values.pop_back();
+            denseToSlot.pop_back();
+            releaseSlot(removedSlot);
+        }
+    };
+}
+
+#endif
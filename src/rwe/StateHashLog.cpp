@@ -0,0 +1,108 @@
+#include "StateHashLog.h"
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <stdexcept>
+
+namespace rwe
+{
+    bool StateHashLog::Entry::operator==(const Entry& rhs) const
+    {
+        return time == rhs.time && hash == rhs.hash;
+    }
+
+    bool StateHashLog::Entry::operator!=(const Entry& rhs) const
+    {
+        return !(rhs == *this);
+    }
+
+    void StateHashLog::record(GameTime time, std::uint64_t hash)
+    {
+        assert(entries.empty() || entries.back().time < time);
+        entries.push_back(Entry{time, hash});
+    }
+
+    std::optional<std::uint64_t> StateHashLog::find(GameTime time) const
+    {
+        auto it = std::lower_bound(entries.begin(), entries.end(), time, [](const Entry& e, GameTime t) { return e.time < t; });
+        if (it == entries.end() || it->time != time)
+        {
+            return std::nullopt;
+        }
+
+        return it->hash;
+    }
+
+    const std::vector<StateHashLog::Entry>& StateHashLog::getEntries() const
+    {
+        return entries;
+    }
+
+    void StateHashLog::clear()
+    {
+        entries.clear();
+    }
+
+    std::optional<GameTime> StateHashLog::findFirstDivergence(const StateHashLog& a, const StateHashLog& b)
+    {
+        auto itA = a.entries.begin();
+        auto itB = b.entries.begin();
+        while (itA != a.entries.end() && itB != b.entries.end())
+        {
+            if (itA->time < itB->time)
+            {
+                ++itA;
+            }
+            else if (itB->time < itA->time)
+            {
+                ++itB;
+            }
+            else
+            {
+                if (itA->hash != itB->hash)
+                {
+                    return itA->time;
+                }
+
+                ++itA;
+                ++itB;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void StateHashLog::write(std::ostream& stream) const
+    {
+        auto flags = stream.flags();
+        for (const auto& e : entries)
+        {
+            stream << std::dec << e.time.value << " " << std::hex << std::setw(16) << std::setfill('0') << e.hash << "\n";
+        }
+        stream.flags(flags);
+    }
+
+    StateHashLog StateHashLog::read(std::istream& stream)
+    {
+        StateHashLog log;
+
+        unsigned int time;
+        std::uint64_t hash;
+        while (stream >> std::dec >> time >> std::hex >> hash)
+        {
+            if (!log.entries.empty() && !(log.entries.back().time < GameTime(time)))
+            {
+                throw std::runtime_error("State hash log ticks are not in increasing order");
+            }
+
+            log.entries.push_back(Entry{GameTime(time), hash});
+        }
+
+        if (!stream.eof())
+        {
+            throw std::runtime_error("Malformed state hash log");
+        }
+
+        return log;
+    }
+}
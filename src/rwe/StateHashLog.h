@@ -0,0 +1,56 @@
+#ifndef RWE_STATEHASHLOG_H
+#define RWE_STATEHASHLOG_H
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <rwe/GameTime.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * The simulation state hash recorded at the end of each tick.
+     * Two runs of the same game should produce identical logs;
+     * comparing logs pinpoints the first tick at which they diverged.
+     */
+    class StateHashLog
+    {
+    public:
+        struct Entry
+        {
+            GameTime time;
+            std::uint64_t hash;
+
+            bool operator==(const Entry& rhs) const;
+            bool operator!=(const Entry& rhs) const;
+        };
+
+    private:
+        std::vector<Entry> entries;
+
+    public:
+        /** Records the hash for a tick. Ticks must be recorded in increasing order. */
+        void record(GameTime time, std::uint64_t hash);
+
+        std::optional<std::uint64_t> find(GameTime time) const;
+
+        const std::vector<Entry>& getEntries() const;
+
+        void clear();
+
+        /**
+         * Returns the earliest tick recorded in both logs
+         * for which the hashes differ.
+         */
+        static std::optional<GameTime> findFirstDivergence(const StateHashLog& a, const StateHashLog& b);
+
+        /** Writes the log as text, one "<tick> <hash>" line per entry. */
+        void write(std::ostream& stream) const;
+
+        static StateHashLog read(std::istream& stream);
+    };
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef RWE_STATEHASHER_H
+#define RWE_STATEHASHER_H
+
+#include <cstdint>
+#include <cstring>
+#include <rwe/math/Vector3f.h>
+
+namespace rwe
+{
+    /**
+     * The SplitMix64 finalizer.
+     * Cheap, and every input bit affects every output bit,
+     * so it serves both as a hash step and as a counter-based random source.
+     */
+    inline std::uint64_t splitMix64(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27u)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31u);
+    }
+
+    /**
+     * Accumulates a sequence of values into a 64-bit hash.
+     * The result depends on the order in which values are added.
+     * Floats are hashed by their bit pattern, so values that compare equal
+     * but differ in representation (such as 0.0 and -0.0) hash differently.
+     */
+    class StateHasher
+    {
+    private:
+        std::uint64_t state;
+
+    public:
+        explicit StateHasher(std::uint64_t seed = 0) : state(seed)
+        {
+        }
+
+        void add(std::uint64_t value)
+        {
+            state = splitMix64(state ^ value);
+        }
+
+        void addFloat(float value)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            add(bits);
+        }
+
+        void addVector(const Vector3f& v)
+        {
+            addFloat(v.x);
+            addFloat(v.y);
+            addFloat(v.z);
+        }
+
+        std::uint64_t get() const
+        {
+            return state;
+        }
+    };
+}
+
+#endif
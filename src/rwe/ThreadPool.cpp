@@ -0,0 +1,70 @@
+#include "ThreadPool.h"
+
+namespace rwe
+{
+    unsigned int ThreadPool::defaultWorkerCount()
+    {
+        auto cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    ThreadPool::ThreadPool(unsigned int workerCount)
+    {
+        workers.reserve(workerCount);
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    unsigned int ThreadPool::getWorkerCount() const
+    {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    void ThreadPool::enqueue(std::function<void()>&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        taskAvailable.notify_one();
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                {
+                    // stopping and nothing left to do
+                    return;
+                }
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+}
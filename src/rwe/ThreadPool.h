@@ -0,0 +1,153 @@
+#ifndef RWE_THREADPOOL_H
+#define RWE_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Fixed set of worker threads that run queued tasks.
+     * A pool with zero workers is valid and runs all work
+     * on the calling thread.
+     */
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable taskAvailable;
+        bool stopping{false};
+
+    public:
+        /** Returns the number of workers to use to keep every core busy, counting the caller. */
+        static unsigned int defaultWorkerCount();
+
+        explicit ThreadPool(unsigned int workerCount);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        /** Finishes all queued tasks, then stops the workers. */
+        ~ThreadPool();
+
+        unsigned int getWorkerCount() const;
+
+        /**
+         * Calls f(i) for every i in [0, count),
+         * spread across the workers and the calling thread,
+         * and returns once every call has finished.
+         * The order of calls is unspecified.
+         * If any call throws, one of the exceptions is rethrown here
+         * after all other calls have finished.
+         */
+        template <typename F>
+        void parallelFor(std::size_t count, F f, std::size_t grainSize = 16)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            grainSize = std::max<std::size_t>(grainSize, 1);
+            auto chunkCount = (count + grainSize - 1) / grainSize;
+            auto helperCount = std::min<std::size_t>(workers.size(), chunkCount - 1);
+
+            std::atomic<std::size_t> nextIndex{0};
+            std::mutex doneMutex;
+            std::condition_variable doneCondition;
+            std::size_t helpersRemaining = helperCount;
+            std::exception_ptr error;
+
+            auto work = [&]() {
+                try
+                {
+                    std::size_t begin;
+                    while ((begin = nextIndex.fetch_add(grainSize)) < count)
+                    {
+                        auto end = std::min(begin + grainSize, count);
+                        for (auto i = begin; i < end; ++i)
+                        {
+                            f(i);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            };
+
+            for (std::size_t i = 0; i < helperCount; ++i)
+            {
+                enqueue([&]() {
+                    work();
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (--helpersRemaining == 0)
+                    {
+                        doneCondition.notify_one();
+                    }
+                });
+            }
+
+            work();
+
+            {
+                std::unique_lock<std::mutex> lock(doneMutex);
+                doneCondition.wait(lock, [&]() { return helpersRemaining == 0; });
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        /**
+         * Queues f to run on a worker and returns a future for its result.
+         * With no workers, f runs on the calling thread before this returns.
+         * Exceptions thrown by f are rethrown from the future.
+         */
+        template <typename F>
+        auto submit(F f) -> std::future<decltype(f())>
+        {
+            auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::move(f));
+            auto future = task->get_future();
+
+            if (workers.empty())
+            {
+                (*task)();
+            }
+            else
+            {
+                enqueue([task]() { (*task)(); });
+            }
+
+            return future;
+        }
+
+    private:
+        void enqueue(std::function<void()>&& task);
+
+        void workerLoop();
+    };
+}
+
+#endif
@@ -35,128 +35,152 @@ namespace rwe
     }
 
     Unit::Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, SelectionMesh&& selectionMesh)
-        : mesh(mesh), cobEnvironment(std::move(cobEnvironment)), selectionMesh(std::move(selectionMesh))
+        : mesh(mesh), cobEnvironment(std::move(cobEnvironment)), selectionMesh(std::make_unique<SelectionMesh>(std::move(selectionMesh)))
     {
+        const auto& pieceNames = this->cobEnvironment->script()->pieces;
+        scriptPieces.reserve(pieceNames.size());
+        for (const auto& pieceName : pieceNames)
+        {
+            scriptPieces.push_back(this->mesh.findPath(pieceName));
+        }
+    }
+
+    std::optional<std::reference_wrapper<const UnitMesh>> Unit::findScriptPiece(unsigned int piece) const
+    {
+        const auto& path = scriptPieces.at(piece);
+        if (!path)
+        {
+            return std::nullopt;
+        }
+
+        return mesh.getPiece(*path);
     }
 
-    void Unit::moveObject(const std::string& pieceName, Axis axis, float targetPosition, float speed)
+    std::optional<std::reference_wrapper<UnitMesh>> Unit::findScriptPiece(unsigned int piece)
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
+        const auto& path = scriptPieces.at(piece);
+        if (!path)
         {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
+            return std::nullopt;
         }
 
+        return mesh.getPiece(*path);
+    }
+
+    const UnitMesh& Unit::getScriptPiece(unsigned int piece) const
+    {
+        auto pieceMesh = findScriptPiece(piece);
+        if (!pieceMesh)
+        {
+            throw std::runtime_error("Invalid piece name: " + cobEnvironment->script()->pieces[piece]);
+        }
+
+        return *pieceMesh;
+    }
+
+    UnitMesh& Unit::getScriptPiece(unsigned int piece)
+    {
+        return const_cast<UnitMesh&>(static_cast<const Unit&>(*this).getScriptPiece(piece));
+    }
+
+    void Unit::moveObject(unsigned int piece, Axis axis, float targetPosition, float speed)
+    {
+        auto& pieceMesh = getScriptPiece(piece);
+
         UnitMesh::MoveOperation op(targetPosition, speed);
 
         switch (axis)
         {
             case Axis::X:
-                piece->get().xMoveOperation = op;
+                pieceMesh.xMoveOperation = op;
                 break;
             case Axis::Y:
-                piece->get().yMoveOperation = op;
+                pieceMesh.yMoveOperation = op;
                 break;
             case Axis::Z:
-                piece->get().zMoveOperation = op;
+                pieceMesh.zMoveOperation = op;
                 break;
         }
     }
 
-    void Unit::moveObjectNow(const std::string& pieceName, Axis axis, float targetPosition)
+    void Unit::moveObjectNow(unsigned int piece, Axis axis, float targetPosition)
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
-        }
+        auto& pieceMesh = getScriptPiece(piece);
 
         switch (axis)
         {
             case Axis::X:
-                piece->get().offset.x = targetPosition;
-                piece->get().xMoveOperation = std::nullopt;
+                pieceMesh.offset.x = targetPosition;
+                pieceMesh.xMoveOperation = std::nullopt;
                 break;
             case Axis::Y:
-                piece->get().offset.y = targetPosition;
-                piece->get().yMoveOperation = std::nullopt;
+                pieceMesh.offset.y = targetPosition;
+                pieceMesh.yMoveOperation = std::nullopt;
                 break;
             case Axis::Z:
-                piece->get().offset.z = targetPosition;
-                piece->get().zMoveOperation = std::nullopt;
+                pieceMesh.offset.z = targetPosition;
+                pieceMesh.zMoveOperation = std::nullopt;
                 break;
         }
     }
 
-    void Unit::turnObject(const std::string& pieceName, Axis axis, RadiansAngle targetAngle, float speed)
+    void Unit::turnObject(unsigned int piece, Axis axis, RadiansAngle targetAngle, float speed)
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
-        }
+        auto& pieceMesh = getScriptPiece(piece);
 
         UnitMesh::TurnOperation op(targetAngle, toRadians(speed));
 
         switch (axis)
         {
             case Axis::X:
-                piece->get().xTurnOperation = op;
+                pieceMesh.xTurnOperation = op;
                 break;
             case Axis::Y:
-                piece->get().yTurnOperation = op;
+                pieceMesh.yTurnOperation = op;
                 break;
             case Axis::Z:
-                piece->get().zTurnOperation = op;
+                pieceMesh.zTurnOperation = op;
                 break;
         }
     }
 
-    void Unit::turnObjectNow(const std::string& pieceName, Axis axis, RadiansAngle targetAngle)
+    void Unit::turnObjectNow(unsigned int piece, Axis axis, RadiansAngle targetAngle)
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
-        }
+        auto& pieceMesh = getScriptPiece(piece);
 
         switch (axis)
         {
             case Axis::X:
-                piece->get().rotation.x = targetAngle.value;
-                piece->get().xTurnOperation = std::nullopt;
+                pieceMesh.rotation.x = targetAngle.value;
+                pieceMesh.xTurnOperation = std::nullopt;
                 break;
             case Axis::Y:
-                piece->get().rotation.y = targetAngle.value;
-                piece->get().yTurnOperation = std::nullopt;
+                pieceMesh.rotation.y = targetAngle.value;
+                pieceMesh.yTurnOperation = std::nullopt;
                 break;
             case Axis::Z:
-                piece->get().rotation.z = targetAngle.value;
-                piece->get().zTurnOperation = std::nullopt;
+                pieceMesh.rotation.z = targetAngle.value;
+                pieceMesh.zTurnOperation = std::nullopt;
                 break;
         }
     }
 
-    void Unit::spinObject(const std::string& pieceName, Axis axis, float speed, float acceleration)
+    void Unit::spinObject(unsigned int piece, Axis axis, float speed, float acceleration)
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
-        }
+        auto& pieceMesh = getScriptPiece(piece);
 
         UnitMesh::SpinOperation op(acceleration == 0.0f ? toRadians(speed) : 0.0f, toRadians(speed), toRadians(acceleration));
 
         switch (axis)
         {
             case Axis::X:
-                piece->get().xTurnOperation = op;
+                pieceMesh.xTurnOperation = op;
                 break;
             case Axis::Y:
-                piece->get().yTurnOperation = op;
+                pieceMesh.yTurnOperation = op;
                 break;
             case Axis::Z:
-                piece->get().zTurnOperation = op;
+                pieceMesh.zTurnOperation = op;
                 break;
         }
     }
@@ -182,66 +206,53 @@ namespace rwe
         existingOp = UnitMesh::StopSpinOperation(spinOp->currentSpeed, toRadians(deceleration));
     }
 
-    void Unit::stopSpinObject(const std::string& pieceName, Axis axis, float deceleration)
+    void Unit::stopSpinObject(unsigned int piece, Axis axis, float deceleration)
     {
-
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name: " + pieceName);
-        }
+        auto& pieceMesh = getScriptPiece(piece);
 
         switch (axis)
         {
             case Axis::X:
-                setStopSpinOp(piece->get().xTurnOperation, deceleration);
+                setStopSpinOp(pieceMesh.xTurnOperation, deceleration);
                 break;
             case Axis::Y:
-                setStopSpinOp(piece->get().yTurnOperation, deceleration);
+                setStopSpinOp(pieceMesh.yTurnOperation, deceleration);
                 break;
             case Axis::Z:
-                setStopSpinOp(piece->get().zTurnOperation, deceleration);
+                setStopSpinOp(pieceMesh.zTurnOperation, deceleration);
                 break;
         }
     }
 
-    bool Unit::isMoveInProgress(const std::string& pieceName, Axis axis) const
+    bool Unit::isMoveInProgress(unsigned int piece, Axis axis) const
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name " + pieceName);
-        }
+        const auto& pieceMesh = getScriptPiece(piece);
 
         switch (axis)
         {
             case Axis::X:
-                return !!(piece->get().xMoveOperation);
+                return !!(pieceMesh.xMoveOperation);
             case Axis::Y:
-                return !!(piece->get().yMoveOperation);
+                return !!(pieceMesh.yMoveOperation);
             case Axis::Z:
-                return !!(piece->get().zMoveOperation);
+                return !!(pieceMesh.zMoveOperation);
         }
 
         throw std::logic_error("Invalid axis");
     }
 
-    bool Unit::isTurnInProgress(const std::string& pieceName, Axis axis) const
+    bool Unit::isTurnInProgress(unsigned int piece, Axis axis) const
     {
-        auto piece = mesh.find(pieceName);
-        if (!piece)
-        {
-            throw std::runtime_error("Invalid piece name " + pieceName);
-        }
+        const auto& pieceMesh = getScriptPiece(piece);
 
         switch (axis)
         {
             case Axis::X:
-                return !!(piece->get().xTurnOperation);
+                return !!(pieceMesh.xTurnOperation);
             case Axis::Y:
-                return !!(piece->get().yTurnOperation);
+                return !!(pieceMesh.yTurnOperation);
             case Axis::Z:
-                return !!(piece->get().zTurnOperation);
+                return !!(pieceMesh.zTurnOperation);
         }
 
         throw std::logic_error("Invalid axis");
@@ -251,7 +262,7 @@ namespace rwe
     {
         auto line = ray.toLine();
         Line3f modelSpaceLine(line.start - position, line.end - position);
-        auto v = selectionMesh.collisionMesh.intersectLine(modelSpaceLine);
+        auto v = selectionMesh->collisionMesh.intersectLine(modelSpaceLine);
         if (!v)
         {
             return std::nullopt;
@@ -73,7 +73,8 @@ namespace rwe
         UnitMesh mesh;
         Vector3f position;
         std::unique_ptr<CobEnvironment> cobEnvironment;
-        SelectionMesh selectionMesh;
+        /** Kept on the heap so that render snapshots can refer to it while the unit moves in memory. */
+        std::unique_ptr<SelectionMesh> selectionMesh;
         std::optional<AudioService::SoundHandle> selectionSound;
         std::optional<AudioService::SoundHandle> okSound;
         std::optional<AudioService::SoundHandle> arrivedSound;
@@ -88,40 +89,19 @@ namespace rwe
          * Anticlockwise rotation of the unit around the Y axis in radians.
          * The other two axes of rotation are normally determined
          * by the normal of the terrain the unit is standing on.
+         *
+         * Steering state, including the authoritative rotation,
+         * lives in GameSimulation::unitKinematics.
+         * This is a copy of it, published once per tick when the unit moves.
          */
         float rotation{0.0f};
 
-
-        /**
-         * Rate at which the unit turns in rads/tick.
-         */
-        float turnRate;
-
-        /**
-         * Rate at which the unit is travelling forwards in game units/tick.
-         */
-        float currentSpeed{0.0f};
-
-        /**
-         * Maximum speed the unit can travel forwards in game units/tick.
-         */
-        float maxSpeed;
-
-        /**
-         * Speed at which the unit accelerates in game units/tick.
-         */
-        float acceleration;
-
         /**
-         * Speed at which the unit brakes in game units/tick.
+         * The position and rotation of the unit at the end of the previous tick.
+         * Used to draw the unit in between ticks.
          */
-        float brakeRate;
-
-        /** The angle we are trying to steer towards. */
-        float targetAngle{0.0f};
-
-        /** The speed we are trying to accelerate/decelerate to */
-        float targetSpeed{0.0f};
+        Vector3f previousPosition;
+        float previousRotation{0.0f};
 
         std::optional<MovementClassId> movementClass;
 
@@ -144,6 +124,14 @@ namespace rwe
          */
         bool inCollision{false};
 
+        /**
+         * The path through the mesh to each piece named by the unit's script,
+         * indexed the same as the script's piece list.
+         * Resolved once when the unit is created so that script instructions
+         * do not have to search the mesh by name.
+         */
+        std::vector<std::optional<UnitMesh::PiecePath>> scriptPieces;
+
         std::array<std::optional<UnitWeapon>, 3> weapons;
 
         bool canAttack;
@@ -156,21 +144,25 @@ namespace rwe
 
         Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, SelectionMesh&& selectionMesh);
 
-        void moveObject(const std::string& pieceName, Axis axis, float targetPosition, float speed);
+        std::optional<std::reference_wrapper<const UnitMesh>> findScriptPiece(unsigned int piece) const;
+
+        std::optional<std::reference_wrapper<UnitMesh>> findScriptPiece(unsigned int piece);
+
+        void moveObject(unsigned int piece, Axis axis, float targetPosition, float speed);
 
-        void moveObjectNow(const std::string& pieceName, Axis axis, float targetPosition);
+        void moveObjectNow(unsigned int piece, Axis axis, float targetPosition);
 
-        void turnObject(const std::string& pieceName, Axis axis, RadiansAngle targetAngle, float speed);
+        void turnObject(unsigned int piece, Axis axis, RadiansAngle targetAngle, float speed);
 
-        void turnObjectNow(const std::string& pieceName, Axis axis, RadiansAngle targetAngle);
+        void turnObjectNow(unsigned int piece, Axis axis, RadiansAngle targetAngle);
 
-        void spinObject(const std::string& pieceName, Axis axis, float speed, float acceleration);
+        void spinObject(unsigned int piece, Axis axis, float speed, float acceleration);
 
-        void stopSpinObject(const std::string& pieceName, Axis axis, float deceleration);
+        void stopSpinObject(unsigned int piece, Axis axis, float deceleration);
 
-        bool isMoveInProgress(const std::string& pieceName, Axis axis) const;
+        bool isMoveInProgress(unsigned int piece, Axis axis) const;
 
-        bool isTurnInProgress(const std::string& pieceName, Axis axis) const;
+        bool isTurnInProgress(unsigned int piece, Axis axis) const;
 
         /**
          * Returns a value if the given ray intersects this unit
@@ -196,6 +188,11 @@ namespace rwe
         void clearWeaponTargets();
 
         Matrix4f getTransform() const;
+
+    private:
+        const UnitMesh& getScriptPiece(unsigned int piece) const;
+
+        UnitMesh& getScriptPiece(unsigned int piece);
     };
 }
 
@@ -1,5 +1,5 @@
 #include "UnitBehaviorService.h"
-#include <rwe/GameScene.h>
+#include <rwe/SimulationRunner.h>
 #include <rwe/cob/CobExecutionContext.h>
 #include <rwe/geometry/Circle2f.h>
 #include <rwe/math/rwe_math.h>
@@ -24,8 +24,8 @@ namespace rwe
         return anticlockwiseCircle.contains(Vector2f(dest.x, dest.z)) || clockwiseCircle.contains(Vector2f(dest.x, dest.z));
     }
 
-    UnitBehaviorService::UnitBehaviorService(GameScene* scene, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService)
-        : scene(scene), pathFindingService(pathFindingService), collisionService(collisionService)
+    UnitBehaviorService::UnitBehaviorService(SimulationRunner* runner, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService)
+        : runner(runner), pathFindingService(pathFindingService), collisionService(collisionService)
     {
     }
 
@@ -48,28 +48,28 @@ namespace rwe
     class AttackTargetToMovingStateGoalVisitor : public boost::static_visitor<MovingStateGoal>
     {
     private:
-        const GameScene* scene;
+        const SimulationRunner* runner;
 
     public:
-        explicit AttackTargetToMovingStateGoalVisitor(const GameScene* scene) : scene(scene) {}
+        explicit AttackTargetToMovingStateGoalVisitor(const SimulationRunner* runner) : runner(runner) {}
 
         MovingStateGoal operator()(const Vector3f& target) const { return target; }
         MovingStateGoal operator()(UnitId unitId) const
         {
-            const auto& targetUnit = scene->getSimulation().getUnit(unitId);
-            return scene->computeFootprintRegion(targetUnit.position, targetUnit.footprintX, targetUnit.footprintZ);
+            const auto& targetUnit = runner->getSimulation().getUnit(unitId);
+            return runner->computeFootprintRegion(targetUnit.position, targetUnit.footprintX, targetUnit.footprintZ);
         }
     };
 
-    void UnitBehaviorService::update(UnitId unitId)
+    void UnitBehaviorService::update(UnitId unitId, UnitEffectBuffer& effects)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
-
-        float previousSpeed = unit.currentSpeed;
+        auto& unit = runner->getSimulation().getUnit(unitId);
+        auto& kinematics = runner->getSimulation().unitKinematics;
+        auto index = runner->getSimulation().getUnitIndex(unitId);
 
         // Clear steering targets.
-        unit.targetAngle = unit.rotation;
-        unit.targetSpeed = 0.0f;
+        kinematics.targetAngle[index] = kinematics.rotation[index];
+        kinematics.targetSpeed[index] = 0.0f;
 
         // check our orders
         if (!unit.orders.empty())
@@ -82,7 +82,7 @@ namespace rwe
                 if (auto idleState = boost::get<IdleState>(&unit.behaviourState); idleState != nullptr)
                 {
                     // request a path to follow
-                    scene->getSimulation().requestPath(unitId);
+                    effects.requestPath(unitId, PathRequestPriority::Order);
                     const auto& destination = moveOrder->destination;
                     unit.behaviourState = MovingState{destination, std::nullopt, true};
                 }
@@ -91,13 +91,13 @@ namespace rwe
                     // if we are colliding, request a new path
                     if (unit.inCollision && !movingState->pathRequested)
                     {
-                        auto& sim = scene->getSimulation();
+                        const auto& sim = runner->getSimulation();
 
                         // only request a new path if we don't have one yet,
                         // or we've already had our current one for a bit
-                        if (!movingState->path || (sim.gameTime - movingState->path->pathCreationTime) >= GameTimeDelta(60))
+                        if (!movingState->path || (sim.gameTime - movingState->path->pathCreationTime) >= deltaSecondsToTicks(1.0f))
                         {
-                            sim.requestPath(unitId);
+                            effects.requestPath(unitId, PathRequestPriority::Repath);
                             movingState->pathRequested = true;
                         }
                     }
@@ -106,7 +106,7 @@ namespace rwe
                     auto& pathToFollow = movingState->path;
                     if (pathToFollow)
                     {
-                        if (followPath(unit, *pathToFollow))
+                        if (followPath(unitId, *pathToFollow))
                         {
                             // we finished following the path,
                             // order complete
@@ -115,7 +115,7 @@ namespace rwe
 
                             if (unit.arrivedSound)
                             {
-                                scene->playSoundOnSelectChannel(*unit.arrivedSound);
+                                effects.playSoundOnSelectChannel(*unit.arrivedSound);
                             }
                         }
                     }
@@ -123,7 +123,7 @@ namespace rwe
             }
             else if (auto attackOrder = boost::get<AttackOrder>(&order); attackOrder != nullptr)
             {
-                if (handleAttackOrder(unitId, *attackOrder))
+                if (handleAttackOrder(unitId, *attackOrder, effects))
                 {
                     unit.orders.pop_front();
                 }
@@ -132,20 +132,36 @@ namespace rwe
 
         for (unsigned int i = 0; i < unit.weapons.size(); ++i)
         {
-            updateWeapon(unitId, i);
+            updateWeapon(unitId, i, effects);
         }
 
-        applyUnitSteering(unitId);
+        auto speedLimit = kinematics.maxSpeed[index];
+        if (unit.position.y < runner->getTerrain().getSeaLevel())
+        {
+            speedLimit /= 2.0f;
+        }
+        kinematics.speedLimit[index] = speedLimit;
+    }
 
-        if (unit.currentSpeed > 0.0f && previousSpeed == 0.0f)
+    void UnitBehaviorService::updateMovement(UnitId unitId)
+    {
+        auto& unit = runner->getSimulation().getUnit(unitId);
+        const auto& kinematics = runner->getSimulation().unitKinematics;
+        auto index = runner->getSimulation().getUnitIndex(unitId);
+
+        auto currentSpeed = kinematics.currentSpeed[index];
+        auto previousSpeed = kinematics.previousSpeed[index];
+        if (currentSpeed > 0.0f && previousSpeed == 0.0f)
         {
             unit.cobEnvironment->createThread("StartMoving");
         }
-        else if (unit.currentSpeed == 0.0f && previousSpeed > 0.0f)
+        else if (currentSpeed == 0.0f && previousSpeed > 0.0f)
         {
             unit.cobEnvironment->createThread("StopMoving");
         }
 
+        unit.rotation = kinematics.rotation[index];
+
         updateUnitPosition(unitId);
     }
 
@@ -163,8 +179,12 @@ namespace rwe
         return {heading, pitch};
     }
 
-    bool UnitBehaviorService::followPath(Unit& unit, PathFollowingInfo& path)
+    bool UnitBehaviorService::followPath(UnitId unitId, PathFollowingInfo& path)
     {
+        const auto& unit = runner->getSimulation().getUnit(unitId);
+        auto& kinematics = runner->getSimulation().unitKinematics;
+        auto index = runner->getSimulation().getUnitIndex(unitId);
+
         const auto& destination = *path.currentWaypoint;
         Vector3f xzPosition(unit.position.x, 0.0f, unit.position.z);
         Vector3f xzDestination(destination.x, 0.0f, destination.z);
@@ -187,32 +207,33 @@ namespace rwe
         {
             // steer towards the goal
             auto xzDirection = xzDestination - xzPosition;
-            unit.targetAngle = Unit::toRotation(xzDirection);
+            kinematics.targetAngle[index] = Unit::toRotation(xzDirection);
 
             // drive at full speed until we need to brake
             // to turn or to arrive at the goal
-            auto brakingDistance = (unit.currentSpeed * unit.currentSpeed) / (2.0f * unit.brakeRate);
+            auto currentSpeed = kinematics.currentSpeed[index];
+            auto brakingDistance = (currentSpeed * currentSpeed) / (2.0f * kinematics.brakeRate[index]);
 
-            if (isWithinTurningCircle(xzDirection, unit.currentSpeed, unit.turnRate, unit.rotation))
+            if (isWithinTurningCircle(xzDirection, currentSpeed, kinematics.turnRate[index], kinematics.rotation[index]))
             {
-                unit.targetSpeed = 0.0f;
+                kinematics.targetSpeed[index] = 0.0f;
             }
             else if (isFinalDestination && distanceSquared <= (brakingDistance * brakingDistance))
             {
-                unit.targetSpeed = 0.0f;
+                kinematics.targetSpeed[index] = 0.0f;
             }
             else
             {
-                unit.targetSpeed = unit.maxSpeed;
+                kinematics.targetSpeed[index] = kinematics.maxSpeed[index];
             }
         }
 
         return false;
     }
 
-    void UnitBehaviorService::updateWeapon(UnitId id, unsigned int weaponIndex)
+    void UnitBehaviorService::updateWeapon(UnitId id, unsigned int weaponIndex, UnitEffectBuffer& effects)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = runner->getSimulation().getUnit(id);
         auto& weapon = unit.weapons[weaponIndex];
         if (!weapon)
         {
@@ -224,10 +245,10 @@ namespace rwe
             // attempt to acquire a target
             if (!weapon->commandFire)
             {
-                for (const auto& entry : scene->getSimulation().units)
+                const auto& sim = runner->getSimulation();
+                for (auto otherUnitId : sim.getUnitsInRadius(unit.position, weapon->maxRange))
                 {
-                    auto otherUnitId = entry.first;
-                    const auto& otherUnit = entry.second;
+                    const auto& otherUnit = sim.getUnit(otherUnitId);
 
                     if (otherUnit.isOwnedBy(unit.owner))
                     {
@@ -271,7 +292,7 @@ namespace rwe
                 {
                     // We couldn't launch an aiming script (there isn't one),
                     // just go straight to firing.
-                    tryFireWeapon(id, weaponIndex, *targetPosition);
+                    tryFireWeapon(id, weaponIndex, *targetPosition, effects);
                 }
             }
             else
@@ -297,7 +318,7 @@ namespace rwe
                         // if the target is close enough, try to fire
                         if (std::abs(heading - aimInfo.lastHeading) <= weapon->tolerance && std::abs(pitch - aimInfo.lastPitch) <= weapon->pitchTolerance)
                         {
-                            tryFireWeapon(id, weaponIndex, *targetPosition);
+                            tryFireWeapon(id, weaponIndex, *targetPosition, effects);
                         }
                     }
                 }
@@ -305,9 +326,9 @@ namespace rwe
         }
     }
 
-    void UnitBehaviorService::tryFireWeapon(UnitId id, unsigned int weaponIndex, const Vector3f& targetPosition)
+    void UnitBehaviorService::tryFireWeapon(UnitId id, unsigned int weaponIndex, const Vector3f& targetPosition, UnitEffectBuffer& effects)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = runner->getSimulation().getUnit(id);
         auto& weapon = unit.weapons[weaponIndex];
 
         if (!weapon)
@@ -316,7 +337,7 @@ namespace rwe
         }
 
         // wait for the weapon to reload
-        auto gameTime = scene->getGameTime();
+        auto gameTime = runner->getGameTime();
         if (gameTime < weapon->readyTime)
         {
             return;
@@ -327,13 +348,13 @@ namespace rwe
         auto targetVector = targetPosition - firingPoint;
         if (weapon->startSmoke)
         {
-            scene->createLightSmoke(firingPoint);
+            effects.createLightSmoke(firingPoint);
         }
-        scene->getSimulation().spawnLaser(unit.owner, *weapon, firingPoint, targetVector.normalized());
+        effects.spawnLaser(runner->getSimulation().createProjectileFromWeapon(unit.owner, *weapon, firingPoint, targetVector.normalized()));
 
         if (weapon->soundStart)
         {
-            scene->playUnitSound(id, *weapon->soundStart);
+            effects.playUnitSound(id, *weapon->soundStart);
         }
         unit.cobEnvironment->createThread(getFireScriptName(weaponIndex));
 
@@ -341,78 +362,20 @@ namespace rwe
         weapon->readyTime = gameTime + deltaSecondsToTicks(weapon->reloadTime);
     }
 
-    void UnitBehaviorService::applyUnitSteering(UnitId id)
-    {
-        updateUnitRotation(id);
-        updateUnitSpeed(id);
-    }
-
-    void UnitBehaviorService::updateUnitRotation(UnitId id)
-    {
-        auto& unit = scene->getSimulation().getUnit(id);
-
-        auto angleDelta = wrap(-Pif, Pif, unit.targetAngle - unit.rotation);
-
-        auto turnRateThisFrame = unit.turnRate;
-        if (std::abs(angleDelta) <= turnRateThisFrame)
-        {
-            unit.rotation = unit.targetAngle;
-        }
-        else
-        {
-            unit.rotation = wrap(-Pif, Pif, unit.rotation + (turnRateThisFrame * (angleDelta > 0.0f ? 1.0f : -1.0f)));
-        }
-    }
-
-    void UnitBehaviorService::updateUnitSpeed(UnitId id)
-    {
-        auto& unit = scene->getSimulation().getUnit(id);
-
-        if (unit.targetSpeed > unit.currentSpeed)
-        {
-            // accelerate to target speed
-            if (unit.targetSpeed - unit.currentSpeed <= unit.acceleration)
-            {
-                unit.currentSpeed = unit.targetSpeed;
-            }
-            else
-            {
-                unit.currentSpeed += unit.acceleration;
-            }
-        }
-        else
-        {
-            // brake to target speed
-            if (unit.currentSpeed - unit.targetSpeed <= unit.brakeRate)
-            {
-                unit.currentSpeed = unit.targetSpeed;
-            }
-            else
-            {
-                unit.currentSpeed -= unit.brakeRate;
-            }
-        }
-
-        auto effectiveMaxSpeed = unit.maxSpeed;
-        if (unit.position.y < scene->getTerrain().getSeaLevel())
-        {
-            effectiveMaxSpeed /= 2.0f;
-        }
-        unit.currentSpeed = std::clamp(unit.currentSpeed, 0.0f, effectiveMaxSpeed);
-    }
-
     void UnitBehaviorService::updateUnitPosition(UnitId unitId)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
+        auto& sim = runner->getSimulation();
+        auto& unit = sim.getUnit(unitId);
+        auto currentSpeed = sim.unitKinematics.currentSpeed[sim.getUnitIndex(unitId)];
 
         auto direction = Unit::toDirection(unit.rotation);
 
         unit.inCollision = false;
 
-        if (unit.currentSpeed > 0.0f)
+        if (currentSpeed > 0.0f)
         {
-            auto newPosition = unit.position + (direction * unit.currentSpeed);
-            newPosition.y = scene->getTerrain().getHeightAt(newPosition.x, newPosition.z);
+            auto newPosition = unit.position + (direction * currentSpeed);
+            newPosition.y = runner->getTerrain().getHeightAt(newPosition.x, newPosition.z);
 
             if (!tryApplyMovementToPosition(unitId, newPosition))
             {
@@ -427,16 +390,16 @@ namespace rwe
                 Vector3f newPos2;
                 if (direction.x > direction.z)
                 {
-                    newPos1 = unit.position + (direction * maskZ * unit.currentSpeed);
-                    newPos2 = unit.position + (direction * maskX * unit.currentSpeed);
+                    newPos1 = unit.position + (direction * maskZ * currentSpeed);
+                    newPos2 = unit.position + (direction * maskX * currentSpeed);
                 }
                 else
                 {
-                    newPos1 = unit.position + (direction * maskX * unit.currentSpeed);
-                    newPos2 = unit.position + (direction * maskZ * unit.currentSpeed);
+                    newPos1 = unit.position + (direction * maskX * currentSpeed);
+                    newPos2 = unit.position + (direction * maskZ * currentSpeed);
                 }
-                newPos1.y = scene->getTerrain().getHeightAt(newPos1.x, newPos1.z);
-                newPos2.y = scene->getTerrain().getHeightAt(newPos2.x, newPos2.z);
+                newPos1.y = runner->getTerrain().getHeightAt(newPos1.x, newPos1.z);
+                newPos2.y = runner->getTerrain().getHeightAt(newPos2.x, newPos2.z);
 
                 if (!tryApplyMovementToPosition(unitId, newPos1))
                 {
@@ -448,11 +411,11 @@ namespace rwe
 
     bool UnitBehaviorService::tryApplyMovementToPosition(UnitId id, const Vector3f& newPosition)
     {
-        auto& sim = scene->getSimulation();
+        auto& sim = runner->getSimulation();
         auto& unit = sim.getUnit(id);
 
         // check for collision at the new position
-        auto newFootprintRegion = scene->computeFootprintRegion(newPosition, unit.footprintX, unit.footprintZ);
+        auto newFootprintRegion = runner->computeFootprintRegion(newPosition, unit.footprintX, unit.footprintZ);
 
         // Unlike for pathfinding, TA doesn't care about the unit's actual movement class for collision checks,
         // it only cares about the attributes defined directly on the unit.
@@ -470,14 +433,14 @@ namespace rwe
             return false;
         }
 
-        if (scene->isCollisionAt(newFootprintRegion, id))
+        if (runner->isCollisionAt(newFootprintRegion, id))
         {
             return false;
         }
 
         // we passed all collision checks, update accordingly
-        auto footprintRegion = scene->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        scene->moveUnitOccupiedArea(footprintRegion, newFootprintRegion, id);
+        auto footprintRegion = runner->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+        runner->moveUnitOccupiedArea(footprintRegion, newFootprintRegion, id);
         unit.position = newPosition;
         return true;
     }
@@ -544,13 +507,13 @@ namespace rwe
 
     std::optional<int> UnitBehaviorService::runCobQuery(UnitId id, const std::string& name)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = runner->getSimulation().getUnit(id);
         auto thread = unit.cobEnvironment->createNonScheduledThread(name, {0});
         if (!thread)
         {
             return std::nullopt;
         }
-        CobExecutionContext context(&scene->getSimulation(), unit.cobEnvironment.get(), &*thread, id);
+        CobExecutionContext context(&runner->getSimulation(), unit.cobEnvironment.get(), &*thread, id);
         auto status = context.execute();
         if (boost::get<CobEnvironment::FinishedStatus>(&status) == nullptr)
         {
@@ -580,7 +543,7 @@ namespace rwe
         auto pieceId = runCobQuery(id, scriptName);
         if (!pieceId)
         {
-            return scene->getSimulation().getUnit(id).position;
+            return runner->getSimulation().getUnit(id).position;
         }
 
         return getPiecePosition(id, *pieceId);
@@ -591,7 +554,7 @@ namespace rwe
         auto pieceId = runCobQuery(id, "SweetSpot");
         if (!pieceId)
         {
-            return scene->getSimulation().getUnit(id).position;
+            return runner->getSimulation().getUnit(id).position;
         }
 
         return getPiecePosition(id, *pieceId);
@@ -599,17 +562,68 @@ namespace rwe
 
     std::optional<Vector3f> UnitBehaviorService::tryGetSweetSpot(UnitId id)
     {
-        if (!scene->getSimulation().unitExists(id))
+        const auto& sim = runner->getSimulation();
+        if (!sim.unitExists(id))
         {
             return std::nullopt;
         }
 
-        return getSweetSpot(id);
+        auto it = sweetSpots.find(id);
+        if (it == sweetSpots.end())
+        {
+            return sim.getUnit(id).position;
+        }
+
+        return it->second;
+    }
+
+    void UnitBehaviorService::updateSweetSpots()
+    {
+        sweetSpots.clear();
+
+        auto addTarget = [this](const boost::variant<UnitId, Vector3f>& target) {
+            auto targetId = boost::get<UnitId>(&target);
+            if (targetId == nullptr || sweetSpots.find(*targetId) != sweetSpots.end())
+            {
+                return;
+            }
+
+            if (!runner->getSimulation().unitExists(*targetId))
+            {
+                return;
+            }
+
+            sweetSpots.emplace(*targetId, getSweetSpot(*targetId));
+        };
+
+        for (const auto& unit : runner->getSimulation().units)
+        {
+            for (const auto& order : unit.orders)
+            {
+                if (auto attackOrder = boost::get<AttackOrder>(&order); attackOrder != nullptr)
+                {
+                    addTarget(attackOrder->target);
+                }
+            }
+
+            for (const auto& weapon : unit.weapons)
+            {
+                if (!weapon)
+                {
+                    continue;
+                }
+
+                if (auto attackingState = boost::get<UnitWeaponStateAttacking>(&weapon->state); attackingState != nullptr)
+                {
+                    addTarget(attackingState->target);
+                }
+            }
+        }
     }
 
-    bool UnitBehaviorService::handleAttackOrder(UnitId unitId, const AttackOrder& attackOrder)
+    bool UnitBehaviorService::handleAttackOrder(UnitId unitId, const AttackOrder& attackOrder, UnitEffectBuffer& effects)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
+        auto& unit = runner->getSimulation().getUnit(unitId);
 
         if (!unit.weapons[0])
         {
@@ -632,8 +646,8 @@ namespace rwe
                 if (unit.position.distanceSquared(*targetPosition) > maxRangeSquared)
                 {
                     // request a path to follow
-                    scene->getSimulation().requestPath(unitId);
-                    auto destination = boost::apply_visitor(AttackTargetToMovingStateGoalVisitor(scene), attackOrder.target);
+                    effects.requestPath(unitId, PathRequestPriority::Order);
+                    auto destination = boost::apply_visitor(AttackTargetToMovingStateGoalVisitor(runner), attackOrder.target);
                     unit.behaviourState = MovingState{destination, std::nullopt, true};
                 }
                 else
@@ -658,13 +672,13 @@ namespace rwe
                     // if we are colliding, request a new path
                     if (unit.inCollision && !movingState->pathRequested)
                     {
-                        auto& sim = scene->getSimulation();
+                        const auto& sim = runner->getSimulation();
 
                         // only request a new path if we don't have one yet,
                         // or we've already had our current one for a bit
-                        if (!movingState->path || (sim.gameTime - movingState->path->pathCreationTime) >= GameTimeDelta(60))
+                        if (!movingState->path || (sim.gameTime - movingState->path->pathCreationTime) >= deltaSecondsToTicks(1.0f))
                         {
-                            sim.requestPath(unitId);
+                            effects.requestPath(unitId, PathRequestPriority::Repath);
                             movingState->pathRequested = true;
                         }
                     }
@@ -673,7 +687,7 @@ namespace rwe
                     auto& pathToFollow = movingState->path;
                     if (pathToFollow)
                     {
-                        if (followPath(unit, *pathToFollow))
+                        if (followPath(unitId, *pathToFollow))
                         {
                             // we finished following the path,
                             // go back to idle
@@ -689,7 +703,7 @@ namespace rwe
 
     Vector3f UnitBehaviorService::getPiecePosition(UnitId id, unsigned int pieceId)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = runner->getSimulation().getUnit(id);
 
         const auto& pieceName = unit.cobEnvironment->_script->pieces.at(pieceId);
         auto pieceTransform = unit.mesh.getPieceTransform(pieceName);
@@ -1,44 +1,76 @@
 #ifndef RWE_UNITBEHAVIORSERVICE_H
 #define RWE_UNITBEHAVIORSERVICE_H
 
+#include <rwe/UnitEffectBuffer.h>
 #include <rwe/UnitId.h>
 #include <rwe/math/Vector3f.h>
 #include <rwe/pathfinding/PathFindingService.h>
+#include <unordered_map>
 
 namespace rwe
 {
-    class GameScene;
+    class SimulationRunner;
 
     class UnitBehaviorService
     {
     private:
-        GameScene* scene;
+        SimulationRunner* runner;
         PathFindingService* pathFindingService;
         MovementClassCollisionService* collisionService;
 
-    public:
-        UnitBehaviorService(GameScene* scene, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService);
+        /**
+         * The sweet spots of units targeted by orders or weapons, found before this tick's update.
+         * Finding one runs a script on the target unit,
+         * which must not happen while its own update may be running on another thread.
+         */
+        std::unordered_map<UnitId, Vector3f> sweetSpots;
 
-        void update(UnitId unitId);
+    public:
+        UnitBehaviorService(SimulationRunner* runner, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService);
+
+        /**
+         * Processes the unit's orders and weapons
+         * and sets its steering targets for this tick.
+         *
+         * This may be called for many units at once from different threads.
+         * It only writes to the given unit's own state;
+         * changes to shared state are recorded in the effect buffer.
+         */
+        void update(UnitId unitId, UnitEffectBuffer& effects);
+
+        /**
+         * Finds the sweet spots of every unit that is the target
+         * of another unit's orders or weapons, in unit order.
+         * Must be called before update is called for this tick's units.
+         */
+        void updateSweetSpots();
+
+        /**
+         * Moves the unit according to its steering state.
+         * Must be called after the simulation's kinematics have been updated.
+         */
+        void updateMovement(UnitId unitId);
 
         // FIXME: shouldn't really be public
         Vector3f getSweetSpot(UnitId id);
+
+        /**
+         * Returns the sweet spot found for the unit by updateSweetSpots,
+         * or the unit's position if it was not a target then.
+         * Returns nothing if the unit no longer exists.
+         */
         std::optional<Vector3f> tryGetSweetSpot(UnitId id);
 
         /** Returns true if the order has been completed. */
-        bool handleAttackOrder(UnitId unitId, const AttackOrder& attackOrder);
+        bool handleAttackOrder(UnitId unitId, const AttackOrder& attackOrder, UnitEffectBuffer& effects);
 
     private:
         static std::pair<float, float> computeHeadingAndPitch(float rotation, const Vector3f& from, const Vector3f& to);
 
-        bool followPath(Unit& unit, PathFollowingInfo& path);
-
-        void updateWeapon(UnitId id, unsigned int weaponIndex);
-        void tryFireWeapon(UnitId id, unsigned int weaponIndex, const Vector3f& targetPosition);
+        bool followPath(UnitId unitId, PathFollowingInfo& path);
 
-        void applyUnitSteering(UnitId id);
-        void updateUnitRotation(UnitId id);
-        void updateUnitSpeed(UnitId id);
+        void updateWeapon(UnitId id, unsigned int weaponIndex, UnitEffectBuffer& effects);
+        void tryFireWeapon(UnitId id, unsigned int weaponIndex, const Vector3f& targetPosition, UnitEffectBuffer& effects);
 
         void updateUnitPosition(UnitId unitId);
 
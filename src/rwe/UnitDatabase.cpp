@@ -1,4 +1,6 @@
 #include "UnitDatabase.h"
+#include <cstring>
+#include <rwe/StateHasher.h>
 #include <rwe/rwe_string.h>
 
 namespace rwe
@@ -109,4 +111,34 @@ namespace rwe
     {
         return movementClassMap.end();
     }
+
+    void UnitDatabase::addSourceFile(const std::string& path, const char* data, std::size_t size)
+    {
+        StateHasher hasher;
+        for (auto c : toUpper(path))
+        {
+            hasher.add(static_cast<unsigned char>(c));
+        }
+        hasher.add(size);
+
+        std::size_t i = 0;
+        for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hasher.add(word);
+        }
+        for (; i < size; ++i)
+        {
+            hasher.add(static_cast<unsigned char>(data[i]));
+        }
+
+        // summing keeps the result independent of the order files were added in
+        dataVersion += hasher.get();
+    }
+
+    std::uint64_t UnitDatabase::getDataVersion() const
+    {
+        return dataVersion;
+    }
 }
@@ -1,6 +1,7 @@
 #ifndef RWE_UNITDATABASE_H
 #define RWE_UNITDATABASE_H
 
+#include <cstdint>
 #include <rwe/AudioService.h>
 #include <rwe/Cob.h>
 #include <rwe/MovementClass.h>
@@ -28,6 +29,8 @@ namespace rwe
 
         std::unordered_map<std::string, AudioService::SoundHandle> soundMap;
 
+        std::uint64_t dataVersion{0};
+
     public:
         const UnitFbi& getUnitInfo(const std::string& unitName) const;
 
@@ -53,6 +56,19 @@ namespace rwe
 
         void addSound(const std::string& soundName, const AudioService::SoundHandle& sound);
 
+        /**
+         * Folds a game data file the database was built from into its data version.
+         * The order in which files are added does not matter.
+         */
+        void addSourceFile(const std::string& path, const char* data, std::size_t size);
+
+        /**
+         * Returns a fingerprint of the game data files the database was built from.
+         * Games recorded with one version of the data
+         * will not replay correctly with another.
+         */
+        std::uint64_t getDataVersion() const;
+
         MovementClassIterator movementClassBegin() const;
 
         MovementClassIterator movementClassEnd() const;
@@ -0,0 +1,91 @@
+#ifndef RWE_UNITEFFECTBUFFER_H
+#define RWE_UNITEFFECTBUFFER_H
+
+#include <boost/variant.hpp>
+#include <rwe/AudioService.h>
+#include <rwe/LaserProjectile.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Vector3f.h>
+#include <rwe/pathfinding/PathRequestQueue.h>
+#include <vector>
+
+namespace rwe
+{
+    struct RequestPathEffect
+    {
+        UnitId unitId;
+        PathRequestPriority priority;
+    };
+
+    struct SpawnLaserEffect
+    {
+        LaserProjectile laser;
+    };
+
+    struct SpawnLightSmokeEffect
+    {
+        Vector3f position;
+    };
+
+    struct PlayUnitSoundEffect
+    {
+        UnitId unitId;
+        AudioService::SoundHandle sound;
+    };
+
+    struct PlaySelectChannelSoundEffect
+    {
+        AudioService::SoundHandle sound;
+    };
+
+    using UnitEffect = boost::variant<
+        RequestPathEffect,
+        SpawnLaserEffect,
+        SpawnLightSmokeEffect,
+        PlayUnitSoundEffect,
+        PlaySelectChannelSoundEffect>;
+
+    /**
+     * Changes to shared simulation state that a unit wants to make
+     * during the parallel part of a tick.
+     * Each unit records into its own buffer,
+     * and the buffers are applied afterwards on a single thread
+     * in unit order, so the result does not depend on thread timing.
+     */
+    struct UnitEffectBuffer
+    {
+        std::vector<UnitEffect> effects;
+
+        void requestPath(UnitId unitId, PathRequestPriority priority)
+        {
+            effects.emplace_back(RequestPathEffect{unitId, priority});
+        }
+
+        void spawnLaser(LaserProjectile&& laser)
+        {
+            effects.emplace_back(SpawnLaserEffect{std::move(laser)});
+        }
+
+        void createLightSmoke(const Vector3f& position)
+        {
+            effects.emplace_back(SpawnLightSmokeEffect{position});
+        }
+
+        void playUnitSound(UnitId unitId, const AudioService::SoundHandle& sound)
+        {
+            effects.emplace_back(PlayUnitSoundEffect{unitId, sound});
+        }
+
+        void playSoundOnSelectChannel(const AudioService::SoundHandle& sound)
+        {
+            effects.emplace_back(PlaySelectChannelSoundEffect{sound});
+        }
+
+        void clear()
+        {
+            effects.clear();
+        }
+    };
+}
+
+#endif
@@ -28,6 +28,22 @@ namespace rwe
         }
     }
 
+    UnitMovementAttributes UnitFactory::getMovementAttributes(const std::string& unitType)
+    {
+        const auto& fbi = unitDatabase.getUnitInfo(unitType);
+
+        // These units are per-tick.
+        // TA ticks are 1/30 of a second,
+        // so we scale them to the length of our ticks.
+        auto tickScale = static_cast<float>(TaTicksPerSecond) / static_cast<float>(SimTicksPerSecond);
+        UnitMovementAttributes attributes;
+        attributes.turnRate = (fbi.turnRate * tickScale) * (Pif / 32768.0f); // also convert to rads
+        attributes.maxSpeed = fbi.maxVelocity * tickScale;
+        attributes.acceleration = fbi.acceleration * tickScale;
+        attributes.brakeRate = fbi.brakeRate * tickScale;
+        return attributes;
+    }
+
     Unit UnitFactory::createUnit(
         const std::string& unitType,
         PlayerId owner,
@@ -64,13 +80,8 @@ namespace rwe
             unit.rotation = Pif;
         }
 
-        // These units are per-tick.
-        // We divide by two here because TA ticks are 1/30 of a second,
-        // where as ours are 1/60 of a second.
-        unit.turnRate = (fbi.turnRate / 2.0f) * (Pif / 32768.0f); // also convert to rads
-        unit.maxSpeed = fbi.maxVelocity / 2.0f;
-        unit.acceleration = fbi.acceleration / 2.0f;
-        unit.brakeRate = fbi.brakeRate / 2.0f;
+        unit.previousPosition = unit.position;
+        unit.previousRotation = unit.rotation;
 
         unit.canAttack = fbi.canAttack;
 
@@ -145,13 +156,14 @@ namespace rwe
     {
         const auto& tdf = unitDatabase.getWeapon(weaponType);
         UnitWeapon weapon;
+        weapon.weaponType = weaponType;
 
         weapon.maxRange = tdf.range;
         weapon.reloadTime = tdf.reloadTime;
         weapon.tolerance = toleranceToRadians(tdf.tolerance);
         weapon.pitchTolerance = toleranceToRadians(tdf.pitchTolerance);
-        weapon.velocity = static_cast<float>(tdf.weaponVelocity) / 60.0f;
-        weapon.duration = tdf.duration * 60.0f * 2.0f; // duration seems to match better if doubled
+        weapon.velocity = static_cast<float>(tdf.weaponVelocity) / static_cast<float>(SimTicksPerSecond);
+        weapon.duration = tdf.duration * static_cast<float>(SimTicksPerSecond) * 2.0f; // duration seems to match better if doubled
         weapon.color = getLaserColor(tdf.color);
         weapon.color2 = getLaserColor(tdf.color2);
         weapon.commandFire = tdf.commandFire;
@@ -159,7 +171,7 @@ namespace rwe
         weapon.endSmoke = tdf.endSmoke;
         if (tdf.smokeTrail)
         {
-            weapon.smokeTrail = GameTimeDelta(static_cast<unsigned int>(tdf.smokeDelay * 60.0f));
+            weapon.smokeTrail = deltaSecondsToTicks(tdf.smokeDelay);
         }
         if (!tdf.soundStart.empty())
         {
@@ -173,11 +185,13 @@ namespace rwe
         {
             weapon.soundWater = unitDatabase.getSoundHandle(tdf.soundWater);
         }
-        if (!tdf.explosionGaf.empty() && !tdf.explosionArt.empty())
+        // Explosion animations are purely cosmetic,
+        // so they are left out when running without textures.
+        if (textureService != nullptr && !tdf.explosionGaf.empty() && !tdf.explosionArt.empty())
         {
             weapon.explosion = textureService->getGafEntry("anims/" + tdf.explosionGaf + ".gaf", tdf.explosionArt);
         }
-        if (!tdf.waterExplosionGaf.empty() && !tdf.waterExplosionArt.empty())
+        if (textureService != nullptr && !tdf.waterExplosionGaf.empty() && !tdf.waterExplosionArt.empty())
         {
             weapon.waterExplosion = textureService->getGafEntry("anims/" + tdf.waterExplosionGaf + ".gaf", tdf.waterExplosionArt);
         }
@@ -6,6 +6,7 @@
 #include <rwe/MovementClassCollisionService.h>
 #include <rwe/Unit.h>
 #include <rwe/UnitDatabase.h>
+#include <rwe/UnitKinematics.h>
 #include <string>
 
 namespace rwe
@@ -32,9 +33,11 @@ namespace rwe
     public:
         Unit createUnit(const std::string& unitType, PlayerId owner, unsigned int colorIndex, const Vector3f& position);
 
-    private:
+        UnitMovementAttributes getMovementAttributes(const std::string& unitType);
+
         UnitWeapon createWeapon(const std::string& weaponType);
 
+    private:
         Vector3f getLaserColor(unsigned int colorIndex);
     };
 }
@@ -0,0 +1,96 @@
+#include "UnitKinematics.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <rwe/util.h>
+
+namespace rwe
+{
+    /**
+     * Wraps an angle in the range [-3pi, 3pi] into [-pi, pi].
+     * Cheaper than the general wrap function and free of calls,
+     * so that the update loop can be vectorized.
+     */
+    float wrapSmallAngle(float angle)
+    {
+        angle = angle > Pif ? angle - (2.0f * Pif) : angle;
+        angle = angle < -Pif ? angle + (2.0f * Pif) : angle;
+        return angle;
+    }
+
+    template <typename T>
+    void swapRemoveElement(std::vector<T>& v, std::size_t index)
+    {
+        assert(index < v.size());
+        v[index] = v.back();
+        v.pop_back();
+    }
+
+    std::size_t UnitKinematicsStore::size() const
+    {
+        return rotation.size();
+    }
+
+    void UnitKinematicsStore::pushBack(float initialRotation, const UnitMovementAttributes& attributes)
+    {
+        rotation.push_back(initialRotation);
+        currentSpeed.push_back(0.0f);
+        previousSpeed.push_back(0.0f);
+        targetAngle.push_back(initialRotation);
+        targetSpeed.push_back(0.0f);
+        speedLimit.push_back(attributes.maxSpeed);
+        turnRate.push_back(attributes.turnRate);
+        maxSpeed.push_back(attributes.maxSpeed);
+        acceleration.push_back(attributes.acceleration);
+        brakeRate.push_back(attributes.brakeRate);
+    }
+
+    void UnitKinematicsStore::swapRemove(std::size_t index)
+    {
+        swapRemoveElement(rotation, index);
+        swapRemoveElement(currentSpeed, index);
+        swapRemoveElement(previousSpeed, index);
+        swapRemoveElement(targetAngle, index);
+        swapRemoveElement(targetSpeed, index);
+        swapRemoveElement(speedLimit, index);
+        swapRemoveElement(turnRate, index);
+        swapRemoveElement(maxSpeed, index);
+        swapRemoveElement(acceleration, index);
+        swapRemoveElement(brakeRate, index);
+    }
+
+    void UnitKinematicsStore::update()
+    {
+        auto count = size();
+
+        float* rotationData = rotation.data();
+        float* currentSpeedData = currentSpeed.data();
+        float* previousSpeedData = previousSpeed.data();
+        const float* targetAngleData = targetAngle.data();
+        const float* targetSpeedData = targetSpeed.data();
+        const float* speedLimitData = speedLimit.data();
+        const float* turnRateData = turnRate.data();
+        const float* accelerationData = acceleration.data();
+        const float* brakeRateData = brakeRate.data();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // turn towards the target angle
+            auto angleDelta = wrapSmallAngle(targetAngleData[i] - rotationData[i]);
+            auto turn = std::clamp(angleDelta, -turnRateData[i], turnRateData[i]);
+            rotationData[i] = std::abs(angleDelta) <= turnRateData[i]
+                ? targetAngleData[i]
+                : wrapSmallAngle(rotationData[i] + turn);
+
+            // accelerate or brake towards the target speed
+            auto speed = currentSpeedData[i];
+            auto target = targetSpeedData[i];
+            auto accelerated = std::min(speed + accelerationData[i], target);
+            auto braked = std::max(speed - brakeRateData[i], target);
+            auto newSpeed = target > speed ? accelerated : braked;
+
+            previousSpeedData[i] = speed;
+            currentSpeedData[i] = std::clamp(newSpeed, 0.0f, speedLimitData[i]);
+        }
+    }
+}
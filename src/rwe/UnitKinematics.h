@@ -0,0 +1,80 @@
+#ifndef RWE_UNITKINEMATICS_H
+#define RWE_UNITKINEMATICS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Per-unit-type movement capabilities, as read from the unit's FBI.
+     * All values are per-tick.
+     */
+    struct UnitMovementAttributes
+    {
+        /** Rate at which the unit turns in rads/tick. */
+        float turnRate{0.0f};
+
+        /** Maximum speed the unit can travel forwards in game units/tick. */
+        float maxSpeed{0.0f};
+
+        /** Speed at which the unit accelerates in game units/tick. */
+        float acceleration{0.0f};
+
+        /** Speed at which the unit brakes in game units/tick. */
+        float brakeRate{0.0f};
+    };
+
+    /**
+     * Structure-of-arrays store for the steering state of every unit.
+     * Entries are kept in the same order as the dense unit array
+     * in GameSimulation, so a unit's dense index is also its index here.
+     *
+     * Unit behaviour sets the targets for each unit,
+     * then a single call to update advances all units at once.
+     */
+    struct UnitKinematicsStore
+    {
+        /**
+         * Anticlockwise rotation of the unit around the Y axis in radians.
+         * This is the authoritative value;
+         * Unit::rotation is a copy published after each tick's movement.
+         */
+        std::vector<float> rotation;
+
+        /** Rate at which the unit is travelling forwards in game units/tick. */
+        std::vector<float> currentSpeed;
+
+        /** The speed the unit was travelling at before the last update. */
+        std::vector<float> previousSpeed;
+
+        /** The angle we are trying to steer towards. */
+        std::vector<float> targetAngle;
+
+        /** The speed we are trying to accelerate/decelerate to. */
+        std::vector<float> targetSpeed;
+
+        /** Upper bound on the speed this tick, e.g. maxSpeed halved in water. */
+        std::vector<float> speedLimit;
+
+        std::vector<float> turnRate;
+        std::vector<float> maxSpeed;
+        std::vector<float> acceleration;
+        std::vector<float> brakeRate;
+
+        std::size_t size() const;
+
+        void pushBack(float initialRotation, const UnitMovementAttributes& attributes);
+
+        /** Moves the last entry into the given index and shrinks the store by one. */
+        void swapRemove(std::size_t index);
+
+        /**
+         * Turns every unit towards its target angle
+         * and accelerates or brakes it towards its target speed.
+         */
+        void update();
+    };
+}
+
+#endif
@@ -111,6 +111,42 @@ namespace rwe
         return std::ref(const_cast<UnitMesh&>(value->get()));
     }
 
+    std::optional<UnitMesh::PiecePath> UnitMesh::findPath(const std::string& pieceName) const
+    {
+        if (pieceName == name)
+        {
+            return PiecePath();
+        }
+
+        for (unsigned int i = 0; i < children.size(); ++i)
+        {
+            auto path = children[i].findPath(pieceName);
+            if (path)
+            {
+                path->insert(path->begin(), i);
+                return path;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    const UnitMesh& UnitMesh::getPiece(const PiecePath& path) const
+    {
+        const UnitMesh* piece = this;
+        for (auto i : path)
+        {
+            piece = &piece->children[i];
+        }
+
+        return *piece;
+    }
+
+    UnitMesh& UnitMesh::getPiece(const PiecePath& path)
+    {
+        return const_cast<UnitMesh&>(static_cast<const UnitMesh&>(*this).getPiece(path));
+    }
+
     std::optional<Matrix4f> UnitMesh::getPieceTransform(const std::string& pieceName) const
     {
         if (pieceName == name)
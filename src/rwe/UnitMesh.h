@@ -60,6 +60,12 @@ namespace rwe
 
         using TurnOperationUnion = boost::variant<TurnOperation, SpinOperation, StopSpinOperation>;
 
+        /**
+         * The index of the child to descend into at each level
+         * to reach a piece from the root of the mesh.
+         */
+        using PiecePath = std::vector<unsigned int>;
+
         std::string name;
         Vector3f origin;
         std::shared_ptr<ShaderMesh> mesh;
@@ -81,6 +87,12 @@ namespace rwe
 
         std::optional<std::reference_wrapper<UnitMesh>> find(const std::string& pieceName);
 
+        std::optional<PiecePath> findPath(const std::string& pieceName) const;
+
+        const UnitMesh& getPiece(const PiecePath& path) const;
+
+        UnitMesh& getPiece(const PiecePath& path);
+
         std::optional<Matrix4f> getPieceTransform(const std::string& pieceName) const;
 
         Matrix4f getTransform() const;
@@ -0,0 +1,280 @@
+#include "UnitSpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rwe
+{
+    std::size_t ceilDiv(std::size_t a, std::size_t b)
+    {
+        return (a + b - 1) / b;
+    }
+
+    UnitSpatialIndex::UnitSpatialIndex(std::size_t widthInCells, std::size_t heightInCells, unsigned int cellsPerBucket, unsigned int margin)
+        : cellsPerBucket(cellsPerBucket),
+          margin(margin),
+          buckets(ceilDiv(widthInCells, cellsPerBucket), ceilDiv(heightInCells, cellsPerBucket))
+    {
+        assert(cellsPerBucket > 0);
+    }
+
+    void UnitSpatialIndex::insert(UnitId unitId, const DiscreteRect& footprint)
+    {
+        auto range = toRecordedBucketRange(footprint);
+        if (range)
+        {
+            insertIntoRange(unitId, *range);
+        }
+    }
+
+    void UnitSpatialIndex::remove(UnitId unitId, const DiscreteRect& footprint)
+    {
+        auto range = toRecordedBucketRange(footprint);
+        if (range)
+        {
+            removeFromRange(unitId, *range);
+        }
+    }
+
+    void UnitSpatialIndex::move(UnitId unitId, const DiscreteRect& oldFootprint, const DiscreteRect& newFootprint)
+    {
+        auto oldRange = toRecordedBucketRange(oldFootprint);
+        auto newRange = toRecordedBucketRange(newFootprint);
+        if (oldRange == newRange)
+        {
+            return;
+        }
+
+        if (oldRange)
+        {
+            removeFromRange(unitId, *oldRange);
+        }
+        if (newRange)
+        {
+            insertIntoRange(unitId, *newRange);
+        }
+    }
+
+    std::vector<UnitId> UnitSpatialIndex::queryRect(const DiscreteRect& rect) const
+    {
+        return collectRange(toBucketRange(rect));
+    }
+
+    std::vector<UnitId> UnitSpatialIndex::queryCircle(const Vector2f& center, float radius) const
+    {
+        auto minX = static_cast<int>(std::floor(center.x - radius));
+        auto minY = static_cast<int>(std::floor(center.y - radius));
+        auto maxX = static_cast<int>(std::floor(center.x + radius));
+        auto maxY = static_cast<int>(std::floor(center.y + radius));
+        return collectRange(toBucketRange(minX, minY, maxX, maxY));
+    }
+
+    std::vector<UnitId> UnitSpatialIndex::queryRay(const Vector2f& origin, const Vector2f& direction) const
+    {
+        std::vector<UnitId> result;
+
+        auto width = static_cast<float>(buckets.getWidth());
+        auto height = static_cast<float>(buckets.getHeight());
+        if (buckets.getWidth() == 0 || buckets.getHeight() == 0)
+        {
+            return result;
+        }
+
+        // work in bucket space
+        Vector2f o(origin.x / cellsPerBucket, origin.y / cellsPerBucket);
+        Vector2f d(direction.x / cellsPerBucket, direction.y / cellsPerBucket);
+
+        // clip the ray to the grid
+        auto tEnter = 0.0f;
+        auto tExit = std::numeric_limits<float>::infinity();
+        auto clipAxis = [&tEnter, &tExit](float o, float d, float size) {
+            if (d == 0.0f)
+            {
+                return o >= 0.0f && o < size;
+            }
+
+            auto t1 = (0.0f - o) / d;
+            auto t2 = (size - o) / d;
+            tEnter = std::max(tEnter, std::min(t1, t2));
+            tExit = std::min(tExit, std::max(t1, t2));
+            return tEnter <= tExit;
+        };
+        if (!clipAxis(o.x, d.x, width) || !clipAxis(o.y, d.y, height))
+        {
+            return result;
+        }
+
+        // walk the buckets the ray passes through
+        auto startX = o.x + (d.x * tEnter);
+        auto startY = o.y + (d.y * tEnter);
+        auto x = std::clamp(static_cast<int>(std::floor(startX)), 0, static_cast<int>(buckets.getWidth()) - 1);
+        auto y = std::clamp(static_cast<int>(std::floor(startY)), 0, static_cast<int>(buckets.getHeight()) - 1);
+
+        auto infinity = std::numeric_limits<float>::infinity();
+        int stepX = d.x > 0.0f ? 1 : -1;
+        int stepY = d.y > 0.0f ? 1 : -1;
+        auto tDeltaX = d.x != 0.0f ? std::abs(1.0f / d.x) : infinity;
+        auto tDeltaY = d.y != 0.0f ? std::abs(1.0f / d.y) : infinity;
+        auto tNextX = d.x != 0.0f ? ((x + (stepX > 0 ? 1 : 0)) - o.x) / d.x : infinity;
+        auto tNextY = d.y != 0.0f ? ((y + (stepY > 0 ? 1 : 0)) - o.y) / d.y : infinity;
+
+        while (true)
+        {
+            collectBucket(x, y, result);
+
+            if (tNextX == infinity && tNextY == infinity)
+            {
+                break;
+            }
+
+            if (tNextX < tNextY)
+            {
+                if (tNextX > tExit)
+                {
+                    break;
+                }
+                x += stepX;
+                tNextX += tDeltaX;
+            }
+            else
+            {
+                if (tNextY > tExit)
+                {
+                    break;
+                }
+                y += stepY;
+                tNextY += tDeltaY;
+            }
+
+            if (x < 0 || y < 0 || x >= static_cast<int>(buckets.getWidth()) || y >= static_cast<int>(buckets.getHeight()))
+            {
+                break;
+            }
+        }
+
+        sortAndDeduplicate(result);
+        return result;
+    }
+
+    void UnitSpatialIndex::clear()
+    {
+        for (std::size_t y = 0; y < buckets.getHeight(); ++y)
+        {
+            for (std::size_t x = 0; x < buckets.getWidth(); ++x)
+            {
+                buckets.get(x, y).clear();
+            }
+        }
+    }
+
+    bool UnitSpatialIndex::BucketRange::operator==(const BucketRange& rhs) const
+    {
+        return minX == rhs.minX && minY == rhs.minY && maxX == rhs.maxX && maxY == rhs.maxY;
+    }
+
+    bool UnitSpatialIndex::BucketRange::operator!=(const BucketRange& rhs) const
+    {
+        return !(rhs == *this);
+    }
+
+    std::optional<UnitSpatialIndex::BucketRange> UnitSpatialIndex::toBucketRange(int minCellX, int minCellY, int maxCellX, int maxCellY) const
+    {
+        auto maxBucketX = static_cast<int>(buckets.getWidth()) - 1;
+        auto maxBucketY = static_cast<int>(buckets.getHeight()) - 1;
+        auto bucketSize = static_cast<int>(cellsPerBucket);
+
+        if (maxCellX < 0 || maxCellY < 0 || minCellX > maxCellX || minCellY > maxCellY)
+        {
+            return std::nullopt;
+        }
+
+        auto minX = std::max(minCellX, 0) / bucketSize;
+        auto minY = std::max(minCellY, 0) / bucketSize;
+        if (minX > maxBucketX || minY > maxBucketY)
+        {
+            return std::nullopt;
+        }
+
+        auto maxX = std::min(maxCellX / bucketSize, maxBucketX);
+        auto maxY = std::min(maxCellY / bucketSize, maxBucketY);
+
+        return BucketRange{
+            static_cast<std::size_t>(minX),
+            static_cast<std::size_t>(minY),
+            static_cast<std::size_t>(maxX),
+            static_cast<std::size_t>(maxY)};
+    }
+
+    std::optional<UnitSpatialIndex::BucketRange> UnitSpatialIndex::toBucketRange(const DiscreteRect& rect) const
+    {
+        if (rect.width == 0 || rect.height == 0)
+        {
+            return std::nullopt;
+        }
+
+        return toBucketRange(rect.x, rect.y, rect.x + static_cast<int>(rect.width) - 1, rect.y + static_cast<int>(rect.height) - 1);
+    }
+
+    std::optional<UnitSpatialIndex::BucketRange> UnitSpatialIndex::toRecordedBucketRange(const DiscreteRect& footprint) const
+    {
+        return toBucketRange(footprint.expand(margin));
+    }
+
+    void UnitSpatialIndex::insertIntoRange(UnitId unitId, const BucketRange& range)
+    {
+        for (auto y = range.minY; y <= range.maxY; ++y)
+        {
+            for (auto x = range.minX; x <= range.maxX; ++x)
+            {
+                buckets.get(x, y).push_back(unitId);
+            }
+        }
+    }
+
+    void UnitSpatialIndex::removeFromRange(UnitId unitId, const BucketRange& range)
+    {
+        for (auto y = range.minY; y <= range.maxY; ++y)
+        {
+            for (auto x = range.minX; x <= range.maxX; ++x)
+            {
+                auto& bucket = buckets.get(x, y);
+                auto it = std::find(bucket.begin(), bucket.end(), unitId);
+                assert(it != bucket.end());
+                *it = bucket.back();
+                bucket.pop_back();
+            }
+        }
+    }
+
+    void UnitSpatialIndex::collectBucket(std::size_t x, std::size_t y, std::vector<UnitId>& out) const
+    {
+        const auto& bucket = buckets.get(x, y);
+        out.insert(out.end(), bucket.begin(), bucket.end());
+    }
+
+    std::vector<UnitId> UnitSpatialIndex::collectRange(const std::optional<BucketRange>& range) const
+    {
+        std::vector<UnitId> result;
+        if (!range)
+        {
+            return result;
+        }
+
+        for (auto y = range->minY; y <= range->maxY; ++y)
+        {
+            for (auto x = range->minX; x <= range->maxX; ++x)
+            {
+                collectBucket(x, y, result);
+            }
+        }
+
+        sortAndDeduplicate(result);
+        return result;
+    }
+
+    void UnitSpatialIndex::sortAndDeduplicate(std::vector<UnitId>& ids)
+    {
+        std::sort(ids.begin(), ids.end(), [](UnitId a, UnitId b) { return a.value < b.value; });
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef RWE_UNITSPATIALINDEX_H
+#define RWE_UNITSPATIALINDEX_H
+
+#include <optional>
+#include <rwe/DiscreteRect.h>
+#include <rwe/Grid.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Vector2f.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Uniform grid of buckets over the heightmap,
+     * recording which units are near each part of the map.
+     * All coordinates are in heightmap cells.
+     *
+     * Each unit is recorded in every bucket touched by its footprint,
+     * expanded by a fixed margin to cover parts of the unit
+     * (such as its selection mesh) that overhang the footprint.
+     * Queries return candidates whose recorded area touches
+     * the queried buckets; callers are expected to do exact tests.
+     * Results are sorted by ID and contain no duplicates.
+     */
+    class UnitSpatialIndex
+    {
+    private:
+        unsigned int cellsPerBucket;
+        unsigned int margin;
+        Grid<std::vector<UnitId>> buckets;
+
+    public:
+        static constexpr unsigned int DefaultCellsPerBucket = 8;
+        static constexpr unsigned int DefaultMargin = 2;
+
+        UnitSpatialIndex(
+            std::size_t widthInCells,
+            std::size_t heightInCells,
+            unsigned int cellsPerBucket = DefaultCellsPerBucket,
+            unsigned int margin = DefaultMargin);
+
+        void insert(UnitId unitId, const DiscreteRect& footprint);
+
+        void remove(UnitId unitId, const DiscreteRect& footprint);
+
+        /**
+         * Updates the unit's recorded area.
+         * Buckets are only touched if the set of buckets covered has changed.
+         */
+        void move(UnitId unitId, const DiscreteRect& oldFootprint, const DiscreteRect& newFootprint);
+
+        std::vector<UnitId> queryRect(const DiscreteRect& rect) const;
+
+        std::vector<UnitId> queryCircle(const Vector2f& center, float radius) const;
+
+        /**
+         * Returns units near the path of the given ray across the map,
+         * projected onto the ground plane.
+         */
+        std::vector<UnitId> queryRay(const Vector2f& origin, const Vector2f& direction) const;
+
+        void clear();
+
+    private:
+        struct BucketRange
+        {
+            std::size_t minX;
+            std::size_t minY;
+            std::size_t maxX;
+            std::size_t maxY;
+
+            bool operator==(const BucketRange& rhs) const;
+            bool operator!=(const BucketRange& rhs) const;
+        };
+
+        /**
+         * Returns the buckets touched by the given rectangle,
+         * clamped to the edge of the map,
+         * or an empty range if the rectangle lies entirely off the map.
+         */
+        std::optional<BucketRange> toBucketRange(int minCellX, int minCellY, int maxCellX, int maxCellY) const;
+
+        std::optional<BucketRange> toBucketRange(const DiscreteRect& rect) const;
+
+        std::optional<BucketRange> toRecordedBucketRange(const DiscreteRect& footprint) const;
+
+        void insertIntoRange(UnitId unitId, const BucketRange& range);
+
+        void removeFromRange(UnitId unitId, const BucketRange& range);
+
+        void collectBucket(std::size_t x, std::size_t y, std::vector<UnitId>& out) const;
+
+        std::vector<UnitId> collectRange(const std::optional<BucketRange>& range) const;
+
+        static void sortAndDeduplicate(std::vector<UnitId>& ids);
+    };
+}
+
+#endif
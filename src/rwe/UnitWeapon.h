@@ -40,6 +40,9 @@ namespace rwe
 
     struct UnitWeapon
     {
+        /** The name of the weapon's definition in the unit database. */
+        std::string weaponType;
+
         float maxRange;
 
         float reloadTime;
@@ -0,0 +1,96 @@
+#include "WalkableGridCache.h"
+#include <rwe/StateHasher.h>
+#include <rwe/snapshot/SnapshotReader.h>
+#include <rwe/snapshot/SnapshotWriter.h>
+#include <stdexcept>
+
+namespace rwe
+{
+    static const std::uint32_t WalkableGridCacheMagic = 0x4b4c4157; // "WALK"
+
+    /** Bump this whenever the way walkable grids are computed changes. */
+    static const std::uint32_t WalkableGridCacheVersion = 1;
+
+    std::uint64_t computeWalkableGridCacheKey(
+        const Grid<unsigned char>& heights,
+        unsigned int waterLevel,
+        const std::vector<MovementClass>& movementClasses)
+    {
+        StateHasher hasher(WalkableGridCacheVersion);
+        hasher.add(heights.getWidth());
+        hasher.add(heights.getHeight());
+        for (auto h : heights.getVector())
+        {
+            hasher.add(h);
+        }
+        hasher.add(waterLevel);
+
+        hasher.add(movementClasses.size());
+        for (const auto& mc : movementClasses)
+        {
+            hasher.add(mc.name.size());
+            for (auto c : mc.name)
+            {
+                hasher.add(static_cast<unsigned char>(c));
+            }
+            hasher.add(mc.footprintX);
+            hasher.add(mc.footprintZ);
+            hasher.add(mc.minWaterDepth);
+            hasher.add(mc.maxWaterDepth);
+            hasher.add(mc.maxSlope);
+            hasher.add(mc.maxWaterSlope);
+        }
+
+        return hasher.get();
+    }
+
+    void writeWalkableGridCache(std::ostream& stream, std::uint64_t key, const std::vector<Grid<char>>& grids)
+    {
+        SnapshotWriter writer(&stream);
+        writer.writeUint32(WalkableGridCacheMagic);
+        writer.writeUint32(WalkableGridCacheVersion);
+        writer.writeUint64(key);
+
+        writer.writeCount(grids.size());
+        for (const auto& grid : grids)
+        {
+            writer.writeCount(grid.getWidth());
+            writer.writeCount(grid.getHeight());
+
+            // one byte per cell, stored as a string to write it in one go
+            std::string cells(grid.getData(), grid.getData() + (grid.getWidth() * grid.getHeight()));
+            writer.writeString(cells);
+        }
+    }
+
+    std::optional<std::vector<Grid<char>>> readWalkableGridCache(std::istream& stream, std::uint64_t key)
+    {
+        SnapshotReader reader(&stream);
+        if (reader.readUint32() != WalkableGridCacheMagic)
+        {
+            throw std::runtime_error("Walkable grid cache is malformed: bad magic number");
+        }
+
+        if (reader.readUint32() != WalkableGridCacheVersion || reader.readUint64() != key)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<Grid<char>> grids;
+        auto count = reader.readCount();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto width = reader.readCount();
+            auto height = reader.readCount();
+            auto cells = reader.readString();
+            if (cells.size() != width * height)
+            {
+                throw std::runtime_error("Walkable grid cache is malformed: wrong grid size");
+            }
+
+            grids.emplace_back(width, height, std::vector<char>(cells.begin(), cells.end()));
+        }
+
+        return grids;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef RWE_WALKABLEGRIDCACHE_H
+#define RWE_WALKABLEGRIDCACHE_H
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <rwe/Grid.h>
+#include <rwe/MovementClass.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Returns a key identifying the walkable grids computed from these inputs.
+     * Changing the heightmap, water level or any movement class changes the key,
+     * as does reordering the movement classes.
+     */
+    std::uint64_t computeWalkableGridCacheKey(
+        const Grid<unsigned char>& heights,
+        unsigned int waterLevel,
+        const std::vector<MovementClass>& movementClasses);
+
+    void writeWalkableGridCache(std::ostream& stream, std::uint64_t key, const std::vector<Grid<char>>& grids);
+
+    /**
+     * Reads grids written by writeWalkableGridCache.
+     * Returns nothing if the cache was written for a different key.
+     * Throws std::runtime_error if the cache is malformed.
+     */
+    std::optional<std::vector<Grid<char>>> readWalkableGridCache(std::istream& stream, std::uint64_t key);
+}
+
+#endif
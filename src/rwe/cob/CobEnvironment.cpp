@@ -47,6 +47,7 @@ namespace rwe
     {
         const auto& functionInfo = _script->functions.at(functionId);
         auto& thread = threads.emplace_back(std::make_unique<CobThread>(functionInfo.name, signalMask));
+        thread->randomSerial = nextThreadSerial++;
         thread->callStack.emplace(functionInfo.address, params);
         readyQueue.push_back(thread.get());
         return thread.get();
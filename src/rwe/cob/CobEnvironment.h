@@ -2,6 +2,7 @@
 #define RWE_COBENVIRONMENT_H
 
 #include <boost/variant.hpp>
+#include <cstdint>
 #include <memory>
 #include <rwe/Cob.h>
 #include <rwe/GameTime.h>
@@ -82,6 +83,12 @@ namespace rwe
         std::deque<std::pair<BlockedStatus, CobThread*>> blockedQueue;
         std::deque<CobThread*> finishedQueue;
 
+        /** Seeds the random numbers drawn by this environment's scripts. */
+        std::uint64_t randomSeed{0};
+
+        /** The random stream serial to give to the next scheduled thread. */
+        unsigned int nextThreadSerial{1};
+
     public:
         explicit CobEnvironment(const CobScript* _script);
 
@@ -1,7 +1,6 @@
 #include "CobExecutionContext.h"
-#include <rwe/SceneManager.h>
+#include <rwe/StateHasher.h>
 #include <rwe/cob/CobConstants.h>
-#include <rwe/cob/CobOpCode.h>
 
 namespace rwe
 {
@@ -9,204 +8,205 @@ namespace rwe
         GameSimulation* sim,
         CobEnvironment* env,
         CobThread* thread,
-        UnitId unitId) : sim(sim), env(env), thread(thread), unitId(unitId)
+        UnitId unitId) : sim(sim), env(env), thread(thread), unitId(unitId), program(env->script()->program)
     {
     }
 
     CobEnvironment::Status CobExecutionContext::execute()
     {
+        if (!thread->callStack.empty())
+        {
+            instructionIndex = program.getIndex(thread->callStack.top().instructionIndex);
+        }
+
         while (!thread->callStack.empty())
         {
-            auto instruction = nextInstruction();
-            switch (static_cast<OpCode>(instruction))
+            const auto& instruction = program.instructions[instructionIndex++];
+            switch (instruction.op)
             {
-                case OpCode::RAND:
+                case CobOp::Rand:
                     randomNumber();
                     break;
 
-                case OpCode::ADD:
+                case CobOp::Add:
                     add();
                     break;
-                case OpCode::SUB:
+                case CobOp::Sub:
                     subtract();
                     break;
-                case OpCode::MUL:
+                case CobOp::Mul:
                     multiply();
                     break;
-                case OpCode::DIV:
+                case CobOp::Div:
                     divide();
                     break;
 
-                case OpCode::SET_LESS:
+                case CobOp::SetLess:
                     compareLessThan();
                     break;
-                case OpCode::SET_LESS_OR_EQUAL:
+                case CobOp::SetLessOrEqual:
                     compareLessThanOrEqual();
                     break;
-                case OpCode::SET_EQUAL:
+                case CobOp::SetEqual:
                     compareEqual();
                     break;
-                case OpCode::SET_NOT_EQUAL:
+                case CobOp::SetNotEqual:
                     compareNotEqual();
                     break;
-                case OpCode::SET_GREATER:
+                case CobOp::SetGreater:
                     compareGreaterThan();
                     break;
-                case OpCode::SET_GREATER_OR_EQUAL:
+                case CobOp::SetGreaterOrEqual:
                     compareGreaterThanOrEqual();
                     break;
 
-                case OpCode::JUMP:
-                    jump();
+                case CobOp::Jump:
+                    jump(instruction);
                     break;
-                case OpCode::JUMP_IF_ZERO:
-                    jumpIfZero();
+                case CobOp::JumpIfZero:
+                    jumpIfZero(instruction);
                     break;
 
-                case OpCode::LOGICAL_AND:
+                case CobOp::LogicalAnd:
                     logicalAnd();
                     break;
-                case OpCode::LOGICAL_OR:
+                case CobOp::LogicalOr:
                     logicalOr();
                     break;
-                case OpCode::LOGICAL_XOR:
+                case CobOp::LogicalXor:
                     logicalXor();
                     break;
-                case OpCode::LOGICAL_NOT:
+                case CobOp::LogicalNot:
                     logicalNot();
                     break;
 
-                case OpCode::BITWISE_AND:
+                case CobOp::BitwiseAnd:
                     bitwiseAnd();
                     break;
-                case OpCode::BITWISE_OR:
+                case CobOp::BitwiseOr:
                     bitwiseOr();
                     break;
-                case OpCode::BITWISE_XOR:
+                case CobOp::BitwiseXor:
                     bitwiseXor();
                     break;
-                case OpCode::BITWISE_NOT:
+                case CobOp::BitwiseNot:
                     bitwiseNot();
                     break;
 
-                case OpCode::MOVE:
-                    moveObject();
+                case CobOp::Move:
+                    moveObject(instruction);
                     break;
-                case OpCode::MOVE_NOW:
-                    moveObjectNow();
+                case CobOp::MoveNow:
+                    moveObjectNow(instruction);
                     break;
-                case OpCode::TURN:
-                    turnObject();
+                case CobOp::Turn:
+                    turnObject(instruction);
                     break;
-                case OpCode::TURN_NOW:
-                    turnObjectNow();
+                case CobOp::TurnNow:
+                    turnObjectNow(instruction);
                     break;
-                case OpCode::SPIN:
-                    spinObject();
+                case CobOp::Spin:
+                    spinObject(instruction);
                     break;
-                case OpCode::STOP_SPIN:
-                    stopSpinObject();
+                case CobOp::StopSpin:
+                    stopSpinObject(instruction);
                     break;
-                case OpCode::EXPLODE:
+                case CobOp::Explode:
                     explode();
                     break;
-                case OpCode::EMIT_SFX:
+                case CobOp::EmitSfx:
                     emitSmoke();
                     break;
-                case OpCode::SHOW:
-                    showObject();
-                    break;
-                case OpCode::HIDE:
-                    hideObject();
+                case CobOp::Show:
+                    showObject(instruction);
                     break;
-                case OpCode::SHADE:
-                    enableShading();
+                case CobOp::Hide:
+                    hideObject(instruction);
                     break;
-                case OpCode::DONT_SHADE:
-                    disableShading();
+                case CobOp::Shade:
+                    enableShading(instruction);
                     break;
-                case OpCode::CACHE:
-                    enableCaching();
+                case CobOp::DontShade:
+                    disableShading(instruction);
                     break;
-                case OpCode::DONT_CACHE:
-                    disableCaching();
-                    break;
-                case OpCode::ATTACH_UNIT:
+                case CobOp::AttachUnit:
                     attachUnit();
                     break;
-                case OpCode::DROP_UNIT:
+                case CobOp::DropUnit:
                     detachUnit();
                     break;
 
-                case OpCode::WAIT_FOR_MOVE:
+                case CobOp::WaitForMove:
                 {
-                    auto object = nextInstruction();
-                    auto axis = nextInstructionAsAxis();
-
-                    return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Move(object, axis));
+                    saveInstructionIndex();
+                    auto object = static_cast<unsigned int>(instruction.operand);
+                    return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Move(object, instruction.axis));
                 }
-                case OpCode::WAIT_FOR_TURN:
+                case CobOp::WaitForTurn:
                 {
-                    auto object = nextInstruction();
-                    auto axis = nextInstructionAsAxis();
-
-                    return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Turn(object, axis));
+                    saveInstructionIndex();
+                    auto object = static_cast<unsigned int>(instruction.operand);
+                    return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Turn(object, instruction.axis));
                 }
-                case OpCode::SLEEP:
+                case CobOp::Sleep:
                 {
+                    saveInstructionIndex();
                     auto duration = pop();
 
-                    auto ticksToWait = GameTimeDelta(duration / SceneManager::TickInterval);
+                    auto ticksToWait = deltaMillisecondsToTicks(duration);
                     auto currentTime = sim->gameTime;
 
                     return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Sleep(currentTime + ticksToWait));
                 }
 
-                case OpCode::CALL_SCRIPT:
-                    callScript();
+                case CobOp::CallScript:
+                    callScript(instruction);
                     break;
-                case OpCode::RETURN:
+                case CobOp::Return:
                     returnFromScript();
                     break;
-                case OpCode::START_SCRIPT:
-                    startScript();
+                case CobOp::StartScript:
+                    startScript(instruction);
                     break;
 
-                case OpCode::SIGNAL:
+                case CobOp::Signal:
                     sendSignal();
                     break;
-                case OpCode::SET_SIGNAL_MASK:
+                case CobOp::SetSignalMask:
                     setSignalMask();
                     break;
 
-                case OpCode::CREATE_LOCAL_VAR:
+                case CobOp::CreateLocalVar:
                     createLocalVariable();
                     break;
-                case OpCode::PUSH_CONSTANT:
-                    pushConstant();
+                case CobOp::PushConstant:
+                    pushConstant(instruction);
                     break;
-                case OpCode::PUSH_LOCAL_VAR:
-                    pushLocalVariable();
+                case CobOp::PushLocalVar:
+                    pushLocalVariable(instruction);
                     break;
-                case OpCode::POP_LOCAL_VAR:
-                    popLocalVariable();
+                case CobOp::PopLocalVar:
+                    popLocalVariable(instruction);
                     break;
-                case OpCode::PUSH_STATIC:
-                    pushStaticVariable();
+                case CobOp::PushStatic:
+                    pushStaticVariable(instruction);
                     break;
-                case OpCode::POP_STATIC:
-                    popStaticVariable();
+                case CobOp::PopStatic:
+                    popStaticVariable(instruction);
                     break;
-                case OpCode::POP_STACK:
+                case CobOp::PopStack:
                     popStackOperation();
                     break;
 
-                case OpCode::GET_UNIT_VALUE:
+                case CobOp::GetUnitValue:
                     getUnitValue();
                     break;
 
-                default:
-                    throw std::runtime_error("Unsupported opcode " + std::to_string(instruction));
+                case CobOp::Nop:
+                    break;
+
+                case CobOp::Invalid:
+                    throw std::runtime_error(program.errors[instruction.operand]);
             }
         }
 
@@ -219,8 +219,15 @@ namespace rwe
         auto low = pop();
         auto range = high - low;
 
-        // FIXME: replace with deterministic RNG source
-        auto value = (std::rand() % range) + low;
+        // Each draw is a pure function of the environment's seed,
+        // the thread that made it and how many draws came before,
+        // so results do not depend on which worker thread runs the script.
+        StateHasher hasher(env->randomSeed);
+        hasher.add(thread->randomSerial);
+        hasher.add(thread->randomCalls++);
+        hasher.add(sim->gameTime.value);
+
+        auto value = range > 0 ? static_cast<int>(hasher.get() % static_cast<std::uint64_t>(range)) + low : low;
         push(value);
     }
 
@@ -294,19 +301,17 @@ namespace rwe
         push(a >= b ? CobTrue : CobFalse);
     }
 
-    void CobExecutionContext::jump()
+    void CobExecutionContext::jump(const CobInstruction& instruction)
     {
-        auto jumpOffset = nextInstruction();
-        thread->callStack.top().instructionIndex = jumpOffset;
+        instructionIndex = static_cast<unsigned int>(instruction.operand);
     }
 
-    void CobExecutionContext::jumpIfZero()
+    void CobExecutionContext::jumpIfZero(const CobInstruction& instruction)
     {
-        auto jumpOffset = nextInstruction();
         auto value = pop();
         if (value == 0)
         {
-            thread->callStack.top().instructionIndex = jumpOffset;
+            instructionIndex = static_cast<unsigned int>(instruction.operand);
         }
     }
 
@@ -364,121 +369,107 @@ namespace rwe
         push(~v);
     }
 
-    void CobExecutionContext::moveObject()
+    void CobExecutionContext::moveObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto position = popPosition();
         if (axis == Axis::X) // flip x-axis translations to match our right-handed coordinates
         {
             position = -position;
         }
         auto speed = popSpeed();
-        sim->moveObject(unitId, getObjectName(object), axis, position, speed);
+        sim->moveObject(unitId, object, axis, position, speed);
     }
 
-    void CobExecutionContext::moveObjectNow()
+    void CobExecutionContext::moveObjectNow(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto position = popPosition();
         if (axis == Axis::X) // flip x-axis translations to match our right-handed coordinates
         {
             position = -position;
         }
-        sim->moveObjectNow(unitId, getObjectName(object), axis, position);
+        sim->moveObjectNow(unitId, object, axis, position);
     }
 
-    void CobExecutionContext::turnObject()
+    void CobExecutionContext::turnObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto angle = popAngle();
         if (axis == Axis::Z) // flip z-axis rotations to match our right-handed coordinates
         {
             angle = TaAngle(-angle.value);
         }
         auto speed = popAngularSpeed();
-        sim->turnObject(unitId, getObjectName(object), axis, toRadians(angle), speed);
+        sim->turnObject(unitId, object, axis, toRadians(angle), speed);
     }
 
-    void CobExecutionContext::turnObjectNow()
+    void CobExecutionContext::turnObjectNow(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto angle = popAngle();
         if (axis == Axis::Z) // flip z-axis rotations to match our right-handed coordinates
         {
             angle = TaAngle(-angle.value);
         }
-        sim->turnObjectNow(unitId, getObjectName(object), axis, toRadians(angle));
+        sim->turnObjectNow(unitId, object, axis, toRadians(angle));
     }
 
-    void CobExecutionContext::spinObject()
+    void CobExecutionContext::spinObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto targetSpeed = popSignedAngularSpeed();
         auto acceleration = popAngularSpeed();
-        sim->spinObject(unitId, getObjectName(object), axis, targetSpeed, acceleration);
+        sim->spinObject(unitId, object, axis, targetSpeed, acceleration);
     }
 
-    void CobExecutionContext::stopSpinObject()
+    void CobExecutionContext::stopSpinObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        auto axis = nextInstructionAsAxis();
+        auto object = instruction.operand;
+        auto axis = instruction.axis;
         auto deceleration = popAngularSpeed();
-        sim->stopSpinObject(unitId, getObjectName(object), axis, deceleration);
+        sim->stopSpinObject(unitId, object, axis, deceleration);
     }
 
     void CobExecutionContext::explode()
     {
-        auto object = nextInstruction();
         auto explosionType = pop();
         // TODO: this
     }
 
     void CobExecutionContext::emitSmoke()
     {
-        auto piece = nextInstruction();
         auto smokeType = pop();
         // TODO: this
     }
 
-    void CobExecutionContext::showObject()
-    {
-        auto object = nextInstruction();
-        sim->showObject(unitId, getObjectName(object));
-    }
-
-    void CobExecutionContext::hideObject()
+    void CobExecutionContext::showObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        sim->hideObject(unitId, getObjectName(object));
+        auto object = instruction.operand;
+        sim->showObject(unitId, object);
     }
 
-    void CobExecutionContext::enableShading()
+    void CobExecutionContext::hideObject(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        sim->enableShading(unitId, getObjectName(object));
+        auto object = instruction.operand;
+        sim->hideObject(unitId, object);
     }
 
-    void CobExecutionContext::disableShading()
+    void CobExecutionContext::enableShading(const CobInstruction& instruction)
     {
-        auto object = nextInstruction();
-        sim->disableShading(unitId, getObjectName(object));
+        auto object = instruction.operand;
+        sim->enableShading(unitId, object);
     }
 
-    void CobExecutionContext::enableCaching()
+    void CobExecutionContext::disableShading(const CobInstruction& instruction)
     {
-        /*auto object = */nextInstruction();
-        // do nothing, RWE does not have the concept of caching
-    }
-
-    void CobExecutionContext::disableCaching()
-    {
-        /*auto object = */nextInstruction();
-        // do nothing, RWE does not have the concept of caching
+        auto object = instruction.operand;
+        sim->disableShading(unitId, object);
     }
 
     void CobExecutionContext::attachUnit()
@@ -499,12 +490,15 @@ namespace rwe
         thread->returnValue = pop();
         thread->returnLocals = thread->callStack.top().locals;
         thread->callStack.pop();
+        if (!thread->callStack.empty())
+        {
+            instructionIndex = program.getIndex(thread->callStack.top().instructionIndex);
+        }
     }
 
-    void CobExecutionContext::callScript()
+    void CobExecutionContext::callScript(const CobInstruction& instruction)
     {
-        auto functionId = nextInstruction();
-        auto paramCount = nextInstruction();
+        auto paramCount = instruction.paramCount;
 
         // collect up the parameters
         std::vector<int> params(paramCount);
@@ -513,14 +507,15 @@ namespace rwe
             params[i] = pop();
         }
 
-        const auto& functionInfo = env->script()->functions.at(functionId);
-        thread->callStack.emplace(functionInfo.address, params);
+        saveInstructionIndex();
+        instructionIndex = static_cast<unsigned int>(instruction.operand);
+        thread->callStack.emplace(program.instructions[instructionIndex].address, params);
     }
 
-    void CobExecutionContext::startScript()
+    void CobExecutionContext::startScript(const CobInstruction& instruction)
     {
-        auto functionId = nextInstruction();
-        auto paramCount = nextInstruction();
+        auto functionId = static_cast<unsigned int>(instruction.operand);
+        auto paramCount = instruction.paramCount;
 
         std::vector<int> params(paramCount);
         for (unsigned int i = 0; i < paramCount; ++i)
@@ -552,36 +547,34 @@ namespace rwe
         thread->callStack.top().localCount += 1;
     }
 
-    void CobExecutionContext::pushConstant()
+    void CobExecutionContext::pushConstant(const CobInstruction& instruction)
     {
-        auto constant = nextInstruction();
-        push(constant);
+        push(instruction.operand);
     }
 
-    void CobExecutionContext::pushLocalVariable()
+    void CobExecutionContext::pushLocalVariable(const CobInstruction& instruction)
     {
-        auto variableId = nextInstruction();
+        auto variableId = static_cast<unsigned int>(instruction.operand);
         push(thread->callStack.top().locals.at(variableId));
     }
 
-    void CobExecutionContext::popLocalVariable()
+    void CobExecutionContext::popLocalVariable(const CobInstruction& instruction)
     {
-        auto variableId = nextInstruction();
+        auto variableId = static_cast<unsigned int>(instruction.operand);
         auto value = pop();
         thread->callStack.top().locals.at(variableId) = value;
     }
 
-    void CobExecutionContext::pushStaticVariable()
+    void CobExecutionContext::pushStaticVariable(const CobInstruction& instruction)
     {
-        auto variableId = nextInstruction();
-        push(env->getStatic(variableId));
+        // the index was checked against the script's static variables when it was decoded
+        push(env->_statics[instruction.operand]);
     }
 
-    void CobExecutionContext::popStaticVariable()
+    void CobExecutionContext::popStaticVariable(const CobInstruction& instruction)
     {
-        auto variableId = nextInstruction();
         auto value = pop();
-        env->setStatic(variableId, value);
+        env->_statics[instruction.operand] = value;
     }
 
     void CobExecutionContext::popStackOperation()
@@ -654,29 +647,8 @@ namespace rwe
         thread->stack.push(val);
     }
 
-    Axis CobExecutionContext::nextInstructionAsAxis()
-    {
-        auto val = nextInstruction();
-        switch (val)
-        {
-            case 0:
-                return Axis::X;
-            case 1:
-                return Axis::Y;
-            case 2:
-                return Axis::Z;
-            default:
-                throw std::runtime_error("Invalid axis: " + std::to_string(val));
-        }
-    }
-
-    unsigned int CobExecutionContext::nextInstruction()
-    {
-        return env->script()->instructions.at(thread->callStack.top().instructionIndex++);
-    }
-
-    const std::string& CobExecutionContext::getObjectName(unsigned int objectId)
+    void CobExecutionContext::saveInstructionIndex()
     {
-        return env->_script->pieces.at(objectId);
+        thread->callStack.top().instructionIndex = program.instructions[instructionIndex].address;
     }
 }
@@ -3,6 +3,7 @@
 
 #include <rwe/GameSimulation.h>
 #include <rwe/cob/CobEnvironment.h>
+#include <rwe/cob/CobProgram.h>
 
 namespace rwe
 {
@@ -13,6 +14,14 @@ namespace rwe
         CobEnvironment* const env;
         CobThread* const thread;
         const UnitId unitId;
+        const CobProgram& program;
+
+        /**
+         * The index in program of the next instruction to run.
+         * The call stack's top frame is only brought up to date
+         * when the thread stops running or calls another function.
+         */
+        unsigned int instructionIndex{0};
 
     public:
         CobExecutionContext(GameSimulation* sim, CobEnvironment* env, CobThread* thread, UnitId unitId);
@@ -46,9 +55,9 @@ namespace rwe
         void compareGreaterThanOrEqual();
 
         // control flow
-        void jump();
+        void jump(const CobInstruction& instruction);
 
-        void jumpIfZero();
+        void jumpIfZero(const CobInstruction& instruction);
 
         // boolean logic
         void logicalAnd();
@@ -69,33 +78,29 @@ namespace rwe
         void bitwiseNot();
 
         // control object pieces
-        void moveObject();
+        void moveObject(const CobInstruction& instruction);
 
-        void moveObjectNow();
+        void moveObjectNow(const CobInstruction& instruction);
 
-        void turnObject();
+        void turnObject(const CobInstruction& instruction);
 
-        void turnObjectNow();
+        void turnObjectNow(const CobInstruction& instruction);
 
-        void spinObject();
+        void spinObject(const CobInstruction& instruction);
 
-        void stopSpinObject();
+        void stopSpinObject(const CobInstruction& instruction);
 
         void explode();
 
         void emitSmoke();
 
-        void showObject();
-
-        void hideObject();
+        void showObject(const CobInstruction& instruction);
 
-        void enableShading();
+        void hideObject(const CobInstruction& instruction);
 
-        void disableShading();
+        void enableShading(const CobInstruction& instruction);
 
-        void enableCaching();
-
-        void disableCaching();
+        void disableShading(const CobInstruction& instruction);
 
         void attachUnit();
 
@@ -104,9 +109,9 @@ namespace rwe
         // script dispatch and return
         void returnFromScript();
 
-        void callScript();
+        void callScript(const CobInstruction& instruction);
 
-        void startScript();
+        void startScript(const CobInstruction& instruction);
 
         // signalling
         void sendSignal();
@@ -116,15 +121,15 @@ namespace rwe
         // variables
         void createLocalVariable();
 
-        void pushConstant();
+        void pushConstant(const CobInstruction& instruction);
 
-        void pushLocalVariable();
+        void pushLocalVariable(const CobInstruction& instruction);
 
-        void popLocalVariable();
+        void popLocalVariable(const CobInstruction& instruction);
 
-        void pushStaticVariable();
+        void pushStaticVariable(const CobInstruction& instruction);
 
-        void popStaticVariable();
+        void popStaticVariable(const CobInstruction& instruction);
 
         void popStackOperation();
 
@@ -144,10 +149,8 @@ namespace rwe
         unsigned int popSignalMask();
         void push(int val);
 
-        unsigned int nextInstruction();
-        Axis nextInstructionAsAxis();
-
-        const std::string& getObjectName(unsigned int objectId);
+        /** Saves where the thread has got to in its top call stack frame. */
+        void saveInstructionIndex();
     };
 }
 
@@ -18,14 +18,12 @@ namespace rwe
 
         bool operator()(const CobEnvironment::BlockedStatus::Move& condition) const
         {
-            const auto& pieceName = env->_script->pieces.at(condition.object);
-            return !simulation->isPieceMoving(unitId, pieceName, condition.axis);
+            return !simulation->isPieceMoving(unitId, condition.object, condition.axis);
         }
 
         bool operator()(const CobEnvironment::BlockedStatus::Turn& condition) const
         {
-            const auto& pieceName = env->_script->pieces.at(condition.object);
-            return !simulation->isPieceTurning(unitId, pieceName, condition.axis);
+            return !simulation->isPieceTurning(unitId, condition.object, condition.axis);
         }
 
         bool operator()(const CobEnvironment::BlockedStatus::Sleep& condition) const
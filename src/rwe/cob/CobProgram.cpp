@@ -0,0 +1,335 @@
+#include "CobProgram.h"
+#include <array>
+#include <optional>
+#include <rwe/Cob.h>
+#include <rwe/cob/CobOpCode.h>
+#include <utility>
+
+namespace rwe
+{
+    unsigned int CobProgram::getIndex(unsigned int address) const
+    {
+        if (address >= addressIndices.size())
+        {
+            return static_cast<unsigned int>(instructions.size() - 1);
+        }
+
+        return addressIndices[address];
+    }
+
+    /** The operands that follow an opcode in the bytecode. */
+    enum class CobOperands
+    {
+        None,
+
+        /** A piece the instruction acts on. */
+        Piece,
+
+        /** A piece the instruction reads but does not use yet. */
+        IgnoredPiece,
+
+        PieceAndAxis,
+        Constant,
+        LocalVariable,
+        StaticVariable,
+
+        /** An address to jump to. */
+        JumpTarget,
+
+        /** A function index followed by a parameter count. */
+        Function,
+    };
+
+    struct CobOpInfo
+    {
+        CobOp op;
+        CobOperands operands;
+    };
+
+    static std::optional<CobOpInfo> getOpInfo(std::uint32_t instruction)
+    {
+        switch (static_cast<OpCode>(instruction))
+        {
+            case OpCode::RAND:
+                return CobOpInfo{CobOp::Rand, CobOperands::None};
+
+            case OpCode::ADD:
+                return CobOpInfo{CobOp::Add, CobOperands::None};
+            case OpCode::SUB:
+                return CobOpInfo{CobOp::Sub, CobOperands::None};
+            case OpCode::MUL:
+                return CobOpInfo{CobOp::Mul, CobOperands::None};
+            case OpCode::DIV:
+                return CobOpInfo{CobOp::Div, CobOperands::None};
+
+            case OpCode::SET_LESS:
+                return CobOpInfo{CobOp::SetLess, CobOperands::None};
+            case OpCode::SET_LESS_OR_EQUAL:
+                return CobOpInfo{CobOp::SetLessOrEqual, CobOperands::None};
+            case OpCode::SET_EQUAL:
+                return CobOpInfo{CobOp::SetEqual, CobOperands::None};
+            case OpCode::SET_NOT_EQUAL:
+                return CobOpInfo{CobOp::SetNotEqual, CobOperands::None};
+            case OpCode::SET_GREATER:
+                return CobOpInfo{CobOp::SetGreater, CobOperands::None};
+            case OpCode::SET_GREATER_OR_EQUAL:
+                return CobOpInfo{CobOp::SetGreaterOrEqual, CobOperands::None};
+
+            case OpCode::JUMP:
+                return CobOpInfo{CobOp::Jump, CobOperands::JumpTarget};
+            case OpCode::JUMP_IF_ZERO:
+                return CobOpInfo{CobOp::JumpIfZero, CobOperands::JumpTarget};
+
+            case OpCode::LOGICAL_AND:
+                return CobOpInfo{CobOp::LogicalAnd, CobOperands::None};
+            case OpCode::LOGICAL_OR:
+                return CobOpInfo{CobOp::LogicalOr, CobOperands::None};
+            case OpCode::LOGICAL_XOR:
+                return CobOpInfo{CobOp::LogicalXor, CobOperands::None};
+            case OpCode::LOGICAL_NOT:
+                return CobOpInfo{CobOp::LogicalNot, CobOperands::None};
+
+            case OpCode::BITWISE_AND:
+                return CobOpInfo{CobOp::BitwiseAnd, CobOperands::None};
+            case OpCode::BITWISE_OR:
+                return CobOpInfo{CobOp::BitwiseOr, CobOperands::None};
+            case OpCode::BITWISE_XOR:
+                return CobOpInfo{CobOp::BitwiseXor, CobOperands::None};
+            case OpCode::BITWISE_NOT:
+                return CobOpInfo{CobOp::BitwiseNot, CobOperands::None};
+
+            case OpCode::MOVE:
+                return CobOpInfo{CobOp::Move, CobOperands::PieceAndAxis};
+            case OpCode::MOVE_NOW:
+                return CobOpInfo{CobOp::MoveNow, CobOperands::PieceAndAxis};
+            case OpCode::TURN:
+                return CobOpInfo{CobOp::Turn, CobOperands::PieceAndAxis};
+            case OpCode::TURN_NOW:
+                return CobOpInfo{CobOp::TurnNow, CobOperands::PieceAndAxis};
+            case OpCode::SPIN:
+                return CobOpInfo{CobOp::Spin, CobOperands::PieceAndAxis};
+            case OpCode::STOP_SPIN:
+                return CobOpInfo{CobOp::StopSpin, CobOperands::PieceAndAxis};
+            case OpCode::EXPLODE:
+                return CobOpInfo{CobOp::Explode, CobOperands::IgnoredPiece};
+            case OpCode::EMIT_SFX:
+                return CobOpInfo{CobOp::EmitSfx, CobOperands::IgnoredPiece};
+            case OpCode::SHOW:
+                return CobOpInfo{CobOp::Show, CobOperands::Piece};
+            case OpCode::HIDE:
+                return CobOpInfo{CobOp::Hide, CobOperands::Piece};
+            case OpCode::SHADE:
+                return CobOpInfo{CobOp::Shade, CobOperands::Piece};
+            case OpCode::DONT_SHADE:
+                return CobOpInfo{CobOp::DontShade, CobOperands::Piece};
+            case OpCode::CACHE:
+            case OpCode::DONT_CACHE:
+                // RWE does not have the concept of caching
+                return CobOpInfo{CobOp::Nop, CobOperands::IgnoredPiece};
+            case OpCode::ATTACH_UNIT:
+                return CobOpInfo{CobOp::AttachUnit, CobOperands::None};
+            case OpCode::DROP_UNIT:
+                return CobOpInfo{CobOp::DropUnit, CobOperands::None};
+
+            case OpCode::WAIT_FOR_MOVE:
+                return CobOpInfo{CobOp::WaitForMove, CobOperands::PieceAndAxis};
+            case OpCode::WAIT_FOR_TURN:
+                return CobOpInfo{CobOp::WaitForTurn, CobOperands::PieceAndAxis};
+            case OpCode::SLEEP:
+                return CobOpInfo{CobOp::Sleep, CobOperands::None};
+
+            case OpCode::CALL_SCRIPT:
+                return CobOpInfo{CobOp::CallScript, CobOperands::Function};
+            case OpCode::RETURN:
+                return CobOpInfo{CobOp::Return, CobOperands::None};
+            case OpCode::START_SCRIPT:
+                return CobOpInfo{CobOp::StartScript, CobOperands::Function};
+
+            case OpCode::SIGNAL:
+                return CobOpInfo{CobOp::Signal, CobOperands::None};
+            case OpCode::SET_SIGNAL_MASK:
+                return CobOpInfo{CobOp::SetSignalMask, CobOperands::None};
+
+            case OpCode::CREATE_LOCAL_VAR:
+                return CobOpInfo{CobOp::CreateLocalVar, CobOperands::None};
+            case OpCode::PUSH_CONSTANT:
+                return CobOpInfo{CobOp::PushConstant, CobOperands::Constant};
+            case OpCode::PUSH_LOCAL_VAR:
+                return CobOpInfo{CobOp::PushLocalVar, CobOperands::LocalVariable};
+            case OpCode::POP_LOCAL_VAR:
+                return CobOpInfo{CobOp::PopLocalVar, CobOperands::LocalVariable};
+            case OpCode::PUSH_STATIC:
+                return CobOpInfo{CobOp::PushStatic, CobOperands::StaticVariable};
+            case OpCode::POP_STATIC:
+                return CobOpInfo{CobOp::PopStatic, CobOperands::StaticVariable};
+            case OpCode::POP_STACK:
+                return CobOpInfo{CobOp::PopStack, CobOperands::None};
+
+            case OpCode::GET_UNIT_VALUE:
+                return CobOpInfo{CobOp::GetUnitValue, CobOperands::None};
+
+            default:
+                return std::nullopt;
+        }
+    }
+
+    static unsigned int getOperandCount(CobOperands operands)
+    {
+        switch (operands)
+        {
+            case CobOperands::None:
+                return 0;
+            case CobOperands::PieceAndAxis:
+            case CobOperands::Function:
+                return 2;
+            default:
+                return 1;
+        }
+    }
+
+    static std::optional<Axis> toAxis(std::uint32_t value)
+    {
+        switch (value)
+        {
+            case 0:
+                return Axis::X;
+            case 1:
+                return Axis::Y;
+            case 2:
+                return Axis::Z;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    CobProgram decodeCobProgram(const CobScript& script)
+    {
+        const auto& code = script.instructions;
+        auto codeLength = static_cast<unsigned int>(code.size());
+
+        CobProgram program;
+        program.addressIndices.resize(codeLength + 1);
+        std::vector<bool> isInstructionStart(codeLength + 1, false);
+
+        auto addInvalid = [&program](unsigned int address, const std::string& message) {
+            program.instructions.push_back(CobInstruction{CobOp::Invalid, Axis::X, 0, address, static_cast<int>(program.errors.size())});
+            program.errors.push_back(message);
+        };
+
+        // Jumps and calls, with the bytecode addresses they go to,
+        // to point at instructions once every instruction is decoded.
+        std::vector<std::pair<std::size_t, unsigned int>> targets;
+
+        unsigned int address = 0;
+        while (address < codeLength)
+        {
+            auto start = address;
+            auto word = code[address++];
+            program.addressIndices[start] = static_cast<unsigned int>(program.instructions.size());
+            isInstructionStart[start] = true;
+
+            auto info = getOpInfo(word);
+            if (!info)
+            {
+                addInvalid(start, "Unsupported opcode " + std::to_string(word));
+                continue;
+            }
+
+            auto operandCount = getOperandCount(info->operands);
+            if (codeLength - address < operandCount)
+            {
+                addInvalid(start, "Instruction at address " + std::to_string(start) + " runs past the end of the script");
+                break;
+            }
+
+            std::array<std::uint32_t, 2> operands{0, 0};
+            for (unsigned int i = 0; i < operandCount; ++i)
+            {
+                operands[i] = code[address++];
+            }
+
+            CobInstruction instruction{info->op, Axis::X, 0, start, 0};
+            switch (info->operands)
+            {
+                case CobOperands::None:
+                    break;
+                case CobOperands::Piece:
+                case CobOperands::PieceAndAxis:
+                {
+                    if (operands[0] >= script.pieces.size())
+                    {
+                        addInvalid(start, "Invalid piece: " + std::to_string(operands[0]));
+                        continue;
+                    }
+                    instruction.operand = static_cast<int>(operands[0]);
+
+                    if (info->operands == CobOperands::PieceAndAxis)
+                    {
+                        auto axis = toAxis(operands[1]);
+                        if (!axis)
+                        {
+                            addInvalid(start, "Invalid axis: " + std::to_string(operands[1]));
+                            continue;
+                        }
+                        instruction.axis = *axis;
+                    }
+                    break;
+                }
+                case CobOperands::IgnoredPiece:
+                    break;
+                case CobOperands::Constant:
+                case CobOperands::LocalVariable:
+                    instruction.operand = static_cast<int>(operands[0]);
+                    break;
+                case CobOperands::StaticVariable:
+                    if (operands[0] >= script.staticVariableCount)
+                    {
+                        addInvalid(start, "Invalid static variable: " + std::to_string(operands[0]));
+                        continue;
+                    }
+                    instruction.operand = static_cast<int>(operands[0]);
+                    break;
+                case CobOperands::JumpTarget:
+                    targets.emplace_back(program.instructions.size(), operands[0]);
+                    break;
+                case CobOperands::Function:
+                    if (operands[0] >= script.functions.size())
+                    {
+                        addInvalid(start, "Invalid function: " + std::to_string(operands[0]));
+                        continue;
+                    }
+                    instruction.paramCount = operands[1];
+                    if (info->op == CobOp::CallScript)
+                    {
+                        targets.emplace_back(program.instructions.size(), script.functions[operands[0]].address);
+                    }
+                    else
+                    {
+                        instruction.operand = static_cast<int>(operands[0]);
+                    }
+                    break;
+            }
+
+            program.instructions.push_back(instruction);
+        }
+
+        // Running off the end of the code, or going to an address
+        // in the middle of an instruction, lands here.
+        auto endIndex = static_cast<unsigned int>(program.instructions.size());
+        addInvalid(codeLength, "Reached an address that does not start an instruction");
+        for (unsigned int i = 0; i <= codeLength; ++i)
+        {
+            if (!isInstructionStart[i])
+            {
+                program.addressIndices[i] = endIndex;
+            }
+        }
+
+        for (const auto& [index, targetAddress] : targets)
+        {
+            program.instructions[index].operand = static_cast<int>(program.getIndex(targetAddress));
+        }
+
+        return program;
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef RWE_COBPROGRAM_H
+#define RWE_COBPROGRAM_H
+
+#include <cstdint>
+#include <rwe/util.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    struct CobScript;
+
+    /**
+     * The operations of decoded COB instructions.
+     * Unlike OpCode these are numbered densely,
+     * so dispatching on them compiles to a single jump table.
+     */
+    enum class CobOp : std::uint8_t
+    {
+        Rand,
+
+        Add,
+        Sub,
+        Mul,
+        Div,
+
+        SetLess,
+        SetLessOrEqual,
+        SetEqual,
+        SetNotEqual,
+        SetGreater,
+        SetGreaterOrEqual,
+
+        Jump,
+        JumpIfZero,
+
+        LogicalAnd,
+        LogicalOr,
+        LogicalXor,
+        LogicalNot,
+
+        BitwiseAnd,
+        BitwiseOr,
+        BitwiseXor,
+        BitwiseNot,
+
+        Move,
+        MoveNow,
+        Turn,
+        TurnNow,
+        Spin,
+        StopSpin,
+        Explode,
+        EmitSfx,
+        Show,
+        Hide,
+        Shade,
+        DontShade,
+        AttachUnit,
+        DropUnit,
+
+        WaitForMove,
+        WaitForTurn,
+        Sleep,
+
+        CallScript,
+        Return,
+        StartScript,
+
+        Signal,
+        SetSignalMask,
+
+        CreateLocalVar,
+        PushConstant,
+        PushLocalVar,
+        PopLocalVar,
+        PushStatic,
+        PopStatic,
+        PopStack,
+
+        GetUnitValue,
+
+        /** Does nothing. CACHE and DONT_CACHE decode to this. */
+        Nop,
+
+        /** Throws CobProgram::errors[operand] when executed. */
+        Invalid,
+    };
+
+    /** A COB instruction with its operands decoded and checked. */
+    struct CobInstruction
+    {
+        CobOp op;
+
+        /** The axis of a piece instruction. */
+        Axis axis;
+
+        /** The number of parameters passed by CallScript and StartScript. */
+        unsigned int paramCount;
+
+        /** Where the instruction starts in CobScript::instructions. */
+        unsigned int address;
+
+        /**
+         * The instruction's inline operand, if it has one:
+         * the constant to push, the piece, local or static variable it works on,
+         * the function to start, or the index in CobProgram::instructions
+         * to jump or call to.
+         */
+        int operand;
+    };
+
+    /**
+     * A COB script's bytecode decoded ahead of time,
+     * so the interpreter does not have to look up operands,
+     * check piece and static variable indices
+     * or find jump targets while scripts run.
+     *
+     * Instructions are laid out in bytecode order,
+     * so execution falls through to the next one.
+     * Anything malformed decodes to a CobOp::Invalid instruction,
+     * so scripts only fail when they reach the problem,
+     * as they did when bytecode was interpreted directly.
+     * The last instruction is always invalid
+     * and catches execution running past the end of the code
+     * or jumping into the middle of an instruction.
+     */
+    class CobProgram
+    {
+    public:
+        std::vector<CobInstruction> instructions;
+
+        /** Messages thrown by CobOp::Invalid instructions. */
+        std::vector<std::string> errors;
+
+        /**
+         * For each bytecode address, the index of the instruction that starts there,
+         * or the index of the last instruction if none does.
+         */
+        std::vector<unsigned int> addressIndices;
+
+    public:
+        /**
+         * Returns the index of the instruction at the given bytecode address.
+         * Call stack frames keep bytecode addresses,
+         * so snapshots do not depend on how instructions are decoded.
+         */
+        unsigned int getIndex(unsigned int address) const;
+    };
+
+    CobProgram decodeCobProgram(const CobScript& script);
+}
+
+#endif
@@ -20,7 +20,7 @@ namespace rwe
 
         std::stack<CobFunction> callStack;
 
-        int returnValue;
+        int returnValue{0};
 
         /**
          * Required for query functions, which communicate back to the engine
@@ -28,6 +28,15 @@ namespace rwe
          */
         std::vector<int> returnLocals;
 
+        /**
+         * Identifies this thread's random number stream within its environment.
+         * Zero for threads that are not scheduled, such as query scripts.
+         */
+        unsigned int randomSerial{0};
+
+        /** The number of random numbers this thread has drawn so far. */
+        unsigned int randomCalls{0};
+
     public:
         CobThread(const std::string& name, unsigned int signalMask);
 
@@ -1,11 +1,17 @@
 #ifndef RWE_ASTARPATHFINDER_H
 #define RWE_ASTARPATHFINDER_H
 
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <deque>
+#include <limits>
 #include <optional>
 #include <rwe/MinHeap.h>
+#include <rwe/Point.h>
 #include <spdlog/spdlog.h>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace rwe
@@ -35,7 +41,9 @@ namespace rwe
     {
         AStarPathType type;
         std::vector<T> path;
-        std::unordered_map<T, AStarVertexInfo<T, Cost>> closedVertices;
+
+        /** Every vertex expanded by the search, after the vertex it was reached from. */
+        std::vector<std::pair<T, T>> closedEdges;
     };
 
     template <typename T, typename Cost = float>
@@ -68,7 +76,7 @@ namespace rwe
                 if (isGoal(current.vertex))
                 {
                     spdlog::get("rwe")->debug("Found goal after visiting {0} vertices", openListPopsPerformed);
-                    return AStarPathInfo<T, Cost>{AStarPathType::Complete, walkPath(current), std::move(closedVertices)};
+                    return AStarPathInfo<T, Cost>{AStarPathType::Complete, walkPath(current), getClosedEdges(closedVertices)};
                 }
 
                 auto estimatedCostToGoal = estimateCostToGoal(current.vertex);
@@ -90,7 +98,7 @@ namespace rwe
             }
 
             spdlog::get("rwe")->debug("Failed to find goal, visited {0} vertices", openListPopsPerformed);
-            return AStarPathInfo<T, Cost>{AStarPathType::Partial, walkPath(*(closestVertex->second)), std::move(closedVertices)};
+            return AStarPathInfo<T, Cost>{AStarPathType::Partial, walkPath(*(closestVertex->second)), getClosedEdges(closedVertices)};
         }
 
     protected:
@@ -114,6 +122,351 @@ namespace rwe
             std::reverse(items.begin(), items.end());
             return items;
         }
+
+        std::vector<std::pair<T, T>> getClosedEdges(const std::unordered_map<T, VertexInfo>& closedVertices)
+        {
+            std::vector<std::pair<T, T>> edges;
+            for (const auto& item : closedVertices)
+            {
+                if (item.second.predecessor)
+                {
+                    edges.emplace_back((*item.second.predecessor)->vertex, item.second.vertex);
+                }
+            }
+            return edges;
+        }
+    };
+
+    /**
+     * Per-cell search state for A* over a grid, reused from one search to the next.
+     * Each cell is stamped with the search that last touched it,
+     * so starting a new search does not need to clear anything.
+     * A grid must only be used by one search at a time.
+     */
+    template <typename Cost>
+    class AStarNodeGrid
+    {
+    public:
+        static constexpr std::uint32_t NoIndex = std::numeric_limits<std::uint32_t>::max();
+
+        struct Node
+        {
+            /** The search this node belongs to. If it is not the current one, the rest is stale. */
+            std::uint32_t generation{0};
+            Cost costToReach;
+            std::uint32_t predecessor{NoIndex};
+            /** Position in the open heap, or NoIndex if not in it. */
+            std::uint32_t heapIndex{NoIndex};
+            bool closed{false};
+        };
+
+        struct HeapEntry
+        {
+            Cost estimatedTotalCost;
+            std::uint32_t index;
+        };
+
+    private:
+        std::size_t width{0};
+        std::size_t height{0};
+        std::uint32_t generation{0};
+        std::vector<Node> nodes;
+
+    public:
+        /** The open heap, kept here so that its storage is reused too. */
+        std::vector<HeapEntry> heap;
+
+        std::size_t getWidth() const { return width; }
+
+        std::size_t getHeight() const { return height; }
+
+        /** Makes every node fresh, resizing the grid if needed. */
+        void beginSearch(std::size_t newWidth, std::size_t newHeight)
+        {
+            if (newWidth != width || newHeight != height)
+            {
+                width = newWidth;
+                height = newHeight;
+                nodes.assign(width * height, Node());
+                generation = 0;
+            }
+
+            heap.clear();
+
+            if (++generation == 0)
+            {
+                // the stamps have wrapped around, so old ones could look current
+                std::fill(nodes.begin(), nodes.end(), Node());
+                generation = 1;
+            }
+        }
+
+        bool contains(const Point& p) const
+        {
+            return p.x >= 0 && p.y >= 0 && static_cast<std::size_t>(p.x) < width && static_cast<std::size_t>(p.y) < height;
+        }
+
+        std::uint32_t toIndex(const Point& p) const
+        {
+            return static_cast<std::uint32_t>((static_cast<std::size_t>(p.y) * width) + static_cast<std::size_t>(p.x));
+        }
+
+        Point toPoint(std::uint32_t index) const
+        {
+            return Point(static_cast<int>(index % width), static_cast<int>(index / width));
+        }
+
+        /** Returns the node, resetting it first if it is left over from an earlier search. */
+        Node& get(std::uint32_t index)
+        {
+            auto& node = nodes[index];
+            if (node.generation != generation)
+            {
+                node = Node();
+                node.generation = generation;
+            }
+            return node;
+        }
+    };
+
+    /**
+     * A* over grid cells.
+     * Rather than hash maps, search state lives in an AStarNodeGrid
+     * indexed by cell, and successors are written into a fixed-size buffer.
+     * Expands vertices in the same order as the general version.
+     * Cells outside the grid are never visited.
+     */
+    template <typename Cost>
+    class AStarPathFinder<Point, Cost>
+    {
+    public:
+        static constexpr unsigned int MaxSuccessors = 8;
+
+        struct VertexInfo
+        {
+            Cost costToReach;
+            Point vertex;
+            std::optional<Point> predecessor;
+        };
+
+        struct Successor
+        {
+            Cost costToReach;
+            Point vertex;
+        };
+
+        using SuccessorBuffer = std::array<Successor, MaxSuccessors>;
+
+    private:
+        using Node = typename AStarNodeGrid<Cost>::Node;
+        using HeapEntry = typename AStarNodeGrid<Cost>::HeapEntry;
+        static constexpr std::uint32_t NoIndex = AStarNodeGrid<Cost>::NoIndex;
+
+        AStarNodeGrid<Cost>* const nodes;
+        const std::size_t width;
+        const std::size_t height;
+
+    public:
+        AStarPathFinder(AStarNodeGrid<Cost>* nodes, std::size_t width, std::size_t height)
+            : nodes(nodes), width(width), height(height)
+        {
+        }
+
+        virtual ~AStarPathFinder() = default;
+
+        AStarPathInfo<Point, Cost> findPath(const Point& start)
+        {
+            nodes->beginSearch(width, height);
+
+            std::vector<std::pair<Point, Point>> closedEdges;
+
+            if (!nodes->contains(start))
+            {
+                return AStarPathInfo<Point, Cost>{AStarPathType::Partial, std::vector<Point>{start}, std::move(closedEdges)};
+            }
+
+            auto startIndex = nodes->toIndex(start);
+            nodes->get(startIndex).costToReach = Cost();
+            pushOrDecrease(HeapEntry{estimateCostToGoal(start), startIndex}, Cost(), NoIndex);
+
+            std::optional<std::pair<Cost, std::uint32_t>> closestVertex;
+
+            SuccessorBuffer successors;
+
+            unsigned int openListPopsPerformed = 0;
+
+            auto& heap = nodes->heap;
+            while (!heap.empty() && openListPopsPerformed < MaxOpenListQueries)
+            {
+                auto currentIndex = heap.front().index;
+                pop();
+                openListPopsPerformed += 1;
+
+                auto& current = nodes->get(currentIndex);
+                current.closed = true;
+
+                auto currentVertex = nodes->toPoint(currentIndex);
+                std::optional<Point> predecessor;
+                if (current.predecessor != NoIndex)
+                {
+                    predecessor = nodes->toPoint(current.predecessor);
+                    closedEdges.emplace_back(*predecessor, currentVertex);
+                }
+
+                if (isGoal(currentVertex))
+                {
+                    return AStarPathInfo<Point, Cost>{AStarPathType::Complete, walkPath(currentIndex), std::move(closedEdges)};
+                }
+
+                auto estimatedCostToGoal = estimateCostToGoal(currentVertex);
+                if (!closestVertex || estimatedCostToGoal < closestVertex->first)
+                {
+                    closestVertex = std::pair<Cost, std::uint32_t>(estimatedCostToGoal, currentIndex);
+                }
+
+                VertexInfo info{current.costToReach, currentVertex, predecessor};
+                auto successorCount = getSuccessors(info, successors);
+                assert(successorCount <= MaxSuccessors);
+
+                for (unsigned int i = 0; i < successorCount; ++i)
+                {
+                    const auto& s = successors[i];
+                    if (!nodes->contains(s.vertex))
+                    {
+                        continue;
+                    }
+
+                    auto successorIndex = nodes->toIndex(s.vertex);
+                    if (nodes->get(successorIndex).closed)
+                    {
+                        continue;
+                    }
+
+                    auto estimatedTotalCost = s.costToReach + estimateCostToGoal(s.vertex);
+                    pushOrDecrease(HeapEntry{estimatedTotalCost, successorIndex}, s.costToReach, currentIndex);
+                }
+            }
+
+            return AStarPathInfo<Point, Cost>{AStarPathType::Partial, walkPath(closestVertex->second), std::move(closedEdges)};
+        }
+
+    protected:
+        virtual bool isGoal(const Point& vertex) = 0;
+
+        virtual Cost estimateCostToGoal(const Point& vertex) = 0;
+
+        /** Writes the successors of the vertex into the buffer and returns how many there are. */
+        virtual unsigned int getSuccessors(const VertexInfo& vertex, SuccessorBuffer& successors) = 0;
+
+    private:
+        std::vector<Point> walkPath(std::uint32_t index)
+        {
+            std::vector<Point> items;
+            while (index != NoIndex)
+            {
+                items.push_back(nodes->toPoint(index));
+                index = nodes->get(index).predecessor;
+            }
+
+            std::reverse(items.begin(), items.end());
+            return items;
+        }
+
+        // The heap below mirrors MinHeap, ordered by estimated total cost,
+        // so that ties are broken exactly as the general version breaks them.
+
+        void pushOrDecrease(const HeapEntry& entry, const Cost& costToReach, std::uint32_t predecessor)
+        {
+            auto& node = nodes->get(entry.index);
+            auto& heap = nodes->heap;
+
+            if (node.heapIndex == NoIndex)
+            {
+                node.costToReach = costToReach;
+                node.predecessor = predecessor;
+                heap.resize(heap.size() + 1);
+                siftUp(heap.size() - 1, entry);
+                return;
+            }
+
+            if (!(entry.estimatedTotalCost < heap[node.heapIndex].estimatedTotalCost))
+            {
+                return;
+            }
+
+            node.costToReach = costToReach;
+            node.predecessor = predecessor;
+            siftUp(node.heapIndex, entry);
+        }
+
+        void pop()
+        {
+            auto& heap = nodes->heap;
+            auto first = heap.front();
+            auto last = heap.back();
+            heap.pop_back();
+            nodes->get(last.index).heapIndex = NoIndex;
+
+            if (!heap.empty())
+            {
+                nodes->get(first.index).heapIndex = NoIndex;
+                siftDown(0, last);
+            }
+        }
+
+        void siftUp(std::size_t position, const HeapEntry& entry)
+        {
+            auto& heap = nodes->heap;
+            while (position > 0)
+            {
+                auto parentPosition = (position - 1) / 2;
+                const auto& parent = heap[parentPosition];
+                if (!(entry.estimatedTotalCost < parent.estimatedTotalCost))
+                {
+                    break;
+                }
+
+                heap[position] = parent;
+                nodes->get(parent.index).heapIndex = static_cast<std::uint32_t>(position);
+                position = parentPosition;
+            }
+
+            heap[position] = entry;
+            nodes->get(entry.index).heapIndex = static_cast<std::uint32_t>(position);
+        }
+
+        void siftDown(std::size_t position, const HeapEntry& entry)
+        {
+            auto& heap = nodes->heap;
+            auto firstLeafPosition = heap.size() / 2;
+            while (position < firstLeafPosition)
+            {
+                auto smallestChildPosition = (position * 2) + 1;
+                const auto* smallestChild = &heap[smallestChildPosition];
+                auto rightChildPosition = (position * 2) + 2;
+                if (rightChildPosition < heap.size())
+                {
+                    const auto* rightChild = &heap[rightChildPosition];
+                    if (rightChild->estimatedTotalCost < smallestChild->estimatedTotalCost)
+                    {
+                        smallestChildPosition = rightChildPosition;
+                        smallestChild = rightChild;
+                    }
+                }
+
+                if (entry.estimatedTotalCost < smallestChild->estimatedTotalCost)
+                {
+                    break;
+                }
+
+                heap[position] = *smallestChild;
+                nodes->get(smallestChild->index).heapIndex = static_cast<std::uint32_t>(position);
+                position = smallestChildPosition;
+            }
+
+            heap[position] = entry;
+            nodes->get(entry.index).heapIndex = static_cast<std::uint32_t>(position);
+        }
     };
 }
 
@@ -3,13 +3,15 @@
 namespace rwe
 {
     AbstractUnitPathFinder::AbstractUnitPathFinder(
-        GameSimulation* simulation,
-        MovementClassCollisionService* collisionService,
+        AStarNodeGrid<PathCost>* nodes,
+        const OccupiedGrid* occupiedGrid,
+        const MovementClassCollisionService* collisionService,
         UnitId self,
         std::optional<MovementClassId> movementClass,
         unsigned int footprintX,
         unsigned int footprintZ)
-        : simulation(simulation),
+        : AStarPathFinder(nodes, occupiedGrid->grid.getWidth(), occupiedGrid->grid.getHeight()),
+          occupiedGrid(occupiedGrid),
           collisionService(collisionService),
           self(self),
           movementClass(movementClass),
@@ -18,20 +20,23 @@ namespace rwe
     {
     }
 
-    std::vector<AbstractUnitPathFinder::VertexInfo>
-    AbstractUnitPathFinder::getSuccessors(const VertexInfo& info)
+    unsigned int AbstractUnitPathFinder::getSuccessors(const VertexInfo& info, SuccessorBuffer& successors)
     {
         std::optional<Direction> prevDirection;
         if (info.predecessor)
         {
-            prevDirection = pointToDirection(info.vertex - (*info.predecessor)->vertex);
+            prevDirection = pointToDirection(info.vertex - *info.predecessor);
         }
 
-        auto neighbours = getNeighbours(info.vertex);
-
-        std::vector<VertexInfo> vs;
-        for (const auto& neighbour : neighbours)
+        unsigned int count = 0;
+        for (auto d : Directions)
         {
+            auto neighbour = step(info.vertex, d);
+            if (!isWalkable(neighbour))
+            {
+                continue;
+            }
+
             auto direction = pointToDirection(neighbour - info.vertex);
             auto distance = octileDistance(info.vertex, neighbour);
             assert(distance.diagonal == 0 || distance.straight == 0);
@@ -42,16 +47,16 @@ namespace rwe
             }
             unsigned int turns = (!prevDirection || direction == *prevDirection) ? 0 : 1;
             PathCost cost(distance, turns);
-            vs.push_back(VertexInfo{info.costToReach + cost, neighbour, &info});
+            successors[count++] = Successor{info.costToReach + cost, neighbour};
         }
 
-        return vs;
+        return count;
     }
 
     bool AbstractUnitPathFinder::isWalkable(const Point& p) const
     {
         DiscreteRect rect(p.x, p.y, footprintX, footprintZ);
-        return (movementClass ? collisionService->isWalkable(*movementClass, p) : true) && !simulation->isCollisionAt(rect, self);
+        return (movementClass ? collisionService->isWalkable(*movementClass, p) : true) && !occupiedGrid->isCollisionAt(rect, self);
     }
 
     bool AbstractUnitPathFinder::isWalkable(int x, int y) const
@@ -62,7 +67,7 @@ namespace rwe
     bool AbstractUnitPathFinder::isRoughTerrain(const Point& p) const
     {
         DiscreteRect rect(p.x, p.y, footprintX, footprintZ);
-        return simulation->isAdjacentToObstacle(rect, self);
+        return occupiedGrid->isAdjacentToObstacle(rect, self);
     }
 
     Point AbstractUnitPathFinder::step(const Point& p, Direction d) const
@@ -70,24 +75,4 @@ namespace rwe
         auto directionVector = directionToPoint(d);
         return p + directionVector;
     }
-
-    std::vector<Point> AbstractUnitPathFinder::getNeighbours(const Point& p)
-    {
-        std::vector<Point> neighbours;
-        neighbours.reserve(Directions.size());
-
-        for (auto d : Directions)
-        {
-            auto newPosition = step(p, d);
-
-            if (!isWalkable(newPosition))
-            {
-                continue;
-            }
-
-            neighbours.push_back(newPosition);
-        }
-
-        return neighbours;
-    }
 }
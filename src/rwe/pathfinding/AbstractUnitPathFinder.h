@@ -3,8 +3,8 @@
 
 #include <rwe/DiscreteRect.h>
 #include <rwe/EightWayDirection.h>
-#include <rwe/GameSimulation.h>
 #include <rwe/MovementClassCollisionService.h>
+#include <rwe/OccupiedGrid.h>
 #include <rwe/UnitId.h>
 #include <rwe/pathfinding/AStarPathFinder.h>
 #include <rwe/pathfinding/PathCost.h>
@@ -18,8 +18,8 @@ namespace rwe
     class AbstractUnitPathFinder : public AStarPathFinder<Point, PathCost>
     {
     private:
-        GameSimulation* const simulation;
-        MovementClassCollisionService* const collisionService;
+        const OccupiedGrid* const occupiedGrid;
+        const MovementClassCollisionService* const collisionService;
         const UnitId self;
         const std::optional<MovementClassId> movementClass;
         const unsigned int footprintX;
@@ -27,15 +27,16 @@ namespace rwe
 
     public:
         AbstractUnitPathFinder(
-            GameSimulation* simulation,
-            MovementClassCollisionService* collisionService,
+            AStarNodeGrid<PathCost>* nodes,
+            const OccupiedGrid* occupiedGrid,
+            const MovementClassCollisionService* collisionService,
             UnitId self,
             std::optional<MovementClassId> movementClass,
             unsigned int footprintX,
             unsigned int footprintZ);
 
     protected:
-        std::vector<VertexInfo> getSuccessors(const VertexInfo& vertex) override;
+        unsigned int getSuccessors(const VertexInfo& vertex, SuccessorBuffer& successors) override;
 
     private:
         bool isWalkable(const Point& p) const;
@@ -45,8 +46,6 @@ namespace rwe
         bool isRoughTerrain(const Point& p) const;
 
         Point step(const Point& p, Direction d) const;
-
-        std::vector<Point> getNeighbours(const Point& p);
     };
 }
 
@@ -0,0 +1,470 @@
+#include "ClusterGraph.h"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <rwe/pathfinding/pathfinding_utils.h>
+
+namespace rwe
+{
+    static const Point NeighbourOffsets[] = {
+        Point(1, 0),
+        Point(1, 1),
+        Point(0, 1),
+        Point(-1, 1),
+        Point(-1, 0),
+        Point(-1, -1),
+        Point(0, -1),
+        Point(1, -1),
+    };
+
+    /** An entry in an open list, ordered by its cost and then its index. */
+    using OpenEntry = std::pair<float, unsigned int>;
+
+    using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+
+    ClusterGraph::ClusterGraph(Grid<char>&& passable)
+        : passable(std::move(passable)),
+          clustersX((this->passable.getWidth() + ClusterSize - 1) / ClusterSize),
+          clustersY((this->passable.getHeight() + ClusterSize - 1) / ClusterSize)
+    {
+        auto width = static_cast<unsigned int>(this->passable.getWidth());
+        auto height = static_cast<unsigned int>(this->passable.getHeight());
+
+        clusters.resize(clustersX * clustersY);
+        for (unsigned int cy = 0; cy < clustersY; ++cy)
+        {
+            for (unsigned int cx = 0; cx < clustersX; ++cx)
+            {
+                auto x = cx * ClusterSize;
+                auto y = cy * ClusterSize;
+                clusters[(cy * clustersX) + cx].region = GridRegion(x, y, std::min(ClusterSize, width - x), std::min(ClusterSize, height - y));
+            }
+        }
+
+        for (unsigned int i = 0; i < clusters.size(); ++i)
+        {
+            rebuildCluster(i);
+        }
+
+        numberNodes();
+    }
+
+    void ClusterGraph::replaceArea(std::size_t x, std::size_t y, const Grid<char>& replacement)
+    {
+        passable.replaceArea(x, y, replacement);
+
+        if (replacement.getWidth() == 0 || replacement.getHeight() == 0)
+        {
+            return;
+        }
+
+        // Entrances on a cluster's border belong to the neighbour too,
+        // so the clusters around the area have to be rebuilt as well.
+        auto minX = static_cast<unsigned int>(x / ClusterSize);
+        auto minY = static_cast<unsigned int>(y / ClusterSize);
+        auto maxX = static_cast<unsigned int>((x + replacement.getWidth() - 1) / ClusterSize);
+        auto maxY = static_cast<unsigned int>((y + replacement.getHeight() - 1) / ClusterSize);
+        minX = minX > 0 ? minX - 1 : 0;
+        minY = minY > 0 ? minY - 1 : 0;
+        maxX = std::min(maxX + 1, clustersX - 1);
+        maxY = std::min(maxY + 1, clustersY - 1);
+
+        for (auto cy = minY; cy <= maxY; ++cy)
+        {
+            for (auto cx = minX; cx <= maxX; ++cx)
+            {
+                rebuildCluster((cy * clustersX) + cx);
+            }
+        }
+
+        numberNodes();
+    }
+
+    std::optional<std::vector<Point>> ClusterGraph::findRoute(const Point& start, const Point& goal) const
+    {
+        if (!isPassable(start) || !isPassable(goal))
+        {
+            return std::nullopt;
+        }
+
+        auto startClusterIndex = getClusterIndex(start);
+        auto goalClusterIndex = getClusterIndex(goal);
+        const auto& startCluster = clusters[startClusterIndex];
+        const auto& goalCluster = clusters[goalClusterIndex];
+        auto startCosts = searchCluster(startCluster, start);
+        auto goalCosts = searchCluster(goalCluster, goal);
+
+        auto toLocalIndex = [](const Cluster& cluster, const Point& p) {
+            return ((p.y - cluster.region.y) * cluster.region.width) + (p.x - cluster.region.x);
+        };
+
+        // The start and goal join the graph as two extra nodes after the others.
+        auto nodeCount = static_cast<unsigned int>(nodeLocations.size());
+        auto startNode = nodeCount;
+        auto goalNode = nodeCount + 1;
+
+        auto getCell = [&](unsigned int node) {
+            if (node == startNode)
+            {
+                return start;
+            }
+            if (node == goalNode)
+            {
+                return goal;
+            }
+            const auto& location = nodeLocations[node];
+            return clusters[location.cluster].nodes[location.node].cell;
+        };
+
+        std::vector<std::optional<OctileDistance>> costs(nodeCount + 2);
+        std::vector<unsigned int> predecessors(nodeCount + 2);
+        std::vector<char> closed(nodeCount + 2, false);
+        OpenList open;
+
+        auto relax = [&](unsigned int from, unsigned int to, const OctileDistance& cost) {
+            auto costToReach = *costs[from] + cost;
+            if (closed[to] || (costs[to] && *costs[to] <= costToReach))
+            {
+                return;
+            }
+
+            costs[to] = costToReach;
+            predecessors[to] = from;
+            open.emplace((costToReach + octileDistance(getCell(to), goal)).asFloat(), to);
+        };
+
+        costs[startNode] = OctileDistance(0, 0);
+        open.emplace(octileDistance(start, goal).asFloat(), startNode);
+
+        while (!open.empty())
+        {
+            auto current = open.top().second;
+            open.pop();
+
+            if (closed[current])
+            {
+                continue;
+            }
+            closed[current] = true;
+
+            if (current == goalNode)
+            {
+                std::vector<Point> route;
+                for (auto node = goalNode; node != startNode; node = predecessors[node])
+                {
+                    route.push_back(getCell(node));
+                }
+                route.push_back(start);
+                std::reverse(route.begin(), route.end());
+                return route;
+            }
+
+            if (current == startNode)
+            {
+                for (unsigned int i = 0; i < startCluster.nodes.size(); ++i)
+                {
+                    const auto& cost = startCosts[toLocalIndex(startCluster, startCluster.nodes[i].cell)];
+                    if (cost)
+                    {
+                        relax(current, firstNodeIndices[startClusterIndex] + i, *cost);
+                    }
+                }
+
+                if (startClusterIndex == goalClusterIndex)
+                {
+                    const auto& cost = startCosts[toLocalIndex(startCluster, goal)];
+                    if (cost)
+                    {
+                        relax(current, goalNode, *cost);
+                    }
+                }
+
+                continue;
+            }
+
+            const auto& location = nodeLocations[current];
+            const auto& node = clusters[location.cluster].nodes[location.node];
+
+            for (const auto& edge : node.edges)
+            {
+                relax(current, firstNodeIndices[location.cluster] + edge.node, edge.cost);
+            }
+
+            for (const auto& exit : node.exits)
+            {
+                auto exitClusterIndex = getClusterIndex(exit);
+                auto exitNode = findNode(clusters[exitClusterIndex], exit);
+                assert(!!exitNode);
+                relax(current, firstNodeIndices[exitClusterIndex] + *exitNode, octileDistance(node.cell, exit));
+            }
+
+            if (location.cluster == goalClusterIndex)
+            {
+                const auto& cost = goalCosts[toLocalIndex(goalCluster, node.cell)];
+                if (cost)
+                {
+                    relax(current, goalNode, *cost);
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    bool ClusterGraph::isPassable(const Point& p) const
+    {
+        auto cell = passable.tryGet(p);
+        return cell && cell->get();
+    }
+
+    void ClusterGraph::rebuildCluster(unsigned int clusterIndex)
+    {
+        auto& cluster = clusters[clusterIndex];
+        cluster.nodes.clear();
+
+        auto cx = clusterIndex % clustersX;
+        auto cy = clusterIndex / clustersX;
+        const auto& r = cluster.region;
+        auto left = static_cast<int>(r.x);
+        auto top = static_cast<int>(r.y);
+        auto right = static_cast<int>(r.x + r.width - 1);
+        auto bottom = static_cast<int>(r.y + r.height - 1);
+
+        if (cy > 0)
+        {
+            addEntrances(cluster, Point(left, top), Point(1, 0), Point(0, -1), r.width);
+        }
+        if (cy < clustersY - 1)
+        {
+            addEntrances(cluster, Point(left, bottom), Point(1, 0), Point(0, 1), r.width);
+        }
+        if (cx > 0)
+        {
+            addEntrances(cluster, Point(left, top), Point(0, 1), Point(-1, 0), r.height);
+        }
+        if (cx < clustersX - 1)
+        {
+            addEntrances(cluster, Point(right, top), Point(0, 1), Point(1, 0), r.height);
+        }
+
+        connectNodes(cluster);
+    }
+
+    void ClusterGraph::addEntrances(Cluster& cluster, const Point& first, const Point& along, const Point& across, unsigned int length)
+    {
+        auto cellAt = [&](int i) {
+            return Point(first.x + (along.x * i), first.y + (along.y * i));
+        };
+
+        // Both clusters walk their shared border in the same direction,
+        // so they agree on where the entrances are.
+        std::optional<int> runStart;
+        for (int i = 0; i <= static_cast<int>(length); ++i)
+        {
+            auto open = i < static_cast<int>(length) && isPassable(cellAt(i)) && isPassable(cellAt(i) + across);
+            if (open && !runStart)
+            {
+                runStart = i;
+            }
+            else if (!open && runStart)
+            {
+                auto runLength = i - *runStart;
+                if (static_cast<unsigned int>(runLength) >= WideEntranceSize)
+                {
+                    addTransition(cluster, cellAt(*runStart), cellAt(*runStart) + across);
+                    addTransition(cluster, cellAt(i - 1), cellAt(i - 1) + across);
+                }
+                else
+                {
+                    auto middle = *runStart + ((runLength - 1) / 2);
+                    addTransition(cluster, cellAt(middle), cellAt(middle) + across);
+                }
+                runStart = std::nullopt;
+            }
+        }
+
+        // Units can also cut diagonally across the border,
+        // which matters where there is no straight way across nearby.
+        // This includes crossing the corner into a diagonally neighbouring cluster.
+        for (int i = 0; i < static_cast<int>(length); ++i)
+        {
+            for (auto j : {i - 1, i + 1})
+            {
+                if (isPassable(cellAt(i))
+                    && isPassable(cellAt(j) + across)
+                    && !isPassable(cellAt(j))
+                    && !isPassable(cellAt(i) + across))
+                {
+                    addTransition(cluster, cellAt(i), cellAt(j) + across);
+                }
+            }
+        }
+    }
+
+    void ClusterGraph::addTransition(Cluster& cluster, const Point& cell, const Point& exit)
+    {
+        // A corner cell can be the transition for entrances on both of its borders.
+        auto existing = findNode(cluster, cell);
+        if (existing)
+        {
+            auto& exits = cluster.nodes[*existing].exits;
+            if (std::find(exits.begin(), exits.end(), exit) == exits.end())
+            {
+                exits.push_back(exit);
+            }
+            return;
+        }
+
+        cluster.nodes.push_back(Node{cell, {exit}, {}});
+    }
+
+    void ClusterGraph::connectNodes(Cluster& cluster)
+    {
+        for (auto& node : cluster.nodes)
+        {
+            auto costs = searchCluster(cluster, node.cell);
+            for (unsigned int i = 0; i < cluster.nodes.size(); ++i)
+            {
+                const auto& other = cluster.nodes[i];
+                if (other.cell == node.cell)
+                {
+                    continue;
+                }
+
+                const auto& cost = costs[((other.cell.y - cluster.region.y) * cluster.region.width) + (other.cell.x - cluster.region.x)];
+                if (cost)
+                {
+                    node.edges.push_back(Edge{i, *cost});
+                }
+            }
+        }
+    }
+
+    void ClusterGraph::numberNodes()
+    {
+        firstNodeIndices.resize(clusters.size());
+        nodeLocations.clear();
+        for (unsigned int i = 0; i < clusters.size(); ++i)
+        {
+            firstNodeIndices[i] = static_cast<unsigned int>(nodeLocations.size());
+            for (unsigned int j = 0; j < clusters[i].nodes.size(); ++j)
+            {
+                nodeLocations.push_back(NodeLocation{i, j});
+            }
+        }
+    }
+
+    std::vector<std::optional<OctileDistance>> ClusterGraph::searchCluster(const Cluster& cluster, const Point& start) const
+    {
+        const auto& r = cluster.region;
+        auto contains = [&](const Point& p) {
+            return p.x >= static_cast<int>(r.x)
+                && p.y >= static_cast<int>(r.y)
+                && p.x < static_cast<int>(r.x + r.width)
+                && p.y < static_cast<int>(r.y + r.height);
+        };
+        auto toLocalIndex = [&](const Point& p) {
+            return ((p.y - r.y) * r.width) + (p.x - r.x);
+        };
+
+        std::vector<std::optional<OctileDistance>> costs(r.width * r.height);
+
+        OpenList open;
+        costs[toLocalIndex(start)] = OctileDistance(0, 0);
+        open.emplace(0.0f, toLocalIndex(start));
+
+        while (!open.empty())
+        {
+            auto entry = open.top();
+            open.pop();
+
+            auto cost = *costs[entry.second];
+            if (entry.first > cost.asFloat())
+            {
+                // superseded by a cheaper entry
+                continue;
+            }
+
+            Point p(r.x + (entry.second % r.width), r.y + (entry.second / r.width));
+            for (const auto& offset : NeighbourOffsets)
+            {
+                auto neighbour = p + offset;
+                if (!contains(neighbour) || !isPassable(neighbour))
+                {
+                    continue;
+                }
+
+                auto step = (offset.x != 0 && offset.y != 0) ? OctileDistance(0, 1) : OctileDistance(1, 0);
+                auto costToReach = cost + step;
+                auto& neighbourCost = costs[toLocalIndex(neighbour)];
+                if (!neighbourCost || costToReach < *neighbourCost)
+                {
+                    neighbourCost = costToReach;
+                    open.emplace(costToReach.asFloat(), toLocalIndex(neighbour));
+                }
+            }
+        }
+
+        return costs;
+    }
+
+    unsigned int ClusterGraph::getClusterIndex(const Point& p) const
+    {
+        return ((p.y / ClusterSize) * clustersX) + (p.x / ClusterSize);
+    }
+
+    std::optional<unsigned int> ClusterGraph::findNode(const Cluster& cluster, const Point& cell) const
+    {
+        for (unsigned int i = 0; i < cluster.nodes.size(); ++i)
+        {
+            if (cluster.nodes[i].cell == cell)
+            {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    Grid<char> computeStaticPassableArea(
+        const Grid<char>& walkableGrid,
+        const OccupiedGrid& occupiedGrid,
+        unsigned int footprintX,
+        unsigned int footprintZ,
+        const GridRegion& region)
+    {
+        Grid<char> area(region.width, region.height, false);
+        for (unsigned int y = 0; y < region.height; ++y)
+        {
+            for (unsigned int x = 0; x < region.width; ++x)
+            {
+                auto cellX = region.x + x;
+                auto cellY = region.y + y;
+                if (!walkableGrid.get(cellX, cellY))
+                {
+                    continue;
+                }
+
+                DiscreteRect footprint(cellX, cellY, footprintX, footprintZ);
+                if (!occupiedGrid.grid.contains(footprint))
+                {
+                    continue;
+                }
+
+                auto blocked = false;
+                for (unsigned int fy = 0; fy < footprintZ && !blocked; ++fy)
+                {
+                    for (unsigned int fx = 0; fx < footprintX && !blocked; ++fx)
+                    {
+                        blocked = occupiedGrid.grid.get(cellX + fx, cellY + fy).isFeature();
+                    }
+                }
+
+                area.set(x, y, !blocked);
+            }
+        }
+
+        return area;
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef RWE_CLUSTERGRAPH_H
+#define RWE_CLUSTERGRAPH_H
+
+#include <optional>
+#include <rwe/Grid.h>
+#include <rwe/GridRegion.h>
+#include <rwe/OccupiedGrid.h>
+#include <rwe/Point.h>
+#include <rwe/pathfinding/OctileDistance.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * A coarse graph over a grid of passable cells,
+     * used to plan long paths hierarchically (HPA*).
+     *
+     * The grid is divided into square clusters.
+     * Wherever two neighbouring clusters share a run of passable cells along their border,
+     * there is an entrance with a node on either side of it.
+     * Each node is joined to its twin on the other side of the entrance
+     * and to the nodes of its own cluster that it can reach without leaving the cluster.
+     */
+    class ClusterGraph
+    {
+    public:
+        static const unsigned int ClusterSize = 16;
+
+        /** Entrances at least this wide get a node at each end rather than one in the middle. */
+        static const unsigned int WideEntranceSize = 6;
+
+    private:
+        struct Edge
+        {
+            /** The index of the target node within the same cluster. */
+            unsigned int node;
+            OctileDistance cost;
+        };
+
+        struct Node
+        {
+            Point cell;
+
+            /** Cells of the twin nodes in neighbouring clusters, one step away. */
+            std::vector<Point> exits;
+
+            std::vector<Edge> edges;
+        };
+
+        struct Cluster
+        {
+            GridRegion region;
+            std::vector<Node> nodes;
+        };
+
+        struct NodeLocation
+        {
+            unsigned int cluster;
+            unsigned int node;
+        };
+
+        Grid<char> passable;
+
+        unsigned int clustersX;
+        unsigned int clustersY;
+
+        std::vector<Cluster> clusters;
+
+        /** The index of each cluster's first node when the nodes of all clusters are numbered together. */
+        std::vector<unsigned int> firstNodeIndices;
+
+        /** The cluster and position within it of each node, by number. */
+        std::vector<NodeLocation> nodeLocations;
+
+    public:
+        explicit ClusterGraph(Grid<char>&& passable);
+
+        /**
+         * Overwrites part of the passable grid
+         * and rebuilds the clusters whose nodes or edges may have changed.
+         */
+        void replaceArea(std::size_t x, std::size_t y, const Grid<char>& replacement);
+
+        /**
+         * Plans a route from start to goal over the graph.
+         * The route begins with start, ends with goal and passes through the entrance nodes in between,
+         * each of which is at most a cluster's width from the one before.
+         * Returns nothing if start or goal is impassable or the goal cannot be reached.
+         */
+        std::optional<std::vector<Point>> findRoute(const Point& start, const Point& goal) const;
+
+        bool isPassable(const Point& p) const;
+
+    private:
+        void rebuildCluster(unsigned int clusterIndex);
+
+        void addEntrances(Cluster& cluster, const Point& first, const Point& along, const Point& across, unsigned int length);
+
+        void addTransition(Cluster& cluster, const Point& cell, const Point& exit);
+
+        void connectNodes(Cluster& cluster);
+
+        void numberNodes();
+
+        /**
+         * Finds the cost of reaching each cell of a cluster from the given cell
+         * without leaving the cluster, indexed by position within the cluster.
+         */
+        std::vector<std::optional<OctileDistance>> searchCluster(const Cluster& cluster, const Point& start) const;
+
+        unsigned int getClusterIndex(const Point& p) const;
+
+        std::optional<unsigned int> findNode(const Cluster& cluster, const Point& cell) const;
+    };
+
+    /**
+     * Computes which cells a unit of the given footprint can stand on
+     * without touching impassable terrain or a feature,
+     * for the given region of the walkable grid of its movement class.
+     */
+    Grid<char> computeStaticPassableArea(
+        const Grid<char>& walkableGrid,
+        const OccupiedGrid& occupiedGrid,
+        unsigned int footprintX,
+        unsigned int footprintZ,
+        const GridRegion& region);
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "FlowField.h"
+#include <cassert>
+#include <limits>
+#include <queue>
+#include <rwe/EightWayDirection.h>
+#include <rwe/pathfinding/pathfinding_utils.h>
+
+namespace rwe
+{
+    static const float Unreached = std::numeric_limits<float>::infinity();
+
+    FlowField::FlowField(
+        std::size_t width,
+        std::size_t height,
+        const std::vector<Point>& goals,
+        const std::vector<Point>& targets,
+        const std::function<bool(const Point&)>& isWalkable,
+        const std::function<bool(const Point&)>& isRoughTerrain)
+        : costs(width, height, Unreached), directions(width, height)
+    {
+        Grid<char> isTarget(width, height, false);
+        unsigned int remainingTargets = 0;
+        for (const auto& target : targets)
+        {
+            auto cell = isTarget.tryGet(target);
+            if (cell && !cell->get())
+            {
+                isTarget.set(target.x, target.y, true);
+                ++remainingTargets;
+            }
+        }
+
+        using OpenEntry = std::pair<float, std::size_t>;
+        std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+
+        for (const auto& goal : goals)
+        {
+            if (costs.tryGet(goal))
+            {
+                costs.set(goal.x, goal.y, 0.0f);
+                open.emplace(0.0f, costs.toIndex(goal.x, goal.y));
+            }
+        }
+
+        while (!open.empty() && remainingTargets > 0)
+        {
+            auto entry = open.top();
+            open.pop();
+
+            Point p(entry.second % width, entry.second / width);
+            if (entry.first > costs.get(p.x, p.y))
+            {
+                // superseded by a cheaper entry
+                continue;
+            }
+
+            if (isTarget.get(p.x, p.y))
+            {
+                --remainingTargets;
+            }
+
+            // Units travel towards the goals, so the step we care about
+            // is from a neighbour into this cell.
+            auto rough = isRoughTerrain(p);
+            for (auto d : Directions)
+            {
+                auto neighbour = p + directionToPoint(d);
+                if (!costs.tryGet(neighbour) || !isWalkable(neighbour))
+                {
+                    continue;
+                }
+
+                auto distance = octileDistance(neighbour, p);
+                if (rough)
+                {
+                    distance = distance + distance;
+                }
+
+                auto cost = entry.first + distance.asFloat();
+                if (cost < costs.get(neighbour.x, neighbour.y))
+                {
+                    costs.set(neighbour.x, neighbour.y, cost);
+                    directions.set(neighbour.x, neighbour.y, pointToDirection(p - neighbour));
+                    open.emplace(cost, costs.toIndex(neighbour.x, neighbour.y));
+                }
+            }
+        }
+    }
+
+    bool FlowField::isReached(const Point& p) const
+    {
+        auto cost = costs.tryGet(p);
+        return cost && cost->get() != Unreached;
+    }
+
+    std::optional<std::vector<Point>> FlowField::tracePath(const Point& start) const
+    {
+        if (!isReached(start))
+        {
+            return std::nullopt;
+        }
+
+        // Directions only ever lead to cheaper cells,
+        // so following them always ends at a goal.
+        std::vector<Point> path{start};
+        auto current = start;
+        while (auto direction = directions.get(current.x, current.y))
+        {
+            current = current + directionToPoint(*direction);
+            assert(isReached(current));
+            path.push_back(current);
+        }
+
+        return path;
+    }
+}
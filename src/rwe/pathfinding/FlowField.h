@@ -0,0 +1,55 @@
+#ifndef RWE_FLOWFIELD_H
+#define RWE_FLOWFIELD_H
+
+#include <functional>
+#include <optional>
+#include <rwe/EightWayDirection.h>
+#include <rwe/Grid.h>
+#include <rwe/Point.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * The cost of getting from each cell to the nearest of a set of goals,
+     * found by a single Dijkstra search outwards from the goals.
+     *
+     * Each reached cell also records which way to step
+     * to get one cell closer to the goal along the cheapest path.
+     * Units heading for the same place can share one field,
+     * each finding its path by following these directions from where it stands.
+     */
+    class FlowField
+    {
+    private:
+        /** Infinite for cells the search did not reach. */
+        Grid<float> costs;
+
+        /** The direction to step in from each cell. Empty for goals and cells not reached. */
+        Grid<std::optional<Direction>> directions;
+
+    public:
+        /**
+         * Grows the field out from the goals over walkable cells
+         * until every target has been reached or there is nowhere left to go.
+         * Moving into rough terrain costs double, as it does for unit path finders.
+         */
+        FlowField(
+            std::size_t width,
+            std::size_t height,
+            const std::vector<Point>& goals,
+            const std::vector<Point>& targets,
+            const std::function<bool(const Point&)>& isWalkable,
+            const std::function<bool(const Point&)>& isRoughTerrain);
+
+        bool isReached(const Point& p) const;
+
+        /**
+         * Returns the cells from start to the nearest goal,
+         * or nothing if the field does not reach start.
+         */
+        std::optional<std::vector<Point>> tracePath(const Point& start) const;
+    };
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "PathCache.h"
+#include <boost/functional/hash.hpp>
+
+namespace rwe
+{
+    bool PathCacheKey::operator==(const PathCacheKey& rhs) const
+    {
+        return movementClass == rhs.movementClass
+            && footprintX == rhs.footprintX
+            && footprintZ == rhs.footprintZ
+            && coarseStart == rhs.coarseStart
+            && isRectGoal == rhs.isRectGoal
+            && goal == rhs.goal
+            && epoch == rhs.epoch;
+    }
+
+    bool PathCacheKey::operator!=(const PathCacheKey& rhs) const
+    {
+        return !(rhs == *this);
+    }
+
+    std::size_t hash_value(const PathCacheKey& key)
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.movementClass ? key.movementClass->value + 1 : 0);
+        boost::hash_combine(seed, key.footprintX);
+        boost::hash_combine(seed, key.footprintZ);
+        boost::hash_combine(seed, key.coarseStart);
+        boost::hash_combine(seed, key.isRectGoal);
+        boost::hash_combine(seed, std::hash<DiscreteRect>()(key.goal));
+        boost::hash_combine(seed, key.epoch);
+        return seed;
+    }
+
+    PathCache::PathCache(unsigned int epoch) : epoch(epoch)
+    {
+    }
+
+    static int floorDivide(int value, int divisor)
+    {
+        auto quotient = value / divisor;
+        return (value % divisor < 0) ? quotient - 1 : quotient;
+    }
+
+    Point PathCache::toCoarseCell(const Point& cell)
+    {
+        return Point(floorDivide(cell.x, CoarseCellSize), floorDivide(cell.y, CoarseCellSize));
+    }
+
+    PathCache::Route PathCache::find(const PathCacheKey& key) const
+    {
+        auto it = routes.find(key);
+        if (it == routes.end())
+        {
+            return nullptr;
+        }
+
+        return it->second;
+    }
+
+    void PathCache::insert(const PathCacheKey& key, std::vector<Point> route)
+    {
+        if (key.epoch != epoch)
+        {
+            return;
+        }
+
+        auto newRoute = std::make_shared<const std::vector<Point>>(std::move(route));
+        auto it = routes.find(key);
+        if (it != routes.end())
+        {
+            it->second = std::move(newRoute);
+            return;
+        }
+
+        if (routes.size() == Capacity)
+        {
+            routes.erase(insertionOrder.front());
+            insertionOrder.pop_front();
+        }
+
+        routes.emplace(key, std::move(newRoute));
+        insertionOrder.push_back(key);
+    }
+
+    unsigned int PathCache::getEpoch() const
+    {
+        return epoch;
+    }
+
+    void PathCache::advanceEpoch()
+    {
+        ++epoch;
+        routes.clear();
+        insertionOrder.clear();
+    }
+
+    std::size_t PathCache::size() const
+    {
+        return routes.size();
+    }
+
+    std::vector<std::pair<PathCacheKey, PathCache::Route>> PathCache::getEntries() const
+    {
+        std::vector<std::pair<PathCacheKey, Route>> entries;
+        entries.reserve(insertionOrder.size());
+        for (const auto& key : insertionOrder)
+        {
+            entries.emplace_back(key, routes.at(key));
+        }
+
+        return entries;
+    }
+}
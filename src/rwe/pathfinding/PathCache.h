@@ -0,0 +1,116 @@
+#ifndef RWE_PATHCACHE_H
+#define RWE_PATHCACHE_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <rwe/DiscreteRect.h>
+#include <rwe/MovementClassId.h>
+#include <rwe/Point.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rwe
+{
+    /** Identifies searches similar enough to share a route. */
+    struct PathCacheKey
+    {
+        std::optional<MovementClassId> movementClass;
+        unsigned int footprintX;
+        unsigned int footprintZ;
+
+        /** The search's start cell, divided by PathCache::CoarseCellSize. */
+        Point coarseStart;
+
+        /** True if the goal is a rect to get next to, false if it is a cell to stand on. */
+        bool isRectGoal;
+
+        /** The search's goal in heightmap cells. */
+        DiscreteRect goal;
+
+        /** The cache epoch the route was found in. */
+        unsigned int epoch;
+
+        bool operator==(const PathCacheKey& rhs) const;
+
+        bool operator!=(const PathCacheKey& rhs) const;
+    };
+
+    std::size_t hash_value(const PathCacheKey& key);
+}
+
+namespace std
+{
+    template <>
+    struct hash<rwe::PathCacheKey>
+    {
+        std::size_t operator()(const rwe::PathCacheKey& key) const noexcept
+        {
+            return rwe::hash_value(key);
+        }
+    };
+}
+
+namespace rwe
+{
+    /**
+     * Routes found by recent searches,
+     * given as the cells at their corners like UnitPath::cells.
+     * A search from near the start of a cached route to the same goal
+     * only has to find its way onto the route.
+     *
+     * Routes are only good while blocking features stay where they were,
+     * so the epoch is advanced whenever they change, dropping every cached route.
+     * When full, the oldest route is dropped to make room.
+     * Looking up a route does not change the cache,
+     * so its contents depend only on which routes were inserted and when.
+     */
+    class PathCache
+    {
+    public:
+        using Route = std::shared_ptr<const std::vector<Point>>;
+
+        static constexpr std::size_t Capacity = 256;
+
+        /** The width and height of the squares of start cells that share routes. */
+        static constexpr int CoarseCellSize = 8;
+
+    private:
+        std::unordered_map<PathCacheKey, Route> routes;
+
+        /** The keys in routes, oldest first. */
+        std::deque<PathCacheKey> insertionOrder;
+
+        unsigned int epoch{0};
+
+    public:
+        PathCache() = default;
+
+        explicit PathCache(unsigned int epoch);
+
+        static Point toCoarseCell(const Point& cell);
+
+        /** Returns the route cached for the key, if there is one. */
+        Route find(const PathCacheKey& key) const;
+
+        /**
+         * Caches the route for the key, replacing any route it already has.
+         * Routes keyed with an earlier epoch are out of date and are ignored.
+         */
+        void insert(const PathCacheKey& key, std::vector<Point> route);
+
+        unsigned int getEpoch() const;
+
+        /** Starts a new epoch, dropping every cached route. */
+        void advanceEpoch();
+
+        std::size_t size() const;
+
+        /** Returns the cached routes, oldest first. */
+        std::vector<std::pair<PathCacheKey, Route>> getEntries() const;
+    };
+}
+
+#endif
@@ -1,127 +1,1029 @@
 #include "PathFindingService.h"
-#include <future>
+#include <algorithm>
+#include <cstdlib>
+#include <rwe/pathfinding/PathRepair.h>
 #include <rwe/pathfinding/UnitPathFinder.h>
 #include <rwe/pathfinding/UnitPerimeterPathFinder.h>
 #include <rwe/pathfinding/pathfinding_utils.h>
+#include <unordered_set>
 
 namespace rwe
 {
-    static const unsigned int MaxTasksPerTick = 10;
+    Vector3f getWorldCenter(const MapTerrain& terrain, const DiscreteRect& rect)
+    {
+        auto corner = terrain.heightmapIndexToWorldCorner(rect.x, rect.y);
+
+        auto halfWorldWidth = (rect.width * MapTerrain::HeightTileWidthInWorldUnits) / 2.0f;
+        auto halfWorldHeight = (rect.height * MapTerrain::HeightTileHeightInWorldUnits) / 2.0f;
 
-    PathFindingService::PathFindingService(GameSimulation* simulation, MovementClassCollisionService* collisionService)
-        : simulation(simulation), collisionService(collisionService)
+        auto center = corner + Vector3f(halfWorldWidth, 0.0f, halfWorldHeight);
+        center.y = terrain.getHeightAt(center.x, center.z);
+        return center;
+    }
+
+    DiscreteRect expandTopLeft(const DiscreteRect& rect, unsigned int width, unsigned int height)
     {
+        return DiscreteRect(
+            rect.x - static_cast<int>(width),
+            rect.y - static_cast<int>(height),
+            rect.width + width,
+            rect.height + height);
     }
 
-    void PathFindingService::update()
+    /** Returns true if the unit could reach any of the cells its search would accept as the goal. */
+    bool isGoalReachable(const MovementClassCollisionService& collisionService, const PathSearchInput& input, unsigned int component)
     {
-        auto& requests = simulation->pathRequests;
-        unsigned int tasksDone = 0;
-        while (!requests.empty() && tasksDone < MaxTasksPerTick)
+        const auto& goal = input.goal;
+        if (boost::get<DiscreteRect>(&input.destination) == nullptr)
+        {
+            return collisionService.getComponent(*input.movementClass, Point(goal.x, goal.y)) == component;
+        }
+
+        for (unsigned int y = 0; y < goal.height; ++y)
+        {
+            for (unsigned int x = 0; x < goal.width; ++x)
+            {
+                Point p(goal.x + static_cast<int>(x), goal.y + static_cast<int>(y));
+                if (goal.isInteriorPerimeter(p.x, p.y) && collisionService.getComponent(*input.movementClass, p) == component)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * If the terrain cuts the unit off from its goal,
+     * moves the goal to the nearest cell the unit can reach.
+     * Otherwise the search would use up its whole budget
+     * before giving up with a partial path.
+     */
+    PathSearchInput redirectUnreachableGoal(const MapTerrain& terrain, const MovementClassCollisionService& collisionService, const PathSearchInput& input)
+    {
+        if (!input.movementClass)
+        {
+            return input;
+        }
+
+        auto component = collisionService.getComponent(*input.movementClass, input.start);
+        if (!component || isGoalReachable(collisionService, input, *component))
+        {
+            return input;
+        }
+
+        const auto& goal = input.goal;
+        Point target(goal.x + static_cast<int>(goal.width / 2), goal.y + static_cast<int>(goal.height / 2));
+        auto cell = collisionService.findNearestInComponent(*input.movementClass, *component, target);
+        assert(!!cell);
+
+        auto redirected = input;
+        redirected.goal = DiscreteRect(cell->x, cell->y, input.footprintX, input.footprintZ);
+        redirected.destination = getWorldCenter(terrain, redirected.goal);
+        return redirected;
+    }
+
+    bool isNeighbour(const Point& a, const Point& b)
+    {
+        auto d = b - a;
+        return std::abs(d.x) <= 1 && std::abs(d.y) <= 1;
+    }
+
+    /** Turns the cells of a path into waypoints at the centre of the unit's footprint at each corner. */
+    UnitPath toUnitPath(const MapTerrain& terrain, const std::vector<Point>& cells, unsigned int footprintX, unsigned int footprintZ)
+    {
+        auto simplifiedPath = runSimplifyPath(cells);
+
+        UnitPath path;
+        for (auto it = ++simplifiedPath.cbegin(); it != simplifiedPath.cend(); ++it)
+        {
+            path.waypoints.push_back(getWorldCenter(terrain, DiscreteRect(it->x, it->y, footprintX, footprintZ)));
+            path.cells.push_back(*it);
+        }
+
+        return path;
+    }
+
+    /** Returns true if the unit's footprint fits at the cell. */
+    bool isCellWalkable(
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const PathSearchInput& input,
+        const Point& p)
+    {
+        DiscreteRect rect(p.x, p.y, input.footprintX, input.footprintZ);
+        return (input.movementClass ? collisionService.isWalkable(*input.movementClass, p) : true)
+            && !occupiedGrid.isCollisionAt(rect, input.unitId);
+    }
+
+    /**
+     * Searches from the unit's start to the cell of the route at the given index
+     * and follows the route from there to its end.
+     * Returns the cells of the whole path and the search's debug info,
+     * or nothing if the search could not reach the route
+     * or the unit is already at the end of it.
+     */
+    std::optional<std::pair<std::vector<Point>, AStarPathInfo<Point, PathCost>>> joinRoute(
+        AStarNodeGrid<PathCost>* nodes,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const PathSearchInput& input,
+        const std::vector<Point>& route,
+        std::size_t joinIndex)
+    {
+        UnitPathFinder pathFinder(
+            nodes,
+            &occupiedGrid,
+            &collisionService,
+            input.unitId,
+            input.movementClass,
+            input.footprintX,
+            input.footprintZ,
+            route[joinIndex]);
+        auto detour = pathFinder.findPath(input.start);
+        if (detour.type == AStarPathType::Partial)
+        {
+            return std::nullopt;
+        }
+
+        auto cells = detour.path;
+        cells.insert(cells.end(), route.begin() + joinIndex + 1, route.end());
+        if (cells.size() == 1)
+        {
+            return std::nullopt;
+        }
+
+        return std::make_pair(std::move(cells), std::move(detour));
+    }
+
+    /**
+     * Routes the unit around whatever now blocks the path it was following
+     * and rejoins the path beyond it, keeping the rest of the path as it was.
+     * Returns nothing if there is no path to repair or no way around the blockage nearby,
+     * in which case the unit needs a full search.
+     */
+    std::optional<PathSearchResult> repairUnitPath(
+        AStarNodeGrid<PathCost>* nodes,
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const PathSearchInput& input)
+    {
+        if (!input.previousPath || input.previousPath->cells.empty())
         {
-            auto& request = requests.front();
+            return std::nullopt;
+        }
+
+        const auto& previousPath = *input.previousPath;
+        auto route = expandRoute(previousPath.cells);
 
-            auto& unit = simulation->getUnit(request.unitId);
+        auto isWalkable = [&](const Point& p) { return isCellWalkable(occupiedGrid, collisionService, input, p); };
+        auto rejoinIndex = findRejoinIndex(route, isWalkable);
+        if (!rejoinIndex)
+        {
+            return std::nullopt;
+        }
+
+        auto joined = joinRoute(nodes, occupiedGrid, collisionService, input, route, *rejoinIndex);
+        if (!joined)
+        {
+            return std::nullopt;
+        }
 
-            if (auto movingState = boost::get<MovingState>(&unit.behaviourState); movingState != nullptr)
+        // The last waypoint may be an exact destination rather than the centre of a cell.
+        auto path = toUnitPath(terrain, joined->first, input.footprintX, input.footprintZ);
+        path.waypoints.back() = previousPath.waypoints.back();
+
+        return PathSearchResult{std::move(path), std::move(joined->second)};
+    }
+
+    /**
+     * Gets the unit onto a route cached for an earlier order to the same place from nearby,
+     * at the cell nearest to it that is not before the first blocked stretch of the route,
+     * and follows the route from there.
+     * Returns nothing if there is no cached route or no way onto it nearby,
+     * in which case the unit needs a full search.
+     */
+    std::optional<PathSearchResult> followCachedRoute(
+        AStarNodeGrid<PathCost>* nodes,
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const PathSearchInput& input)
+    {
+        if (!input.cachedRoute)
+        {
+            return std::nullopt;
+        }
+
+        auto route = expandRoute(*input.cachedRoute);
+
+        auto isWalkable = [&](const Point& p) { return isCellWalkable(occupiedGrid, collisionService, input, p); };
+        auto rejoinIndex = findRejoinIndex(route, isWalkable);
+        if (!rejoinIndex)
+        {
+            return std::nullopt;
+        }
+
+        auto joinIndex = *rejoinIndex;
+        auto joinDistance = octileDistance(input.start, route[joinIndex]);
+        for (auto i = joinIndex + 1; i < route.size(); ++i)
+        {
+            auto distance = octileDistance(input.start, route[i]);
+            if (distance < joinDistance)
             {
-                UnitPath path = boost::apply_visitor(FindPathVisitor(this, request.unitId), movingState->destination);
-                movingState->path = PathFollowingInfo(std::move(path), simulation->gameTime);
-                movingState->pathRequested = false;
+                joinIndex = i;
+                joinDistance = distance;
             }
+        }
+
+        auto joined = joinRoute(nodes, occupiedGrid, collisionService, input, route, joinIndex);
+        if (!joined)
+        {
+            return std::nullopt;
+        }
 
-            requests.pop_front();
-            tasksDone += 1;
+        auto path = toUnitPath(terrain, joined->first, input.footprintX, input.footprintZ);
+        if (const auto* destination = boost::get<Vector3f>(&input.destination); destination != nullptr)
+        {
+            path.waypoints.back() = *destination;
         }
+
+        return PathSearchResult{std::move(path), std::move(joined->second)};
     }
 
-    UnitPath PathFindingService::findPath(UnitId unitId, const DiscreteRect& destination)
+    class FindPathVisitor : public boost::static_visitor<PathSearchResult>
     {
-        const auto& unit = simulation->getUnit(unitId);
+    private:
+        AStarNodeGrid<PathCost>* nodes;
+        const MapTerrain* terrain;
+        const OccupiedGrid* occupiedGrid;
+        const MovementClassCollisionService* collisionService;
+        const ClusterGraph* clusterGraph;
+        const FlowField* flowField;
+        const PathSearchInput* input;
 
-        auto start = simulation->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        // expand the goal rect to take into account our own collision rect
-        auto goal = expandTopLeft(destination, unit.footprintX, unit.footprintZ);
+    public:
+        FindPathVisitor(
+            AStarNodeGrid<PathCost>* nodes,
+            const MapTerrain* terrain,
+            const OccupiedGrid* occupiedGrid,
+            const MovementClassCollisionService* collisionService,
+            const ClusterGraph* clusterGraph,
+            const FlowField* flowField,
+            const PathSearchInput* input)
+            : nodes(nodes),
+              terrain(terrain),
+              occupiedGrid(occupiedGrid),
+              collisionService(collisionService),
+              clusterGraph(clusterGraph),
+              flowField(flowField),
+              input(input)
+        {
+        }
 
-        UnitPerimeterPathFinder pathFinder(simulation, collisionService, unitId, unit.movementClass, unit.footprintX, unit.footprintZ, goal);
+        PathSearchResult operator()(const Vector3f& destination) const
+        {
+            auto path = findPathToPoint(Point(input->goal.x, input->goal.y));
+
+            auto cells = path.path;
+            if (path.type == AStarPathType::Partial)
+            {
+                cells.emplace_back(input->goal.x, input->goal.y);
+            }
 
-        auto path = pathFinder.findPath(Point(start.x, start.y));
-        lastPathDebugInfo = AStarPathInfo<Point, PathCost>{path.type, path.path, std::move(path.closedVertices)};
+            assert(cells.size() >= 1);
 
-        assert(path.path.size() >= 1);
+            if (cells.size() == 1)
+            {
+                // The path is trivial, we are already at the goal.
+                return PathSearchResult{UnitPath{std::vector<Vector3f>{destination}, {}}, std::move(path)};
+            }
 
-        if (path.path.size() == 1)
+            auto unitPath = toUnitPath(*terrain, cells, input->footprintX, input->footprintZ);
+            unitPath.waypoints.back() = destination;
+
+            return PathSearchResult{std::move(unitPath), std::move(path)};
+        }
+
+        PathSearchResult operator()(const DiscreteRect&) const
         {
-            // The path is trivial, we are already at the goal.
-            return UnitPath{std::vector<Vector3f>{unit.position}};
+            auto path = findPathToRect();
+
+            assert(path.path.size() >= 1);
+
+            if (path.path.size() == 1)
+            {
+                // The path is trivial, we are already at the goal.
+                return PathSearchResult{UnitPath{std::vector<Vector3f>{input->position}, {}}, std::move(path)};
+            }
+
+            auto unitPath = toUnitPath(*terrain, path.path, input->footprintX, input->footprintZ);
+            return PathSearchResult{std::move(unitPath), std::move(path)};
         }
 
-        auto simplifiedPath = runSimplifyPath(path.path);
+    private:
+        AStarPathInfo<Point, PathCost> findPathToPoint(const Point& goal) const
+        {
+            if (auto path = followFlowField(); path)
+            {
+                return std::move(*path);
+            }
 
-        std::vector<Vector3f> waypoints;
-        for (auto it = ++simplifiedPath.cbegin(); it != simplifiedPath.cend(); ++it)
+            auto route = findRoute(goal);
+            if (!route)
+            {
+                return findLeg(goal, input->start);
+            }
+
+            AStarPathInfo<Point, PathCost> path{AStarPathType::Complete, {input->start}, {}};
+            for (const auto& waypoint : *route)
+            {
+                if (!appendLeg(path, findLeg(waypoint, path.path.back())))
+                {
+                    break;
+                }
+            }
+
+            return path;
+        }
+
+        AStarPathInfo<Point, PathCost> findPathToRect() const
+        {
+            if (auto path = followFlowField(); path)
+            {
+                return std::move(*path);
+            }
+
+            const auto& goal = input->goal;
+            auto route = findRoute(Point(goal.x + static_cast<int>(goal.width / 2), goal.y + static_cast<int>(goal.height / 2)));
+            if (!route)
+            {
+                return findPerimeterLeg(input->start);
+            }
+
+            // The route ends in the middle of the goal,
+            // but we only need to get as far as its edge.
+            route->pop_back();
+
+            AStarPathInfo<Point, PathCost> path{AStarPathType::Complete, {input->start}, {}};
+            for (const auto& waypoint : *route)
+            {
+                if (!appendLeg(path, findLeg(waypoint, path.path.back())))
+                {
+                    return path;
+                }
+            }
+
+            appendLeg(path, findPerimeterLeg(path.path.back()));
+            return path;
+        }
+
+        std::optional<AStarPathInfo<Point, PathCost>> followFlowField() const
+        {
+            if (flowField == nullptr)
+            {
+                return std::nullopt;
+            }
+
+            auto cells = flowField->tracePath(input->start);
+            if (!cells)
+            {
+                return std::nullopt;
+            }
+
+            return AStarPathInfo<Point, PathCost>{AStarPathType::Complete, std::move(*cells), {}};
+        }
+
+        /**
+         * Plans a route to the goal over the cluster graph
+         * and returns the points after the start to search towards in turn.
+         */
+        std::optional<std::vector<Point>> findRoute(const Point& goal) const
+        {
+            if (clusterGraph == nullptr)
+            {
+                return std::nullopt;
+            }
+
+            auto route = clusterGraph->findRoute(input->start, goal);
+            if (!route)
+            {
+                return std::nullopt;
+            }
+
+            // The nodes either side of an entrance are a step apart,
+            // so search straight through to the far one.
+            std::vector<Point> waypoints;
+            for (std::size_t i = 1; i < route->size(); ++i)
+            {
+                if (i + 1 < route->size() && isNeighbour((*route)[i], (*route)[i + 1]))
+                {
+                    continue;
+                }
+
+                waypoints.push_back((*route)[i]);
+            }
+
+            return waypoints;
+        }
+
+        AStarPathInfo<Point, PathCost> findLeg(const Point& goal, const Point& start) const
+        {
+            UnitPathFinder pathFinder(
+                nodes,
+                occupiedGrid,
+                collisionService,
+                input->unitId,
+                input->movementClass,
+                input->footprintX,
+                input->footprintZ,
+                goal);
+
+            return pathFinder.findPath(start);
+        }
+
+        AStarPathInfo<Point, PathCost> findPerimeterLeg(const Point& start) const
+        {
+            UnitPerimeterPathFinder pathFinder(
+                nodes,
+                occupiedGrid,
+                collisionService,
+                input->unitId,
+                input->movementClass,
+                input->footprintX,
+                input->footprintZ,
+                input->goal);
+
+            return pathFinder.findPath(start);
+        }
+
+        /**
+         * Extends the path with a leg that starts where it ends.
+         * Returns false if the leg fell short of its goal.
+         */
+        bool appendLeg(AStarPathInfo<Point, PathCost>& path, AStarPathInfo<Point, PathCost>&& leg) const
+        {
+            path.path.insert(path.path.end(), ++leg.path.begin(), leg.path.end());
+            path.closedEdges.insert(path.closedEdges.end(), leg.closedEdges.begin(), leg.closedEdges.end());
+
+            if (leg.type == AStarPathType::Partial)
+            {
+                path.type = AStarPathType::Partial;
+                return false;
+            }
+
+            return true;
+        }
+    };
+
+    PathSearchResult findUnitPath(
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const ClusterGraph* clusterGraph,
+        const FlowField* flowField,
+        const PathSearchInput& input)
+    {
+        // Searches run on pool threads, so each thread keeps its own node storage.
+        thread_local AStarNodeGrid<PathCost> nodes;
+
+        if (auto repaired = repairUnitPath(&nodes, terrain, occupiedGrid, collisionService, input); repaired)
+        {
+            return std::move(*repaired);
+        }
+
+        if (auto followed = followCachedRoute(&nodes, terrain, occupiedGrid, collisionService, input); followed)
+        {
+            return std::move(*followed);
+        }
+
+        auto reachableInput = redirectUnreachableGoal(terrain, collisionService, input);
+        FindPathVisitor visitor(&nodes, &terrain, &occupiedGrid, &collisionService, clusterGraph, flowField, &reachableInput);
+        return boost::apply_visitor(visitor, reachableInput.destination);
+    }
+
+    /** Rough costs of a search's work, in microseconds, from which search times are estimated. */
+    static const unsigned int SearchBaseCostMicros = 50;
+    static const unsigned int SearchCostMicrosPerCell = 4;
+
+    /** A flow field's cost grows with the area it covers, the square of its reach. */
+    static const unsigned int FlowFieldCellsPerMicro = 2;
+
+    static std::chrono::microseconds timeSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    }
+
+    /** The number of diagonal or straight steps from the input's start to its goal, ignoring obstacles. */
+    static unsigned int getStepsToGoal(const PathSearchInput& input)
+    {
+        auto dx = std::abs(input.goal.x - input.start.x);
+        auto dy = std::abs(input.goal.y - input.start.y);
+        return static_cast<unsigned int>(std::max(dx, dy));
+    }
+
+    unsigned int estimateSearchCost(const std::vector<PathSearchInput>& group)
+    {
+        if (group.size() >= PathFindingService::MinFlowFieldGroupSize)
+        {
+            unsigned int reach = 0;
+            for (const auto& input : group)
+            {
+                reach = std::max(reach, getStepsToGoal(input));
+            }
+
+            auto traceCost = static_cast<unsigned int>(group.size()) * reach;
+            return SearchBaseCostMicros + ((reach * reach) / FlowFieldCellsPerMicro) + traceCost;
+        }
+
+        unsigned int cost = 0;
+        for (const auto& input : group)
+        {
+            // A unit joining a cached route only searches as far as the route,
+            // which started within a coarse cell of it.
+            auto steps = input.cachedRoute ? static_cast<unsigned int>(PathCache::CoarseCellSize) : getStepsToGoal(input);
+            cost += SearchBaseCostMicros + (SearchCostMicrosPerCell * steps);
+        }
+        return cost;
+    }
+
+    bool isSameDestination(const PathSearchInput& a, const PathSearchInput& b)
+    {
+        return a.movementClass == b.movementClass
+            && a.footprintX == b.footprintX
+            && a.footprintZ == b.footprintZ
+            && a.destination.which() == b.destination.which()
+            && a.goal == b.goal;
+    }
+
+    std::vector<PathSearchResult> findGroupUnitPaths(
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const ClusterGraph* clusterGraph,
+        const std::vector<PathSearchInput>& inputs)
+    {
+        assert(!inputs.empty());
+        const auto& first = inputs.front();
+
+        // The units in the group are all heading the same way,
+        // so they do not get in each other's way.
+        std::unordered_set<UnitId> group;
+        std::vector<Point> starts;
+        for (const auto& input : inputs)
+        {
+            assert(isSameDestination(input, first));
+            group.insert(input.unitId);
+
+            // Units cut off from the goal search for themselves,
+            // so there is no need to grow the field looking for them.
+            auto component = input.movementClass ? collisionService.getComponent(*input.movementClass, input.start) : std::nullopt;
+            if (!component || isGoalReachable(collisionService, input, *component))
+            {
+                starts.push_back(input.start);
+            }
+        }
+
+        auto isWalkable = [&](const Point& p) {
+            DiscreteRect rect(p.x, p.y, first.footprintX, first.footprintZ);
+            return (first.movementClass ? collisionService.isWalkable(*first.movementClass, p) : true)
+                && !occupiedGrid.isCollisionAt(rect, group);
+        };
+        auto isRoughTerrain = [&](const Point& p) {
+            DiscreteRect rect(p.x, p.y, first.footprintX, first.footprintZ);
+            return occupiedGrid.isAdjacentToObstacle(rect, group);
+        };
+
+        std::vector<Point> goals;
+        const auto& goal = first.goal;
+        if (boost::get<DiscreteRect>(&first.destination) != nullptr)
+        {
+            for (unsigned int y = 0; y < goal.height; ++y)
+            {
+                for (unsigned int x = 0; x < goal.width; ++x)
+                {
+                    Point p(goal.x + static_cast<int>(x), goal.y + static_cast<int>(y));
+                    if (goal.isInteriorPerimeter(p.x, p.y) && isWalkable(p))
+                    {
+                        goals.push_back(p);
+                    }
+                }
+            }
+        }
+        else if (isWalkable(Point(goal.x, goal.y)))
+        {
+            goals.emplace_back(goal.x, goal.y);
+        }
+
+        std::optional<FlowField> flowField;
+        if (!starts.empty())
+        {
+            flowField.emplace(occupiedGrid.grid.getWidth(), occupiedGrid.grid.getHeight(), goals, starts, isWalkable, isRoughTerrain);
+        }
+
+        // Units the field does not reach search for themselves as usual.
+        std::vector<PathSearchResult> results;
+        for (const auto& input : inputs)
+        {
+            results.push_back(findUnitPath(terrain, occupiedGrid, collisionService, clusterGraph, flowField ? &*flowField : nullptr, input));
+        }
+
+        return results;
+    }
+
+    class ComputePathGoalVisitor : public boost::static_visitor<DiscreteRect>
+    {
+    private:
+        const GameSimulation* simulation;
+        const Unit* unit;
+
+    public:
+        ComputePathGoalVisitor(const GameSimulation* simulation, const Unit* unit) : simulation(simulation), unit(unit)
+        {
+        }
+
+        DiscreteRect operator()(const Vector3f& destination) const
+        {
+            return simulation->computeFootprintRegion(destination, unit->footprintX, unit->footprintZ);
+        }
+
+        DiscreteRect operator()(const DiscreteRect& destination) const
         {
-            waypoints.push_back(getWorldCenter(DiscreteRect(it->x, it->y, unit.footprintX, unit.footprintZ)));
+            // expand the goal rect to take into account our own collision rect
+            return expandTopLeft(destination, unit->footprintX, unit->footprintZ);
+        }
+    };
+
+    /** Returns true if the search found a complete path that reaches the goal it is cached under. */
+    static bool isCacheable(const PathCacheKey& key, const PathSearchResult& result)
+    {
+        const auto& cells = result.path.cells;
+        if (result.debugInfo.type != AStarPathType::Complete || cells.empty())
+        {
+            return false;
+        }
+
+        // A unit cut off from its goal is sent somewhere else instead.
+        const auto& last = cells.back();
+        return key.isRectGoal
+            ? key.goal.isInteriorPerimeter(last.x, last.y)
+            : last == Point(key.goal.x, key.goal.y);
+    }
+
+    PathFindingService::PathFindingService(GameSimulation* simulation, const MovementClassCollisionService* collisionService, unsigned int workerThreadCount)
+        : simulation(simulation), collisionService(collisionService), threadPool(workerThreadCount)
+    {
+    }
+
+    void PathFindingService::finishSearches()
+    {
+        const auto& requests = simulation->pathRequests;
+        metrics.searchTime = std::chrono::microseconds(0);
+        for (auto& search : runningSearches)
+        {
+            auto completed = search.completed.get();
+            auto& results = completed.results;
+            assert(results.size() == search.unitIds.size());
+            metrics.searchTime += completed.duration;
+
+            for (std::size_t i = 0; i < results.size(); ++i)
+            {
+                auto unitId = search.unitIds[i];
+                auto& result = results[i];
+
+                const auto& cacheKey = search.cacheKeys[i];
+                if (cacheKey && isCacheable(*cacheKey, result))
+                {
+                    simulation->pathCache.insert(*cacheKey, result.path.cells);
+                }
+
+                lastPathDebugInfo = std::move(result.debugInfo);
+
+                if (!simulation->unitExists(unitId))
+                {
+                    continue;
+                }
+
+                // If the unit asked again while we were searching,
+                // it wants a path to somewhere else or from somewhere else.
+                if (requests.contains(unitId))
+                {
+                    continue;
+                }
+
+                auto& unit = simulation->getUnit(unitId);
+                if (auto movingState = boost::get<MovingState>(&unit.behaviourState); movingState != nullptr)
+                {
+                    movingState->path = PathFollowingInfo(std::move(result.path), simulation->gameTime);
+                    movingState->pathRequested = false;
+                }
+            }
+        }
+
+        runningSearches.clear();
+        simulation->pathRequestsInProgress.clear();
+    }
+
+    void PathFindingService::startSearches()
+    {
+        assert(runningSearches.empty());
+
+        updateClusterGraphs();
+
+        auto searchTime = metrics.searchTime;
+        metrics = PathFindingMetrics();
+        metrics.searchTime = searchTime;
+
+        auto& requests = simulation->pathRequests;
+        auto& inProgress = simulation->pathRequestsInProgress;
+        while (metrics.searchesStarted == 0 || metrics.estimatedMicros < SearchBudgetMicros)
+        {
+            auto request = requests.pop();
+            if (!request)
+            {
+                break;
+            }
+
+            if (!needsPath(request->unitId))
+            {
+                continue;
+            }
+
+            inProgress.push_back(*request);
+            recordStartedRequest(*request);
+
+            // Take the rest of the units going to the same place along with it,
+            // since a group that shares a flow field costs about as much as one search.
+            std::vector<PathSearchInput> group{createSearchInput(*request)};
+            for (const auto& other : requests.getRequests())
+            {
+                if (needsPath(other.unitId))
+                {
+                    auto input = createSearchInput(other);
+                    if (isSameDestination(input, group.front()))
+                    {
+                        inProgress.push_back(other);
+                        recordStartedRequest(other);
+                        requests.erase(other.unitId);
+                        group.push_back(std::move(input));
+                    }
+                }
+            }
+
+            for (const auto& input : group)
+            {
+                if (input.cachedRoute)
+                {
+                    metrics.pathCacheHits += 1;
+                }
+                else if (input.cacheKey)
+                {
+                    metrics.pathCacheMisses += 1;
+                }
+            }
+
+            metrics.estimatedMicros += estimateSearchCost(group);
+            metrics.searchesStarted += group.size() >= MinFlowFieldGroupSize ? 1 : static_cast<unsigned int>(group.size());
         }
 
-        return UnitPath{std::move(waypoints)};
+        metrics.queueDepth = requests.size();
+
+        startSearches(inProgress);
     }
 
-    UnitPath PathFindingService::findPath(UnitId unitId, const Vector3f& destination)
+    void PathFindingService::restartSearches()
     {
-        const auto& unit = simulation->getUnit(unitId);
+        waitForSearches();
+        runningSearches.clear();
+
+        // The simulation may have been replaced with one from the same game time,
+        // whose features may not be the ones the graphs were built from.
+        occupiedGridSnapshot.reset();
+        clusterGraphs.clear();
+        simulation->changedFeatureAreas.clear();
+
+        startSearches(simulation->pathRequestsInProgress);
+    }
+
+    const PathFindingMetrics& PathFindingService::getMetrics() const
+    {
+        return metrics;
+    }
+
+    bool PathFindingService::needsPath(UnitId unitId) const
+    {
+        return simulation->unitExists(unitId) && boost::get<MovingState>(&simulation->getUnit(unitId).behaviourState) != nullptr;
+    }
+
+    void PathFindingService::recordStartedRequest(const PathRequest& request)
+    {
+        auto wait = (simulation->gameTime - request.requestTime).value;
+        metrics.requestsStarted += 1;
+        metrics.totalWaitTicks += wait;
+        metrics.maxWaitTicks = std::max(metrics.maxWaitTicks, wait);
+    }
+
+    PathSearchInput PathFindingService::createSearchInput(const PathRequest& request) const
+    {
+        const auto& unit = simulation->getUnit(request.unitId);
+
+        auto movingState = boost::get<MovingState>(&unit.behaviourState);
+        assert(movingState != nullptr);
 
         auto start = simulation->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        auto goal = simulation->computeFootprintRegion(destination, unit.footprintX, unit.footprintZ);
 
-        UnitPathFinder pathFinder(simulation, collisionService, unitId, unit.movementClass, unit.footprintX, unit.footprintZ, Point(goal.x, goal.y));
+        auto goal = boost::apply_visitor(ComputePathGoalVisitor(simulation, &unit), movingState->destination);
 
-        auto path = pathFinder.findPath(Point(start.x, start.y));
-        lastPathDebugInfo = AStarPathInfo<Point, PathCost>{path.type, path.path, std::move(path.closedVertices)};
+        // Orders to the same place from nearby can share a route.
+        std::optional<PathCacheKey> cacheKey;
+        PathCache::Route cachedRoute;
+        if (request.priority == PathRequestPriority::Order)
+        {
+            cacheKey = PathCacheKey{
+                unit.movementClass,
+                unit.footprintX,
+                unit.footprintZ,
+                PathCache::toCoarseCell(Point(start.x, start.y)),
+                boost::get<DiscreteRect>(&movingState->destination) != nullptr,
+                goal,
+                simulation->pathCache.getEpoch()};
+            cachedRoute = simulation->pathCache.find(*cacheKey);
+        }
 
-        if (path.type == AStarPathType::Partial)
+        // A unit asking again because it got stuck is still heading the same way,
+        // so the search can try to repair the rest of its path.
+        std::optional<UnitPath> previousPath;
+        if (request.priority == PathRequestPriority::Repath && movingState->path)
         {
-            path.path.emplace_back(goal.x, goal.y);
+            const auto& path = *movingState->path;
+            previousPath = UnitPath{std::vector<Vector3f>(path.currentWaypoint, path.path.waypoints.cend()), {}};
+            if (!path.path.cells.empty())
+            {
+                assert(path.path.cells.size() == path.path.waypoints.size());
+                auto index = path.currentWaypoint - path.path.waypoints.cbegin();
+                previousPath->cells.assign(path.path.cells.begin() + index, path.path.cells.end());
+            }
         }
 
-        assert(path.path.size() >= 1);
+        return PathSearchInput{
+            request.unitId,
+            unit.position,
+            Point(start.x, start.y),
+            unit.movementClass,
+            unit.footprintX,
+            unit.footprintZ,
+            movingState->destination,
+            goal,
+            std::move(previousPath),
+            std::move(cacheKey),
+            std::move(cachedRoute)};
+    }
 
-        if (path.path.size() == 1)
+    /** Units that joined a cached route leave it as it is; the rest add the routes they find. */
+    static std::optional<PathCacheKey> getCacheKeyForResult(const PathSearchInput& input)
+    {
+        return input.cachedRoute ? std::nullopt : input.cacheKey;
+    }
+
+    void PathFindingService::startSearches(const std::vector<PathRequest>& requests)
+    {
+        if (requests.empty())
         {
-            // The path is trivial, we are already at the goal.
-            return UnitPath{std::vector<Vector3f>{destination}};
+            return;
         }
 
-        auto simplifiedPath = runSimplifyPath(path.path);
+        if (!occupiedGridSnapshot)
+        {
+            occupiedGridSnapshot = std::make_shared<OccupiedGrid>(simulation->occupiedGrid);
+        }
+        else
+        {
+            occupiedGridSnapshot->updateFrom(simulation->occupiedGrid);
+        }
 
-        std::vector<Vector3f> waypoints;
-        for (auto it = ++simplifiedPath.cbegin(); it != simplifiedPath.cend(); ++it)
+        // Group the requests by destination, keeping the groups in order of their first request.
+        std::vector<std::vector<PathSearchInput>> groups;
+        for (const auto& request : requests)
+        {
+            auto input = createSearchInput(request);
+            auto group = std::find_if(groups.begin(), groups.end(), [&](const auto& g) { return isSameDestination(g.front(), input); });
+            if (group == groups.end())
+            {
+                groups.push_back(std::vector<PathSearchInput>{std::move(input)});
+            }
+            else
+            {
+                group->push_back(std::move(input));
+            }
+        }
+
+        const auto* terrain = &simulation->terrain;
+        const auto* collisionService = this->collisionService;
+        std::shared_ptr<const OccupiedGrid> occupiedGrid = occupiedGridSnapshot;
+
+        for (auto& group : groups)
+        {
+            auto clusterGraph = getClusterGraph(simulation->getUnit(group.front().unitId));
+
+            if (group.size() >= MinFlowFieldGroupSize)
+            {
+                std::vector<UnitId> unitIds;
+                std::vector<std::optional<PathCacheKey>> cacheKeys;
+                for (const auto& input : group)
+                {
+                    unitIds.push_back(input.unitId);
+                    cacheKeys.push_back(getCacheKeyForResult(input));
+                }
+
+                auto completed = threadPool.submit([terrain, collisionService, clusterGraph, occupiedGrid, inputs = std::move(group)]() {
+                    auto start = std::chrono::steady_clock::now();
+                    auto results = findGroupUnitPaths(*terrain, *occupiedGrid, *collisionService, waitForClusterGraph(clusterGraph), inputs);
+                    return CompletedSearch{std::move(results), timeSince(start)};
+                });
+                runningSearches.push_back(RunningSearch{std::move(unitIds), std::move(cacheKeys), std::move(completed)});
+                continue;
+            }
+
+            for (auto& input : group)
+            {
+                auto unitId = input.unitId;
+                auto cacheKey = getCacheKeyForResult(input);
+                auto completed = threadPool.submit([terrain, collisionService, clusterGraph, occupiedGrid, input = std::move(input)]() {
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<PathSearchResult> results{findUnitPath(*terrain, *occupiedGrid, *collisionService, waitForClusterGraph(clusterGraph), nullptr, input)};
+                    return CompletedSearch{std::move(results), timeSince(start)};
+                });
+                runningSearches.push_back(RunningSearch{std::vector<UnitId>{unitId}, std::vector<std::optional<PathCacheKey>>{cacheKey}, std::move(completed)});
+            }
+        }
+    }
+
+    PathFindingService::PendingClusterGraph PathFindingService::getClusterGraph(const Unit& unit)
+    {
+        if (!unit.movementClass)
+        {
+            // units without a movement class can go anywhere
+            return PendingClusterGraph();
+        }
+
+        auto key = std::make_tuple(unit.movementClass->value, unit.footprintX, unit.footprintZ);
+        auto it = clusterGraphs.find(key);
+        if (it == clusterGraphs.end())
         {
-            waypoints.push_back(getWorldCenter(DiscreteRect(it->x, it->y, unit.footprintX, unit.footprintZ)));
+            // Building a graph scans the whole map, which is too slow to do on the simulation thread.
+            // Only features are read from the grid, and the snapshot has the same ones as the simulation.
+            const auto* walkableGrid = &collisionService->getGrid(*unit.movementClass);
+            std::shared_ptr<const OccupiedGrid> occupiedGrid = occupiedGridSnapshot;
+            auto built = threadPool.submit([walkableGrid, occupiedGrid, footprintX = unit.footprintX, footprintZ = unit.footprintZ]() {
+                GridRegion region(0, 0, walkableGrid->getWidth(), walkableGrid->getHeight());
+                auto passable = computeStaticPassableArea(*walkableGrid, *occupiedGrid, footprintX, footprintZ, region);
+                return std::make_shared<ClusterGraph>(std::move(passable));
+            });
+            it = clusterGraphs.emplace(key, built.share()).first;
         }
-        waypoints.back() = destination;
 
-        return UnitPath{std::move(waypoints)};
+        return it->second;
     }
 
-    Vector3f PathFindingService::getWorldCenter(const DiscreteRect& rect)
+    const ClusterGraph* PathFindingService::waitForClusterGraph(const PendingClusterGraph& clusterGraph)
     {
-        auto corner = simulation->terrain.heightmapIndexToWorldCorner(rect.x, rect.y);
+        return clusterGraph.valid() ? clusterGraph.get().get() : nullptr;
+    }
 
-        auto halfWorldWidth = (rect.width * MapTerrain::HeightTileWidthInWorldUnits) / 2.0f;
-        auto halfWorldHeight = (rect.height * MapTerrain::HeightTileHeightInWorldUnits) / 2.0f;
+    void PathFindingService::updateClusterGraphs()
+    {
+        for (const auto& area : simulation->changedFeatureAreas)
+        {
+            for (auto& entry : clusterGraphs)
+            {
+                auto movementClass = MovementClassId(std::get<0>(entry.first));
+                auto footprintX = std::get<1>(entry.first);
+                auto footprintZ = std::get<2>(entry.first);
 
-        auto center = corner + Vector3f(halfWorldWidth, 0.0f, halfWorldHeight);
-        center.y = simulation->terrain.getHeightAt(center.x, center.z);
-        return center;
+                // A cell is passable if the footprint placed there avoids the feature,
+                // so cells up to a footprint above and to the left of the area are affected.
+                const auto& walkableGrid = collisionService->getGrid(movementClass);
+                auto region = walkableGrid.clipRegion(expandTopLeft(area, footprintX - 1, footprintZ - 1));
+                auto passable = computeStaticPassableArea(walkableGrid, simulation->occupiedGrid, footprintX, footprintZ, region);
+                entry.second.get()->replaceArea(region.x, region.y, passable);
+            }
+        }
+
+        if (!simulation->changedFeatureAreas.empty())
+        {
+            simulation->pathCache.advanceEpoch();
+        }
+
+        simulation->changedFeatureAreas.clear();
     }
 
-    DiscreteRect PathFindingService::expandTopLeft(const DiscreteRect& rect, unsigned int width, unsigned int height)
+    void PathFindingService::waitForSearches()
     {
-        return DiscreteRect(
-            rect.x - static_cast<int>(width),
-            rect.y - static_cast<int>(height),
-            rect.width + width,
-            rect.height + height);
+        for (auto& search : runningSearches)
+        {
+            search.completed.wait();
+        }
     }
 }
@@ -1,61 +1,297 @@
 #ifndef RWE_PATHFINDINGSERVICE_H
 #define RWE_PATHFINDINGSERVICE_H
 
-#include <deque>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <rwe/DiscreteRect.h>
 #include <rwe/GameSimulation.h>
 #include <rwe/MovementClassCollisionService.h>
+#include <rwe/MovementClassId.h>
+#include <rwe/OccupiedGrid.h>
 #include <rwe/Point.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/Unit.h>
 #include <rwe/UnitId.h>
 #include <rwe/math/Vector3f.h>
 #include <rwe/pathfinding/AStarPathFinder.h>
+#include <rwe/pathfinding/ClusterGraph.h>
+#include <rwe/pathfinding/FlowField.h>
 #include <rwe/pathfinding/OctileDistance.h>
+#include <rwe/pathfinding/PathCache.h>
 #include <rwe/pathfinding/PathCost.h>
 #include <rwe/pathfinding/UnitPath.h>
+#include <tuple>
+#include <vector>
 
 namespace rwe
 {
+    /**
+     * Everything a path search needs to know about the unit,
+     * copied out of the simulation when the search starts.
+     */
+    struct PathSearchInput
+    {
+        UnitId unitId;
+        Vector3f position;
+        Point start;
+        std::optional<MovementClassId> movementClass;
+        unsigned int footprintX;
+        unsigned int footprintZ;
+        MovingStateGoal destination;
+
+        /**
+         * The destination in heightmap cells.
+         * For a rect destination, this is expanded to account for the unit's footprint.
+         */
+        DiscreteRect goal;
+
+        /**
+         * For a unit that asked again because it got stuck,
+         * the rest of the path it was following.
+         * The search tries to repair this before searching from scratch.
+         */
+        std::optional<UnitPath> previousPath;
+
+        /** For a unit that was given an order, where the route it finds is cached. */
+        std::optional<PathCacheKey> cacheKey;
+
+        /**
+         * A route cached for a similar order, if there was one.
+         * The search tries to join this before searching from scratch.
+         */
+        PathCache::Route cachedRoute;
+    };
+
+    struct PathSearchResult
+    {
+        UnitPath path;
+        AStarPathInfo<Point, PathCost> debugInfo;
+    };
+
+    struct PathFindingMetrics
+    {
+        /** Requests still queued after the last searches were started. */
+        std::size_t queueDepth{0};
+
+        /** Searches started at the end of the last tick. A group sharing a flow field counts as one. */
+        unsigned int searchesStarted{0};
+
+        /** The estimated cost of those searches, in microseconds. */
+        unsigned int estimatedMicros{0};
+
+        /** The number of requests those searches were for. */
+        unsigned int requestsStarted{0};
+
+        /** The total and longest time, in ticks, those requests spent queued. */
+        unsigned int totalWaitTicks{0};
+        unsigned int maxWaitTicks{0};
+
+        /** How many of those requests found a cached route to join, and how many did not. */
+        unsigned int pathCacheHits{0};
+        unsigned int pathCacheMisses{0};
+
+        /**
+         * How long the searches applied at the start of the tick took on the workers, added together.
+         * Unlike everything else here, this depends on the machine.
+         */
+        std::chrono::microseconds searchTime{0};
+    };
+
+    /**
+     * Finds paths for units that have requested them.
+     *
+     * Searches are started at the end of a tick and run on worker threads
+     * against a copy of the occupied grid as it was at that point.
+     * Their results are applied at the start of the next tick,
+     * which is when the simulation used to search for them,
+     * so the outcome does not depend on how long a search takes.
+     * Movement class walkable grids do not change during a game,
+     * so searches read them directly.
+     *
+     * Long paths are planned over a ClusterGraph for the unit's movement class and footprint
+     * and then refined cluster by cluster, so that they are not cut short
+     * by the limit on how much of the map a single search may explore.
+     * The graphs are built the first time they are needed
+     * and kept up to date with features between ticks, while no searches are running.
+     *
+     * When enough units are sent to the same place at once,
+     * they share a single FlowField out from the destination
+     * instead of searching for a path each.
+     *
+     * A unit that gets stuck on its way keeps the path it was following.
+     * Its search first tries to go around the part of that path which is now blocked
+     * and rejoin it beyond, and only searches from scratch if that fails.
+     *
+     * The routes found for orders are kept in the simulation's PathCache.
+     * A later order to the same place from nearby searches for a way onto the cached route
+     * instead of all the way to the goal.
+     *
+     * Each tick starts searches in priority order until their estimated cost
+     * uses up SearchBudgetMicros. Costs are estimated from the searches' inputs
+     * rather than measured, so that every machine starts the same searches on the same tick.
+     */
     class PathFindingService
     {
+    public:
+        /**
+         * The estimated worker time the searches started each tick may take, in microseconds.
+         * At least one search is started each tick, however costly.
+         */
+        static const unsigned int SearchBudgetMicros = 4000;
+
+        /** The fewest units heading for the same place that share a flow field. */
+        static const unsigned int MinFlowFieldGroupSize = 4;
+
     private:
-        class FindPathVisitor : public boost::static_visitor<UnitPath>
+        struct CompletedSearch
         {
-        private:
-            PathFindingService* svc;
-            UnitId unitId;
-
-        public:
-            FindPathVisitor(PathFindingService* svc, const UnitId& unitId) : svc(svc), unitId(unitId)
-            {
-            }
-
-            UnitPath operator()(const Vector3f& pos) const
-            {
-                return svc->findPath(unitId, pos);
-            }
-            UnitPath operator()(const DiscreteRect& pos) const
-            {
-                return svc->findPath(unitId, pos);
-            }
+            /** A result for each unit, in the same order as RunningSearch::unitIds. */
+            std::vector<PathSearchResult> results;
+
+            std::chrono::microseconds duration;
+        };
+
+        struct RunningSearch
+        {
+            std::vector<UnitId> unitIds;
+
+            /** For each unit, where to cache the route it finds, if it is searching from scratch. */
+            std::vector<std::optional<PathCacheKey>> cacheKeys;
+
+            std::future<CompletedSearch> completed;
         };
 
         GameSimulation* const simulation;
-        MovementClassCollisionService* const collisionService;
+        const MovementClassCollisionService* const collisionService;
+
+        ThreadPool threadPool;
+
+        /**
+         * The occupied grid as it was when the running searches were started.
+         * Only updated while no searches are running,
+         * and then only in the rows that have changed since.
+         */
+        std::shared_ptr<OccupiedGrid> occupiedGridSnapshot;
+
+        /** Started for the requests in GameSimulation::pathRequestsInProgress. */
+        std::vector<RunningSearch> runningSearches;
+
+        /**
+         * A cluster graph that may still be being built on the pool.
+         * Tasks are taken from the pool in order,
+         * so searches queued after the build can safely wait for it.
+         */
+        using PendingClusterGraph = std::shared_future<std::shared_ptr<ClusterGraph>>;
+
+        /** Keyed by movement class, footprint X and footprint Z. */
+        std::map<std::tuple<MovementClassId::ValueType, unsigned int, unsigned int>, PendingClusterGraph> clusterGraphs;
+
+        PathFindingMetrics metrics;
 
     public:
-        PathFindingService(GameSimulation* simulation, MovementClassCollisionService* collisionService);
+        PathFindingService(GameSimulation* simulation, const MovementClassCollisionService* collisionService, unsigned int workerThreadCount);
+
+        PathFindingService(const PathFindingService&) = delete;
+        PathFindingService& operator=(const PathFindingService&) = delete;
 
         AStarPathInfo<Point, PathCost> lastPathDebugInfo;
 
-        void update();
+        /**
+         * Waits for the searches started last tick and gives each unit its path.
+         * A result is thrown away if its unit has since died, stopped moving,
+         * or asked for another path.
+         */
+        void finishSearches();
+
+        /**
+         * Starts searches for queued requests, most urgent first,
+         * until their estimated cost reaches SearchBudgetMicros.
+         * Requests further back in the queue for the same destination
+         * are taken along with each one.
+         */
+        void startSearches();
+
+        /**
+         * Abandons the running searches and starts them again
+         * for the requests the simulation records as in progress.
+         * Call this after replacing the simulation state, e.g. from a snapshot.
+         */
+        void restartSearches();
+
+        const PathFindingMetrics& getMetrics() const;
 
     private:
-        UnitPath findPath(UnitId unitId, const Vector3f& destination);
-        UnitPath findPath(UnitId unitId, const DiscreteRect& destination);
+        bool needsPath(UnitId unitId) const;
+
+        /** Records that a search for the request is starting now. */
+        void recordStartedRequest(const PathRequest& request);
+
+        PathSearchInput createSearchInput(const PathRequest& request) const;
+
+        /** Starts searches for the given requests, sharing them between units where possible. */
+        void startSearches(const std::vector<PathRequest>& requests);
+
+        /**
+         * Returns the graph for the unit's movement class and footprint,
+         * starting to build it on the pool from the occupied grid snapshot if need be.
+         * The result is not valid for units without a movement class, which do not use a graph.
+         */
+        PendingClusterGraph getClusterGraph(const Unit& unit);
 
-        Vector3f getWorldCenter(const DiscreteRect& discreteRect);
+        /** Waits for the graph to be built. Returns null if it is not valid. */
+        static const ClusterGraph* waitForClusterGraph(const PendingClusterGraph& clusterGraph);
 
-        DiscreteRect expandTopLeft(const DiscreteRect& rect, unsigned int width, unsigned int height);
+        /**
+         * Applies feature changes recorded by the simulation to the graphs built so far,
+         * and drops cached routes, which may now run through features.
+         */
+        void updateClusterGraphs();
+
+        void waitForSearches();
     };
+
+    /**
+     * Finds a path for the input, treating cells in the occupied grid as obstacles.
+     * If the input has a previous path that can be repaired, the result is the repaired path.
+     * Otherwise, if it has a cached route the unit can get onto nearby, the path follows that.
+     * Otherwise, if a flow field is given and reaches the unit, the path follows it.
+     * Otherwise, if a cluster graph is given, the path follows a route planned over it.
+     * If the terrain cuts the unit off from its goal,
+     * the path leads to the nearest cell it can reach instead.
+     */
+    PathSearchResult findUnitPath(
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const ClusterGraph* clusterGraph,
+        const FlowField* flowField,
+        const PathSearchInput& input);
+
+    /**
+     * Estimates how long, in microseconds, a worker will take
+     * to find paths for a group of units with the same destination,
+     * sharing a flow field if there are at least PathFindingService::MinFlowFieldGroupSize.
+     * The estimate depends only on the inputs, never on timing.
+     */
+    unsigned int estimateSearchCost(const std::vector<PathSearchInput>& group);
+
+    /** Returns true if the two searches can share a flow field. */
+    bool isSameDestination(const PathSearchInput& a, const PathSearchInput& b);
+
+    /**
+     * Finds paths for a group of units with the same destination
+     * from one flow field grown out from it.
+     * Units in the group are not obstacles to each other.
+     */
+    std::vector<PathSearchResult> findGroupUnitPaths(
+        const MapTerrain& terrain,
+        const OccupiedGrid& occupiedGrid,
+        const MovementClassCollisionService& collisionService,
+        const ClusterGraph* clusterGraph,
+        const std::vector<PathSearchInput>& inputs);
 }
 
 #endif
@@ -0,0 +1,54 @@
+#include "PathRepair.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace rwe
+{
+    static int sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+    std::vector<Point> expandRoute(const std::vector<Point>& corners)
+    {
+        std::vector<Point> route;
+        if (corners.empty())
+        {
+            return route;
+        }
+
+        route.push_back(corners.front());
+        for (std::size_t i = 1; i < corners.size(); ++i)
+        {
+            auto delta = corners[i] - corners[i - 1];
+            assert(delta.x == 0 || delta.y == 0 || std::abs(delta.x) == std::abs(delta.y));
+
+            Point step(sign(delta.x), sign(delta.y));
+            auto steps = std::max(std::abs(delta.x), std::abs(delta.y));
+            for (int j = 0; j < steps; ++j)
+            {
+                route.push_back(route.back() + step);
+            }
+        }
+
+        return route;
+    }
+
+    std::optional<std::size_t> findRejoinIndex(const std::vector<Point>& route, const std::function<bool(const Point&)>& isWalkable)
+    {
+        auto blocked = std::find_if(route.begin(), route.end(), [&](const Point& p) { return !isWalkable(p); });
+        if (blocked == route.end())
+        {
+            return 0;
+        }
+
+        auto rejoin = std::find_if(blocked, route.end(), isWalkable);
+        if (rejoin == route.end())
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<std::size_t>(rejoin - route.begin());
+    }
+}
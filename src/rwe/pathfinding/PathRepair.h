@@ -0,0 +1,29 @@
+#ifndef RWE_PATHREPAIR_H
+#define RWE_PATHREPAIR_H
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <rwe/Point.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Returns every cell along a route given by its corners.
+     * Each corner must lie on a straight or diagonal line from the one before,
+     * as the corners of a simplified path do.
+     */
+    std::vector<Point> expandRoute(const std::vector<Point>& corners);
+
+    /**
+     * Finds where a unit should rejoin its route
+     * after going around the first stretch of it that is no longer walkable.
+     * Returns the index of the first walkable cell after that stretch,
+     * zero if none of the route is blocked,
+     * or nothing if the route is blocked all the way to its end.
+     */
+    std::optional<std::size_t> findRejoinIndex(const std::vector<Point>& route, const std::function<bool(const Point&)>& isWalkable);
+}
+
+#endif
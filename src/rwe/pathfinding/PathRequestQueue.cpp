@@ -0,0 +1,115 @@
+#include "PathRequestQueue.h"
+#include <algorithm>
+
+namespace rwe
+{
+    bool PathRequest::operator==(const PathRequest& rhs) const
+    {
+        return unitId == rhs.unitId && priority == rhs.priority && requestTime == rhs.requestTime;
+    }
+
+    bool PathRequest::operator!=(const PathRequest& rhs) const
+    {
+        return !(rhs == *this);
+    }
+
+    void PathRequestQueue::push(const PathRequest& request)
+    {
+        auto newRequest = request;
+
+        auto it = liveEntries.find(request.unitId);
+        if (it != liveEntries.end())
+        {
+            newRequest.priority = std::min(newRequest.priority, it->second.priority);
+            ++deadEntryCount;
+        }
+
+        auto sequence = nextSequence++;
+        liveEntries.insert_or_assign(request.unitId, LiveEntry{sequence, newRequest.priority});
+        queues[static_cast<std::size_t>(newRequest.priority)].push_back(Entry{newRequest, sequence});
+        compact();
+    }
+
+    std::optional<PathRequest> PathRequestQueue::pop()
+    {
+        for (auto& queue : queues)
+        {
+            while (!queue.empty())
+            {
+                auto entry = queue.front();
+                queue.pop_front();
+                if (isLive(entry))
+                {
+                    liveEntries.erase(entry.request.unitId);
+                    return entry.request;
+                }
+
+                --deadEntryCount;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void PathRequestQueue::erase(UnitId unitId)
+    {
+        if (liveEntries.erase(unitId) != 0)
+        {
+            ++deadEntryCount;
+            compact();
+        }
+    }
+
+    bool PathRequestQueue::contains(UnitId unitId) const
+    {
+        return liveEntries.find(unitId) != liveEntries.end();
+    }
+
+    bool PathRequestQueue::empty() const
+    {
+        return liveEntries.empty();
+    }
+
+    std::size_t PathRequestQueue::size() const
+    {
+        return liveEntries.size();
+    }
+
+    std::vector<PathRequest> PathRequestQueue::getRequests() const
+    {
+        std::vector<PathRequest> requests;
+        requests.reserve(liveEntries.size());
+        for (const auto& queue : queues)
+        {
+            for (const auto& entry : queue)
+            {
+                if (isLive(entry))
+                {
+                    requests.push_back(entry.request);
+                }
+            }
+        }
+
+        return requests;
+    }
+
+    bool PathRequestQueue::isLive(const Entry& entry) const
+    {
+        auto it = liveEntries.find(entry.request.unitId);
+        return it != liveEntries.end() && it->second.sequence == entry.sequence;
+    }
+
+    void PathRequestQueue::compact()
+    {
+        if (deadEntryCount <= liveEntries.size())
+        {
+            return;
+        }
+
+        for (auto& queue : queues)
+        {
+            queue.erase(std::remove_if(queue.begin(), queue.end(), [this](const Entry& e) { return !isLive(e); }), queue.end());
+        }
+        deadEntryCount = 0;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef RWE_PATHREQUESTQUEUE_H
+#define RWE_PATHREQUESTQUEUE_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <rwe/GameTime.h>
+#include <rwe/UnitId.h>
+#include <unordered_map>
+#include <vector>
+
+namespace rwe
+{
+    /** How urgently a unit wants its path. Lower values are served first. */
+    enum class PathRequestPriority
+    {
+        /** The unit has just been given somewhere to go. */
+        Order = 0,
+
+        /** The unit already has a path but wants a new one, e.g. because it is stuck. */
+        Repath = 1,
+    };
+
+    struct PathRequest
+    {
+        UnitId unitId;
+        PathRequestPriority priority;
+
+        /** When the request was made, for measuring how long it waited. */
+        GameTime requestTime;
+
+        bool operator==(const PathRequest& rhs) const;
+
+        bool operator!=(const PathRequest& rhs) const;
+    };
+
+    /**
+     * Requests waiting for a path search, in order of priority and then age.
+     * Each unit has at most one request queued.
+     */
+    class PathRequestQueue
+    {
+    public:
+        static constexpr std::size_t PriorityCount = 2;
+
+    private:
+        struct Entry
+        {
+            PathRequest request;
+            std::uint64_t sequence;
+        };
+
+        /**
+         * One queue per priority, oldest first.
+         * Replaced and removed requests are left in place and skipped over when reached.
+         */
+        std::array<std::deque<Entry>, PriorityCount> queues;
+
+        struct LiveEntry
+        {
+            std::uint64_t sequence;
+            PathRequestPriority priority;
+        };
+
+        /** Where to find each unit's request. */
+        std::unordered_map<UnitId, LiveEntry> liveEntries;
+
+        /** The number of entries in the queues that are no longer live. */
+        std::size_t deadEntryCount{0};
+
+        std::uint64_t nextSequence{0};
+
+    public:
+        /**
+         * Queues the request at the back of its priority.
+         * If the unit already has a request queued, that one is dropped,
+         * and the new one keeps the more urgent of the two priorities.
+         */
+        void push(const PathRequest& request);
+
+        /** Removes and returns the most urgent request, or nothing if the queue is empty. */
+        std::optional<PathRequest> pop();
+
+        /** Removes the unit's request, if it has one. */
+        void erase(UnitId unitId);
+
+        bool contains(UnitId unitId) const;
+
+        bool empty() const;
+
+        std::size_t size() const;
+
+        /** Returns the queued requests in the order pop would return them. */
+        std::vector<PathRequest> getRequests() const;
+
+    private:
+        bool isLive(const Entry& entry) const;
+
+        /** Drops dead entries once they outnumber the live ones. */
+        void compact();
+    };
+}
+
+#endif
@@ -1,13 +1,22 @@
 #ifndef RWE_UNITPATH_H
 #define RWE_UNITPATH_H
 
+#include <rwe/Point.h>
 #include <rwe/math/Vector3f.h>
+#include <vector>
 
 namespace rwe
 {
     struct UnitPath
     {
         std::vector<Vector3f> waypoints;
+
+        /**
+         * The heightmap cell the unit's footprint is placed at for each waypoint,
+         * used to repair the path if it becomes blocked.
+         * Empty if the path was not planned over cells.
+         */
+        std::vector<Point> cells;
     };
 }
 
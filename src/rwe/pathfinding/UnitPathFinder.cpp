@@ -3,15 +3,17 @@
 namespace rwe
 {
     UnitPathFinder::UnitPathFinder(
-        GameSimulation* simulation,
-        MovementClassCollisionService* collisionService,
+        AStarNodeGrid<PathCost>* nodes,
+        const OccupiedGrid* occupiedGrid,
+        const MovementClassCollisionService* collisionService,
         UnitId self,
         std::optional<MovementClassId> movementClass,
         unsigned int footprintX,
         unsigned int footprintZ,
         const Point& goal)
         : AbstractUnitPathFinder(
-              simulation,
+              nodes,
+              occupiedGrid,
               collisionService,
               self,
               movementClass,
@@ -3,8 +3,8 @@
 
 #include <rwe/DiscreteRect.h>
 #include <rwe/EightWayDirection.h>
-#include <rwe/GameSimulation.h>
 #include <rwe/MovementClassCollisionService.h>
+#include <rwe/OccupiedGrid.h>
 #include <rwe/UnitId.h>
 #include <rwe/pathfinding/AStarPathFinder.h>
 #include <rwe/pathfinding/AbstractUnitPathFinder.h>
@@ -23,8 +23,9 @@ namespace rwe
 
     public:
         UnitPathFinder(
-            GameSimulation* simulation,
-            MovementClassCollisionService* collisionService,
+            AStarNodeGrid<PathCost>* nodes,
+            const OccupiedGrid* occupiedGrid,
+            const MovementClassCollisionService* collisionService,
             UnitId self,
             std::optional<MovementClassId> movementClass,
             unsigned int footprintX,
@@ -3,14 +3,16 @@
 namespace rwe
 {
     UnitPerimeterPathFinder::UnitPerimeterPathFinder(
-        GameSimulation* simulation,
-        MovementClassCollisionService* collisionService,
+        AStarNodeGrid<PathCost>* nodes,
+        const OccupiedGrid* occupiedGrid,
+        const MovementClassCollisionService* collisionService,
         const UnitId& self,
         const std::optional<MovementClassId>& movementClass,
         unsigned int footprintX,
         unsigned int footprintZ,
         const DiscreteRect& goalRect)
-        : AbstractUnitPathFinder(simulation,
+        : AbstractUnitPathFinder(nodes,
+              occupiedGrid,
               collisionService,
               self,
               movementClass,
@@ -18,8 +18,9 @@ namespace rwe
     protected:
     public:
         UnitPerimeterPathFinder(
-            GameSimulation* simulation,
-            MovementClassCollisionService* collisionService,
+            AStarNodeGrid<PathCost>* nodes,
+            const OccupiedGrid* occupiedGrid,
+            const MovementClassCollisionService* collisionService,
             const UnitId& self,
             const std::optional<MovementClassId>& movementClass,
             unsigned int footprintX,
@@ -0,0 +1,191 @@
+#include "Replay.h"
+#include <rwe/snapshot/SnapshotReader.h>
+#include <stdexcept>
+
+namespace rwe
+{
+    static const std::uint32_t ReplayMagic = 0x52455752; // "RWER"
+    static const std::uint32_t ReplayVersion = 2;
+
+    enum class ReplayCommandTag : std::uint8_t
+    {
+        SpawnUnit,
+        MoveOrder,
+        AttackOrder,
+        AttackGroundOrder,
+        Stop,
+        EndGame
+    };
+
+    class WriteReplayCommandVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteReplayCommandVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const SpawnUnitCommand& c) const
+        {
+            writeTag(ReplayCommandTag::SpawnUnit);
+            writer->writeString(c.unitType);
+            writer->writeUint32(c.owner.value);
+            writer->writeVector3f(c.position);
+        }
+
+        void operator()(const MoveOrderCommand& c) const
+        {
+            writeTag(ReplayCommandTag::MoveOrder);
+            writer->writeUint32(c.unitId.value);
+            writer->writeVector3f(c.destination);
+            writer->writeBool(c.enqueue);
+        }
+
+        void operator()(const AttackOrderCommand& c) const
+        {
+            writeTag(ReplayCommandTag::AttackOrder);
+            writer->writeUint32(c.unitId.value);
+            writer->writeUint32(c.target.value);
+            writer->writeBool(c.enqueue);
+        }
+
+        void operator()(const AttackGroundOrderCommand& c) const
+        {
+            writeTag(ReplayCommandTag::AttackGroundOrder);
+            writer->writeUint32(c.unitId.value);
+            writer->writeVector3f(c.target);
+            writer->writeBool(c.enqueue);
+        }
+
+        void operator()(const StopCommand& c) const
+        {
+            writeTag(ReplayCommandTag::Stop);
+            writer->writeUint32(c.unitId.value);
+        }
+
+        void operator()(const EndGameCommand&) const
+        {
+            writeTag(ReplayCommandTag::EndGame);
+        }
+
+    private:
+        void writeTag(ReplayCommandTag tag) const
+        {
+            writer->writeUint8(static_cast<std::uint8_t>(tag));
+        }
+    };
+
+    void writeReplayHeader(SnapshotWriter& writer, const ReplayHeader& header)
+    {
+        writer.writeUint32(ReplayMagic);
+        writer.writeUint32(ReplayVersion);
+        writer.writeString(header.mapName);
+        writer.writeUint32(header.schemaIndex);
+        writer.writeUint64(header.unitDataVersion);
+        writer.writeUint64(header.randomSeed);
+        writer.writeUint32(header.ticksPerSecond);
+        writer.writeCount(header.playerColors.size());
+        for (auto color : header.playerColors)
+        {
+            writer.writeUint32(color);
+        }
+    }
+
+    void writeReplayEntry(SnapshotWriter& writer, GameTimeDelta sincePrevious, const ReplayCommand& command)
+    {
+        writer.writeUint32(sincePrevious.value);
+        boost::apply_visitor(WriteReplayCommandVisitor(&writer), command);
+    }
+
+    ReplayCommand readReplayCommand(SnapshotReader& reader)
+    {
+        auto tag = static_cast<ReplayCommandTag>(reader.readUint8());
+        switch (tag)
+        {
+            case ReplayCommandTag::SpawnUnit:
+            {
+                SpawnUnitCommand c;
+                c.unitType = reader.readString();
+                c.owner = PlayerId(reader.readUint32());
+                c.position = reader.readVector3f();
+                return c;
+            }
+            case ReplayCommandTag::MoveOrder:
+            {
+                UnitId unitId(reader.readUint32());
+                auto destination = reader.readVector3f();
+                auto enqueue = reader.readBool();
+                return MoveOrderCommand{unitId, destination, enqueue};
+            }
+            case ReplayCommandTag::AttackOrder:
+            {
+                UnitId unitId(reader.readUint32());
+                UnitId target(reader.readUint32());
+                auto enqueue = reader.readBool();
+                return AttackOrderCommand{unitId, target, enqueue};
+            }
+            case ReplayCommandTag::AttackGroundOrder:
+            {
+                UnitId unitId(reader.readUint32());
+                auto target = reader.readVector3f();
+                auto enqueue = reader.readBool();
+                return AttackGroundOrderCommand{unitId, target, enqueue};
+            }
+            case ReplayCommandTag::Stop:
+                return StopCommand{UnitId(reader.readUint32())};
+            case ReplayCommandTag::EndGame:
+                return EndGameCommand();
+            default:
+                throw std::runtime_error("Unknown replay command");
+        }
+    }
+
+    Replay readReplay(std::istream& stream)
+    {
+        SnapshotReader reader(&stream);
+        Replay replay;
+
+        if (reader.readUint32() != ReplayMagic)
+        {
+            throw std::runtime_error("Not a replay");
+        }
+        if (reader.readUint32() != ReplayVersion)
+        {
+            throw std::runtime_error("Unsupported replay version");
+        }
+
+        replay.header.mapName = reader.readString();
+        replay.header.schemaIndex = reader.readUint32();
+        replay.header.unitDataVersion = reader.readUint64();
+        replay.header.randomSeed = reader.readUint64();
+        replay.header.ticksPerSecond = reader.readUint32();
+        replay.header.playerColors.resize(reader.readCount());
+        for (auto& color : replay.header.playerColors)
+        {
+            color = reader.readUint32();
+        }
+
+        GameTime time(0);
+        while (stream.peek() != std::istream::traits_type::eof())
+        {
+            try
+            {
+                time = time + GameTimeDelta(reader.readUint32());
+                auto command = readReplayCommand(reader);
+                replay.entries.push_back(ReplayEntry{time, std::move(command)});
+            }
+            catch (const std::runtime_error&)
+            {
+                if (!stream.eof())
+                {
+                    throw;
+                }
+
+                // The recording was cut off part way through an entry.
+                break;
+            }
+        }
+
+        return replay;
+    }
+}
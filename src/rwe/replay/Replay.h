@@ -0,0 +1,113 @@
+#ifndef RWE_REPLAY_H
+#define RWE_REPLAY_H
+
+#include <boost/variant.hpp>
+#include <cstdint>
+#include <istream>
+#include <rwe/GameTime.h>
+#include <rwe/PlayerId.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Vector3f.h>
+#include <rwe/snapshot/SnapshotWriter.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /** Everything needed to recreate the game a replay was recorded from. */
+    struct ReplayHeader
+    {
+        std::string mapName;
+        unsigned int schemaIndex{0};
+
+        /** Fingerprint of the unit data the game was played with. See UnitDatabase::getDataVersion. */
+        std::uint64_t unitDataVersion{0};
+
+        std::uint64_t randomSeed{0};
+
+        /** The simulation tick rate the game was played at. Command times are in these ticks. */
+        unsigned int ticksPerSecond{SimTicksPerSecond};
+
+        /** The color of each player, in the order they were added to the simulation. */
+        std::vector<unsigned int> playerColors;
+    };
+
+    struct SpawnUnitCommand
+    {
+        std::string unitType;
+        PlayerId owner;
+        Vector3f position;
+    };
+
+    struct MoveOrderCommand
+    {
+        UnitId unitId;
+        Vector3f destination;
+
+        /** If true, the order is added to the unit's queue instead of replacing it. */
+        bool enqueue;
+    };
+
+    struct AttackOrderCommand
+    {
+        UnitId unitId;
+        UnitId target;
+        bool enqueue;
+    };
+
+    struct AttackGroundOrderCommand
+    {
+        UnitId unitId;
+        Vector3f target;
+        bool enqueue;
+    };
+
+    struct StopCommand
+    {
+        UnitId unitId;
+    };
+
+    /** Marks the point at which the recorded game ended. */
+    struct EndGameCommand
+    {
+    };
+
+    using ReplayCommand = boost::variant<
+        SpawnUnitCommand,
+        MoveOrderCommand,
+        AttackOrderCommand,
+        AttackGroundOrderCommand,
+        StopCommand,
+        EndGameCommand>;
+
+    struct ReplayEntry
+    {
+        /**
+         * The game time when the command was issued.
+         * The command takes effect in the tick that follows.
+         */
+        GameTime time;
+
+        ReplayCommand command;
+    };
+
+    struct Replay
+    {
+        ReplayHeader header;
+        std::vector<ReplayEntry> entries;
+    };
+
+    void writeReplayHeader(SnapshotWriter& writer, const ReplayHeader& header);
+
+    /** Writes a command issued the given number of ticks after the previous one. */
+    void writeReplayEntry(SnapshotWriter& writer, GameTimeDelta sincePrevious, const ReplayCommand& command);
+
+    /**
+     * Reads a replay written by ReplayRecorder.
+     * A replay cut short (for example by a crash) is read up to the last complete entry.
+     * Throws std::runtime_error if the stream does not hold a replay.
+     */
+    Replay readReplay(std::istream& stream);
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "ReplayPlayer.h"
+
+namespace rwe
+{
+    class ApplyReplayCommandVisitor : public boost::static_visitor<>
+    {
+    private:
+        SimulationRunner* runner;
+
+    public:
+        explicit ApplyReplayCommandVisitor(SimulationRunner* runner) : runner(runner) {}
+
+        void operator()(const SpawnUnitCommand& c) const
+        {
+            runner->spawnUnit(c.unitType, c.owner, c.position);
+        }
+
+        void operator()(const MoveOrderCommand& c) const
+        {
+            if (c.enqueue)
+            {
+                runner->enqueueMoveOrder(c.unitId, c.destination);
+            }
+            else
+            {
+                runner->issueMoveOrder(c.unitId, c.destination);
+            }
+        }
+
+        void operator()(const AttackOrderCommand& c) const
+        {
+            if (c.enqueue)
+            {
+                runner->enqueueAttackOrder(c.unitId, c.target);
+            }
+            else
+            {
+                runner->issueAttackOrder(c.unitId, c.target);
+            }
+        }
+
+        void operator()(const AttackGroundOrderCommand& c) const
+        {
+            if (c.enqueue)
+            {
+                runner->enqueueAttackGroundOrder(c.unitId, c.target);
+            }
+            else
+            {
+                runner->issueAttackGroundOrder(c.unitId, c.target);
+            }
+        }
+
+        void operator()(const StopCommand& c) const
+        {
+            runner->stopUnit(c.unitId);
+        }
+
+        void operator()(const EndGameCommand&) const
+        {
+        }
+    };
+
+    class CanApplyReplayCommandVisitor : public boost::static_visitor<bool>
+    {
+    private:
+        const GameSimulation* simulation;
+
+    public:
+        explicit CanApplyReplayCommandVisitor(const GameSimulation* simulation) : simulation(simulation) {}
+
+        bool operator()(const SpawnUnitCommand&) const
+        {
+            return true;
+        }
+
+        bool operator()(const MoveOrderCommand& c) const
+        {
+            return simulation->unitExists(c.unitId);
+        }
+
+        bool operator()(const AttackOrderCommand& c) const
+        {
+            return simulation->unitExists(c.unitId) && simulation->unitExists(c.target);
+        }
+
+        bool operator()(const AttackGroundOrderCommand& c) const
+        {
+            return simulation->unitExists(c.unitId);
+        }
+
+        bool operator()(const StopCommand& c) const
+        {
+            return simulation->unitExists(c.unitId);
+        }
+
+        bool operator()(const EndGameCommand&) const
+        {
+            return true;
+        }
+    };
+
+    void applyReplayCommand(SimulationRunner& runner, const ReplayCommand& command)
+    {
+        boost::apply_visitor(ApplyReplayCommandVisitor(&runner), command);
+    }
+
+    bool canApplyReplayCommand(const SimulationRunner& runner, const ReplayCommand& command)
+    {
+        return boost::apply_visitor(CanApplyReplayCommandVisitor(&runner.getSimulation()), command);
+    }
+
+    ReplayPlayer::ReplayPlayer(const Replay* replay) : replay(replay)
+    {
+    }
+
+    void ReplayPlayer::applyCommands(SimulationRunner& runner)
+    {
+        auto time = runner.getGameTime();
+        const auto& entries = replay->entries;
+        while (nextEntry < entries.size() && entries[nextEntry].time <= time)
+        {
+            applyReplayCommand(runner, entries[nextEntry].command);
+            ++nextEntry;
+        }
+    }
+
+    bool ReplayPlayer::isFinished(GameTime time) const
+    {
+        return time >= getEndTime();
+    }
+
+    GameTime ReplayPlayer::getEndTime() const
+    {
+        if (replay->entries.empty())
+        {
+            return GameTime(0);
+        }
+
+        return replay->entries.back().time;
+    }
+}
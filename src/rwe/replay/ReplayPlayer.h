@@ -0,0 +1,47 @@
+#ifndef RWE_REPLAYPLAYER_H
+#define RWE_REPLAYPLAYER_H
+
+#include <rwe/SimulationRunner.h>
+#include <rwe/replay/Replay.h>
+
+namespace rwe
+{
+    /** Applies a command to the simulation, as the player who issued it did. */
+    void applyReplayCommand(SimulationRunner& runner, const ReplayCommand& command);
+
+    /**
+     * Returns false if the command refers to a unit that no longer exists.
+     * Commands issued against an older view of the simulation,
+     * such as a render snapshot, may refer to units that have since died.
+     */
+    bool canApplyReplayCommand(const SimulationRunner& runner, const ReplayCommand& command);
+
+    /**
+     * Feeds the commands of a recorded game back into a simulation.
+     * The simulation must have been set up from the replay's header.
+     */
+    class ReplayPlayer
+    {
+    private:
+        const Replay* replay;
+        std::size_t nextEntry{0};
+
+    public:
+        explicit ReplayPlayer(const Replay* replay);
+
+        /**
+         * Applies every command issued at the runner's current game time.
+         * Call this before each tick, exactly as the game applied
+         * player input between ticks.
+         */
+        void applyCommands(SimulationRunner& runner);
+
+        /** Returns true once the recorded game has ended. */
+        bool isFinished(GameTime time) const;
+
+        /** The game time at which the recorded game ended, or the time of the last command. */
+        GameTime getEndTime() const;
+    };
+}
+
+#endif
@@ -0,0 +1,20 @@
+#include "ReplayRecorder.h"
+#include <cassert>
+
+namespace rwe
+{
+    ReplayRecorder::ReplayRecorder(std::unique_ptr<std::ostream>&& stream, const ReplayHeader& header)
+        : stream(std::move(stream)), writer(this->stream.get())
+    {
+        writeReplayHeader(writer, header);
+        this->stream->flush();
+    }
+
+    void ReplayRecorder::record(GameTime time, const ReplayCommand& command)
+    {
+        assert(time >= lastTime);
+        writeReplayEntry(writer, time - lastTime, command);
+        stream->flush();
+        lastTime = time;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef RWE_REPLAYRECORDER_H
+#define RWE_REPLAYRECORDER_H
+
+#include <memory>
+#include <ostream>
+#include <rwe/replay/Replay.h>
+#include <rwe/snapshot/SnapshotWriter.h>
+
+namespace rwe
+{
+    /**
+     * Writes the commands issued during a game to a stream as they happen.
+     * Each entry is flushed immediately,
+     * so the log is usable even if the game crashes.
+     */
+    class ReplayRecorder
+    {
+    private:
+        std::unique_ptr<std::ostream> stream;
+        SnapshotWriter writer;
+        GameTime lastTime{0};
+
+    public:
+        ReplayRecorder(std::unique_ptr<std::ostream>&& stream, const ReplayHeader& header);
+
+        /** Commands must be recorded in order of game time. */
+        void record(GameTime time, const ReplayCommand& command);
+    };
+}
+
+#endif
@@ -0,0 +1,1134 @@
+#include "SimulationSnapshot.h"
+#include <algorithm>
+#include <rwe/snapshot/SnapshotReader.h>
+#include <rwe/snapshot/SnapshotWriter.h>
+#include <stack>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace rwe
+{
+    static const std::uint32_t SnapshotMagic = 0x50414e53; // "SNAP"
+    static const std::uint32_t SnapshotVersion = 6;
+
+    /** Marks a reference to a COB thread that no longer exists. */
+    static const std::uint32_t NoThread = 0xffffffff;
+
+    template <typename T>
+    std::vector<T> stackToVector(std::stack<T> stack)
+    {
+        std::vector<T> v;
+        v.reserve(stack.size());
+        while (!stack.empty())
+        {
+            v.push_back(std::move(stack.top()));
+            stack.pop();
+        }
+        std::reverse(v.begin(), v.end());
+        return v;
+    }
+
+    void snapshotMismatch(const std::string& what)
+    {
+        throw std::runtime_error("Snapshot does not match the current game: " + what);
+    }
+
+    void snapshotMalformed(const std::string& what)
+    {
+        throw std::runtime_error("Malformed snapshot: " + what);
+    }
+
+    // writing
+
+    class WriteAttackTargetVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteAttackTargetVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(UnitId id) const
+        {
+            writer->writeUint8(0);
+            writer->writeUint32(id.value);
+        }
+
+        void operator()(const Vector3f& position) const
+        {
+            writer->writeUint8(1);
+            writer->writeVector3f(position);
+        }
+    };
+
+    class WriteOrderVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteOrderVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const MoveOrder& o) const
+        {
+            writer->writeUint8(0);
+            writer->writeVector3f(o.destination);
+        }
+
+        void operator()(const AttackOrder& o) const
+        {
+            writer->writeUint8(1);
+            boost::apply_visitor(WriteAttackTargetVisitor(writer), o.target);
+        }
+    };
+
+    class WriteMovingGoalVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteMovingGoalVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const Vector3f& position) const
+        {
+            writer->writeUint8(0);
+            writer->writeVector3f(position);
+        }
+
+        void operator()(const DiscreteRect& rect) const
+        {
+            writer->writeUint8(1);
+            writer->writeInt32(rect.x);
+            writer->writeInt32(rect.y);
+            writer->writeUint32(rect.width);
+            writer->writeUint32(rect.height);
+        }
+    };
+
+    class WriteUnitStateVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteUnitStateVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const IdleState&) const
+        {
+            writer->writeUint8(0);
+        }
+
+        void operator()(const MovingState& s) const
+        {
+            writer->writeUint8(1);
+            boost::apply_visitor(WriteMovingGoalVisitor(writer), s.destination);
+            writer->writeBool(s.pathRequested);
+            writer->writeBool(!!s.path);
+            if (s.path)
+            {
+                const auto& waypoints = s.path->path.waypoints;
+                writer->writeCount(waypoints.size());
+                for (const auto& w : waypoints)
+                {
+                    writer->writeVector3f(w);
+                }
+                const auto& cells = s.path->path.cells;
+                writer->writeCount(cells.size());
+                for (const auto& c : cells)
+                {
+                    writer->writeInt32(c.x);
+                    writer->writeInt32(c.y);
+                }
+                writer->writeUint32(s.path->pathCreationTime.value);
+                writer->writeCount(s.path->currentWaypoint - waypoints.begin());
+            }
+        }
+    };
+
+    class WriteTurnOperationVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteTurnOperationVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const UnitMesh::TurnOperation& op) const
+        {
+            writer->writeUint8(0);
+            writer->writeFloat(op.targetAngle.value);
+            writer->writeFloat(op.speed);
+        }
+
+        void operator()(const UnitMesh::SpinOperation& op) const
+        {
+            writer->writeUint8(1);
+            writer->writeFloat(op.currentSpeed);
+            writer->writeFloat(op.targetSpeed);
+            writer->writeFloat(op.acceleration);
+        }
+
+        void operator()(const UnitMesh::StopSpinOperation& op) const
+        {
+            writer->writeUint8(2);
+            writer->writeFloat(op.currentSpeed);
+            writer->writeFloat(op.deceleration);
+        }
+    };
+
+    class WriteBlockedConditionVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+
+    public:
+        explicit WriteBlockedConditionVisitor(SnapshotWriter* writer) : writer(writer) {}
+
+        void operator()(const CobEnvironment::BlockedStatus::Move& c) const
+        {
+            writer->writeUint8(0);
+            writer->writeUint32(c.object);
+            writer->writeUint8(static_cast<std::uint8_t>(c.axis));
+        }
+
+        void operator()(const CobEnvironment::BlockedStatus::Turn& c) const
+        {
+            writer->writeUint8(1);
+            writer->writeUint32(c.object);
+            writer->writeUint8(static_cast<std::uint8_t>(c.axis));
+        }
+
+        void operator()(const CobEnvironment::BlockedStatus::Sleep& c) const
+        {
+            writer->writeUint8(2);
+            writer->writeUint32(c.wakeUpTime.value);
+        }
+    };
+
+    using ThreadIndexMap = std::unordered_map<const CobThread*, std::uint32_t>;
+
+    class WriteWeaponStateVisitor : public boost::static_visitor<>
+    {
+    private:
+        SnapshotWriter* writer;
+        const ThreadIndexMap* threadIndices;
+
+    public:
+        WriteWeaponStateVisitor(SnapshotWriter* writer, const ThreadIndexMap* threadIndices)
+            : writer(writer), threadIndices(threadIndices)
+        {
+        }
+
+        void operator()(const UnitWeaponStateIdle&) const
+        {
+            writer->writeUint8(0);
+        }
+
+        void operator()(const UnitWeaponStateAttacking& s) const
+        {
+            writer->writeUint8(1);
+            boost::apply_visitor(WriteAttackTargetVisitor(writer), s.target);
+            writer->writeBool(!!s.aimInfo);
+            if (s.aimInfo)
+            {
+                auto it = threadIndices->find(s.aimInfo->thread);
+                writer->writeUint32(it == threadIndices->end() ? NoThread : it->second);
+                writer->writeFloat(s.aimInfo->lastHeading);
+                writer->writeFloat(s.aimInfo->lastPitch);
+            }
+        }
+    };
+
+    void writeMoveOperation(SnapshotWriter& writer, const std::optional<UnitMesh::MoveOperation>& op)
+    {
+        writer.writeBool(!!op);
+        if (op)
+        {
+            writer.writeFloat(op->targetPosition);
+            writer.writeFloat(op->speed);
+        }
+    }
+
+    void writeTurnOperation(SnapshotWriter& writer, const std::optional<UnitMesh::TurnOperationUnion>& op)
+    {
+        writer.writeBool(!!op);
+        if (op)
+        {
+            boost::apply_visitor(WriteTurnOperationVisitor(&writer), *op);
+        }
+    }
+
+    void writePiece(SnapshotWriter& writer, const UnitMesh& piece)
+    {
+        writer.writeString(piece.name);
+        writer.writeBool(piece.visible);
+        writer.writeBool(piece.shaded);
+        writer.writeVector3f(piece.offset);
+        writer.writeVector3f(piece.rotation);
+        writeMoveOperation(writer, piece.xMoveOperation);
+        writeMoveOperation(writer, piece.yMoveOperation);
+        writeMoveOperation(writer, piece.zMoveOperation);
+        writeTurnOperation(writer, piece.xTurnOperation);
+        writeTurnOperation(writer, piece.yTurnOperation);
+        writeTurnOperation(writer, piece.zTurnOperation);
+
+        writer.writeCount(piece.children.size());
+        for (const auto& child : piece.children)
+        {
+            writePiece(writer, child);
+        }
+    }
+
+    void writeCobThread(SnapshotWriter& writer, const CobThread& thread)
+    {
+        writer.writeString(thread.name);
+        writer.writeUint32(thread.signalMask);
+
+        auto stack = stackToVector(thread.stack);
+        writer.writeCount(stack.size());
+        for (auto v : stack)
+        {
+            writer.writeInt32(v);
+        }
+
+        auto callStack = stackToVector(thread.callStack);
+        writer.writeCount(callStack.size());
+        for (const auto& f : callStack)
+        {
+            writer.writeUint32(f.instructionIndex);
+            writer.writeUint32(f.localCount);
+            writer.writeCount(f.locals.size());
+            for (auto v : f.locals)
+            {
+                writer.writeInt32(v);
+            }
+        }
+
+        writer.writeInt32(thread.returnValue);
+        writer.writeCount(thread.returnLocals.size());
+        for (auto v : thread.returnLocals)
+        {
+            writer.writeInt32(v);
+        }
+
+        writer.writeUint32(thread.randomSerial);
+        writer.writeUint32(thread.randomCalls);
+    }
+
+    void writeThreadQueue(SnapshotWriter& writer, const std::deque<CobThread*>& queue, const ThreadIndexMap& threadIndices)
+    {
+        writer.writeCount(queue.size());
+        for (const auto* thread : queue)
+        {
+            writer.writeUint32(threadIndices.at(thread));
+        }
+    }
+
+    ThreadIndexMap writeCobEnvironment(SnapshotWriter& writer, const CobEnvironment& env)
+    {
+        writer.writeCount(env._statics.size());
+        for (auto v : env._statics)
+        {
+            writer.writeInt32(v);
+        }
+
+        ThreadIndexMap threadIndices;
+        writer.writeCount(env.threads.size());
+        for (std::size_t i = 0; i < env.threads.size(); ++i)
+        {
+            writeCobThread(writer, *env.threads[i]);
+            threadIndices.emplace(env.threads[i].get(), static_cast<std::uint32_t>(i));
+        }
+
+        writeThreadQueue(writer, env.readyQueue, threadIndices);
+
+        writer.writeCount(env.blockedQueue.size());
+        for (const auto& pair : env.blockedQueue)
+        {
+            boost::apply_visitor(WriteBlockedConditionVisitor(&writer), pair.first.condition);
+            writer.writeUint32(threadIndices.at(pair.second));
+        }
+
+        writeThreadQueue(writer, env.finishedQueue, threadIndices);
+
+        writer.writeUint64(env.randomSeed);
+        writer.writeUint32(env.nextThreadSerial);
+
+        return threadIndices;
+    }
+
+    void writeUnit(SnapshotWriter& writer, const Unit& unit)
+    {
+        writer.writeString(unit.unitType);
+        writer.writeUint32(unit.owner.value);
+        writer.writeVector3f(unit.position);
+        writer.writeFloat(unit.rotation);
+        writer.writeUint32(unit.hitPoints);
+        writer.writeBool(unit.inCollision);
+
+        auto threadIndices = writeCobEnvironment(writer, *unit.cobEnvironment);
+
+        writePiece(writer, unit.mesh);
+
+        for (const auto& weapon : unit.weapons)
+        {
+            writer.writeBool(!!weapon);
+            if (weapon)
+            {
+                writer.writeUint32(weapon->readyTime.value);
+                boost::apply_visitor(WriteWeaponStateVisitor(&writer, &threadIndices), weapon->state);
+            }
+        }
+
+        writer.writeCount(unit.orders.size());
+        for (const auto& order : unit.orders)
+        {
+            boost::apply_visitor(WriteOrderVisitor(&writer), order);
+        }
+
+        boost::apply_visitor(WriteUnitStateVisitor(&writer), unit.behaviourState);
+    }
+
+    void writeLaser(SnapshotWriter& writer, const LaserProjectile& laser)
+    {
+        writer.writeString(laser.weaponType);
+        writer.writeUint32(laser.owner.value);
+        writer.writeVector3f(laser.position);
+        writer.writeVector3f(laser.origin);
+        writer.writeVector3f(laser.velocity);
+        writer.writeFloat(laser.duration);
+        writer.writeUint32(laser.lastSmoke.value);
+    }
+
+    void writePathRequest(SnapshotWriter& writer, const PathRequest& request)
+    {
+        writer.writeUint32(request.unitId.value);
+        writer.writeUint8(static_cast<std::uint8_t>(request.priority));
+        writer.writeUint32(request.requestTime.value);
+    }
+
+    void writePathCacheEntry(SnapshotWriter& writer, const PathCacheKey& key, const std::vector<Point>& route)
+    {
+        writer.writeBool(!!key.movementClass);
+        if (key.movementClass)
+        {
+            writer.writeUint32(key.movementClass->value);
+        }
+        writer.writeUint32(key.footprintX);
+        writer.writeUint32(key.footprintZ);
+        writer.writeInt32(key.coarseStart.x);
+        writer.writeInt32(key.coarseStart.y);
+        writer.writeBool(key.isRectGoal);
+        writer.writeInt32(key.goal.x);
+        writer.writeInt32(key.goal.y);
+        writer.writeUint32(key.goal.width);
+        writer.writeUint32(key.goal.height);
+
+        writer.writeCount(route.size());
+        for (const auto& c : route)
+        {
+            writer.writeInt32(c.x);
+            writer.writeInt32(c.y);
+        }
+    }
+
+    void writeSimulationSnapshot(std::ostream& stream, const GameSimulation& simulation)
+    {
+        SnapshotWriter writer(&stream);
+
+        writer.writeUint32(SnapshotMagic);
+        writer.writeUint32(SnapshotVersion);
+        writer.writeUint32(SimTicksPerSecond);
+
+        const auto& heightMap = simulation.terrain.getHeightMap();
+        writer.writeCount(heightMap.getWidth());
+        writer.writeCount(heightMap.getHeight());
+        writer.writeCount(simulation.features.size());
+        writer.writeCount(simulation.players.size());
+
+        writer.writeUint32(simulation.gameTime.value);
+        writer.writeUint64(simulation.randomSeed);
+
+        auto generations = simulation.units.getSlotGenerations();
+        writer.writeCount(generations.size());
+        for (auto g : generations)
+        {
+            writer.writeUint32(g);
+        }
+
+        const auto& freeSlots = simulation.units.getFreeSlots();
+        writer.writeCount(freeSlots.size());
+        for (auto s : freeSlots)
+        {
+            writer.writeUint32(s);
+        }
+
+        const auto& k = simulation.unitKinematics;
+        writer.writeCount(simulation.units.size());
+        for (std::size_t i = 0; i < simulation.units.size(); ++i)
+        {
+            writer.writeUint32(simulation.units.idAt(i).value);
+            writeUnit(writer, simulation.units.valueAt(i));
+
+            writer.writeFloat(k.rotation[i]);
+            writer.writeFloat(k.currentSpeed[i]);
+            writer.writeFloat(k.previousSpeed[i]);
+            writer.writeFloat(k.targetAngle[i]);
+            writer.writeFloat(k.targetSpeed[i]);
+            writer.writeFloat(k.speedLimit[i]);
+        }
+
+        writer.writeCount(simulation.lasers.size());
+        for (const auto& laser : simulation.lasers)
+        {
+            writeLaser(writer, laser);
+        }
+
+        auto pathRequests = simulation.pathRequests.getRequests();
+        writer.writeCount(pathRequests.size());
+        for (const auto& request : pathRequests)
+        {
+            writePathRequest(writer, request);
+        }
+
+        writer.writeCount(simulation.pathRequestsInProgress.size());
+        for (const auto& request : simulation.pathRequestsInProgress)
+        {
+            writePathRequest(writer, request);
+        }
+
+        // every cached route belongs to the current epoch
+        writer.writeUint32(simulation.pathCache.getEpoch());
+        auto pathCacheEntries = simulation.pathCache.getEntries();
+        writer.writeCount(pathCacheEntries.size());
+        for (const auto& entry : pathCacheEntries)
+        {
+            writePathCacheEntry(writer, entry.first, *entry.second);
+        }
+
+        if (!stream)
+        {
+            throw std::runtime_error("Failed to write snapshot");
+        }
+    }
+
+    // reading
+
+    Axis readAxis(SnapshotReader& reader)
+    {
+        auto value = reader.readUint8();
+        switch (value)
+        {
+            case 0:
+                return Axis::X;
+            case 1:
+                return Axis::Y;
+            case 2:
+                return Axis::Z;
+            default:
+                snapshotMalformed("invalid axis");
+                return Axis::X;
+        }
+    }
+
+    AttackTarget readAttackTarget(SnapshotReader& reader)
+    {
+        auto tag = reader.readUint8();
+        switch (tag)
+        {
+            case 0:
+                return UnitId(reader.readUint32());
+            case 1:
+                return reader.readVector3f();
+            default:
+                snapshotMalformed("invalid attack target");
+                return UnitId(0);
+        }
+    }
+
+    UnitOrder readOrder(SnapshotReader& reader)
+    {
+        auto tag = reader.readUint8();
+        switch (tag)
+        {
+            case 0:
+                return MoveOrder(reader.readVector3f());
+            case 1:
+            {
+                auto target = readAttackTarget(reader);
+                if (auto unitTarget = boost::get<UnitId>(&target); unitTarget != nullptr)
+                {
+                    return AttackOrder(*unitTarget);
+                }
+                return AttackOrder(boost::get<Vector3f>(target));
+            }
+            default:
+                snapshotMalformed("invalid order");
+                return MoveOrder(Vector3f(0.0f, 0.0f, 0.0f));
+        }
+    }
+
+    MovingStateGoal readMovingGoal(SnapshotReader& reader)
+    {
+        auto tag = reader.readUint8();
+        switch (tag)
+        {
+            case 0:
+                return reader.readVector3f();
+            case 1:
+            {
+                auto x = reader.readInt32();
+                auto y = reader.readInt32();
+                auto width = reader.readUint32();
+                auto height = reader.readUint32();
+                return DiscreteRect(x, y, width, height);
+            }
+            default:
+                snapshotMalformed("invalid movement goal");
+                return Vector3f(0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    void readUnitState(SnapshotReader& reader, Unit& unit)
+    {
+        auto tag = reader.readUint8();
+        if (tag == 0)
+        {
+            unit.behaviourState = IdleState();
+            return;
+        }
+
+        if (tag != 1)
+        {
+            snapshotMalformed("invalid unit state");
+        }
+
+        auto destination = readMovingGoal(reader);
+        auto pathRequested = reader.readBool();
+        unit.behaviourState = MovingState{destination, std::nullopt, pathRequested};
+
+        if (!reader.readBool())
+        {
+            return;
+        }
+
+        UnitPath path;
+        auto waypointCount = reader.readCount();
+        path.waypoints.reserve(waypointCount);
+        for (std::size_t i = 0; i < waypointCount; ++i)
+        {
+            path.waypoints.push_back(reader.readVector3f());
+        }
+        auto cellCount = reader.readCount();
+        if (cellCount != 0 && cellCount != waypointCount)
+        {
+            snapshotMalformed("path cells do not match waypoints");
+        }
+        path.cells.reserve(cellCount);
+        for (std::size_t i = 0; i < cellCount; ++i)
+        {
+            auto x = reader.readInt32();
+            auto y = reader.readInt32();
+            path.cells.emplace_back(x, y);
+        }
+        GameTime creationTime(reader.readUint32());
+        auto currentWaypoint = reader.readCount();
+        if (currentWaypoint > waypointCount)
+        {
+            snapshotMalformed("waypoint out of range");
+        }
+
+        // Build the path in place so that the waypoint iterator
+        // refers to the waypoints the unit actually holds.
+        auto& movingState = boost::get<MovingState>(unit.behaviourState);
+        movingState.path.emplace(std::move(path), creationTime);
+        movingState.path->currentWaypoint = movingState.path->path.waypoints.begin() + currentWaypoint;
+    }
+
+    std::optional<UnitMesh::MoveOperation> readMoveOperation(SnapshotReader& reader)
+    {
+        if (!reader.readBool())
+        {
+            return std::nullopt;
+        }
+
+        auto targetPosition = reader.readFloat();
+        auto speed = reader.readFloat();
+        return UnitMesh::MoveOperation(targetPosition, speed);
+    }
+
+    std::optional<UnitMesh::TurnOperationUnion> readTurnOperation(SnapshotReader& reader)
+    {
+        if (!reader.readBool())
+        {
+            return std::nullopt;
+        }
+
+        auto tag = reader.readUint8();
+        switch (tag)
+        {
+            case 0:
+            {
+                auto targetAngle = reader.readFloat();
+                auto speed = reader.readFloat();
+                return UnitMesh::TurnOperationUnion(UnitMesh::TurnOperation(RadiansAngle(targetAngle), speed));
+            }
+            case 1:
+            {
+                auto currentSpeed = reader.readFloat();
+                auto targetSpeed = reader.readFloat();
+                auto acceleration = reader.readFloat();
+                return UnitMesh::TurnOperationUnion(UnitMesh::SpinOperation(currentSpeed, targetSpeed, acceleration));
+            }
+            case 2:
+            {
+                auto currentSpeed = reader.readFloat();
+                auto deceleration = reader.readFloat();
+                return UnitMesh::TurnOperationUnion(UnitMesh::StopSpinOperation(currentSpeed, deceleration));
+            }
+            default:
+                snapshotMalformed("invalid turn operation");
+                return std::nullopt;
+        }
+    }
+
+    void readPiece(SnapshotReader& reader, UnitMesh& piece)
+    {
+        if (reader.readString() != piece.name)
+        {
+            snapshotMismatch("unit piece names differ");
+        }
+
+        piece.visible = reader.readBool();
+        piece.shaded = reader.readBool();
+        piece.offset = reader.readVector3f();
+        piece.rotation = reader.readVector3f();
+        piece.xMoveOperation = readMoveOperation(reader);
+        piece.yMoveOperation = readMoveOperation(reader);
+        piece.zMoveOperation = readMoveOperation(reader);
+        piece.xTurnOperation = readTurnOperation(reader);
+        piece.yTurnOperation = readTurnOperation(reader);
+        piece.zTurnOperation = readTurnOperation(reader);
+
+        if (reader.readCount() != piece.children.size())
+        {
+            snapshotMismatch("unit piece hierarchies differ");
+        }
+
+        for (auto& child : piece.children)
+        {
+            readPiece(reader, child);
+        }
+    }
+
+    std::unique_ptr<CobThread> readCobThread(SnapshotReader& reader)
+    {
+        auto name = reader.readString();
+        auto signalMask = reader.readUint32();
+        auto thread = std::make_unique<CobThread>(name, signalMask);
+
+        auto stackSize = reader.readCount();
+        for (std::size_t i = 0; i < stackSize; ++i)
+        {
+            thread->stack.push(reader.readInt32());
+        }
+
+        auto callStackSize = reader.readCount();
+        for (std::size_t i = 0; i < callStackSize; ++i)
+        {
+            auto instructionIndex = reader.readUint32();
+            auto localCount = reader.readUint32();
+            std::vector<int> locals(reader.readCount());
+            for (auto& v : locals)
+            {
+                v = reader.readInt32();
+            }
+
+            CobFunction function(instructionIndex, locals);
+            function.localCount = localCount;
+            thread->callStack.push(std::move(function));
+        }
+
+        thread->returnValue = reader.readInt32();
+        thread->returnLocals.resize(reader.readCount());
+        for (auto& v : thread->returnLocals)
+        {
+            v = reader.readInt32();
+        }
+
+        thread->randomSerial = reader.readUint32();
+        thread->randomCalls = reader.readUint32();
+
+        return thread;
+    }
+
+    CobThread* readThreadReference(SnapshotReader& reader, const CobEnvironment& env)
+    {
+        auto index = reader.readUint32();
+        if (index >= env.threads.size())
+        {
+            snapshotMalformed("thread index out of range");
+        }
+
+        return env.threads[index].get();
+    }
+
+    void readThreadQueue(SnapshotReader& reader, const CobEnvironment& env, std::deque<CobThread*>& queue)
+    {
+        queue.clear();
+        auto count = reader.readCount();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            queue.push_back(readThreadReference(reader, env));
+        }
+    }
+
+    CobEnvironment::BlockedStatus::Condition readBlockedCondition(SnapshotReader& reader)
+    {
+        auto tag = reader.readUint8();
+        switch (tag)
+        {
+            case 0:
+            {
+                auto object = reader.readUint32();
+                return CobEnvironment::BlockedStatus::Move(object, readAxis(reader));
+            }
+            case 1:
+            {
+                auto object = reader.readUint32();
+                return CobEnvironment::BlockedStatus::Turn(object, readAxis(reader));
+            }
+            case 2:
+                return CobEnvironment::BlockedStatus::Sleep(GameTime(reader.readUint32()));
+            default:
+                snapshotMalformed("invalid blocked condition");
+                return CobEnvironment::BlockedStatus::Sleep(GameTime(0));
+        }
+    }
+
+    void readCobEnvironment(SnapshotReader& reader, CobEnvironment& env)
+    {
+        if (reader.readCount() != env._statics.size())
+        {
+            snapshotMismatch("unit script static variables differ");
+        }
+        for (auto& v : env._statics)
+        {
+            v = reader.readInt32();
+        }
+
+        env.threads.clear();
+        auto threadCount = reader.readCount();
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            env.threads.push_back(readCobThread(reader));
+        }
+
+        readThreadQueue(reader, env, env.readyQueue);
+
+        env.blockedQueue.clear();
+        auto blockedCount = reader.readCount();
+        for (std::size_t i = 0; i < blockedCount; ++i)
+        {
+            auto condition = readBlockedCondition(reader);
+            auto thread = readThreadReference(reader, env);
+            env.blockedQueue.emplace_back(CobEnvironment::BlockedStatus(condition), thread);
+        }
+
+        readThreadQueue(reader, env, env.finishedQueue);
+
+        env.randomSeed = reader.readUint64();
+        env.nextThreadSerial = reader.readUint32();
+
+        if (!env.isNotCorrupt())
+        {
+            snapshotMalformed("inconsistent unit script queues");
+        }
+    }
+
+    void readWeaponState(SnapshotReader& reader, const CobEnvironment& env, UnitWeapon& weapon)
+    {
+        auto tag = reader.readUint8();
+        if (tag == 0)
+        {
+            weapon.state = UnitWeaponStateIdle();
+            return;
+        }
+
+        if (tag != 1)
+        {
+            snapshotMalformed("invalid weapon state");
+        }
+
+        UnitWeaponStateAttacking state(readAttackTarget(reader));
+        if (reader.readBool())
+        {
+            auto threadIndex = reader.readUint32();
+            auto lastHeading = reader.readFloat();
+            auto lastPitch = reader.readFloat();
+
+            // If the aiming thread had already been cleaned up,
+            // leave the weapon to start aiming again.
+            if (threadIndex != NoThread)
+            {
+                if (threadIndex >= env.threads.size())
+                {
+                    snapshotMalformed("thread index out of range");
+                }
+                state.aimInfo = UnitWeaponStateAttacking::AimInfo{env.threads[threadIndex].get(), lastHeading, lastPitch};
+            }
+        }
+
+        weapon.state = std::move(state);
+    }
+
+    Unit readUnit(SnapshotReader& reader, const GameSimulation& simulation, UnitFactory& unitFactory)
+    {
+        auto unitType = reader.readString();
+        PlayerId owner(reader.readUint32());
+        if (owner.value >= simulation.players.size())
+        {
+            snapshotMismatch("unit owner does not exist");
+        }
+        auto position = reader.readVector3f();
+
+        auto unit = unitFactory.createUnit(unitType, owner, simulation.getPlayer(owner).color, position);
+        unit.rotation = reader.readFloat();
+        unit.previousRotation = unit.rotation;
+        unit.hitPoints = reader.readUint32();
+        unit.inCollision = reader.readBool();
+
+        readCobEnvironment(reader, *unit.cobEnvironment);
+
+        readPiece(reader, unit.mesh);
+
+        for (auto& weapon : unit.weapons)
+        {
+            if (reader.readBool() != !!weapon)
+            {
+                snapshotMismatch("unit weapons differ");
+            }
+
+            if (weapon)
+            {
+                weapon->readyTime = GameTime(reader.readUint32());
+                readWeaponState(reader, *unit.cobEnvironment, *weapon);
+            }
+        }
+
+        auto orderCount = reader.readCount();
+        for (std::size_t i = 0; i < orderCount; ++i)
+        {
+            unit.orders.push_back(readOrder(reader));
+        }
+
+        readUnitState(reader, unit);
+
+        return unit;
+    }
+
+    PathRequest readPathRequest(SnapshotReader& reader)
+    {
+        auto unitId = UnitId(reader.readUint32());
+        auto priority = reader.readUint8();
+        if (priority >= PathRequestQueue::PriorityCount)
+        {
+            snapshotMalformed("invalid path request priority");
+        }
+        auto requestTime = GameTime(reader.readUint32());
+        return PathRequest{unitId, static_cast<PathRequestPriority>(priority), requestTime};
+    }
+
+    std::pair<PathCacheKey, std::vector<Point>> readPathCacheEntry(SnapshotReader& reader, unsigned int epoch)
+    {
+        PathCacheKey key;
+        if (reader.readBool())
+        {
+            key.movementClass = MovementClassId(reader.readUint32());
+        }
+        key.footprintX = reader.readUint32();
+        key.footprintZ = reader.readUint32();
+        key.coarseStart.x = reader.readInt32();
+        key.coarseStart.y = reader.readInt32();
+        key.isRectGoal = reader.readBool();
+        key.goal.x = reader.readInt32();
+        key.goal.y = reader.readInt32();
+        key.goal.width = reader.readUint32();
+        key.goal.height = reader.readUint32();
+        key.epoch = epoch;
+
+        std::vector<Point> route;
+        auto cellCount = reader.readCount();
+        if (cellCount == 0)
+        {
+            snapshotMalformed("empty cached route");
+        }
+        route.reserve(cellCount);
+        for (std::size_t i = 0; i < cellCount; ++i)
+        {
+            auto x = reader.readInt32();
+            auto y = reader.readInt32();
+            route.emplace_back(x, y);
+        }
+
+        return std::make_pair(key, std::move(route));
+    }
+
+    LaserProjectile readLaser(SnapshotReader& reader, const GameSimulation& simulation, UnitFactory& unitFactory)
+    {
+        auto weaponType = reader.readString();
+        PlayerId owner(reader.readUint32());
+        auto position = reader.readVector3f();
+        auto origin = reader.readVector3f();
+        auto velocity = reader.readVector3f();
+        auto duration = reader.readFloat();
+        GameTime lastSmoke(reader.readUint32());
+
+        auto weapon = unitFactory.createWeapon(weaponType);
+        auto laser = simulation.createProjectileFromWeapon(owner, weapon, position, Vector3f(0.0f, 0.0f, 0.0f));
+        laser.origin = origin;
+        laser.velocity = velocity;
+        laser.duration = duration;
+        laser.lastSmoke = lastSmoke;
+        return laser;
+    }
+
+    void readSimulationSnapshot(std::istream& stream, GameSimulation& simulation, UnitFactory& unitFactory)
+    {
+        SnapshotReader reader(&stream);
+
+        if (reader.readUint32() != SnapshotMagic)
+        {
+            snapshotMalformed("not a snapshot");
+        }
+        if (reader.readUint32() != SnapshotVersion)
+        {
+            snapshotMalformed("unsupported version");
+        }
+        if (reader.readUint32() != SimTicksPerSecond)
+        {
+            snapshotMismatch("simulation tick rate differs");
+        }
+
+        const auto& heightMap = simulation.terrain.getHeightMap();
+        if (reader.readCount() != heightMap.getWidth() || reader.readCount() != heightMap.getHeight())
+        {
+            snapshotMismatch("map size differs");
+        }
+        if (reader.readCount() != simulation.features.size())
+        {
+            snapshotMismatch("map features differ");
+        }
+        if (reader.readCount() != simulation.players.size())
+        {
+            snapshotMismatch("number of players differs");
+        }
+
+        GameTime gameTime(reader.readUint32());
+        auto randomSeed = reader.readUint64();
+
+        // Everything is read into temporaries first,
+        // so that a bad snapshot leaves the simulation untouched.
+        std::vector<std::uint32_t> generations(reader.readCount());
+        for (auto& g : generations)
+        {
+            g = reader.readUint32();
+        }
+
+        std::vector<std::uint32_t> freeSlots(reader.readCount());
+        for (auto& s : freeSlots)
+        {
+            s = reader.readUint32();
+        }
+
+        auto unitCount = reader.readCount();
+        std::vector<UnitId> unitIds;
+        std::vector<Unit> units;
+        UnitKinematicsStore kinematics;
+        unitIds.reserve(unitCount);
+        units.reserve(unitCount);
+        for (std::size_t i = 0; i < unitCount; ++i)
+        {
+            unitIds.emplace_back(reader.readUint32());
+            auto& unit = units.emplace_back(readUnit(reader, simulation, unitFactory));
+
+            kinematics.pushBack(0.0f, unitFactory.getMovementAttributes(unit.unitType));
+            kinematics.rotation[i] = reader.readFloat();
+            kinematics.currentSpeed[i] = reader.readFloat();
+            kinematics.previousSpeed[i] = reader.readFloat();
+            kinematics.targetAngle[i] = reader.readFloat();
+            kinematics.targetSpeed[i] = reader.readFloat();
+            kinematics.speedLimit[i] = reader.readFloat();
+        }
+
+        ObjectPool<LaserProjectile> lasers;
+        auto laserCount = reader.readCount();
+        for (std::size_t i = 0; i < laserCount; ++i)
+        {
+            lasers.insert(readLaser(reader, simulation, unitFactory));
+        }
+
+        // pushing the requests in the order they were written
+        // recreates the order they will be served in
+        PathRequestQueue pathRequests;
+        auto pathRequestCount = reader.readCount();
+        for (std::size_t i = 0; i < pathRequestCount; ++i)
+        {
+            pathRequests.push(readPathRequest(reader));
+        }
+
+        std::vector<PathRequest> pathRequestsInProgress;
+        auto pathRequestsInProgressCount = reader.readCount();
+        for (std::size_t i = 0; i < pathRequestsInProgressCount; ++i)
+        {
+            pathRequestsInProgress.push_back(readPathRequest(reader));
+        }
+
+        // inserting the routes in the order they were written
+        // recreates the order they will be dropped in
+        PathCache pathCache(reader.readUint32());
+        auto pathCacheEntryCount = reader.readCount();
+        if (pathCacheEntryCount > PathCache::Capacity)
+        {
+            snapshotMalformed("too many cached routes");
+        }
+        for (std::size_t i = 0; i < pathCacheEntryCount; ++i)
+        {
+            auto entry = readPathCacheEntry(reader, pathCache.getEpoch());
+            pathCache.insert(entry.first, std::move(entry.second));
+        }
+
+        SlotMap<Unit, UnitId> newUnits;
+        newUnits.restore(generations, freeSlots, unitIds, std::move(units));
+
+        // commit
+        for (std::size_t i = 0; i < simulation.units.size(); ++i)
+        {
+            const auto& unit = simulation.units.valueAt(i);
+            auto footprintRect = simulation.computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+            simulation.occupiedGrid.setArea(simulation.occupiedGrid.grid.clipRegion(footprintRect), OccupiedNone());
+            simulation.unitSpatialIndex.remove(simulation.units.idAt(i), footprintRect);
+        }
+
+        simulation.units = std::move(newUnits);
+        simulation.unitKinematics = std::move(kinematics);
+
+        for (std::size_t i = 0; i < simulation.units.size(); ++i)
+        {
+            const auto& unit = simulation.units.valueAt(i);
+            auto unitId = simulation.units.idAt(i);
+            auto footprintRect = simulation.computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+            simulation.occupiedGrid.setArea(simulation.occupiedGrid.grid.clipRegion(footprintRect), OccupiedUnit(unitId));
+            simulation.unitSpatialIndex.insert(unitId, footprintRect);
+        }
+
+        simulation.lasers = std::move(lasers);
+        simulation.explosions.clear();
+        simulation.pathRequests = std::move(pathRequests);
+        simulation.pathRequestsInProgress = std::move(pathRequestsInProgress);
+        simulation.pathCache = std::move(pathCache);
+        simulation.gameTime = gameTime;
+        simulation.randomSeed = randomSeed;
+    }
+}
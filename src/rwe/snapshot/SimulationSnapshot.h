@@ -0,0 +1,34 @@
+#ifndef RWE_SIMULATIONSNAPSHOT_H
+#define RWE_SIMULATIONSNAPSHOT_H
+
+#include <istream>
+#include <ostream>
+#include <rwe/GameSimulation.h>
+#include <rwe/UnitFactory.h>
+
+namespace rwe
+{
+    /**
+     * Writes everything needed to resume the simulation to a compact binary stream:
+     * units (including their scripts' threads and queues and their pieces' animations),
+     * steering state, projectiles, pending path requests, cached routes and the game clock.
+     *
+     * Terrain and features are not written, since they do not change during a game
+     * and are reloaded from the map.
+     * Explosions and smoke are purely cosmetic and are also left out.
+     */
+    void writeSimulationSnapshot(std::ostream& stream, const GameSimulation& simulation);
+
+    /**
+     * Replaces the state of the simulation with a snapshot.
+     * The simulation must have been loaded from the same map with the same players.
+     * Data that comes from the game files, such as meshes, sounds and weapon definitions,
+     * is recreated by the unit factory and then overwritten with the saved state.
+     *
+     * Throws std::runtime_error if the snapshot is malformed or does not match.
+     * In that case the simulation is left unchanged.
+     */
+    void readSimulationSnapshot(std::istream& stream, GameSimulation& simulation, UnitFactory& unitFactory);
+}
+
+#endif
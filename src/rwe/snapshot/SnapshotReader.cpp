@@ -0,0 +1,97 @@
+#include "SnapshotReader.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace rwe
+{
+    SnapshotReader::SnapshotReader(std::istream* stream) : stream(stream)
+    {
+    }
+
+    bool SnapshotReader::readBool()
+    {
+        auto value = readUint8();
+        if (value > 1)
+        {
+            throw std::runtime_error("Invalid boolean in snapshot");
+        }
+
+        return value == 1;
+    }
+
+    std::uint8_t SnapshotReader::readUint8()
+    {
+        char byte;
+        readBytes(&byte, 1);
+        return static_cast<std::uint8_t>(byte);
+    }
+
+    std::uint32_t SnapshotReader::readUint32()
+    {
+        char bytes[4];
+        readBytes(bytes, sizeof(bytes));
+
+        std::uint32_t value = 0;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[i])) << (i * 8u);
+        }
+        return value;
+    }
+
+    std::uint64_t SnapshotReader::readUint64()
+    {
+        char bytes[8];
+        readBytes(bytes, sizeof(bytes));
+
+        std::uint64_t value = 0;
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i])) << (i * 8u);
+        }
+        return value;
+    }
+
+    std::int32_t SnapshotReader::readInt32()
+    {
+        return static_cast<std::int32_t>(readUint32());
+    }
+
+    float SnapshotReader::readFloat()
+    {
+        auto bits = readUint32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string SnapshotReader::readString()
+    {
+        auto size = readCount();
+        std::string value(size, '\0');
+        readBytes(value.data(), size);
+        return value;
+    }
+
+    Vector3f SnapshotReader::readVector3f()
+    {
+        auto x = readFloat();
+        auto y = readFloat();
+        auto z = readFloat();
+        return Vector3f(x, y, z);
+    }
+
+    std::size_t SnapshotReader::readCount()
+    {
+        return readUint32();
+    }
+
+    void SnapshotReader::readBytes(char* buffer, std::size_t count)
+    {
+        stream->read(buffer, count);
+        if (static_cast<std::size_t>(stream->gcount()) != count)
+        {
+            throw std::runtime_error("Unexpected end of snapshot");
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RWE_SNAPSHOTREADER_H
+#define RWE_SNAPSHOTREADER_H
+
+#include <cstdint>
+#include <istream>
+#include <rwe/math/Vector3f.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * Reads values written by SnapshotWriter.
+     * Throws std::runtime_error if the stream ends early.
+     */
+    class SnapshotReader
+    {
+    private:
+        std::istream* stream;
+
+    public:
+        explicit SnapshotReader(std::istream* stream);
+
+        bool readBool();
+
+        std::uint8_t readUint8();
+
+        std::uint32_t readUint32();
+
+        std::uint64_t readUint64();
+
+        std::int32_t readInt32();
+
+        float readFloat();
+
+        std::string readString();
+
+        Vector3f readVector3f();
+
+        std::size_t readCount();
+
+    private:
+        void readBytes(char* buffer, std::size_t count);
+    };
+}
+
+#endif
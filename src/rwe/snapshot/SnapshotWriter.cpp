@@ -0,0 +1,76 @@
+#include "SnapshotWriter.h"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace rwe
+{
+    SnapshotWriter::SnapshotWriter(std::ostream* stream) : stream(stream)
+    {
+    }
+
+    void SnapshotWriter::writeBool(bool value)
+    {
+        writeUint8(value ? 1 : 0);
+    }
+
+    void SnapshotWriter::writeUint8(std::uint8_t value)
+    {
+        stream->put(static_cast<char>(value));
+    }
+
+    void SnapshotWriter::writeUint32(std::uint32_t value)
+    {
+        char bytes[4];
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            bytes[i] = static_cast<char>((value >> (i * 8u)) & 0xffu);
+        }
+        stream->write(bytes, sizeof(bytes));
+    }
+
+    void SnapshotWriter::writeUint64(std::uint64_t value)
+    {
+        char bytes[8];
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            bytes[i] = static_cast<char>((value >> (i * 8u)) & 0xffu);
+        }
+        stream->write(bytes, sizeof(bytes));
+    }
+
+    void SnapshotWriter::writeInt32(std::int32_t value)
+    {
+        writeUint32(static_cast<std::uint32_t>(value));
+    }
+
+    void SnapshotWriter::writeFloat(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeUint32(bits);
+    }
+
+    void SnapshotWriter::writeString(const std::string& value)
+    {
+        writeCount(value.size());
+        stream->write(value.data(), value.size());
+    }
+
+    void SnapshotWriter::writeVector3f(const Vector3f& value)
+    {
+        writeFloat(value.x);
+        writeFloat(value.y);
+        writeFloat(value.z);
+    }
+
+    void SnapshotWriter::writeCount(std::size_t count)
+    {
+        if (count > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::runtime_error("Collection too large for snapshot");
+        }
+
+        writeUint32(static_cast<std::uint32_t>(count));
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef RWE_SNAPSHOTWRITER_H
+#define RWE_SNAPSHOTWRITER_H
+
+#include <cstdint>
+#include <ostream>
+#include <rwe/math/Vector3f.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * Writes primitive values to a binary stream
+     * in a fixed little-endian layout,
+     * so that snapshots can be read back on any platform.
+     */
+    class SnapshotWriter
+    {
+    private:
+        std::ostream* stream;
+
+    public:
+        explicit SnapshotWriter(std::ostream* stream);
+
+        void writeBool(bool value);
+
+        void writeUint8(std::uint8_t value);
+
+        void writeUint32(std::uint32_t value);
+
+        void writeUint64(std::uint64_t value);
+
+        void writeInt32(std::int32_t value);
+
+        void writeFloat(float value);
+
+        void writeString(const std::string& value);
+
+        void writeVector3f(const Vector3f& value);
+
+        /** Writes the number of elements in a collection that follows. */
+        void writeCount(std::size_t count);
+    };
+}
+
+#endif
@@ -0,0 +1,728 @@
+#include <algorithm>
+#include <array>
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <rwe/ColorPalette.h>
+#include <rwe/MapFeatureService.h>
+#include <rwe/SideData.h>
+#include <rwe/SimulationRunner.h>
+#include <rwe/ota.h>
+#include <rwe/replay/ReplayPlayer.h>
+#include <rwe/tdf.h>
+#include <rwe/tnt/TntArchive.h>
+#include <rwe/vfs/CompositeVirtualFileSystem.h>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
+
+/**
+ * Runs the game simulation without a window, OpenGL context or audio device
+ * and reports how long each tick took
+ * and how much of that was spent animating pieces and running unit scripts
+ * and computing the state hash.
+ *
+ * Both armies are spawned around their start positions
+ * and are ordered to attack each other.
+ * Units that run out of orders are periodically given new ones,
+ * so the simulation stays busy for the whole run.
+ *
+ * By default each side spawns its commander;
+ * pass "-" as the unit type to keep that default
+ * while still specifying the number of worker threads.
+ *
+ * The simulation state hash of every tick can be written to a file.
+ * If a reference hash file from an earlier run is given,
+ * each tick is checked against it as it is simulated
+ * and the first tick that differs is reported.
+ * Pass "-" as the hash log to check without writing a new one.
+ *
+ * --load-snapshot=<file> starts the run from a saved game
+ * instead of spawning new armies,
+ * and --save-snapshot=<file> saves the game at the end of the run,
+ * so that a late-game slowdown can be profiled without replaying the early game.
+ *
+ * --replay=<file> plays back a recorded game instead of the scripted battle.
+ * The map, players and random seed are taken from the replay,
+ * so "-" may be given as the map name,
+ * and the run lasts until the recorded game ended.
+ */
+namespace rwe
+{
+    /** Number of ticks between scripted order refreshes. */
+    static const unsigned int OrderInterval = 300;
+
+    /** Distance between spawned units in world units. */
+    static const float SpawnSpacing = 48.0f;
+
+    std::string readFileAsString(AbstractVirtualFileSystem& vfs, const std::string& path)
+    {
+        auto bytes = vfs.readFile(path);
+        if (!bytes)
+        {
+            throw std::runtime_error("Failed to read " + path);
+        }
+
+        return std::string(bytes->data(), bytes->size());
+    }
+
+    ColorPalette loadPalette(AbstractVirtualFileSystem& vfs, const std::string& path)
+    {
+        auto bytes = vfs.readFile(path);
+        if (!bytes)
+        {
+            throw std::runtime_error("Failed to read " + path);
+        }
+
+        auto palette = readPalette(*bytes);
+        if (!palette)
+        {
+            throw std::runtime_error("Failed to parse " + path);
+        }
+
+        return *palette;
+    }
+
+    Vector3f computeFeaturePosition(const MapTerrain& terrain, const FeatureDefinition& featureDefinition, std::size_t x, std::size_t y)
+    {
+        const auto& heightmap = terrain.getHeightMap();
+
+        unsigned int height = 0;
+        if (x < heightmap.getWidth() - 1 && y < heightmap.getHeight() - 1)
+        {
+            height = (heightmap.get(x, y) + heightmap.get(x + 1, y) + heightmap.get(x, y + 1) + heightmap.get(x + 1, y + 1)) / 4u;
+        }
+
+        auto position = terrain.heightmapIndexToWorldCorner(x, y);
+        position.y = height;
+
+        position.x += (featureDefinition.footprintX * MapTerrain::HeightTileWidthInWorldUnits) / 2.0f;
+        position.z += (featureDefinition.footprintZ * MapTerrain::HeightTileHeightInWorldUnits) / 2.0f;
+
+        return position;
+    }
+
+    /** Creates a feature that has collision but no animation. */
+    MapFeature createHeadlessFeature(const Vector3f& pos, const FeatureDefinition& definition)
+    {
+        MapFeature f;
+        f.footprintX = definition.footprintX;
+        f.footprintZ = definition.footprintZ;
+        f.height = definition.height;
+        f.isBlocking = definition.blocking;
+        f.position = pos;
+        f.transparentAnimation = definition.animTrans;
+        f.transparentShadow = definition.shadTrans;
+        return f;
+    }
+
+    GameSimulation createHeadlessSimulation(AbstractVirtualFileSystem& vfs, MapFeatureService& featureService, const std::string& mapName, const OtaSchema& schema)
+    {
+        auto tntBytes = vfs.readFile("maps/" + mapName + ".tnt");
+        if (!tntBytes)
+        {
+            throw std::runtime_error("Failed to load map bytes");
+        }
+
+        boost::interprocess::bufferstream tntStream(tntBytes->data(), tntBytes->size());
+        TntArchive tnt(&tntStream);
+
+        auto mapWidthInTiles = tnt.getHeader().width / 2;
+        auto mapHeightInTiles = tnt.getHeader().height / 2;
+        std::vector<uint16_t> mapData(mapWidthInTiles * mapHeightInTiles);
+        tnt.readMapData(mapData.data());
+        Grid<std::size_t> dataGrid(mapWidthInTiles, mapHeightInTiles, std::vector<std::size_t>(mapData.begin(), mapData.end()));
+
+        Grid<TntTileAttributes> mapAttributes(tnt.getHeader().width, tnt.getHeader().height);
+        tnt.readMapAttributes(mapAttributes.getData());
+
+        std::vector<unsigned char> heights;
+        heights.reserve(mapAttributes.getVector().size());
+        for (const auto& e : mapAttributes.getVector())
+        {
+            heights.push_back(e.height);
+        }
+        Grid<unsigned char> heightGrid(mapAttributes.getWidth(), mapAttributes.getHeight(), std::move(heights));
+
+        // Tile graphics are only needed for drawing the map, so none are loaded.
+        MapTerrain terrain(
+            std::vector<TextureRegion>(),
+            std::move(dataGrid),
+            std::move(heightGrid),
+            tnt.getHeader().seaLevel);
+
+        GameSimulation simulation(std::move(terrain));
+
+        std::vector<FeatureDefinition> featureTemplates;
+        tnt.readFeatures([&featureService, &featureTemplates](const auto& featureName) {
+            featureTemplates.push_back(featureService.getFeatureDefinition(featureName));
+        });
+
+        for (std::size_t y = 0; y < mapAttributes.getHeight(); ++y)
+        {
+            for (std::size_t x = 0; x < mapAttributes.getWidth(); ++x)
+            {
+                const auto& e = mapAttributes.get(x, y);
+                switch (e.feature)
+                {
+                    case TntTileAttributes::FeatureNone:
+                    case TntTileAttributes::FeatureUnknown:
+                    case TntTileAttributes::FeatureVoid:
+                        break;
+                    default:
+                        const auto& featureTemplate = featureTemplates[e.feature];
+                        Vector3f pos = computeFeaturePosition(simulation.terrain, featureTemplate, x, y);
+                        simulation.addFeature(createHeadlessFeature(pos, featureTemplate));
+                }
+            }
+        }
+
+        for (const auto& f : schema.features)
+        {
+            const auto& featureTemplate = featureService.getFeatureDefinition(f.featureName);
+            Vector3f pos = computeFeaturePosition(simulation.terrain, featureTemplate, f.xPos, f.zPos);
+            simulation.addFeature(createHeadlessFeature(pos, featureTemplate));
+        }
+
+        return simulation;
+    }
+
+    /**
+     * Loads the unit database without loading any sounds.
+     * Every sound name is registered with an empty handle
+     * so that unit creation can still look it up.
+     */
+    UnitDatabase createHeadlessUnitDatabase(AbstractVirtualFileSystem& vfs)
+    {
+        UnitDatabase db;
+
+        auto readDataFile = [&vfs, &db](const std::string& path) {
+            auto contents = readFileAsString(vfs, path);
+            db.addSourceFile(path, contents.data(), contents.size());
+            return contents;
+        };
+
+        auto addSound = [&db](const std::optional<std::string>& soundName) {
+            if (soundName)
+            {
+                db.addSound(*soundName, AudioService::SoundHandle());
+            }
+        };
+
+        for (auto& s : parseSoundTdf(parseTdfFromString(readDataFile("gamedata/SOUND.TDF"))))
+        {
+            const auto& c = s.second;
+            addSound(c.select1);
+            addSound(c.ok1);
+            addSound(c.arrived1);
+            db.addSoundClass(s.first, std::move(s.second));
+        }
+
+        for (auto& c : parseMovementTdf(parseTdfFromString(readDataFile("gamedata/MOVEINFO.TDF"))))
+        {
+            auto name = c.second.name;
+            db.addMovementClass(name, std::move(c.second));
+        }
+
+        for (const auto& fileName : vfs.getFileNames("weapons", ".tdf"))
+        {
+            for (auto& pair : parseWeaponTdf(parseTdfFromString(readDataFile("weapons/" + fileName))))
+            {
+                addSound(pair.second.soundStart);
+                addSound(pair.second.soundHit);
+                addSound(pair.second.soundWater);
+                db.addWeapon(pair.first, std::move(pair.second));
+            }
+        }
+
+        for (const auto& fbiName : vfs.getFileNames("units", ".fbi"))
+        {
+            auto fbi = parseUnitFbi(parseTdfFromString(readDataFile("units/" + fbiName)));
+            db.addUnitInfo(fbi.unitName, fbi);
+        }
+
+        for (const auto& scriptName : vfs.getFileNames("scripts", ".cob"))
+        {
+            auto bytes = vfs.readFile("scripts/" + scriptName);
+            if (!bytes)
+            {
+                throw std::runtime_error("File in listing could not be read: " + scriptName);
+            }
+            db.addSourceFile("scripts/" + scriptName, bytes->data(), bytes->size());
+
+            boost::interprocess::bufferstream s(bytes->data(), bytes->size());
+            auto scriptNameWithoutExtension = scriptName.substr(0, scriptName.size() - 4);
+            db.addUnitScript(scriptNameWithoutExtension, parseCob(s));
+        }
+
+        return db;
+    }
+
+    Vector3f getStartPosition(const MapTerrain& terrain, const OtaSchema& schema, unsigned int index)
+    {
+        std::string startPosKey("StartPos");
+        startPosKey.append(std::to_string(index + 1));
+
+        auto it = std::find_if(schema.specials.begin(), schema.specials.end(), [&startPosKey](const OtaSpecial& s) { return s.specialWhat == startPosKey; });
+        if (it == schema.specials.end())
+        {
+            throw std::runtime_error("Missing key from schema: " + startPosKey);
+        }
+
+        auto pos = terrain.topLeftCoordinateToWorld(Vector3f(it->xPos, 0.0f, it->zPos));
+        pos.y = terrain.getHeightAt(pos.x, pos.z);
+        return pos;
+    }
+
+    std::vector<UnitId> spawnArmy(SimulationRunner& runner, const std::string& unitType, PlayerId owner, const Vector3f& center, unsigned int count)
+    {
+        const auto& terrain = runner.getTerrain();
+        auto columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(count))));
+        auto offset = (static_cast<float>(columns) - 1.0f) * SpawnSpacing / 2.0f;
+
+        std::vector<UnitId> units;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            auto x = center.x - offset + static_cast<float>(i % columns) * SpawnSpacing;
+            auto z = center.z - offset + static_cast<float>(i / columns) * SpawnSpacing;
+            x = std::clamp(x, terrain.leftInWorldUnits() + SpawnSpacing, terrain.rightCutoffInWorldUnits() - SpawnSpacing);
+            z = std::clamp(z, terrain.topInWorldUnits() + SpawnSpacing, terrain.bottomCutoffInWorldUnits() - SpawnSpacing);
+            Vector3f position(x, terrain.getHeightAt(x, z), z);
+
+            auto unitId = runner.spawnUnit(unitType, owner, position);
+            if (unitId)
+            {
+                units.push_back(*unitId);
+            }
+        }
+
+        return units;
+    }
+
+    /**
+     * Gives every idle unit in the army something to do.
+     * Units attack live enemies in round-robin order,
+     * or march on the enemy start position if there are none left.
+     */
+    void issueScriptedOrders(SimulationRunner& runner, const std::vector<UnitId>& army, const std::vector<UnitId>& enemies, const Vector3f& enemyStart)
+    {
+        const auto& simulation = runner.getSimulation();
+
+        std::vector<UnitId> liveEnemies;
+        std::copy_if(enemies.begin(), enemies.end(), std::back_inserter(liveEnemies), [&simulation](UnitId id) { return simulation.unitExists(id); });
+
+        for (std::size_t i = 0; i < army.size(); ++i)
+        {
+            auto unitId = army[i];
+            if (!simulation.unitExists(unitId))
+            {
+                continue;
+            }
+
+            const auto& unit = simulation.getUnit(unitId);
+            if (!unit.orders.empty())
+            {
+                continue;
+            }
+
+            if (unit.canAttack && !liveEnemies.empty())
+            {
+                runner.issueAttackOrder(unitId, liveEnemies[i % liveEnemies.size()]);
+            }
+            else
+            {
+                runner.issueMoveOrder(unitId, enemyStart);
+            }
+        }
+    }
+
+    unsigned int countLiveUnits(const GameSimulation& simulation, const std::vector<UnitId>& units)
+    {
+        return std::count_if(units.begin(), units.end(), [&simulation](UnitId id) { return simulation.unitExists(id); });
+    }
+
+    /** Returns the live units of each player, in the order the players are given. */
+    std::vector<std::vector<UnitId>> groupUnitsByOwner(const GameSimulation& simulation, const std::vector<PlayerId>& players)
+    {
+        std::vector<std::vector<UnitId>> armies(players.size());
+        for (std::size_t i = 0; i < simulation.units.size(); ++i)
+        {
+            for (std::size_t p = 0; p < players.size(); ++p)
+            {
+                if (simulation.units.valueAt(i).isOwnedBy(players[p]))
+                {
+                    armies[p].push_back(simulation.units.idAt(i));
+                }
+            }
+        }
+
+        return armies;
+    }
+
+    double percentile(const std::vector<double>& sortedSamples, double p)
+    {
+        assert(!sortedSamples.empty());
+        auto index = static_cast<std::size_t>(p * static_cast<double>(sortedSamples.size()));
+        return sortedSamples[std::min(index, sortedSamples.size() - 1)];
+    }
+
+    int run(
+        const std::string& searchPath,
+        const std::string& mapName,
+        unsigned int unitsPerPlayer,
+        unsigned int ticks,
+        const std::optional<std::string>& unitTypeOverride,
+        unsigned int workerThreads,
+        const std::optional<std::string>& hashLogPath,
+        const std::optional<std::string>& referenceHashLogPath,
+        const std::optional<std::string>& loadSnapshotPath,
+        const std::optional<std::string>& saveSnapshotPath,
+        const std::optional<std::string>& replayPath)
+    {
+        if (loadSnapshotPath && replayPath)
+        {
+            throw std::runtime_error("A replay cannot be played from a snapshot");
+        }
+
+        std::optional<Replay> replay;
+        if (replayPath)
+        {
+            std::ifstream replayStream(*replayPath, std::ios::binary);
+            if (!replayStream)
+            {
+                throw std::runtime_error("Failed to open " + *replayPath);
+            }
+            replay = readReplay(replayStream);
+            ticks = ReplayPlayer(&*replay).getEndTime().value;
+        }
+
+        std::optional<StateHashLog> referenceHashes;
+        if (referenceHashLogPath)
+        {
+            std::ifstream referenceStream(*referenceHashLogPath);
+            if (!referenceStream)
+            {
+                throw std::runtime_error("Failed to open " + *referenceHashLogPath);
+            }
+            referenceHashes = StateHashLog::read(referenceStream);
+        }
+
+        auto vfs = constructVfs(searchPath);
+
+        auto palette = loadPalette(vfs, "palettes/PALETTE.PAL");
+        auto guiPalette = loadPalette(vfs, "palettes/GUIPAL.PAL");
+
+        auto sides = parseSidesFromSideData(parseTdfFromString(readFileAsString(vfs, "gamedata/SIDEDATA.TDF")));
+        if (sides.empty())
+        {
+            throw std::runtime_error("No sides found in SIDEDATA.TDF");
+        }
+
+        MapFeatureService featureService(&vfs);
+        featureService.loadAllFeatureDefinitions();
+
+        const auto& activeMapName = replay ? replay->header.mapName : mapName;
+        auto ota = parseOta(parseTdfFromString(readFileAsString(vfs, "maps/" + activeMapName + ".ota")));
+        const auto& schema = ota.schemas.at(replay ? replay->header.schemaIndex : 0);
+
+        std::cerr << "Loading map " << activeMapName << std::endl;
+        auto simulation = createHeadlessSimulation(vfs, featureService, activeMapName, schema);
+
+        std::cerr << "Loading unit database" << std::endl;
+        auto unitDatabase = createHeadlessUnitDatabase(vfs);
+        if (replay && replay->header.unitDataVersion != unitDatabase.getDataVersion())
+        {
+            throw std::runtime_error("Replay was recorded with different unit data");
+        }
+        if (replay && replay->header.ticksPerSecond != SimTicksPerSecond)
+        {
+            throw std::runtime_error("Replay was recorded at a different simulation tick rate");
+        }
+
+        std::cerr << "Computing walkable grids" << std::endl;
+        MovementClassCollisionService collisionService;
+        {
+            std::vector<std::pair<std::string, MovementClass>> namedClasses(unitDatabase.movementClassBegin(), unitDatabase.movementClassEnd());
+            std::sort(namedClasses.begin(), namedClasses.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            std::vector<MovementClass> movementClasses;
+            for (const auto& pair : namedClasses)
+            {
+                movementClasses.push_back(pair.second);
+            }
+
+            ThreadPool threadPool(workerThreads);
+            auto waterLevel = static_cast<unsigned int>(simulation.terrain.getSeaLevel());
+            auto grids = computeWalkableGrids(simulation.terrain.getHeightMap(), waterLevel, movementClasses, threadPool);
+            for (std::size_t i = 0; i < namedClasses.size(); ++i)
+            {
+                collisionService.registerMovementClass(namedClasses[i].first, std::move(grids[i]));
+            }
+        }
+
+        std::vector<PlayerId> players;
+        if (replay)
+        {
+            for (auto color : replay->header.playerColors)
+            {
+                players.push_back(simulation.addPlayer(GamePlayerInfo{color}));
+            }
+            simulation.randomSeed = replay->header.randomSeed;
+        }
+        else
+        {
+            players.push_back(simulation.addPlayer(GamePlayerInfo{0}));
+            players.push_back(simulation.addPlayer(GamePlayerInfo{1}));
+        }
+
+        SimulationRunner runner(
+            nullptr,
+            nullptr,
+            &palette,
+            &guiPalette,
+            std::move(simulation),
+            std::move(collisionService),
+            std::move(unitDatabase),
+            MeshService::createHeadlessMeshService(&vfs, &palette),
+            workerThreads);
+
+        std::array<Vector3f, 2> startPositions{
+            getStartPosition(runner.getTerrain(), schema, 0),
+            getStartPosition(runner.getTerrain(), schema, 1)};
+
+        std::vector<std::vector<UnitId>> armies(players.size());
+        std::optional<ReplayPlayer> replayPlayer;
+        if (replay)
+        {
+            std::cerr << "Playing replay " << *replayPath << std::endl;
+            replayPlayer.emplace(&*replay);
+        }
+        else if (loadSnapshotPath)
+        {
+            std::cerr << "Loading snapshot " << *loadSnapshotPath << std::endl;
+            std::ifstream snapshotStream(*loadSnapshotPath, std::ios::binary);
+            if (!snapshotStream)
+            {
+                throw std::runtime_error("Failed to open " + *loadSnapshotPath);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            runner.loadSnapshot(snapshotStream);
+            auto end = std::chrono::steady_clock::now();
+            std::cerr << "Loaded snapshot in " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+            armies = groupUnitsByOwner(runner.getSimulation(), players);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < 2; ++i)
+            {
+                auto unitType = unitTypeOverride ? *unitTypeOverride : sides[i % sides.size()].commander;
+                armies[i] = spawnArmy(runner, unitType, players[i], startPositions[i], unitsPerPlayer);
+                std::cerr << "Spawned " << armies[i].size() << " of " << unitsPerPlayer << " " << unitType << std::endl;
+            }
+        }
+
+        std::vector<double> samples;
+        samples.reserve(ticks);
+
+        std::size_t maxPathQueueDepth = 0;
+        unsigned long long pathRequestsStarted = 0;
+        unsigned long long totalPathWaitTicks = 0;
+        unsigned int maxPathWaitTicks = 0;
+        std::chrono::microseconds totalPathSearchTime(0);
+        unsigned long long pathCacheHits = 0;
+        unsigned long long pathCacheMisses = 0;
+        std::chrono::microseconds totalScriptTime(0);
+        std::chrono::microseconds totalStateHashTime(0);
+
+        std::cerr << "Running " << ticks << " ticks" << std::endl;
+        for (unsigned int tick = 0; tick < ticks; ++tick)
+        {
+            if (replayPlayer)
+            {
+                replayPlayer->applyCommands(runner);
+            }
+            else if (tick % OrderInterval == 0)
+            {
+                issueScriptedOrders(runner, armies[0], armies[1], startPositions[1]);
+                issueScriptedOrders(runner, armies[1], armies[0], startPositions[0]);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            runner.update();
+            auto end = std::chrono::steady_clock::now();
+
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+            const auto& pathMetrics = runner.getPathFindingService().getMetrics();
+            maxPathQueueDepth = std::max(maxPathQueueDepth, pathMetrics.queueDepth);
+            pathRequestsStarted += pathMetrics.requestsStarted;
+            totalPathWaitTicks += pathMetrics.totalWaitTicks;
+            maxPathWaitTicks = std::max(maxPathWaitTicks, pathMetrics.maxWaitTicks);
+            totalPathSearchTime += pathMetrics.searchTime;
+            pathCacheHits += pathMetrics.pathCacheHits;
+            pathCacheMisses += pathMetrics.pathCacheMisses;
+
+            totalScriptTime += runner.getTickMetrics().scriptTime;
+            totalStateHashTime += runner.getTickMetrics().stateHashTime;
+
+            if (referenceHashes)
+            {
+                auto referenceHash = referenceHashes->find(runner.getGameTime());
+                if (referenceHash)
+                {
+                    runner.verifyStateHash(runner.getGameTime(), *referenceHash);
+                }
+            }
+        }
+
+        if (replayPlayer)
+        {
+            armies = groupUnitsByOwner(runner.getSimulation(), players);
+        }
+
+        if (saveSnapshotPath)
+        {
+            std::ofstream snapshotStream(*saveSnapshotPath, std::ios::binary);
+            runner.saveSnapshot(snapshotStream);
+        }
+
+        if (hashLogPath)
+        {
+            std::ofstream hashLogStream(*hashLogPath);
+            runner.getStateHashLog().write(hashLogStream);
+            if (!hashLogStream)
+            {
+                throw std::runtime_error("Failed to write " + *hashLogPath);
+            }
+        }
+
+        auto total = std::accumulate(samples.begin(), samples.end(), 0.0);
+        std::sort(samples.begin(), samples.end());
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "ticks: " << samples.size() << std::endl;
+        std::cout << "worker threads: " << workerThreads << std::endl;
+        if (!runner.getStateHashLog().getEntries().empty())
+        {
+            std::cout << "final state hash: " << std::hex << std::setw(16) << std::setfill('0') << runner.getStateHashLog().getEntries().back().hash << std::dec << std::setfill(' ') << std::endl;
+        }
+        if (referenceHashes)
+        {
+            auto divergence = runner.getFirstDivergence();
+            if (divergence)
+            {
+                std::cout << "first divergent tick: " << divergence->value << std::endl;
+            }
+            else
+            {
+                std::cout << "state hashes match reference" << std::endl;
+            }
+        }
+        std::cout << "units remaining:";
+        for (std::size_t i = 0; i < armies.size(); ++i)
+        {
+            std::cout << (i == 0 ? " " : " vs ") << countLiveUnits(runner.getSimulation(), armies[i]);
+        }
+        std::cout << std::endl;
+        if (!samples.empty())
+        {
+            std::cout << "total ms: " << total << std::endl;
+            std::cout << "mean ms: " << (total / static_cast<double>(samples.size())) << std::endl;
+            std::cout << "min ms: " << samples.front() << std::endl;
+            std::cout << "p50 ms: " << percentile(samples, 0.50) << std::endl;
+            std::cout << "p90 ms: " << percentile(samples, 0.90) << std::endl;
+            std::cout << "p99 ms: " << percentile(samples, 0.99) << std::endl;
+            std::cout << "p99.9 ms: " << percentile(samples, 0.999) << std::endl;
+            std::cout << "max ms: " << samples.back() << std::endl;
+            std::cout << "script ms mean: " << (std::chrono::duration<double, std::milli>(totalScriptTime).count() / static_cast<double>(samples.size())) << std::endl;
+            std::cout << "state hash ms mean: " << (std::chrono::duration<double, std::milli>(totalStateHashTime).count() / static_cast<double>(samples.size())) << std::endl;
+        }
+        std::cout << "path requests started: " << pathRequestsStarted << std::endl;
+        std::cout << "path queue depth max: " << maxPathQueueDepth << std::endl;
+        if (pathRequestsStarted > 0)
+        {
+            std::cout << "path wait ticks mean: " << (static_cast<double>(totalPathWaitTicks) / static_cast<double>(pathRequestsStarted)) << std::endl;
+            std::cout << "path wait ticks max: " << maxPathWaitTicks << std::endl;
+        }
+        std::cout << "path cache hits: " << pathCacheHits << std::endl;
+        std::cout << "path cache misses: " << pathCacheMisses << std::endl;
+        std::cout << "path search worker ms: " << std::chrono::duration<double, std::milli>(totalPathSearchTime).count() << std::endl;
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> args;
+    std::optional<std::string> loadSnapshotPath;
+    std::optional<std::string> saveSnapshotPath;
+    std::optional<std::string> replayPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if (arg.rfind("--load-snapshot=", 0) == 0)
+        {
+            loadSnapshotPath = arg.substr(16);
+        }
+        else if (arg.rfind("--save-snapshot=", 0) == 0)
+        {
+            saveSnapshotPath = arg.substr(16);
+        }
+        else if (arg.rfind("--replay=", 0) == 0)
+        {
+            replayPath = arg.substr(9);
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--load-snapshot=<file>] [--save-snapshot=<file>] [--replay=<file>] <search-path> <map-name> [units-per-player] [ticks] [unit-type] [worker-threads] [hash-log] [reference-hash-log]" << std::endl;
+        return 1;
+    }
+
+    std::string searchPath(args[0]);
+    std::string mapName(args[1]);
+    unsigned int unitsPerPlayer = args.size() > 2 ? std::stoul(args[2]) : 50;
+    unsigned int ticks = args.size() > 3 ? std::stoul(args[3]) : 3600;
+    std::optional<std::string> unitType;
+    if (args.size() > 4 && args[4] != "-")
+    {
+        unitType = args[4];
+    }
+    unsigned int workerThreads = args.size() > 5 ? std::stoul(args[5]) : rwe::ThreadPool::defaultWorkerCount();
+    std::optional<std::string> hashLogPath;
+    if (args.size() > 6 && args[6] != "-")
+    {
+        hashLogPath = args[6];
+    }
+    std::optional<std::string> referenceHashLogPath;
+    if (args.size() > 7)
+    {
+        referenceHashLogPath = args[7];
+    }
+
+    // the pathfinder logs through this logger
+    auto logger = spdlog::stdout_logger_mt("rwe");
+    logger->set_level(spdlog::level::warn);
+
+    try
+    {
+        return rwe::run(searchPath, mapName, unitsPerPlayer, ticks, unitType, workerThreads, hashLogPath, referenceHashLogPath, loadSnapshotPath, saveSnapshotPath, replayPath);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
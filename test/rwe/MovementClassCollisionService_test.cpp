@@ -0,0 +1,133 @@
+#include <catch.hpp>
+#include <random>
+#include <rwe/MovementClassCollisionService.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    static Grid<char> makeGrid(const std::vector<std::string>& rows)
+    {
+        Grid<char> grid(rows[0].size(), rows.size());
+        for (std::size_t y = 0; y < rows.size(); ++y)
+        {
+            for (std::size_t x = 0; x < rows[y].size(); ++x)
+            {
+                grid.set(x, y, rows[y][x] == '.');
+            }
+        }
+        return grid;
+    }
+
+    TEST_CASE("computeConnectedComponents")
+    {
+        auto components = computeConnectedComponents(makeGrid({
+            "..#...",
+            "..#.#.",
+            "###.#.",
+            "....#.",
+        }));
+
+        SECTION("labels unwalkable cells 0")
+        {
+            REQUIRE(components.get(2, 0) == 0);
+            REQUIRE(components.get(4, 3) == 0);
+        }
+
+        SECTION("gives connected cells the same label")
+        {
+            REQUIRE(components.get(0, 0) != 0);
+            REQUIRE(components.get(0, 0) == components.get(1, 1));
+            REQUIRE(components.get(3, 0) == components.get(5, 3));
+            REQUIRE(components.get(3, 0) == components.get(0, 3));
+        }
+
+        SECTION("gives separate areas different labels")
+        {
+            REQUIRE(components.get(0, 0) != components.get(3, 0));
+        }
+
+        SECTION("connects cells that touch only diagonally")
+        {
+            auto diagonal = computeConnectedComponents(makeGrid({
+                ".#",
+                "#.",
+            }));
+            REQUIRE(diagonal.get(0, 0) != 0);
+            REQUIRE(diagonal.get(0, 0) == diagonal.get(1, 1));
+        }
+    }
+
+    TEST_CASE("MovementClassCollisionService reachability")
+    {
+        MovementClassCollisionService service;
+        auto id = service.registerMovementClass("TANK", makeGrid({
+            "...#....",
+            "...#....",
+            "...#....",
+            "...#....",
+        }));
+
+        SECTION("knows which cells can reach each other")
+        {
+            REQUIRE(service.isReachable(id, Point(0, 0), Point(2, 3)));
+            REQUIRE(!service.isReachable(id, Point(0, 0), Point(4, 0)));
+            REQUIRE(!service.isReachable(id, Point(0, 0), Point(3, 0)));
+            REQUIRE(!service.getComponent(id, Point(3, 0)));
+            REQUIRE(!service.getComponent(id, Point(-1, 0)));
+        }
+
+        SECTION("finds the nearest cell in a component")
+        {
+            auto component = *service.getComponent(id, Point(0, 0));
+            REQUIRE(service.findNearestInComponent(id, component, Point(7, 2)) == Point(2, 2));
+            REQUIRE(service.findNearestInComponent(id, component, Point(1, 1)) == Point(1, 1));
+        }
+    }
+
+    TEST_CASE("computeWalkableGrids")
+    {
+        std::mt19937 rng(7);
+        Grid<unsigned char> heights(37, 29);
+        for (std::size_t y = 0; y < heights.getHeight(); ++y)
+        {
+            for (std::size_t x = 0; x < heights.getWidth(); ++x)
+            {
+                // gentle hills with some noise, dipping below the water level in places
+                heights.set(x, y, static_cast<unsigned char>(40 + ((x * 3 + y * 2) % 50) + (rng() % 12)));
+            }
+        }
+        const unsigned int waterLevel = 60;
+
+        std::vector<MovementClass> classes{
+            MovementClass{"TANK2", 2, 2, 0, 15, 12, 255},
+            MovementClass{"KBOT3", 3, 3, 0, 25, 20, 255},
+            MovementClass{"BOAT3", 3, 2, 2, 255, 255, 255},
+            MovementClass{"HOVER1", 1, 1, 0, 255, 10, 60},
+        };
+
+        ThreadPool threadPool(2);
+        auto grids = computeWalkableGrids(heights, waterLevel, classes, threadPool);
+
+        REQUIRE(grids.size() == classes.size());
+        for (std::size_t i = 0; i < classes.size(); ++i)
+        {
+            const auto& mc = classes[i];
+            const auto& grid = grids[i];
+            REQUIRE(grid.getWidth() == heights.getWidth());
+            REQUIRE(grid.getHeight() == heights.getHeight());
+
+            for (unsigned int y = 0; y < grid.getHeight(); ++y)
+            {
+                for (unsigned int x = 0; x < grid.getWidth(); ++x)
+                {
+                    auto inRange = x < heights.getWidth() - mc.footprintX - 1 && y < heights.getHeight() - mc.footprintZ - 1;
+                    auto expected = inRange
+                        && !isMaxSlopeGreaterThan(heights, waterLevel, x, y, mc.footprintX, mc.footprintZ, mc.maxSlope, mc.maxWaterSlope)
+                        && isWaterDepthWithinBounds(heights, waterLevel, x, y, mc.footprintX, mc.footprintZ, mc.minWaterDepth, mc.maxWaterDepth);
+                    REQUIRE(static_cast<bool>(grid.get(x, y)) == expected);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#include <catch.hpp>
+#include <rwe/ObjectPool.h>
+#include <string>
+
+namespace rwe
+{
+    TEST_CASE("ObjectPool")
+    {
+        SECTION("starts empty")
+        {
+            ObjectPool<std::string> p;
+            REQUIRE(p.empty());
+            REQUIRE(p.size() == 0);
+            REQUIRE(p.begin() == p.end());
+        }
+
+        SECTION("retrieves inserted values by handle")
+        {
+            ObjectPool<std::string> p;
+            auto a = p.insert("a");
+            auto b = p.insert("b");
+
+            REQUIRE(p.size() == 2);
+            REQUIRE(p.get(a) == "a");
+            REQUIRE(p.get(b) == "b");
+        }
+
+        SECTION("reuses the most recently freed slot")
+        {
+            ObjectPool<std::string> p;
+            auto a = p.insert("a");
+            auto b = p.insert("b");
+            p.insert("c");
+
+            p.remove(a);
+            p.remove(b);
+            REQUIRE(!p.contains(a));
+            REQUIRE(!p.contains(b));
+
+            REQUIRE(p.insert("d") == b);
+            REQUIRE(p.insert("e") == a);
+            REQUIRE(p.capacity() == 3);
+        }
+
+        SECTION("iteration visits only live values")
+        {
+            ObjectPool<std::string> p;
+            auto a = p.insert("a");
+            p.insert("b");
+            p.insert("c");
+
+            p.remove(a);
+
+            std::string concatenated;
+            for (const auto& v : p)
+            {
+                concatenated += v;
+            }
+            REQUIRE(concatenated == "cb");
+        }
+
+        SECTION("removeIf removes matching values and keeps handles of the rest")
+        {
+            ObjectPool<int> p;
+            std::vector<ObjectPool<int>::Handle> handles;
+            for (int i = 0; i < 10; ++i)
+            {
+                handles.push_back(p.insert(int(i)));
+            }
+
+            p.removeIf([](int& v) { return v % 2 == 0; });
+
+            REQUIRE(p.size() == 5);
+            for (int i = 0; i < 10; ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    REQUIRE(!p.contains(handles[i]));
+                }
+                else
+                {
+                    REQUIRE(p.get(handles[i]) == i);
+                }
+            }
+        }
+
+        SECTION("removeIf can modify surviving values")
+        {
+            ObjectPool<int> p;
+            p.insert(1);
+            p.insert(2);
+
+            p.removeIf([](int& v) {
+                v *= 10;
+                return false;
+            });
+
+            int sum = 0;
+            for (auto v : p)
+            {
+                sum += v;
+            }
+            REQUIRE(sum == 30);
+        }
+    }
+}
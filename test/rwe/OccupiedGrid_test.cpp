@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <catch.hpp>
+#include <random>
+#include <rwe/OccupiedGrid.h>
+
+namespace rwe
+{
+    /** Finds the clearance of a cell the slow way, by growing a square until it hits something. */
+    static unsigned int measureClearance(const OccupiedGrid& occupiedGrid, unsigned int x, unsigned int y)
+    {
+        unsigned int size = 0;
+        while (size < OccupiedGrid::MaxClearance)
+        {
+            DiscreteRect square(x, y, size + 1, size + 1);
+            auto region = occupiedGrid.grid.tryToRegion(square);
+            if (!region)
+            {
+                break;
+            }
+
+            for (unsigned int dy = 0; dy < region->height; ++dy)
+            {
+                for (unsigned int dx = 0; dx < region->width; ++dx)
+                {
+                    if (!occupiedGrid.grid.get(x + dx, y + dy).isNone())
+                    {
+                        return size;
+                    }
+                }
+            }
+
+            ++size;
+        }
+
+        return size;
+    }
+
+    TEST_CASE("OccupiedGrid")
+    {
+        OccupiedGrid occupiedGrid(20, 20);
+
+        SECTION("clearance is limited by the edge of the grid")
+        {
+            REQUIRE(occupiedGrid.clearance.get(0, 0) == OccupiedGrid::MaxClearance);
+            REQUIRE(occupiedGrid.clearance.get(19, 0) == 1);
+            REQUIRE(occupiedGrid.clearance.get(17, 15) == 3);
+        }
+
+        SECTION("clearance is limited by occupied cells")
+        {
+            occupiedGrid.setArea(GridRegion(5, 5, 2, 2), OccupiedUnit(UnitId(1)));
+            REQUIRE(occupiedGrid.clearance.get(5, 5) == 0);
+            REQUIRE(occupiedGrid.clearance.get(3, 3) == 2);
+            REQUIRE(occupiedGrid.clearance.get(4, 4) == 1);
+            REQUIRE(occupiedGrid.clearance.get(3, 7) == OccupiedGrid::MaxClearance);
+
+            occupiedGrid.setArea(GridRegion(5, 5, 2, 2), OccupiedNone());
+            REQUIRE(occupiedGrid.clearance.get(3, 3) == measureClearance(occupiedGrid, 3, 3));
+            REQUIRE(occupiedGrid.clearance.get(5, 5) == measureClearance(occupiedGrid, 5, 5));
+        }
+
+        SECTION("collision checks agree with the cells after many changes")
+        {
+            std::mt19937 rng(42);
+            for (int i = 0; i < 200; ++i)
+            {
+                auto x = static_cast<unsigned int>(rng() % 20);
+                auto y = static_cast<unsigned int>(rng() % 20);
+                auto width = 1 + static_cast<unsigned int>(rng() % std::min(4u, 20 - x));
+                auto height = 1 + static_cast<unsigned int>(rng() % std::min(4u, 20 - y));
+                switch (rng() % 3)
+                {
+                    case 0:
+                        occupiedGrid.setArea(GridRegion(x, y, width, height), OccupiedNone());
+                        break;
+                    case 1:
+                        occupiedGrid.setArea(GridRegion(x, y, width, height), OccupiedUnit(UnitId(rng() % 3)));
+                        break;
+                    default:
+                        occupiedGrid.setArea(GridRegion(x, y, width, height), OccupiedFeature(FeatureId(0)));
+                        break;
+                }
+            }
+
+            for (unsigned int y = 0; y < 20; ++y)
+            {
+                for (unsigned int x = 0; x < 20; ++x)
+                {
+                    REQUIRE(occupiedGrid.clearance.get(x, y) == measureClearance(occupiedGrid, x, y));
+
+                    DiscreteRect rect(x, y, 3, 2);
+                    auto expected = !occupiedGrid.grid.contains(rect);
+                    for (unsigned int dy = 0; !expected && dy < rect.height; ++dy)
+                    {
+                        for (unsigned int dx = 0; !expected && dx < rect.width; ++dx)
+                        {
+                            const auto& cell = occupiedGrid.grid.get(x + dx, y + dy);
+                            expected = cell.isFeature() || (cell.isUnit() && cell.unitId() != UnitId(1));
+                        }
+                    }
+                    REQUIRE(occupiedGrid.isCollisionAt(rect, UnitId(1)) == expected);
+                }
+            }
+        }
+
+        SECTION("rects spanning several words of occupied bits")
+        {
+            OccupiedGrid wideGrid(150, 3);
+            wideGrid.setArea(GridRegion(63, 1, 2, 1), OccupiedFeature(FeatureId(2)));
+            wideGrid.setArea(GridRegion(128, 0, 1, 1), OccupiedUnit(UnitId(1)));
+
+            REQUIRE(wideGrid.isOccupied(63, 1));
+            REQUIRE(wideGrid.isOccupied(64, 1));
+            REQUIRE(!wideGrid.isOccupied(65, 1));
+
+            REQUIRE(wideGrid.isCollisionAt(DiscreteRect(10, 0, 100, 3), UnitId(1)));
+            REQUIRE(!wideGrid.isCollisionAt(DiscreteRect(65, 0, 80, 3), UnitId(1)));
+            REQUIRE(wideGrid.isCollisionAt(DiscreteRect(65, 0, 80, 3), UnitId(2)));
+            REQUIRE(!wideGrid.isCollisionAt(DiscreteRect(0, 0, 63, 3), UnitId(1)));
+
+            wideGrid.setArea(GridRegion(63, 1, 2, 1), OccupiedNone());
+            REQUIRE(!wideGrid.isOccupied(63, 1));
+            REQUIRE(!wideGrid.isCollisionAt(DiscreteRect(0, 0, 150, 3), UnitId(1)));
+        }
+
+        SECTION("copies catch up with the rows that changed")
+        {
+            OccupiedGrid source(100, 40);
+            source.setArea(GridRegion(5, 5, 3, 3), OccupiedFeature(FeatureId(1)));
+            auto copy = source;
+
+            source.setArea(GridRegion(5, 5, 3, 3), OccupiedNone());
+            source.setArea(GridRegion(70, 30, 2, 4), OccupiedUnit(UnitId(3)));
+
+            // rows above a change have their clearance updated too
+            REQUIRE(source.rowVersions[30 - (OccupiedGrid::MaxClearance - 1)] == source.version);
+            REQUIRE(source.rowVersions[0] < source.version);
+
+            copy.updateFrom(source);
+            REQUIRE(copy.version == source.version);
+            REQUIRE(copy.rowVersions == source.rowVersions);
+            REQUIRE(copy.grid == source.grid);
+            REQUIRE(copy.occupiedBits == source.occupiedBits);
+            REQUIRE(copy.clearance == source.clearance);
+        }
+    }
+
+    TEST_CASE("OccupiedCell")
+    {
+        SECTION("is empty by default")
+        {
+            OccupiedCell cell;
+            REQUIRE(cell.isNone());
+            REQUIRE(!cell.isUnit());
+            REQUIRE(!cell.isFeature());
+            REQUIRE(cell == OccupiedCell(OccupiedNone()));
+        }
+
+        SECTION("keeps the kind and ID apart")
+        {
+            OccupiedCell unit(OccupiedUnit(UnitId(12345)));
+            OccupiedCell feature(OccupiedFeature(FeatureId(12345)));
+            REQUIRE(unit.isUnit());
+            REQUIRE(unit.unitId() == UnitId(12345));
+            REQUIRE(feature.isFeature());
+            REQUIRE(feature.featureId() == FeatureId(12345));
+            REQUIRE(unit != feature);
+        }
+    }
+}
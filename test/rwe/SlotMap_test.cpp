@@ -0,0 +1,222 @@
+#include <catch.hpp>
+#include <rwe/SlotMap.h>
+#include <rwe/UnitId.h>
+#include <string>
+
+namespace rwe
+{
+    TEST_CASE("SlotMap")
+    {
+        SECTION("starts empty")
+        {
+            SlotMap<std::string, UnitId> m;
+            REQUIRE(m.empty());
+            REQUIRE(m.size() == 0);
+            REQUIRE(!m.contains(UnitId(0)));
+        }
+
+        SECTION("retrieves inserted values by ID")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            auto b = m.insert("b");
+
+            REQUIRE(a != b);
+            REQUIRE(m.size() == 2);
+            REQUIRE(m.get(a) == "a");
+            REQUIRE(m.get(b) == "b");
+        }
+
+        SECTION("nextId predicts the ID returned by insert")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto predicted = m.nextId();
+            REQUIRE(m.insert("a") == predicted);
+
+            m.remove(predicted);
+            auto predictedAfterRemove = m.nextId();
+            REQUIRE(m.insert("b") == predictedAfterRemove);
+        }
+
+        SECTION("removed IDs are no longer valid")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            auto b = m.insert("b");
+
+            REQUIRE(m.remove(a));
+            REQUIRE(!m.contains(a));
+            REQUIRE(m.tryGet(a) == nullptr);
+            REQUIRE(!m.remove(a));
+
+            REQUIRE(m.contains(b));
+            REQUIRE(m.get(b) == "b");
+            REQUIRE(m.size() == 1);
+        }
+
+        SECTION("reused slots get a new generation")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            m.remove(a);
+            auto b = m.insert("b");
+
+            REQUIRE(a != b);
+            REQUIRE(!m.contains(a));
+            REQUIRE(m.get(b) == "b");
+        }
+
+        SECTION("iteration visits values densely")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            auto b = m.insert("b");
+            auto c = m.insert("c");
+
+            m.remove(a);
+
+            // c is moved into a's old position
+            REQUIRE(m.size() == 2);
+            REQUIRE(m.valueAt(0) == "c");
+            REQUIRE(m.idAt(0) == c);
+            REQUIRE(m.valueAt(1) == "b");
+            REQUIRE(m.idAt(1) == b);
+
+            std::string concatenated;
+            for (const auto& v : m)
+            {
+                concatenated += v;
+            }
+            REQUIRE(concatenated == "cb");
+        }
+
+        SECTION("removeIf removes matching values and keeps IDs of the rest")
+        {
+            SlotMap<int, UnitId> m;
+            std::vector<UnitId> ids;
+            for (int i = 0; i < 10; ++i)
+            {
+                ids.push_back(m.insert(int(i)));
+            }
+
+            m.removeIf([](UnitId, int v) { return v % 2 == 0; });
+
+            REQUIRE(m.size() == 5);
+            for (int i = 0; i < 10; ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    REQUIRE(!m.contains(ids[i]));
+                }
+                else
+                {
+                    REQUIRE(m.get(ids[i]) == i);
+                }
+            }
+        }
+
+        SECTION("indexOf and removeAt address values by dense position")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            auto b = m.insert("b");
+            auto c = m.insert("c");
+
+            REQUIRE(m.indexOf(b) == std::optional<std::size_t>(1));
+
+            m.removeAt(0);
+
+            REQUIRE(!m.contains(a));
+            REQUIRE(!m.indexOf(a));
+            REQUIRE(m.indexOf(c) == std::optional<std::size_t>(0));
+            REQUIRE(m.indexOf(b) == std::optional<std::size_t>(1));
+        }
+
+        SECTION("restore reproduces IDs, order and future IDs")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto a = m.insert("a");
+            auto b = m.insert("b");
+            auto c = m.insert("c");
+            m.remove(a);
+
+            std::vector<UnitId> ids;
+            std::vector<std::string> values;
+            for (std::size_t i = 0; i < m.size(); ++i)
+            {
+                ids.push_back(m.idAt(i));
+                values.push_back(m.valueAt(i));
+            }
+
+            SlotMap<std::string, UnitId> restored;
+            restored.insert("x");
+            restored.restore(m.getSlotGenerations(), m.getFreeSlots(), ids, std::move(values));
+
+            REQUIRE(restored.size() == 2);
+            REQUIRE(!restored.contains(a));
+            REQUIRE(restored.get(b) == "b");
+            REQUIRE(restored.get(c) == "c");
+            REQUIRE(restored.idAt(0) == c);
+            REQUIRE(restored.nextId() == m.nextId());
+            REQUIRE(restored.insert("d") == m.insert("d"));
+        }
+
+        SECTION("restore rejects inconsistent state")
+        {
+            SlotMap<std::string, UnitId> m;
+
+            // slot 0 is both occupied and free
+            REQUIRE_THROWS(m.restore({0}, {0}, {UnitId(0)}, {"a"}));
+
+            // generation does not match the ID
+            REQUIRE_THROWS(m.restore({1}, {}, {UnitId(0)}, {"a"}));
+
+            // slot 1 is neither occupied nor free
+            REQUIRE_THROWS(m.restore({0, 0}, {}, {UnitId(0)}, {"a"}));
+        }
+
+        SECTION("retires a slot instead of wrapping its generation")
+        {
+            SlotMap<int, UnitId> m;
+            auto first = m.insert(0);
+            auto id = first;
+            for (std::uint32_t i = 0; i < SlotMap<int, UnitId>::MaxSize; ++i)
+            {
+                m.remove(id);
+                id = m.insert(1);
+                REQUIRE(id != first);
+            }
+
+            REQUIRE(!m.contains(first));
+            REQUIRE(m.size() == 1);
+        }
+
+        SECTION("restore accepts retired slots")
+        {
+            SlotMap<std::string, UnitId> m;
+            auto maxGeneration = (std::uint32_t(1) << SlotMap<std::string, UnitId>::GenerationBits) - 1;
+
+            // slot 0 is retired, slot 1 is occupied
+            m.restore({maxGeneration, 0}, {}, {UnitId(1)}, {"a"});
+            REQUIRE(m.get(UnitId(1)) == "a");
+            REQUIRE(m.nextId() == UnitId(2));
+        }
+
+        SECTION("clear invalidates all IDs")
+        {
+            SlotMap<int, UnitId> m;
+            auto a = m.insert(1);
+            auto b = m.insert(2);
+            m.clear();
+
+            REQUIRE(m.empty());
+            REQUIRE(!m.contains(a));
+            REQUIRE(!m.contains(b));
+
+            auto c = m.insert(3);
+            REQUIRE(c != a);
+            REQUIRE(c != b);
+            REQUIRE(m.get(c) == 3);
+        }
+    }
+}
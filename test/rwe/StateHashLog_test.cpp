@@ -0,0 +1,129 @@
+#include <catch.hpp>
+#include <rwe/StateHashLog.h>
+#include <rwe/StateHasher.h>
+#include <sstream>
+
+namespace rwe
+{
+    TEST_CASE("StateHasher")
+    {
+        SECTION("is deterministic")
+        {
+            StateHasher a(1);
+            a.add(42);
+            a.addFloat(1.5f);
+
+            StateHasher b(1);
+            b.add(42);
+            b.addFloat(1.5f);
+
+            REQUIRE(a.get() == b.get());
+        }
+
+        SECTION("depends on the seed")
+        {
+            StateHasher a(1);
+            a.add(42);
+
+            StateHasher b(2);
+            b.add(42);
+
+            REQUIRE(a.get() != b.get());
+        }
+
+        SECTION("depends on order")
+        {
+            StateHasher a;
+            a.add(1);
+            a.add(2);
+
+            StateHasher b;
+            b.add(2);
+            b.add(1);
+
+            REQUIRE(a.get() != b.get());
+        }
+
+        SECTION("distinguishes float bit patterns")
+        {
+            StateHasher a;
+            a.addFloat(0.0f);
+
+            StateHasher b;
+            b.addFloat(-0.0f);
+
+            REQUIRE(a.get() != b.get());
+        }
+    }
+
+    TEST_CASE("StateHashLog")
+    {
+        SECTION("finds recorded hashes by tick")
+        {
+            StateHashLog log;
+            log.record(GameTime(1), 10);
+            log.record(GameTime(2), 20);
+            log.record(GameTime(4), 40);
+
+            REQUIRE(log.find(GameTime(2)) == std::optional<std::uint64_t>(20));
+            REQUIRE(log.find(GameTime(4)) == std::optional<std::uint64_t>(40));
+            REQUIRE(!log.find(GameTime(3)));
+            REQUIRE(!log.find(GameTime(5)));
+        }
+
+        SECTION("findFirstDivergence")
+        {
+            StateHashLog a;
+            a.record(GameTime(1), 10);
+            a.record(GameTime(2), 20);
+            a.record(GameTime(3), 30);
+            a.record(GameTime(4), 40);
+
+            SECTION("returns nothing for matching logs")
+            {
+                StateHashLog b = a;
+                REQUIRE(!StateHashLog::findFirstDivergence(a, b));
+            }
+
+            SECTION("returns the earliest differing tick")
+            {
+                StateHashLog b;
+                b.record(GameTime(1), 10);
+                b.record(GameTime(2), 20);
+                b.record(GameTime(3), 31);
+                b.record(GameTime(4), 41);
+                REQUIRE(StateHashLog::findFirstDivergence(a, b) == std::optional<GameTime>(GameTime(3)));
+            }
+
+            SECTION("only compares ticks present in both logs")
+            {
+                StateHashLog b;
+                b.record(GameTime(2), 20);
+                b.record(GameTime(4), 40);
+                b.record(GameTime(5), 50);
+                REQUIRE(!StateHashLog::findFirstDivergence(a, b));
+                REQUIRE(!StateHashLog::findFirstDivergence(b, a));
+            }
+        }
+
+        SECTION("round-trips through text")
+        {
+            StateHashLog log;
+            log.record(GameTime(1), 0x0123456789abcdefull);
+            log.record(GameTime(2), 0xffffffffffffffffull);
+            log.record(GameTime(10), 0);
+
+            std::stringstream stream;
+            log.write(stream);
+
+            auto readLog = StateHashLog::read(stream);
+            REQUIRE(readLog.getEntries() == log.getEntries());
+        }
+
+        SECTION("rejects malformed text")
+        {
+            std::stringstream stream("1 abc\n2 zzz\n");
+            REQUIRE_THROWS(StateHashLog::read(stream));
+        }
+    }
+}
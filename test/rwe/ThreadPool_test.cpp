@@ -0,0 +1,70 @@
+#include <atomic>
+#include <catch.hpp>
+#include <rwe/ThreadPool.h>
+#include <stdexcept>
+#include <vector>
+
+namespace rwe
+{
+    TEST_CASE("ThreadPool")
+    {
+        SECTION("parallelFor calls the function once for every index")
+        {
+            for (unsigned int workers : {0u, 1u, 3u})
+            {
+                ThreadPool pool(workers);
+                std::vector<std::atomic<int>> calls(1000);
+                pool.parallelFor(calls.size(), [&calls](std::size_t i) { ++calls[i]; }, 7);
+
+                for (const auto& c : calls)
+                {
+                    REQUIRE(c == 1);
+                }
+            }
+        }
+
+        SECTION("parallelFor with no work returns immediately")
+        {
+            ThreadPool pool(2);
+            bool called = false;
+            pool.parallelFor(0, [&called](std::size_t) { called = true; });
+            REQUIRE(!called);
+        }
+
+        SECTION("exceptions are rethrown on the calling thread")
+        {
+            ThreadPool pool(2);
+            REQUIRE_THROWS_WITH(
+                pool.parallelFor(100, [](std::size_t i) {
+                    if (i == 42)
+                    {
+                        throw std::runtime_error("boom");
+                    }
+                }, 1),
+                "boom");
+
+            // the pool is still usable afterwards
+            std::atomic<int> total{0};
+            pool.parallelFor(10, [&total](std::size_t) { ++total; }, 1);
+            REQUIRE(total == 10);
+        }
+
+        SECTION("submit runs the task and returns its result")
+        {
+            for (unsigned int workers : {0u, 2u})
+            {
+                ThreadPool pool(workers);
+                auto a = pool.submit([]() { return 20; });
+                auto b = pool.submit([]() { return 22; });
+                REQUIRE(a.get() + b.get() == 42);
+            }
+        }
+
+        SECTION("submit passes exceptions through the future")
+        {
+            ThreadPool pool(1);
+            auto f = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+            REQUIRE_THROWS_WITH(f.get(), "boom");
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <catch.hpp>
+#include <rwe/UnitKinematics.h>
+#include <rwe/util.h>
+
+namespace rwe
+{
+    TEST_CASE("UnitKinematicsStore")
+    {
+        UnitMovementAttributes attributes;
+        attributes.turnRate = 0.1f;
+        attributes.maxSpeed = 2.0f;
+        attributes.acceleration = 0.5f;
+        attributes.brakeRate = 0.25f;
+
+        SECTION("new units are stationary and face their initial rotation")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(1.0f, attributes);
+
+            REQUIRE(k.size() == 1);
+            REQUIRE(k.rotation[0] == 1.0f);
+            REQUIRE(k.targetAngle[0] == 1.0f);
+            REQUIRE(k.currentSpeed[0] == 0.0f);
+            REQUIRE(k.speedLimit[0] == 2.0f);
+
+            k.update();
+            REQUIRE(k.rotation[0] == 1.0f);
+            REQUIRE(k.currentSpeed[0] == 0.0f);
+        }
+
+        SECTION("turns by at most turnRate per update")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(0.0f, attributes);
+            k.targetAngle[0] = 0.25f;
+
+            k.update();
+            REQUIRE(k.rotation[0] == Approx(0.1f));
+            k.update();
+            REQUIRE(k.rotation[0] == Approx(0.2f));
+            k.update();
+            REQUIRE(k.rotation[0] == 0.25f);
+        }
+
+        SECTION("turns the short way across the -pi/pi boundary")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(Pif - 0.05f, attributes);
+            k.targetAngle[0] = -Pif + 0.5f;
+
+            k.update();
+            REQUIRE(k.rotation[0] == Approx(-Pif + 0.05f));
+        }
+
+        SECTION("accelerates and brakes towards the target speed")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(0.0f, attributes);
+            k.targetSpeed[0] = 1.2f;
+
+            k.update();
+            REQUIRE(k.currentSpeed[0] == 0.5f);
+            REQUIRE(k.previousSpeed[0] == 0.0f);
+            k.update();
+            REQUIRE(k.currentSpeed[0] == 1.0f);
+            k.update();
+            REQUIRE(k.currentSpeed[0] == 1.2f);
+
+            k.targetSpeed[0] = 0.0f;
+            k.update();
+            REQUIRE(k.currentSpeed[0] == Approx(0.95f));
+            REQUIRE(k.previousSpeed[0] == 1.2f);
+        }
+
+        SECTION("speed is clamped to the speed limit")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(0.0f, attributes);
+            k.currentSpeed[0] = 2.0f;
+            k.targetSpeed[0] = 2.0f;
+            k.speedLimit[0] = 1.0f;
+
+            k.update();
+            REQUIRE(k.currentSpeed[0] == 1.0f);
+        }
+
+        SECTION("swapRemove moves the last unit into the hole")
+        {
+            UnitKinematicsStore k;
+            k.pushBack(1.0f, attributes);
+            k.pushBack(2.0f, attributes);
+            k.pushBack(3.0f, attributes);
+
+            k.swapRemove(0);
+
+            REQUIRE(k.size() == 2);
+            REQUIRE(k.rotation[0] == 3.0f);
+            REQUIRE(k.rotation[1] == 2.0f);
+            REQUIRE(k.turnRate.size() == 2);
+            REQUIRE(k.brakeRate.size() == 2);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include <catch.hpp>
+#include <rwe/UnitMesh.h>
+
+namespace rwe
+{
+    UnitMesh makePiece(const std::string& name, std::vector<UnitMesh>&& children = {})
+    {
+        UnitMesh mesh;
+        mesh.name = name;
+        mesh.children = std::move(children);
+        return mesh;
+    }
+
+    TEST_CASE("UnitMesh::findPath")
+    {
+        auto mesh = makePiece("base", {makePiece("turret", {makePiece("barrel")}), makePiece("flare")});
+
+        SECTION("the root piece has an empty path")
+        {
+            auto path = mesh.findPath("base");
+            REQUIRE(path);
+            REQUIRE(path->empty());
+            REQUIRE(&mesh.getPiece(*path) == &mesh);
+        }
+
+        SECTION("finds the child index at each level")
+        {
+            auto path = mesh.findPath("barrel");
+            REQUIRE(path);
+            REQUIRE(*path == (UnitMesh::PiecePath{0, 0}));
+            REQUIRE(mesh.getPiece(*path).name == "barrel");
+
+            auto flarePath = mesh.findPath("flare");
+            REQUIRE(flarePath);
+            REQUIRE(*flarePath == (UnitMesh::PiecePath{1}));
+            REQUIRE(mesh.getPiece(*flarePath).name == "flare");
+        }
+
+        SECTION("returns nothing for a missing piece")
+        {
+            REQUIRE(!mesh.findPath("wheel"));
+        }
+
+        SECTION("paths still lead to the same piece in a copy")
+        {
+            auto path = mesh.findPath("barrel");
+            auto copy = mesh;
+            copy.getPiece(*path).visible = false;
+            REQUIRE(!copy.find("barrel")->get().visible);
+            REQUIRE(mesh.find("barrel")->get().visible);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <catch.hpp>
+#include <rwe/UnitSpatialIndex.h>
+
+namespace rwe
+{
+    TEST_CASE("UnitSpatialIndex")
+    {
+        // 64x64 cells, in 8x8 buckets of 8x8 cells, no margin
+        UnitSpatialIndex index(64, 64, 8, 0);
+
+        SECTION("rect queries find units in touched buckets")
+        {
+            index.insert(UnitId(1), DiscreteRect(2, 2, 2, 2));
+            index.insert(UnitId(2), DiscreteRect(30, 30, 2, 2));
+
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 4, 4)) == std::vector<UnitId>({UnitId(1)}));
+            REQUIRE(index.queryRect(DiscreteRect(24, 24, 8, 8)) == std::vector<UnitId>({UnitId(2)}));
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 64, 64)) == std::vector<UnitId>({UnitId(1), UnitId(2)}));
+            REQUIRE(index.queryRect(DiscreteRect(40, 40, 4, 4)).empty());
+        }
+
+        SECTION("units spanning buckets are reported once")
+        {
+            index.insert(UnitId(1), DiscreteRect(6, 6, 4, 4));
+
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 16, 16)) == std::vector<UnitId>({UnitId(1)}));
+            REQUIRE(index.queryRect(DiscreteRect(8, 8, 1, 1)) == std::vector<UnitId>({UnitId(1)}));
+        }
+
+        SECTION("moved units are found at their new location only")
+        {
+            index.insert(UnitId(1), DiscreteRect(2, 2, 2, 2));
+            index.move(UnitId(1), DiscreteRect(2, 2, 2, 2), DiscreteRect(50, 2, 2, 2));
+
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 8, 8)).empty());
+            REQUIRE(index.queryRect(DiscreteRect(48, 0, 8, 8)) == std::vector<UnitId>({UnitId(1)}));
+        }
+
+        SECTION("removed units are no longer found")
+        {
+            index.insert(UnitId(1), DiscreteRect(2, 2, 2, 2));
+            index.insert(UnitId(2), DiscreteRect(3, 3, 2, 2));
+            index.remove(UnitId(1), DiscreteRect(2, 2, 2, 2));
+
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 8, 8)) == std::vector<UnitId>({UnitId(2)}));
+        }
+
+        SECTION("units partly off the map are clamped")
+        {
+            index.insert(UnitId(1), DiscreteRect(-1, 62, 3, 4));
+            REQUIRE(index.queryRect(DiscreteRect(0, 56, 8, 8)) == std::vector<UnitId>({UnitId(1)}));
+            index.remove(UnitId(1), DiscreteRect(-1, 62, 3, 4));
+            REQUIRE(index.queryRect(DiscreteRect(0, 0, 64, 64)).empty());
+        }
+
+        SECTION("circle queries cover the circle's bounding square")
+        {
+            index.insert(UnitId(1), DiscreteRect(20, 20, 1, 1));
+            index.insert(UnitId(2), DiscreteRect(40, 20, 1, 1));
+
+            REQUIRE(index.queryCircle(Vector2f(20.0f, 20.0f), 4.0f) == std::vector<UnitId>({UnitId(1)}));
+            REQUIRE(index.queryCircle(Vector2f(30.0f, 20.0f), 10.0f) == std::vector<UnitId>({UnitId(1), UnitId(2)}));
+        }
+
+        SECTION("ray queries find units along the ray's path")
+        {
+            index.insert(UnitId(1), DiscreteRect(4, 4, 1, 1));
+            index.insert(UnitId(2), DiscreteRect(60, 60, 1, 1));
+            index.insert(UnitId(3), DiscreteRect(4, 60, 1, 1));
+
+            // diagonal across the map
+            REQUIRE(index.queryRay(Vector2f(0.5f, 0.5f), Vector2f(1.0f, 1.0f)) == std::vector<UnitId>({UnitId(1), UnitId(2)}));
+
+            // from off the map, heading down the left edge
+            REQUIRE(index.queryRay(Vector2f(4.0f, -100.0f), Vector2f(0.0f, 1.0f)) == std::vector<UnitId>({UnitId(1), UnitId(3)}));
+
+            // pointing away from the map
+            REQUIRE(index.queryRay(Vector2f(4.0f, -100.0f), Vector2f(0.0f, -1.0f)).empty());
+
+            // straight down
+            REQUIRE(index.queryRay(Vector2f(60.0f, 60.0f), Vector2f(0.0f, 0.0f)) == std::vector<UnitId>({UnitId(2)}));
+        }
+
+        SECTION("margin records units in neighbouring buckets")
+        {
+            UnitSpatialIndex marginIndex(64, 64, 8, 2);
+            marginIndex.insert(UnitId(1), DiscreteRect(7, 7, 1, 1));
+            REQUIRE(marginIndex.queryRect(DiscreteRect(8, 8, 1, 1)) == std::vector<UnitId>({UnitId(1)}));
+        }
+    }
+}
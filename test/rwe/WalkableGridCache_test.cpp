@@ -0,0 +1,65 @@
+#include <catch.hpp>
+#include <rwe/WalkableGridCache.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace rwe
+{
+    TEST_CASE("WalkableGridCache")
+    {
+        Grid<unsigned char> heights(4, 3, 50);
+        heights.set(1, 1, 20);
+        std::vector<MovementClass> classes{
+            MovementClass{"TANK2", 2, 2, 0, 15, 12, 255},
+            MovementClass{"BOAT3", 3, 3, 15, 255, 255, 255},
+        };
+        auto key = computeWalkableGridCacheKey(heights, 30, classes);
+
+        std::vector<Grid<char>> grids{Grid<char>(4, 3, true), Grid<char>(4, 3, false)};
+        grids[0].set(2, 1, false);
+
+        SECTION("reads back what was written")
+        {
+            std::stringstream stream;
+            writeWalkableGridCache(stream, key, grids);
+
+            auto result = readWalkableGridCache(stream, key);
+            REQUIRE(!!result);
+            REQUIRE(*result == grids);
+        }
+
+        SECTION("ignores a cache written for other inputs")
+        {
+            std::stringstream stream;
+            writeWalkableGridCache(stream, key, grids);
+
+            REQUIRE(!readWalkableGridCache(stream, key + 1));
+        }
+
+        SECTION("rejects a truncated cache")
+        {
+            std::stringstream stream;
+            writeWalkableGridCache(stream, key, grids);
+            auto bytes = stream.str();
+
+            std::stringstream truncated(bytes.substr(0, bytes.size() - 3));
+            REQUIRE_THROWS(readWalkableGridCache(truncated, key));
+        }
+
+        SECTION("key changes with the terrain")
+        {
+            auto otherHeights = heights;
+            otherHeights.set(3, 2, 51);
+            REQUIRE(computeWalkableGridCacheKey(otherHeights, 30, classes) != key);
+            REQUIRE(computeWalkableGridCacheKey(heights, 31, classes) != key);
+        }
+
+        SECTION("key changes with the movement classes")
+        {
+            auto otherClasses = classes;
+            otherClasses[1].maxSlope = 254;
+            REQUIRE(computeWalkableGridCacheKey(heights, 30, otherClasses) != key);
+            REQUIRE(computeWalkableGridCacheKey(heights, 30, {classes[0]}) != key);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include <catch.hpp>
+#include <rwe/Cob.h>
+#include <rwe/cob/CobOpCode.h>
+#include <rwe/cob/CobProgram.h>
+
+namespace rwe
+{
+    static std::uint32_t op(OpCode opCode)
+    {
+        return static_cast<std::uint32_t>(opCode);
+    }
+
+    static CobScript makeScript(std::vector<std::uint32_t> instructions)
+    {
+        CobScript script;
+        script.instructions = std::move(instructions);
+        script.pieces = {"base", "turret"};
+        script.functions = {CobFunctionInfo{"Create", 0}, CobFunctionInfo{"Helper", 5}};
+        script.staticVariableCount = 2;
+        return script;
+    }
+
+    TEST_CASE("decodeCobProgram")
+    {
+        SECTION("inlines operands and resolves jumps and calls to instructions")
+        {
+            auto script = makeScript({
+                op(OpCode::PUSH_CONSTANT), 7,
+                op(OpCode::CALL_SCRIPT), 1, 1,
+                op(OpCode::MOVE), 1, 2,
+                op(OpCode::JUMP), 5,
+            });
+            auto program = decodeCobProgram(script);
+
+            REQUIRE(program.instructions.size() == 5);
+
+            REQUIRE(program.instructions[0].op == CobOp::PushConstant);
+            REQUIRE(program.instructions[0].operand == 7);
+
+            REQUIRE(program.instructions[1].op == CobOp::CallScript);
+            REQUIRE(program.instructions[1].address == 2);
+            REQUIRE(program.instructions[1].operand == 2);
+            REQUIRE(program.instructions[1].paramCount == 1);
+
+            REQUIRE(program.instructions[2].op == CobOp::Move);
+            REQUIRE(program.instructions[2].address == 5);
+            REQUIRE(program.instructions[2].operand == 1);
+            REQUIRE(program.instructions[2].axis == Axis::Z);
+
+            REQUIRE(program.instructions[3].op == CobOp::Jump);
+            REQUIRE(program.instructions[3].operand == 2);
+
+            // execution falls through into the trap at the end
+            REQUIRE(program.instructions[4].op == CobOp::Invalid);
+            REQUIRE(program.instructions[4].address == 10);
+        }
+
+        SECTION("maps addresses to the instructions starting there")
+        {
+            auto script = makeScript({op(OpCode::PUSH_CONSTANT), 7, op(OpCode::ADD)});
+            auto program = decodeCobProgram(script);
+
+            REQUIRE(program.getIndex(0) == 0);
+            REQUIRE(program.getIndex(2) == 1);
+
+            // the middle of an instruction, the end of the code and beyond go to the trap
+            REQUIRE(program.getIndex(1) == 2);
+            REQUIRE(program.getIndex(3) == 2);
+            REQUIRE(program.getIndex(100) == 2);
+        }
+
+        SECTION("jumps into the middle of an instruction go to the trap")
+        {
+            auto script = makeScript({op(OpCode::PUSH_CONSTANT), 7, op(OpCode::JUMP), 1});
+            auto program = decodeCobProgram(script);
+
+            REQUIRE(program.instructions[1].operand == 2);
+            REQUIRE(program.instructions[2].op == CobOp::Invalid);
+        }
+
+        SECTION("decodes malformed instructions to invalid ones")
+        {
+            auto script = makeScript({
+                0x12345678,
+                op(OpCode::SHOW), 2,
+                op(OpCode::TURN), 0, 3,
+                op(OpCode::PUSH_STATIC), 2,
+                op(OpCode::RETURN),
+            });
+            auto program = decodeCobProgram(script);
+
+            REQUIRE(program.instructions.size() == 6);
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                REQUIRE(program.instructions[i].op == CobOp::Invalid);
+            }
+            REQUIRE(program.errors[program.instructions[0].operand] == "Unsupported opcode 305419896");
+            REQUIRE(program.errors[program.instructions[2].operand] == "Invalid axis: 3");
+
+            // decoding carries on after them
+            REQUIRE(program.instructions[4].op == CobOp::Return);
+            REQUIRE(program.instructions[4].address == 8);
+        }
+
+        SECTION("stops at an instruction cut off by the end of the code")
+        {
+            auto script = makeScript({op(OpCode::ADD), op(OpCode::MOVE), 0});
+            auto program = decodeCobProgram(script);
+
+            REQUIRE(program.instructions.size() == 3);
+            REQUIRE(program.instructions[0].op == CobOp::Add);
+            REQUIRE(program.instructions[1].op == CobOp::Invalid);
+            REQUIRE(program.instructions[2].op == CobOp::Invalid);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include <cstdlib>
+#include <rwe/pathfinding/AStarPathFinder.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /** Four-way movement over a map of strings, where '#' is a wall. */
+    class TestGridPathFinder : public AStarPathFinder<Point, unsigned int>
+    {
+    private:
+        std::vector<std::string> map;
+        Point goal;
+
+    public:
+        TestGridPathFinder(AStarNodeGrid<unsigned int>* nodes, const std::vector<std::string>& map, const Point& goal)
+            : AStarPathFinder(nodes, map[0].size(), map.size()), map(map), goal(goal)
+        {
+        }
+
+    protected:
+        bool isGoal(const Point& vertex) override
+        {
+            return vertex == goal;
+        }
+
+        unsigned int estimateCostToGoal(const Point& vertex) override
+        {
+            return std::abs(vertex.x - goal.x) + std::abs(vertex.y - goal.y);
+        }
+
+        unsigned int getSuccessors(const VertexInfo& vertex, SuccessorBuffer& successors) override
+        {
+            unsigned int count = 0;
+            for (const auto& offset : {Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1)})
+            {
+                auto p = vertex.vertex + offset;
+                if (p.y >= 0 && p.y < static_cast<int>(map.size()) && p.x >= 0 && p.x < static_cast<int>(map[0].size()) && map[p.y][p.x] != '#')
+                {
+                    successors[count++] = Successor{vertex.costToReach + 1, p};
+                }
+            }
+            return count;
+        }
+    };
+
+    TEST_CASE("AStarPathFinder over a grid")
+    {
+        std::vector<std::string> map{
+            ".....",
+            ".###.",
+            "...#.",
+            "##.#.",
+            ".....",
+        };
+
+        AStarNodeGrid<unsigned int> nodes;
+
+        SECTION("finds a shortest path around walls")
+        {
+            TestGridPathFinder finder(&nodes, map, Point(0, 2));
+            auto result = finder.findPath(Point(4, 4));
+
+            REQUIRE(result.type == AStarPathType::Complete);
+            REQUIRE(result.path.front() == Point(4, 4));
+            REQUIRE(result.path.back() == Point(0, 2));
+            REQUIRE(result.path.size() == 7);
+            for (std::size_t i = 1; i < result.path.size(); ++i)
+            {
+                auto d = result.path[i] - result.path[i - 1];
+                REQUIRE(std::abs(d.x) + std::abs(d.y) == 1);
+            }
+        }
+
+        SECTION("returns a partial path to the closest cell when the goal is walled off")
+        {
+            std::vector<std::string> closedMap{
+                ".....",
+                ".###.",
+                ".#.#.",
+                ".###.",
+                ".....",
+            };
+            TestGridPathFinder finder(&nodes, closedMap, Point(2, 2));
+            auto result = finder.findPath(Point(0, 0));
+
+            REQUIRE(result.type == AStarPathType::Partial);
+            REQUIRE(result.path.front() == Point(0, 0));
+            auto last = result.path.back();
+            REQUIRE(std::abs(last.x - 2) + std::abs(last.y - 2) == 2);
+        }
+
+        SECTION("gives the same answer when the node grid is reused")
+        {
+            TestGridPathFinder finder(&nodes, map, Point(0, 2));
+            auto first = finder.findPath(Point(4, 4));
+
+            TestGridPathFinder other(&nodes, map, Point(4, 0));
+            other.findPath(Point(0, 4));
+
+            auto second = finder.findPath(Point(4, 4));
+            REQUIRE(first.path == second.path);
+            REQUIRE(first.closedEdges == second.closedEdges);
+        }
+
+        SECTION("does not leave the grid from an outside start")
+        {
+            TestGridPathFinder finder(&nodes, map, Point(0, 0));
+            auto result = finder.findPath(Point(-1, 0));
+            REQUIRE(result.type == AStarPathType::Partial);
+            REQUIRE(result.path == std::vector<Point>{Point(-1, 0)});
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <catch.hpp>
+#include <cstdlib>
+#include <rwe/pathfinding/ClusterGraph.h>
+
+namespace rwe
+{
+    /**
+     * Makes an open grid with a wall down column wallX, leaving a gap at gapY.
+     * With wallX on a cluster border, the gap is the only entrance across it.
+     */
+    static Grid<char> makeWalledGrid(std::size_t width, std::size_t height, std::size_t wallX, std::size_t gapY)
+    {
+        Grid<char> grid(width, height, true);
+        for (std::size_t y = 0; y < height; ++y)
+        {
+            if (y != gapY)
+            {
+                grid.set(wallX, y, false);
+            }
+        }
+        return grid;
+    }
+
+    TEST_CASE("ClusterGraph")
+    {
+        SECTION("finds a route across an open grid")
+        {
+            ClusterGraph graph(Grid<char>(50, 40, true));
+            auto route = graph.findRoute(Point(1, 1), Point(48, 38));
+
+            REQUIRE(!!route);
+            REQUIRE(route->front() == Point(1, 1));
+            REQUIRE(route->back() == Point(48, 38));
+            for (std::size_t i = 1; i < route->size(); ++i)
+            {
+                auto d = (*route)[i] - (*route)[i - 1];
+                REQUIRE(std::abs(d.x) < static_cast<int>(ClusterGraph::ClusterSize));
+                REQUIRE(std::abs(d.y) < static_cast<int>(ClusterGraph::ClusterSize));
+            }
+        }
+
+        SECTION("routes through the only gap in a wall")
+        {
+            ClusterGraph graph(makeWalledGrid(48, 32, 16, 30));
+            auto route = graph.findRoute(Point(2, 2), Point(45, 2));
+
+            REQUIRE(!!route);
+            REQUIRE(std::find(route->begin(), route->end(), Point(16, 30)) != route->end());
+        }
+
+        SECTION("finds no route when the goal is walled off")
+        {
+            auto grid = makeWalledGrid(48, 32, 16, 30);
+            grid.set(16, 30, false);
+            ClusterGraph graph(std::move(grid));
+
+            REQUIRE(!graph.findRoute(Point(2, 2), Point(45, 2)));
+        }
+
+        SECTION("finds no route from an impassable cell")
+        {
+            ClusterGraph graph(makeWalledGrid(48, 32, 16, 30));
+
+            REQUIRE(!graph.findRoute(Point(16, 2), Point(45, 2)));
+        }
+
+        SECTION("follows changes to the grid")
+        {
+            ClusterGraph graph(makeWalledGrid(48, 32, 16, 30));
+
+            graph.replaceArea(16, 30, Grid<char>(1, 1, false));
+            REQUIRE(!graph.findRoute(Point(2, 2), Point(45, 2)));
+
+            graph.replaceArea(16, 3, Grid<char>(1, 2, true));
+            auto route = graph.findRoute(Point(2, 2), Point(45, 2));
+            REQUIRE(!!route);
+            for (const auto& p : *route)
+            {
+                REQUIRE(p.y < 16);
+            }
+        }
+    }
+
+    TEST_CASE("computeStaticPassableArea")
+    {
+        Grid<char> walkable(10, 10, true);
+        walkable.set(1, 1, false);
+
+        OccupiedGrid occupied(10, 10);
+        occupied.setArea(GridRegion(5, 5, 1, 1), OccupiedFeature(FeatureId(0)));
+        occupied.setArea(GridRegion(2, 2, 1, 1), OccupiedUnit(UnitId(0)));
+
+        auto area = computeStaticPassableArea(walkable, occupied, 2, 2, GridRegion(0, 0, 10, 10));
+
+        SECTION("blocks cells whose footprint covers a feature")
+        {
+            REQUIRE(!area.get(4, 4));
+            REQUIRE(!area.get(5, 4));
+            REQUIRE(!area.get(4, 5));
+            REQUIRE(!area.get(5, 5));
+            REQUIRE(area.get(3, 3));
+            REQUIRE(area.get(6, 6));
+        }
+
+        SECTION("ignores units")
+        {
+            REQUIRE(area.get(2, 2));
+        }
+
+        SECTION("blocks unwalkable cells")
+        {
+            REQUIRE(!area.get(1, 1));
+        }
+
+        SECTION("blocks cells whose footprint leaves the grid")
+        {
+            REQUIRE(area.get(8, 8));
+            REQUIRE(!area.get(9, 8));
+            REQUIRE(!area.get(8, 9));
+        }
+
+        SECTION("covers only the given region")
+        {
+            auto part = computeStaticPassableArea(walkable, occupied, 2, 2, GridRegion(4, 4, 3, 2));
+            REQUIRE(part.getWidth() == 3);
+            REQUIRE(part.getHeight() == 2);
+            REQUIRE(!part.get(0, 0));
+            REQUIRE(part.get(2, 0));
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+#include <cstdlib>
+#include <rwe/pathfinding/FlowField.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    static std::function<bool(const Point&)> walkableIn(const std::vector<std::string>& map)
+    {
+        return [map](const Point& p) { return map[p.y][p.x] != '#'; };
+    }
+
+    static bool isNotRough(const Point&)
+    {
+        return false;
+    }
+
+    TEST_CASE("FlowField")
+    {
+        std::vector<std::string> map{
+            "......",
+            ".####.",
+            "....#.",
+            "###.#.",
+            "......",
+        };
+
+        SECTION("leads each target to the goal")
+        {
+            FlowField field(6, 5, {Point(0, 2)}, {Point(5, 4), Point(0, 0)}, walkableIn(map), isNotRough);
+
+            for (const auto& start : {Point(5, 4), Point(0, 0)})
+            {
+                auto path = field.tracePath(start);
+                REQUIRE(!!path);
+                REQUIRE(path->front() == start);
+                REQUIRE(path->back() == Point(0, 2));
+                for (std::size_t i = 1; i < path->size(); ++i)
+                {
+                    auto d = (*path)[i] - (*path)[i - 1];
+                    REQUIRE(std::abs(d.x) <= 1);
+                    REQUIRE(std::abs(d.y) <= 1);
+                    REQUIRE(map[(*path)[i].y][(*path)[i].x] != '#');
+                }
+            }
+        }
+
+        SECTION("takes the shortest way")
+        {
+            FlowField field(6, 5, {Point(0, 2)}, {Point(0, 0)}, walkableIn(map), isNotRough);
+            auto path = field.tracePath(Point(0, 0));
+            REQUIRE(!!path);
+            REQUIRE(path->size() == 3);
+        }
+
+        SECTION("stops once every target is reached")
+        {
+            FlowField field(6, 5, {Point(0, 2)}, {Point(0, 0)}, walkableIn(map), isNotRough);
+            REQUIRE(field.isReached(Point(1, 0)));
+            REQUIRE(!field.isReached(Point(5, 4)));
+        }
+
+        SECTION("does not reach walled off cells")
+        {
+            std::vector<std::string> closedMap{
+                "......",
+                ".###..",
+                ".#.#..",
+                ".###..",
+                "......",
+            };
+            FlowField field(6, 5, {Point(0, 0)}, {Point(2, 2)}, walkableIn(closedMap), isNotRough);
+            REQUIRE(!field.tracePath(Point(2, 2)));
+            REQUIRE(field.isReached(Point(5, 4)));
+        }
+
+        SECTION("avoids rough terrain when it can")
+        {
+            std::vector<std::string> openMap{
+                ".....",
+                ".....",
+                ".....",
+            };
+            auto isRough = [](const Point& p) { return p.y == 1 && p.x > 0 && p.x < 4; };
+            FlowField field(5, 3, {Point(4, 1)}, {Point(0, 1)}, walkableIn(openMap), isRough);
+            auto path = field.tracePath(Point(0, 1));
+            REQUIRE(!!path);
+            for (const auto& p : *path)
+            {
+                REQUIRE(!isRough(p));
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#include <catch.hpp>
+#include <rwe/pathfinding/PathCache.h>
+
+namespace rwe
+{
+    static PathCacheKey makeKey(int goalX, unsigned int epoch = 0)
+    {
+        return PathCacheKey{MovementClassId(1), 2, 2, Point(0, 0), true, DiscreteRect(goalX, 10, 4, 4), epoch};
+    }
+
+    TEST_CASE("PathCache")
+    {
+        PathCache cache;
+
+        SECTION("finds nothing until a route is inserted")
+        {
+            REQUIRE(!cache.find(makeKey(1)));
+
+            cache.insert(makeKey(1), std::vector<Point>{Point(1, 1), Point(5, 5)});
+
+            auto route = cache.find(makeKey(1));
+            REQUIRE(route);
+            REQUIRE((*route == std::vector<Point>{Point(1, 1), Point(5, 5)}));
+            REQUIRE(!cache.find(makeKey(2)));
+        }
+
+        SECTION("replaces the route for a key")
+        {
+            cache.insert(makeKey(1), std::vector<Point>{Point(1, 1)});
+            cache.insert(makeKey(1), std::vector<Point>{Point(2, 2)});
+
+            REQUIRE(cache.size() == 1);
+            REQUIRE((*cache.find(makeKey(1)) == std::vector<Point>{Point(2, 2)}));
+        }
+
+        SECTION("drops the oldest route when full")
+        {
+            for (std::size_t i = 0; i < PathCache::Capacity + 1; ++i)
+            {
+                cache.insert(makeKey(static_cast<int>(i)), std::vector<Point>{Point(0, 0)});
+            }
+
+            REQUIRE(cache.size() == PathCache::Capacity);
+            REQUIRE(!cache.find(makeKey(0)));
+            REQUIRE(cache.find(makeKey(1)));
+            REQUIRE(cache.find(makeKey(PathCache::Capacity)));
+            REQUIRE(cache.getEntries().front().first == makeKey(1));
+        }
+
+        SECTION("drops every route when the epoch advances")
+        {
+            cache.insert(makeKey(1), std::vector<Point>{Point(1, 1)});
+            cache.advanceEpoch();
+
+            REQUIRE(cache.getEpoch() == 1);
+            REQUIRE(cache.size() == 0);
+
+            // routes found before the change are out of date
+            cache.insert(makeKey(1, 0), std::vector<Point>{Point(1, 1)});
+            REQUIRE(cache.size() == 0);
+
+            cache.insert(makeKey(1, 1), std::vector<Point>{Point(1, 1)});
+            REQUIRE(cache.find(makeKey(1, 1)));
+        }
+
+        SECTION("groups start cells into coarse cells")
+        {
+            REQUIRE(PathCache::toCoarseCell(Point(0, 7)) == Point(0, 0));
+            REQUIRE(PathCache::toCoarseCell(Point(8, 15)) == Point(1, 1));
+            REQUIRE(PathCache::toCoarseCell(Point(-1, -8)) == Point(-1, -1));
+            REQUIRE(PathCache::toCoarseCell(Point(-9, 0)) == Point(-2, 0));
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#include <catch.hpp>
+#include <rwe/pathfinding/PathRepair.h>
+
+namespace rwe
+{
+    TEST_CASE("expandRoute")
+    {
+        SECTION("returns nothing for an empty route")
+        {
+            REQUIRE(expandRoute(std::vector<Point>()).empty());
+        }
+
+        SECTION("fills in straight and diagonal lines between corners")
+        {
+            std::vector<Point> corners{Point(0, 0), Point(3, 0), Point(1, 2)};
+            std::vector<Point> expected{
+                Point(0, 0),
+                Point(1, 0),
+                Point(2, 0),
+                Point(3, 0),
+                Point(2, 1),
+                Point(1, 2),
+            };
+
+            REQUIRE(expandRoute(corners) == expected);
+        }
+    }
+
+    TEST_CASE("findRejoinIndex")
+    {
+        std::vector<Point> route{Point(0, 0), Point(1, 0), Point(2, 0), Point(3, 0), Point(4, 0), Point(5, 0)};
+
+        SECTION("returns zero when nothing is blocked")
+        {
+            auto index = findRejoinIndex(route, [](const Point&) { return true; });
+            REQUIRE(index == std::optional<std::size_t>(0));
+        }
+
+        SECTION("returns the first cell after the first blocked stretch")
+        {
+            auto index = findRejoinIndex(route, [](const Point& p) { return p.x != 2 && p.x != 3 && p.x != 5; });
+            REQUIRE(index == std::optional<std::size_t>(4));
+        }
+
+        SECTION("returns nothing when the route is blocked to its end")
+        {
+            auto index = findRejoinIndex(route, [](const Point& p) { return p.x < 4; });
+            REQUIRE(!index);
+        }
+    }
+}
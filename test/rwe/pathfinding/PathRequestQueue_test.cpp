@@ -0,0 +1,94 @@
+#include <catch.hpp>
+#include <rwe/pathfinding/PathRequestQueue.h>
+
+namespace rwe
+{
+    static PathRequest makeRequest(unsigned int unitId, PathRequestPriority priority, unsigned int time = 0)
+    {
+        return PathRequest{UnitId(unitId), priority, GameTime(time)};
+    }
+
+    TEST_CASE("PathRequestQueue")
+    {
+        PathRequestQueue queue;
+
+        SECTION("starts empty")
+        {
+            REQUIRE(queue.empty());
+            REQUIRE(queue.size() == 0);
+            REQUIRE(!queue.pop());
+        }
+
+        SECTION("serves urgent requests first, then oldest first")
+        {
+            queue.push(makeRequest(1, PathRequestPriority::Repath));
+            queue.push(makeRequest(2, PathRequestPriority::Order));
+            queue.push(makeRequest(3, PathRequestPriority::Repath));
+            queue.push(makeRequest(4, PathRequestPriority::Order));
+
+            REQUIRE(queue.pop()->unitId == UnitId(2));
+            REQUIRE(queue.pop()->unitId == UnitId(4));
+            REQUIRE(queue.pop()->unitId == UnitId(1));
+            REQUIRE(queue.pop()->unitId == UnitId(3));
+            REQUIRE(queue.empty());
+        }
+
+        SECTION("keeps one request per unit, moved to the back")
+        {
+            queue.push(makeRequest(1, PathRequestPriority::Order, 5));
+            queue.push(makeRequest(2, PathRequestPriority::Order));
+            queue.push(makeRequest(1, PathRequestPriority::Order, 7));
+
+            REQUIRE(queue.size() == 2);
+            REQUIRE(queue.contains(UnitId(1)));
+            REQUIRE(queue.pop()->unitId == UnitId(2));
+
+            auto request = queue.pop();
+            REQUIRE(request->unitId == UnitId(1));
+            REQUIRE(request->requestTime == GameTime(7));
+            REQUIRE(!queue.pop());
+        }
+
+        SECTION("a replaced request keeps the more urgent priority")
+        {
+            queue.push(makeRequest(1, PathRequestPriority::Order));
+            queue.push(makeRequest(2, PathRequestPriority::Repath));
+            queue.push(makeRequest(1, PathRequestPriority::Repath));
+
+            auto request = queue.pop();
+            REQUIRE(request->unitId == UnitId(1));
+            REQUIRE(request->priority == PathRequestPriority::Order);
+        }
+
+        SECTION("erase removes a unit's request")
+        {
+            queue.push(makeRequest(1, PathRequestPriority::Order));
+            queue.push(makeRequest(2, PathRequestPriority::Order));
+            queue.erase(UnitId(1));
+            queue.erase(UnitId(3));
+
+            REQUIRE(queue.size() == 1);
+            REQUIRE(!queue.contains(UnitId(1)));
+            REQUIRE(queue.pop()->unitId == UnitId(2));
+            REQUIRE(queue.empty());
+        }
+
+        SECTION("getRequests lists requests in the order they will be served")
+        {
+            for (unsigned int i = 0; i < 50; ++i)
+            {
+                queue.push(makeRequest(i % 7, i % 3 == 0 ? PathRequestPriority::Order : PathRequestPriority::Repath, i));
+            }
+
+            auto requests = queue.getRequests();
+            REQUIRE(requests.size() == queue.size());
+            for (const auto& expected : requests)
+            {
+                auto actual = queue.pop();
+                REQUIRE(!!actual);
+                REQUIRE(*actual == expected);
+            }
+            REQUIRE(queue.empty());
+        }
+    }
+}
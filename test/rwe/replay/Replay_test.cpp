@@ -0,0 +1,113 @@
+#include <catch.hpp>
+#include <rwe/replay/Replay.h>
+#include <rwe/replay/ReplayRecorder.h>
+#include <sstream>
+
+namespace rwe
+{
+    ReplayHeader createTestHeader()
+    {
+        ReplayHeader header;
+        header.mapName = "Coast to Coast";
+        header.schemaIndex = 1;
+        header.unitDataVersion = 0x0123456789abcdefull;
+        header.randomSeed = 42;
+        header.ticksPerSecond = 30;
+        header.playerColors = {0, 3};
+        return header;
+    }
+
+    TEST_CASE("readReplay")
+    {
+        SECTION("reads back what ReplayRecorder wrote")
+        {
+            auto stream = std::make_unique<std::stringstream>();
+            auto& buffer = *stream;
+
+            ReplayRecorder recorder(std::move(stream), createTestHeader());
+            recorder.record(GameTime(0), SpawnUnitCommand{"ARMCOM", PlayerId(1), Vector3f(10.0f, 20.0f, 30.0f)});
+            recorder.record(GameTime(0), MoveOrderCommand{UnitId(5), Vector3f(1.0f, 2.0f, 3.0f), false});
+            recorder.record(GameTime(30), AttackOrderCommand{UnitId(5), UnitId(7), true});
+            recorder.record(GameTime(31), AttackGroundOrderCommand{UnitId(7), Vector3f(4.0f, 5.0f, 6.0f), false});
+            recorder.record(GameTime(100), StopCommand{UnitId(7)});
+            recorder.record(GameTime(250), EndGameCommand());
+
+            auto replay = readReplay(buffer);
+
+            REQUIRE(replay.header.mapName == "Coast to Coast");
+            REQUIRE(replay.header.schemaIndex == 1);
+            REQUIRE(replay.header.unitDataVersion == 0x0123456789abcdefull);
+            REQUIRE(replay.header.randomSeed == 42);
+            REQUIRE(replay.header.ticksPerSecond == 30);
+            REQUIRE(replay.header.playerColors == std::vector<unsigned int>({0, 3}));
+
+            REQUIRE(replay.entries.size() == 6);
+
+            REQUIRE(replay.entries[0].time == GameTime(0));
+            const auto& spawn = boost::get<SpawnUnitCommand>(replay.entries[0].command);
+            REQUIRE(spawn.unitType == "ARMCOM");
+            REQUIRE(spawn.owner == PlayerId(1));
+            REQUIRE(spawn.position == Vector3f(10.0f, 20.0f, 30.0f));
+
+            REQUIRE(replay.entries[1].time == GameTime(0));
+            const auto& move = boost::get<MoveOrderCommand>(replay.entries[1].command);
+            REQUIRE(move.unitId == UnitId(5));
+            REQUIRE(move.destination == Vector3f(1.0f, 2.0f, 3.0f));
+            REQUIRE(!move.enqueue);
+
+            REQUIRE(replay.entries[2].time == GameTime(30));
+            const auto& attack = boost::get<AttackOrderCommand>(replay.entries[2].command);
+            REQUIRE(attack.unitId == UnitId(5));
+            REQUIRE(attack.target == UnitId(7));
+            REQUIRE(attack.enqueue);
+
+            REQUIRE(replay.entries[3].time == GameTime(31));
+            const auto& attackGround = boost::get<AttackGroundOrderCommand>(replay.entries[3].command);
+            REQUIRE(attackGround.unitId == UnitId(7));
+            REQUIRE(attackGround.target == Vector3f(4.0f, 5.0f, 6.0f));
+            REQUIRE(!attackGround.enqueue);
+
+            REQUIRE(replay.entries[4].time == GameTime(100));
+            REQUIRE(boost::get<StopCommand>(replay.entries[4].command).unitId == UnitId(7));
+
+            REQUIRE(replay.entries[5].time == GameTime(250));
+            REQUIRE(boost::get<EndGameCommand>(&replay.entries[5].command) != nullptr);
+        }
+
+        SECTION("reads a truncated replay up to the last complete entry")
+        {
+            auto stream = std::make_unique<std::stringstream>();
+            auto& buffer = *stream;
+
+            ReplayRecorder recorder(std::move(stream), createTestHeader());
+            recorder.record(GameTime(10), StopCommand{UnitId(1)});
+            recorder.record(GameTime(20), StopCommand{UnitId(2)});
+
+            auto bytes = buffer.str();
+            std::stringstream truncated(bytes.substr(0, bytes.size() - 2));
+
+            auto replay = readReplay(truncated);
+            REQUIRE(replay.entries.size() == 1);
+            REQUIRE(replay.entries[0].time == GameTime(10));
+            REQUIRE(boost::get<StopCommand>(replay.entries[0].command).unitId == UnitId(1));
+        }
+
+        SECTION("rejects a stream that is not a replay")
+        {
+            std::stringstream stream("this is not a replay");
+            REQUIRE_THROWS(readReplay(stream));
+        }
+
+        SECTION("rejects an unknown command")
+        {
+            std::stringstream stream;
+            SnapshotWriter writer(&stream);
+            writeReplayHeader(writer, createTestHeader());
+            writer.writeUint32(0);
+            writer.writeUint8(200);
+            writer.writeUint32(0);
+
+            REQUIRE_THROWS(readReplay(stream));
+        }
+    }
+}
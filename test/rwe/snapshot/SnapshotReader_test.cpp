@@ -0,0 +1,69 @@
+#include <catch.hpp>
+#include <cmath>
+#include <rwe/snapshot/SnapshotReader.h>
+#include <rwe/snapshot/SnapshotWriter.h>
+#include <sstream>
+
+namespace rwe
+{
+    TEST_CASE("SnapshotReader")
+    {
+        SECTION("reads back what SnapshotWriter wrote")
+        {
+            std::stringstream stream;
+            SnapshotWriter writer(&stream);
+            writer.writeBool(true);
+            writer.writeUint8(200);
+            writer.writeUint32(0xdeadbeef);
+            writer.writeUint64(0x0123456789abcdefull);
+            writer.writeInt32(-42);
+            writer.writeFloat(-0.0f);
+            writer.writeString("hello");
+            writer.writeVector3f(Vector3f(1.0f, 2.5f, -3.0f));
+            writer.writeCount(7);
+
+            SnapshotReader reader(&stream);
+            REQUIRE(reader.readBool() == true);
+            REQUIRE(reader.readUint8() == 200);
+            REQUIRE(reader.readUint32() == 0xdeadbeef);
+            REQUIRE(reader.readUint64() == 0x0123456789abcdefull);
+            REQUIRE(reader.readInt32() == -42);
+            auto f = reader.readFloat();
+            REQUIRE(f == 0.0f);
+            REQUIRE(std::signbit(f));
+            REQUIRE(reader.readString() == "hello");
+            REQUIRE(reader.readVector3f() == Vector3f(1.0f, 2.5f, -3.0f));
+            REQUIRE(reader.readCount() == 7);
+        }
+
+        SECTION("writes integers little-endian")
+        {
+            std::stringstream stream;
+            SnapshotWriter writer(&stream);
+            writer.writeUint32(0x04030201);
+
+            REQUIRE(stream.str() == std::string("\x01\x02\x03\x04"));
+        }
+
+        SECTION("throws when the stream ends early")
+        {
+            std::stringstream stream;
+            SnapshotWriter writer(&stream);
+            writer.writeUint32(10);
+            writer.writeUint8('a');
+
+            SnapshotReader reader(&stream);
+            REQUIRE_THROWS(reader.readString());
+        }
+
+        SECTION("rejects invalid booleans")
+        {
+            std::stringstream stream;
+            SnapshotWriter writer(&stream);
+            writer.writeUint8(2);
+
+            SnapshotReader reader(&stream);
+            REQUIRE_THROWS(reader.readBool());
+        }
+    }
+}